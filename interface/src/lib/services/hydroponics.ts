@@ -4,16 +4,35 @@
  * Provides functions for interacting with the ESP32 backend for the hydroponics system.
  */
 
+import { get } from 'svelte/store';
+import { user } from '$lib/stores/user';
+
 // Sensor data interface
 export interface SensorData {
   temperature: number;
   ph: number;
   ec: number;
   waterLevel: number;
-  humidity: number;
   timestamp: number;
 }
 
+// One downsampled point of a sensor channel: picked value with the range of its bucket
+export interface SensorPoint {
+  timestamp: number;
+  value: number;
+  low: number;
+  high: number;
+}
+
+// Sensor history, one series per channel
+export interface SensorHistory {
+  resolution: number;
+  temperature: SensorPoint[];
+  ph: SensorPoint[];
+  ec: SensorPoint[];
+  waterLevel: SensorPoint[];
+}
+
 // Relay interface
 export interface Relay {
   id: number;
@@ -44,15 +63,69 @@ export interface HydroponicsSettings {
   pumpCycleOffDuration: number;
 }
 
+function authorization(): string {
+  const token = get(user).bearer_token;
+  return token ? 'Bearer ' + token : 'Basic';
+}
+
 /**
  * Fetch the latest sensor data from the ESP32
  */
 export async function fetchSensorData(): Promise<SensorData> {
-  const response = await fetch('/api/hydroponics/sensors');
+  const response = await fetch('/rest/sensors', {
+    headers: {
+      Authorization: authorization()
+    }
+  });
   if (!response.ok) {
     throw new Error('Failed to fetch sensor data');
   }
-  return await response.json();
+  const data = await response.json();
+  return {
+    temperature: data.temperature ?? NaN,
+    ph: data.ph ?? NaN,
+    ec: data.ec ?? NaN,
+    waterLevel: data.level ?? NaN,
+    timestamp: data.timestamp * 1000
+  };
+}
+
+/**
+ * Fetch the sensor history between from and to (ms), reduced to at most points per channel.
+ * The ESP32 answers from the coarsest rollup that still has enough resolution.
+ */
+export async function fetchSensorHistory(from: number, to: number, points = 200): Promise<SensorHistory> {
+  const query = `from=${Math.floor(from / 1000)}&to=${Math.floor(to / 1000)}&points=${points}`;
+  const response = await fetch(`/rest/sensors/history?${query}`, {
+    headers: {
+      Authorization: authorization()
+    }
+  });
+  if (!response.ok) {
+    throw new Error('Failed to fetch sensor history');
+  }
+  const data = await response.json();
+
+  // rows hold timestamp, value, low and high for every channel
+  const series = (channel: string): SensorPoint[] => {
+    const offset = 4 * data.channels.indexOf(channel);
+    return data.points
+      .filter((row: (number | null)[]) => row[offset] !== null)
+      .map((row: number[]) => ({
+        timestamp: row[offset] * 1000,
+        value: row[offset + 1],
+        low: row[offset + 2],
+        high: row[offset + 3]
+      }));
+  };
+
+  return {
+    resolution: data.resolution,
+    temperature: series('temperature'),
+    ph: series('ph'),
+    ec: series('ec'),
+    waterLevel: series('level')
+  };
 }
 
 /**
@@ -2,20 +2,31 @@ import { writable } from 'svelte/store';
 import { goto } from '$app/navigation';
 import { jwtDecode } from 'jwt-decode';
 
+// permission bits carried in the JWT, see SecurityManager.h
+export const Permission = {
+	READ_RELAYS: 1 << 0,
+	WRITE_RELAYS: 1 << 1,
+	OTA: 1 << 2,
+	SETTINGS: 1 << 3
+};
+
 export type userProfile = {
 	username: string;
 	admin: boolean;
+	permissions: number;
 	bearer_token: string;
 };
 
 type decodedJWT = {
 	username: string;
 	admin: boolean;
+	permissions: number;
 };
 
 let empty = {
 	username: '',
 	admin: false,
+	permissions: 0,
 	bearer_token: ''
 };
 
@@ -35,7 +46,8 @@ function createStore() {
 			const userdata = {
 				bearer_token: access_token,
 				username: decoded.username,
-				admin: decoded.admin
+				admin: decoded.admin,
+				permissions: decoded.permissions ?? 0
 			};
 			set(userdata);
 			// persist store in sessionStorage / localStorage
@@ -123,7 +123,21 @@ export type StaticSystemInformation = {
 	arduino_version: string;
 	flash_chip_size: number;
 	flash_chip_speed: number;
+	fs_writes: number;
+	fs_writes_avoided: number;
+	fs_bytes_written: number;
 	cpu_reset_reason: string;
+	// only reported by firmware built with ENABLE_ASYNC
+	async_workers?: AsyncWorkerStats;
+};
+
+export type AsyncWorkerStats = {
+	workers: number;
+	busy: number;
+	handled: number;
+	rejected: number;
+	wait_avg_ms: number;
+	wait_max_ms: number;
 };
 
 export type SystemInformation = Analytics & StaticSystemInformation;
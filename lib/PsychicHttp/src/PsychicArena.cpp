@@ -0,0 +1,147 @@
+#include "PsychicArena.h"
+
+#define ARENA_ALIGN(x) (((x) + 7) & ~((size_t)7))
+
+PsychicArena::PsychicArena(size_t blockSize) : _head(NULL),
+                                               _current(NULL),
+                                               _blockSize(blockSize),
+                                               _depth(0)
+{
+}
+
+PsychicArena::~PsychicArena()
+{
+  _freeBlocks();
+}
+
+PsychicArena::Block *PsychicArena::_newBlock(size_t size)
+{
+  Block *block = (Block *)malloc(sizeof(Block) + size);
+  if (block == NULL)
+  {
+    ESP_LOGE(PH_TAG, "Unable to allocate %u byte arena block", size);
+    return NULL;
+  }
+
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+
+  return block;
+}
+
+void PsychicArena::_freeBlocks()
+{
+  Block *block = _head;
+  while (block != NULL)
+  {
+    Block *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  _head = NULL;
+  _current = NULL;
+}
+
+void *PsychicArena::alloc(size_t size)
+{
+  size = ARENA_ALIGN(size);
+
+  //first use, grab our main block
+  if (_head == NULL)
+  {
+    _head = _newBlock(_blockSize > size ? _blockSize : size);
+    _current = _head;
+    if (_head == NULL)
+      return NULL;
+  }
+
+  //out of room? chain on an overflow block.
+  if (_current->used + size > _current->size)
+  {
+    Block *block = _newBlock(_blockSize > size ? _blockSize : size);
+    if (block == NULL)
+      return NULL;
+
+    _current->next = block;
+    _current = block;
+  }
+
+  void *ptr = _data(_current) + _current->used;
+  _current->used += size;
+
+  return ptr;
+}
+
+char *PsychicArena::strdup(const char *str)
+{
+  size_t len = strlen(str) + 1;
+  char *copy = (char *)alloc(len);
+  if (copy != NULL)
+    memcpy(copy, str, len);
+
+  return copy;
+}
+
+bool PsychicArena::owns(const void *ptr)
+{
+  for (Block *block = _head; block != NULL; block = block->next)
+    if ((const uint8_t *)ptr >= _data(block) && (const uint8_t *)ptr < _data(block) + block->size)
+      return true;
+
+  return false;
+}
+
+void PsychicArena::retain()
+{
+  _depth++;
+}
+
+void PsychicArena::release()
+{
+  if (_depth > 0)
+    _depth--;
+
+  if (_depth == 0)
+    reset();
+}
+
+void PsychicArena::reset()
+{
+  if (_head == NULL)
+    return;
+
+  //did we overflow? replace the chain with one block big enough for next time.
+  if (_head->next != NULL)
+  {
+    size_t total = capacity();
+    _freeBlocks();
+
+    _blockSize = total < PSYCHIC_ARENA_MAX_SIZE ? total : PSYCHIC_ARENA_MAX_SIZE;
+    _head = _newBlock(_blockSize);
+    _current = _head;
+    return;
+  }
+
+  _head->used = 0;
+  _current = _head;
+}
+
+size_t PsychicArena::used()
+{
+  size_t used = 0;
+  for (Block *block = _head; block != NULL; block = block->next)
+    used += block->used;
+
+  return used;
+}
+
+size_t PsychicArena::capacity()
+{
+  size_t capacity = 0;
+  for (Block *block = _head; block != NULL; block = block->next)
+    capacity += block->size;
+
+  return capacity;
+}
@@ -0,0 +1,85 @@
+#ifndef PsychicArena_h
+#define PsychicArena_h
+
+#include "PsychicCore.h"
+
+/*
+* PsychicArena :: bump allocator owned by a client connection
+*
+* Request metadata (response headers, parameters) is carved out of one block
+* and released all at once when the outermost request on the connection ends.
+* If a request overflows the block, extra blocks are chained on and the block
+* is grown on reset, so steady state traffic does not touch the heap at all.
+*/
+
+class PsychicArena {
+  private:
+    struct Block {
+      Block *next;
+      size_t size;
+      size_t used;
+    };
+
+    Block *_head;
+    Block *_current;
+    size_t _blockSize;
+    int _depth;
+
+    Block *_newBlock(size_t size);
+    void _freeBlocks();
+    static uint8_t *_data(Block *block) { return (uint8_t *)(block + 1); }
+
+  public:
+    PsychicArena(size_t blockSize = PSYCHIC_ARENA_SIZE);
+    ~PsychicArena();
+
+    void *alloc(size_t size);
+    char *strdup(const char *str);
+    bool owns(const void *ptr);
+
+    //nested requests on the same connection (eg. websocket frames) share the arena
+    void retain();
+    void release();
+    void reset();
+
+    size_t used();
+    size_t capacity();
+};
+
+/*
+* PsychicArenaAllocator :: lets std containers put their nodes in an arena
+* (falls back to the heap if there is no arena)
+*/
+
+template <typename T>
+class PsychicArenaAllocator {
+  public:
+    typedef T value_type;
+
+    PsychicArena *arena;
+
+    PsychicArenaAllocator(PsychicArena *arena = NULL) noexcept : arena(arena) {}
+    template <typename U>
+    PsychicArenaAllocator(const PsychicArenaAllocator<U> &other) noexcept : arena(other.arena) {}
+
+    T *allocate(size_t n)
+    {
+      void *ptr = arena != NULL ? arena->alloc(n * sizeof(T)) : NULL;
+      if (ptr == NULL)
+        ptr = malloc(n * sizeof(T));
+      return (T *)ptr;
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+      if (arena == NULL || !arena->owns(ptr))
+        free(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const PsychicArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const PsychicArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+#endif // PsychicArena_h
@@ -4,13 +4,22 @@
 
 PsychicClient::PsychicClient(httpd_handle_t server, int socket) : _server(server),
                                                                   _socket(socket),
+                                                                  _arena(NULL),
+                                                                  _lastActivity(millis()),
+                                                                  _activeRequests(0),
                                                                   _friend(NULL),
-                                                                  isNew(false)
+                                                                  isNew(false),
+                                                                  context(NULL)
 {
 }
 
 PsychicClient::~PsychicClient()
 {
+  if (context != NULL)
+    delete context;
+
+  if (_arena != NULL)
+    delete _arena;
 }
 
 httpd_handle_t PsychicClient::server()
@@ -23,6 +32,36 @@ int PsychicClient::socket()
   return _socket;
 }
 
+PsychicArena *PsychicClient::arena()
+{
+  if (_arena == NULL)
+    _arena = new PsychicArena();
+
+  return _arena;
+}
+
+void PsychicClient::beginRequest()
+{
+  _activeRequests++;
+  _lastActivity = millis();
+}
+
+void PsychicClient::endRequest()
+{
+  if (_activeRequests > 0)
+    _activeRequests--;
+  _lastActivity = millis();
+}
+
+bool PsychicClient::isIdle(unsigned long timeout)
+{
+  //upgraded connections (websocket, event source) are supposed to stay open
+  if (_friend != NULL || _activeRequests > 0)
+    return false;
+
+  return millis() - _lastActivity > timeout;
+}
+
 // I'm not sure this is entirely safe to call.  I was having issues with race conditions when highly loaded using this.
 esp_err_t PsychicClient::close()
 {
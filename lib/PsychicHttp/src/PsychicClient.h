@@ -2,6 +2,16 @@
 #define PsychicClient_h
 
 #include "PsychicCore.h"
+#include "PsychicArena.h"
+
+/*
+* PsychicClientContext :: state a filter or handler keeps for the lifetime of a connection
+*/
+
+class PsychicClientContext {
+  public:
+    virtual ~PsychicClientContext() {}
+};
 
 /*
 * PsychicClient :: Generic wrapper around the ESP-IDF socket
@@ -11,6 +21,9 @@ class PsychicClient {
   protected:
     httpd_handle_t _server;
     int _socket;
+    PsychicArena *_arena;
+    unsigned long _lastActivity;
+    uint8_t _activeRequests;
 
   public:
     PsychicClient(httpd_handle_t server, int socket);
@@ -22,12 +35,23 @@ class PsychicClient {
 
     bool isNew = false;
 
+    //owned by the client, deleted when the connection closes
+    PsychicClientContext *context;
+
     bool operator==(PsychicClient& rhs) const { return _socket == rhs.socket(); }
 
     httpd_handle_t server();
     int socket();
     esp_err_t close();
 
+    //scratch memory for the request currently running on this connection
+    PsychicArena *arena();
+
+    //keep track of what the connection is doing so idle ones can be reaped
+    void beginRequest();
+    void endRequest();
+    bool isIdle(unsigned long timeout);
+
     IPAddress localIP();
     IPAddress remoteIP();
 };
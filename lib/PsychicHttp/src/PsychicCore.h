@@ -28,6 +28,30 @@
   #define MAX_REQUEST_BODY_SIZE (16*1024) //16K
 #endif
 
+#ifndef ASYNC_WORKER_COUNT
+  #define ASYNC_WORKER_COUNT 8 //default for PsychicHttpServer::asyncWorkers
+#endif
+
+#ifndef PSYCHIC_STACK_SIZE
+  #define PSYCHIC_STACK_SIZE (6*1024) //httpd task (and async worker) stack, handlers decode tokens into stack buffers
+#endif
+
+#ifndef PSYCHIC_IDLE_TIMEOUT
+  #define PSYCHIC_IDLE_TIMEOUT 30000 //ms a keep-alive connection may sit idle with useHighConcurrencyProfile()
+#endif
+
+#ifndef PSYCHIC_RESERVED_SOCKETS
+  #define PSYCHIC_RESERVED_SOCKETS 3 //sockets left for mqtt, dns, ntp etc with useHighConcurrencyProfile()
+#endif
+
+#ifndef PSYCHIC_ARENA_SIZE
+  #define PSYCHIC_ARENA_SIZE 1024 //per connection scratch space for headers + params
+#endif
+
+#ifndef PSYCHIC_ARENA_MAX_SIZE
+  #define PSYCHIC_ARENA_MAX_SIZE (8*1024) //how far the arena may grow after an overflow
+#endif
+
 #ifdef ARDUINO
   #include <Arduino.h>
   #include <ArduinoTrace.h>
@@ -36,6 +60,7 @@
 #include <esp_http_server.h>
 #include <map>
 #include <list>
+#include <unordered_map>
 #include <libb64/cencode.h>
 #include "esp_random.h"
 #include "MD5Builder.h"
@@ -45,7 +70,14 @@
 
 enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
 
+//async worker queues, api requests are preferred over static assets
+enum PsychicAsyncLane { ASYNC_LANE_API, ASYNC_LANE_STATIC, ASYNC_LANE_COUNT };
+
 String urlDecode(const char* encoded);
+//decodes length bytes into a caller buffer, false if it doesn't fit
+bool urlDecode(const char* encoded, size_t length, char* decoded, size_t size);
+//decodes one (possibly %xx encoded) character, returns the encoded length
+size_t urlDecodeChar(const char* encoded, size_t length, char* decoded);
 
 class PsychicHttpServer;
 class PsychicRequest;
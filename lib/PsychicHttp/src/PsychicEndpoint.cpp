@@ -5,7 +5,8 @@ PsychicEndpoint::PsychicEndpoint() :
   _server(NULL),
   _uri(""),
   _method(HTTP_GET),
-  _handler(NULL)
+  _handler(NULL),
+  _lane(ASYNC_LANE_API)
 {
 }
 
@@ -13,7 +14,8 @@ PsychicEndpoint::PsychicEndpoint(PsychicHttpServer *server, http_method method,
   _server(server),
   _uri(uri),
   _method(method),
-  _handler(NULL)
+  _handler(NULL),
+  _lane(ASYNC_LANE_API)
 {
 }
 
@@ -41,15 +43,22 @@ String PsychicEndpoint::uri() {
   return _uri;
 }
 
+PsychicEndpoint * PsychicEndpoint::setLane(PsychicAsyncLane lane)
+{
+  _lane = lane;
+  return this;
+}
+
 esp_err_t PsychicEndpoint::requestCallback(httpd_req_t *req)
 {
   #ifdef ENABLE_ASYNC
     if (is_on_async_worker_thread() == false) {
-      if (submit_async_req(req, PsychicEndpoint::requestCallback) == ESP_OK) {
+      PsychicEndpoint *endpoint = (PsychicEndpoint *)req->user_ctx;
+      if (submit_async_req(req, PsychicEndpoint::requestCallback, endpoint->lane()) == ESP_OK) {
         return ESP_OK;
       } else {
         httpd_resp_set_status(req, "503 Busy");
-        httpd_resp_sendstr(req, "No workers available. Server busy.</div>");
+        httpd_resp_sendstr(req, "No workers available. Server busy.");
         return ESP_OK;
       }
     }
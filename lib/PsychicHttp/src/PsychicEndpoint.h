@@ -18,6 +18,7 @@ class PsychicEndpoint
     String _uri;
     http_method _method;
     PsychicHandler *_handler;
+    PsychicAsyncLane _lane;
 
   public:
     PsychicEndpoint();
@@ -31,6 +32,10 @@ class PsychicEndpoint
 
     String uri();
 
+    //which async worker queue this endpoint waits in (only used with ENABLE_ASYNC)
+    PsychicEndpoint* setLane(PsychicAsyncLane lane);
+    PsychicAsyncLane lane() { return _lane; }
+
     static esp_err_t requestCallback(httpd_req_t *req);
 };
 
@@ -1,7 +1,16 @@
 #include "PsychicFileResponse.h"
 #include "PsychicResponse.h"
 #include "PsychicRequest.h"
+#include <http_status.h>
 
+//one scratch buffer per worker task, kept for the lifetime of the task instead of malloc'd per response
+static uint8_t *_chunkBuffer()
+{
+  static thread_local uint8_t *buffer = nullptr;
+  if (buffer == nullptr)
+    buffer = (uint8_t *)malloc(FILE_CHUNK_SIZE);
+  return buffer;
+}
 
 PsychicFileResponse::PsychicFileResponse(PsychicRequest *request, FS &fs, const String& path, const String& contentType, bool download)
  : PsychicResponse(request) {
@@ -16,6 +25,12 @@ PsychicFileResponse::PsychicFileResponse(PsychicRequest *request, FS &fs, const
   _content = fs.open(_path, "r");
   _contentLength = _content.size();
 
+  if (_content) {
+    _etag = etag(_content);
+    addHeader("ETag", _etag.c_str());
+    addHeader("Accept-Ranges", "bytes");
+  }
+
   if(contentType == "")
     _setContentType(path);
   else
@@ -46,6 +61,12 @@ PsychicFileResponse::PsychicFileResponse(PsychicRequest *request, File content,
   _content = content;
   _contentLength = _content.size();
 
+  if (_content) {
+    _etag = etag(_content);
+    addHeader("ETag", _etag.c_str());
+    addHeader("Accept-Ranges", "bytes");
+  }
+
   if(contentType == "")
     _setContentType(path);
   else
@@ -95,51 +116,128 @@ void PsychicFileResponse::_setContentType(const String& path){
   setContentType(_contentType);
 }
 
+String PsychicFileResponse::etag(File &file)
+{
+  //mtime + size changes whenever the file is rewritten, even if the size stays the same
+  char buf[32];
+  snprintf(buf, sizeof(buf), "\"%lx-%x\"", (unsigned long)file.getLastWrite(), (unsigned int)file.size());
+  return String(buf);
+}
+
+//returns 1 for a satisfiable single range, 0 to ignore the header and -1 if it can't be satisfied
+int PsychicFileResponse::_parseRange(const String& range, size_t size, size_t &start, size_t &end)
+{
+  if (!range.startsWith("bytes=") || range.indexOf(',') != -1)
+    return 0;
+
+  int dash = range.indexOf('-', 6);
+  if (dash == -1)
+    return 0;
+
+  String first = range.substring(6, dash);
+  String last = range.substring(dash + 1);
+  first.trim();
+  last.trim();
+
+  //suffix range: the last n bytes
+  if (first.length() == 0)
+  {
+    size_t suffix = strtoul(last.c_str(), NULL, 10);
+    if (last.length() == 0 || suffix == 0 || size == 0)
+      return -1;
+    start = suffix >= size ? 0 : size - suffix;
+    end = size - 1;
+    return 1;
+  }
+
+  start = strtoul(first.c_str(), NULL, 10);
+  end = last.length() ? strtoul(last.c_str(), NULL, 10) : size - 1;
+
+  if (start >= size || end < start)
+    return -1;
+  if (end >= size)
+    end = size - 1;
+
+  return 1;
+}
+
 esp_err_t PsychicFileResponse::send()
 {
   esp_err_t err = ESP_OK;
 
-  //just send small files directly
   size_t size = getContentLength();
-  if (size < FILE_CHUNK_SIZE)
+  size_t start = 0;
+  size_t end = size ? size - 1 : 0;
+
+  //only honour a range if the client's copy is still the one we have (If-Range)
+  if (_code == 200 && _request->hasHeader("Range"))
+  {
+    String ifRange = _request->header("If-Range");
+    if (ifRange.length() == 0 || ifRange == _etag)
+    {
+      int result = _parseRange(_request->header("Range"), size, start, end);
+      if (result < 0)
+      {
+        char contentRange[32];
+        snprintf(contentRange, sizeof(contentRange), "bytes */%u", (unsigned int)size);
+        addHeader("Content-Range", contentRange);
+        setCode(416);
+        setContent("");
+        return PsychicResponse::send();
+      }
+      else if (result > 0)
+      {
+        char contentRange[64];
+        snprintf(contentRange, sizeof(contentRange), "bytes %u-%u/%u", (unsigned int)start, (unsigned int)end, (unsigned int)size);
+        addHeader("Content-Range", contentRange);
+        setCode(206);
+
+        if (start > 0 && !_content.seek(start))
+          return httpd_resp_send_err(this->_request->request(), HTTPD_500_INTERNAL_SERVER_ERROR, "Unable to seek file.");
+        size = end - start + 1;
+      }
+    }
+  }
+
+  uint8_t *chunk = _chunkBuffer();
+  if (chunk == NULL)
+  {
+    /* Respond with 500 Internal Server Error */
+    httpd_resp_send_err(this->_request->request(), HTTPD_500_INTERNAL_SERVER_ERROR, "Unable to allocate memory.");
+    return ESP_FAIL;
+  }
+
+  //just send small files directly
+  if (size <= FILE_CHUNK_SIZE)
   {
-    uint8_t *buffer = (uint8_t *)malloc(size);
-    int readSize = _content.readBytes((char *)buffer, size);
+    size_t readSize = size ? _content.read(chunk, size) : 0;
 
-    this->setContent(buffer, size);
+    this->setContent(chunk, readSize);
     err = PsychicResponse::send();
-    
-    free(buffer);
   }
   else
   {
-    /* Retrieve the pointer to scratch buffer for temporary storage */
-    char *chunk = (char *)malloc(FILE_CHUNK_SIZE);
-    if (chunk == NULL)
-    {
-      /* Respond with 500 Internal Server Error */
-      httpd_resp_send_err(this->_request->request(), HTTPD_500_INTERNAL_SERVER_ERROR, "Unable to allocate memory.");
-      return ESP_FAIL;
-    }
+    //esp-idf makes you set the whole status.
+    sprintf(_status, "%u %s", _code, http_status_reason(_code));
+    httpd_resp_set_status(_request->request(), _status);
 
     this->sendHeaders();
 
-    size_t chunksize;
-    do {
-        /* Read file in chunks into the scratch buffer */
-        chunksize = _content.readBytes(chunk, FILE_CHUNK_SIZE);
-        if (chunksize > 0)
-        {
-          err = this->sendChunk((uint8_t *)chunk, chunksize);
-          if (err != ESP_OK)
-            break;
-        }
-
-        /* Keep looping till the whole file is sent */
-    } while (chunksize != 0);
-
-    //keep track of our memory
-    free(chunk);
+    size_t remaining = size;
+    while (remaining > 0)
+    {
+      /* Read file in chunks into the scratch buffer */
+      size_t chunksize = _content.read(chunk, remaining < FILE_CHUNK_SIZE ? remaining : FILE_CHUNK_SIZE);
+      if (chunksize == 0)
+        break;
+
+      err = this->sendChunk(chunk, chunksize);
+      if (err != ESP_OK)
+        break;
+
+      /* Keep looping till the whole file (or range) is sent */
+      remaining -= chunksize;
+    }
 
     if (err == ESP_OK)
     {
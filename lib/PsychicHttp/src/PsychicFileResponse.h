@@ -12,12 +12,17 @@ class PsychicFileResponse: public PsychicResponse
   using FS = fs::FS;
   private:
     File _content;
+    String _etag;
     void _setContentType(const String& path);
+    int _parseRange(const String& range, size_t size, size_t &start, size_t &end);
   public:
     PsychicFileResponse(PsychicRequest *request, FS &fs, const String& path, const String& contentType=String(), bool download=false);
     PsychicFileResponse(PsychicRequest *request, File content, const String& path, const String& contentType=String(), bool download=false);
     ~PsychicFileResponse();
     esp_err_t send();
+
+    const String& etag() { return _etag; }
+    static String etag(File &file);
 };
 
 #endif // PsychicFileResponse_h
\ No newline at end of file
@@ -8,11 +8,14 @@
 #include "WiFi.h"
 
 PsychicHttpServer::PsychicHttpServer() :
+  _reapTimer(NULL),
   _onOpen(NULL),
   _onClose(NULL)
 {
   maxRequestBodySize = MAX_REQUEST_BODY_SIZE;
   maxUploadSize = MAX_UPLOAD_SIZE;
+  asyncWorkers = ASYNC_WORKER_COUNT;
+  idleTimeout = 0;
 
   defaultEndpoint = new PsychicEndpoint(this, HTTP_GET, "");
   onNotFound(PsychicHttpServer::defaultNotFoundHandler);
@@ -25,6 +28,8 @@ PsychicHttpServer::PsychicHttpServer() :
   config.global_user_ctx = this;
   config.global_user_ctx_free_fn = destroy;
   config.max_uri_handlers = 20;
+  //the 4k default leaves little room for the request buffers handlers keep on the stack
+  config.stack_size = PSYCHIC_STACK_SIZE;
 
   #ifdef ENABLE_ASYNC
     // It is advisable that httpd_config_t->max_open_sockets > MAX_ASYNC_REQUESTS
@@ -39,9 +44,12 @@ PsychicHttpServer::PsychicHttpServer() :
 
 PsychicHttpServer::~PsychicHttpServer()
 {
+  _stopReapTimer();
+
   for (auto *client : _clients)
     delete(client);
   _clients.clear();
+  _clientsBySocket.clear();
 
   for (auto *endpoint : _endpoints)
     delete(endpoint);
@@ -60,6 +68,25 @@ void PsychicHttpServer::destroy(void *ctx)
   delete temp;
 }
 
+void PsychicHttpServer::useHighConcurrencyProfile()
+{
+  // esp-idf keeps 3 sockets for itself, and the rest of the firmware needs a few as well
+  config.max_open_sockets = CONFIG_LWIP_MAX_SOCKETS - 3 - PSYCHIC_RESERVED_SOCKETS;
+
+  // when we do run out, drop the least recently used connection instead of refusing new ones
+  config.lru_purge_enable = true;
+
+  // don't let a stalled client block the server task for long
+  config.recv_wait_timeout = 3;
+  config.send_wait_timeout = 3;
+
+  // more connections may be waiting to be accepted when a dashboard reconnects all at once
+  config.backlog_conn = 8;
+
+  // and clean up keep-alive connections nobody is using anymore
+  idleTimeout = PSYCHIC_IDLE_TIMEOUT;
+}
+
 esp_err_t PsychicHttpServer::listen(uint16_t port)
 {
   this->_use_ssl = false;
@@ -74,7 +101,7 @@ esp_err_t PsychicHttpServer::_start()
 
   #ifdef ENABLE_ASYNC
     // start workers
-    start_async_req_workers();
+    start_async_req_workers(asyncWorkers);
   #endif
 
   //fire it up.
@@ -90,18 +117,75 @@ esp_err_t PsychicHttpServer::_start()
   if (ret != ESP_OK)
     ESP_LOGE(PH_TAG, "Add 404 handler failed (%s)", esp_err_to_name(ret)); 
 
+  // check for idle connections a few times per timeout period
+  if (idleTimeout > 0 && _reapTimer == NULL)
+  {
+    esp_timer_create_args_t timerArgs = {
+      .callback = PsychicHttpServer::_reapTimerCallback,
+      .arg = this,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "psychic_reap"
+    };
+
+    if (esp_timer_create(&timerArgs, &_reapTimer) == ESP_OK)
+      esp_timer_start_periodic(_reapTimer, (uint64_t)idleTimeout * 1000 / 4);
+    else
+      ESP_LOGE(PH_TAG, "Failed to create idle connection timer");
+  }
+
   return ret;
 }
 
+void PsychicHttpServer::_reapTimerCallback(void *arg)
+{
+  // the client list belongs to the server task, so do the actual work over there
+  PsychicHttpServer *server = (PsychicHttpServer *)arg;
+  httpd_queue_work(server->server, PsychicHttpServer::_reapIdleClients, server);
+}
+
+void PsychicHttpServer::_reapIdleClients(void *arg)
+{
+  PsychicHttpServer *server = (PsychicHttpServer *)arg;
+
+  if (server->_clients.empty())
+    return;
+
+  // collect first, closing removes clients from the list. A client holds a socket, so there are never
+  // more than CONFIG_LWIP_MAX_SOCKETS of them.
+  int idle[CONFIG_LWIP_MAX_SOCKETS];
+  int count = 0;
+  for (PsychicClient *client : server->_clients)
+    if (count < CONFIG_LWIP_MAX_SOCKETS && client->isIdle(server->idleTimeout))
+      idle[count++] = client->socket();
+
+  for (int i = 0; i < count; i++)
+  {
+    ESP_LOGD(PH_TAG, "Closing idle client %d", idle[i]);
+    httpd_sess_trigger_close(server->server, idle[i]);
+  }
+}
+
 esp_err_t PsychicHttpServer::_startServer() {
   return httpd_start(&this->server, &this->config);
 }
 
 void PsychicHttpServer::stop()
 {
+  _stopReapTimer();
+
   httpd_stop(this->server);  
 }
 
+void PsychicHttpServer::_stopReapTimer()
+{
+  if (_reapTimer != NULL)
+  {
+    esp_timer_stop(_reapTimer);
+    esp_timer_delete(_reapTimer);
+    _reapTimer = NULL;
+  }
+}
+
 PsychicHandler& PsychicHttpServer::addHandler(PsychicHandler* handler){
   _handlers.push_back(handler);
   return *handler;
@@ -297,17 +381,19 @@ PsychicStaticFileHandler* PsychicHttpServer::serveStatic(const char* uri, fs::FS
 
 void PsychicHttpServer::addClient(PsychicClient *client) {
   _clients.push_back(client);
+  _clientsBySocket[client->socket()] = client;
 }
 
 void PsychicHttpServer::removeClient(PsychicClient *client) {
   _clients.remove(client);
+  _clientsBySocket.erase(client->socket());
   delete client;
 }
 
 PsychicClient * PsychicHttpServer::getClient(int socket) {
-  for (PsychicClient * client : _clients)
-    if (client->socket() == socket)
-      return client;
+  auto it = _clientsBySocket.find(socket);
+  if (it != _clientsBySocket.end())
+    return it->second;
 
   return NULL;
 }
@@ -332,6 +418,55 @@ bool ON_AP_FILTER(PsychicRequest *request) {
   return WiFi.softAPIP() == request->client()->localIP();
 }
 
+//hex digit values, -1 for anything else
+static const int8_t hexValues[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+size_t urlDecodeChar(const char* encoded, size_t length, char* decoded)
+{
+  if (encoded[0] == '%' && length > 2) {
+    int8_t high = hexValues[(uint8_t)encoded[1]];
+    int8_t low = hexValues[(uint8_t)encoded[2]];
+    if (high >= 0 && low >= 0) {
+      *decoded = (char)((high << 4) | low);
+      return 3;
+    }
+  }
+
+  *decoded = encoded[0] == '+' ? ' ' : encoded[0];
+  return 1;
+}
+
+bool urlDecode(const char* encoded, size_t length, char* decoded, size_t size)
+{
+  size_t j = 0;
+  for (size_t i = 0; i < length; ) {
+    if (j + 1 >= size)
+      return false;
+    i += urlDecodeChar(encoded + i, length - i, decoded + j++);
+  }
+
+  if (size > 0)
+    decoded[j] = '\0';
+  return size > 0;
+}
+
 String urlDecode(const char* encoded)
 {
   size_t length = strlen(encoded);
@@ -340,24 +475,8 @@ String urlDecode(const char* encoded)
     return "";
   }
 
-  size_t i, j = 0;
-  for (i = 0; i < length; ++i) {
-      if (encoded[i] == '%' && isxdigit(encoded[i + 1]) && isxdigit(encoded[i + 2])) {
-          // Valid percent-encoded sequence
-          int hex;
-          sscanf(encoded + i + 1, "%2x", &hex);
-          decoded[j++] = (char)hex;
-          i += 2;  // Skip the two hexadecimal characters
-      } else if (encoded[i] == '+') {
-          // Convert '+' to space
-          decoded[j++] = ' ';
-      } else {
-          // Copy other characters as they are
-          decoded[j++] = encoded[i];
-      }
-  }
-
-  decoded[j] = '\0';  // Null-terminate the decoded string
+  //decoded text is never longer than the input
+  urlDecode(encoded, length, decoded, length + 1);
 
   String output(decoded);
   free(decoded);
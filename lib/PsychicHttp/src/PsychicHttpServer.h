@@ -4,6 +4,7 @@
 #include "PsychicCore.h"
 #include "PsychicClient.h"
 #include "PsychicHandler.h"
+#include <esp_timer.h>
 
 class PsychicEndpoint;
 class PsychicHandler;
@@ -16,6 +17,8 @@ class PsychicHttpServer
     std::list<PsychicEndpoint*> _endpoints;
     std::list<PsychicHandler*> _handlers;
     std::list<PsychicClient*> _clients;
+    std::unordered_map<int, PsychicClient*> _clientsBySocket;
+    esp_timer_handle_t _reapTimer;
 
     PsychicClientCallback _onOpen;
     PsychicClientCallback _onClose;
@@ -23,6 +26,10 @@ class PsychicHttpServer
     esp_err_t _start();
     virtual esp_err_t _startServer();
 
+    void _stopReapTimer();
+    static void _reapTimerCallback(void *arg);
+    static void _reapIdleClients(void *arg);
+
   public:
     PsychicHttpServer();
     ~PsychicHttpServer();
@@ -35,6 +42,15 @@ class PsychicHttpServer
     unsigned long maxUploadSize;
     unsigned long maxRequestBodySize;
 
+    //number of async workers started by listen() (only used with ENABLE_ASYNC)
+    uint8_t asyncWorkers;
+
+    //close keep-alive connections that have been idle this long (ms), 0 to leave it to esp-idf
+    unsigned long idleTimeout;
+
+    //tune socket limits + timeouts for many concurrent clients, call before listen()
+    void useHighConcurrencyProfile();
+
     PsychicEndpoint *defaultEndpoint;
 
     static void destroy(void *ctx);
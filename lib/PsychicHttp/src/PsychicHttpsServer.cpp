@@ -43,6 +43,8 @@ esp_err_t PsychicHttpsServer::_startServer()
 
 void PsychicHttpsServer::stop()
 {
+  _stopReapTimer();
+
   if (this->_use_ssl)
     httpd_ssl_stop(this->server);
   else
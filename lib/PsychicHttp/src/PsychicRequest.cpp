@@ -1,28 +1,25 @@
 #include "PsychicRequest.h"
 #include "http_status.h"
 #include "PsychicHttpServer.h"
+#include <new>
 
 PsychicRequest::PsychicRequest(PsychicHttpServer *server, httpd_req_t *req) : _server(server),
                                                                               _req(req),
+                                                                              _session(NULL),
+                                                                              _client(server->getClient(req)),
+                                                                              _arena(_client != NULL ? _client->arena() : NULL),
                                                                               _method(HTTP_GET),
                                                                               _query(""),
                                                                               _body(""),
+                                                                              _params(PsychicArenaAllocator<PsychicWebParameter *>(_arena)),
                                                                               _tempObject(NULL)
 {
-  // load up our client.
-  this->_client = server->getClient(req);
+  // params + response headers live in the connection arena until the outermost request is done
+  if (_arena != NULL)
+    _arena->retain();
 
-  // handle our session data
-  if (req->sess_ctx != NULL)
-    this->_session = (SessionData *)req->sess_ctx;
-  else
-  {
-    this->_session = new SessionData();
-    req->sess_ctx = this->_session;
-  }
-
-  // callback for freeing the session later
-  req->free_ctx = this->freeSession;
+  if (_client != NULL)
+    _client->beginRequest();
 
   // load up some data
   this->_uri = String(this->_req->uri);
@@ -36,8 +33,37 @@ PsychicRequest::~PsychicRequest()
 
   // our web parameters
   for (auto *param : _params)
-    delete (param);
+  {
+    if (_arena != NULL && _arena->owns(param))
+      param->~PsychicWebParameter();
+    else
+      delete (param);
+  }
   _params.clear();
+
+  if (_arena != NULL)
+    _arena->release();
+
+  if (_client != NULL)
+    _client->endRequest();
+}
+
+// sessions are only created once somebody actually stores something
+SessionData *PsychicRequest::_getSession(bool create)
+{
+  if (_session == NULL)
+  {
+    if (_req->sess_ctx != NULL)
+      _session = (SessionData *)_req->sess_ctx;
+    else if (create)
+    {
+      _session = new SessionData();
+      _req->sess_ctx = _session;
+      _req->free_ctx = this->freeSession;
+    }
+  }
+
+  return _session;
 }
 
 void PsychicRequest::freeSession(void *ctx)
@@ -324,10 +350,21 @@ void PsychicRequest::_addParams(const String &params)
 
 PsychicWebParameter *PsychicRequest::addParam(const String &name, const String &value, bool decode)
 {
+  // parameters are placed in the connection arena when we have one
+  void *mem = _arena != NULL ? _arena->alloc(sizeof(PsychicWebParameter)) : NULL;
+
   if (decode)
+  {
+    if (mem != NULL)
+      return addParam(new (mem) PsychicWebParameter(urlDecode(name.c_str()), urlDecode(value.c_str())));
     return addParam(new PsychicWebParameter(urlDecode(name.c_str()), urlDecode(value.c_str())));
+  }
   else
+  {
+    if (mem != NULL)
+      return addParam(new (mem) PsychicWebParameter(name, value));
     return addParam(new PsychicWebParameter(name, value));
+  }
 }
 
 PsychicWebParameter *PsychicRequest::addParam(PsychicWebParameter *param)
@@ -350,15 +387,77 @@ PsychicWebParameter *PsychicRequest::getParam(const char *key)
   return NULL;
 }
 
+bool PsychicRequest::getParam(const char *name, char *value, size_t size)
+{
+  //scan the raw query, so it works before (or without) loadParams()
+  const char *query = strchr(_uri.c_str(), '?');
+  if (query != NULL && _findParam(query + 1, strlen(query + 1), name, value, size))
+    return true;
+
+  //body params are only known after loadParams()
+  PsychicWebParameter *param = getParam(name);
+  if (param == NULL || param->value().length() >= size)
+    return false;
+
+  memcpy(value, param->value().c_str(), param->value().length() + 1);
+  return true;
+}
+
+bool PsychicRequest::_findParam(const char *params, size_t length, const char *name, char *value, size_t size)
+{
+  const char *end = params + length;
+  const char *start = params;
+  while (start < end)
+  {
+    const char *next = (const char *)memchr(start, '&', end - start);
+    if (next == NULL)
+      next = end;
+    const char *equal = (const char *)memchr(start, '=', next - start);
+    if (equal == NULL)
+      equal = next;
+
+    //compare the (encoded) name against the key while decoding it
+    const char *pos = start;
+    const char *key = name;
+    bool match = true;
+    while (match && pos < equal && *key != '\0')
+    {
+      char c;
+      pos += urlDecodeChar(pos, equal - pos, &c);
+      match = c == *key++;
+    }
+
+    if (match && pos == equal && *key == '\0')
+    {
+      const char *data = equal < next ? equal + 1 : next;
+      if (!urlDecode(data, next - data, value, size))
+      {
+        ESP_LOGW(PH_TAG, "Parameter %s does not fit into %u bytes", name, size);
+        return false;
+      }
+      return true;
+    }
+
+    start = next + 1;
+  }
+
+  return false;
+}
+
 bool PsychicRequest::hasSessionKey(const String &key)
 {
-  return this->_session->find(key) != this->_session->end();
+  SessionData *session = _getSession(false);
+  return session != NULL && session->find(key) != session->end();
 }
 
 const String PsychicRequest::getSessionKey(const String &key)
 {
-  auto it = this->_session->find(key);
-  if (it != this->_session->end())
+  SessionData *session = _getSession(false);
+  if (session == NULL)
+    return "";
+
+  auto it = session->find(key);
+  if (it != session->end())
     return it->second;
   else
     return "";
@@ -366,7 +465,7 @@ const String PsychicRequest::getSessionKey(const String &key)
 
 void PsychicRequest::setSessionKey(const String &key, const String &value)
 {
-  this->_session->insert(std::pair<String, String>(key, value));
+  _getSession(true)->insert(std::pair<String, String>(key, value));
 }
 
 static const String md5str(const String &in)
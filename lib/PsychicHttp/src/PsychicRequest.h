@@ -4,6 +4,7 @@
 #include "PsychicCore.h"
 #include "PsychicHttpServer.h"
 #include "PsychicClient.h"
+#include "PsychicArena.h"
 #include "PsychicWebParameter.h"
 #include "PsychicResponse.h"
 
@@ -25,15 +26,19 @@ class PsychicRequest {
     httpd_req_t *_req;
     SessionData *_session;
     PsychicClient *_client;
+    PsychicArena *_arena;
 
     http_method _method;
     String _uri;
     String _query;
     String _body;
 
-    std::list<PsychicWebParameter*> _params;
+    std::list<PsychicWebParameter*, PsychicArenaAllocator<PsychicWebParameter*>> _params;
+
+    SessionData *_getSession(bool create);
 
     void _addParams(const String& params);
+    static bool _findParam(const char *params, size_t length, const char *name, char *value, size_t size);
     void _parseGETParams();
     void _parsePOSTParams();
 
@@ -49,6 +54,7 @@ class PsychicRequest {
     PsychicHttpServer * server();
     httpd_req_t * request();
     virtual PsychicClient * client();
+    PsychicArena * arena() { return _arena; }
 
     bool isMultipart();
     esp_err_t loadBody();
@@ -83,6 +89,7 @@ class PsychicRequest {
     PsychicWebParameter * addParam(const String &name, const String &value, bool decode = true);
     bool hasParam(const char *key);
     PsychicWebParameter * getParam(const char *name);
+    bool getParam(const char *name, char *value, size_t size); // decodes straight from the query into value, no allocations
 
     const String getFilename();
 
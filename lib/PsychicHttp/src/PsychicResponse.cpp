@@ -4,8 +4,10 @@
 
 PsychicResponse::PsychicResponse(PsychicRequest *request) :
   _request(request),
+  _arena(request->arena()),
   _code(200),
   _status(""),
+  _headers(PsychicArenaAllocator<HTTPHeader>(_arena)),
   _contentLength(0),
   _body("")
 {
@@ -14,23 +16,32 @@ PsychicResponse::PsychicResponse(PsychicRequest *request) :
 PsychicResponse::~PsychicResponse()
 {
   //clean up our header variables.  we have to do this since httpd_resp_send doesn't store copies
-  for (HTTPHeader header : _headers)
+  //arena backed headers are released along with the request
+  if (_arena == NULL)
   {
-    free(header.field);
-    free(header.value);
+    for (HTTPHeader header : _headers)
+    {
+      free(header.field);
+      free(header.value);
+    }
   }
   _headers.clear();
 }
 
 void PsychicResponse::addHeader(const char *field, const char *value)
 {
-  //these get freed during send()
+  //these have to stick around until the response is sent
   HTTPHeader header;
-  header.field =(char *)malloc(strlen(field)+1);
-  header.value = (char *)malloc(strlen(value)+1);
-
-  strlcpy(header.field, field, strlen(field)+1);
-  strlcpy(header.value, value, strlen(value)+1);
+  if (_arena != NULL)
+  {
+    header.field = _arena->strdup(field);
+    header.value = _arena->strdup(value);
+  }
+  else
+  {
+    header.field = strdup(field);
+    header.value = strdup(value);
+  }
 
   _headers.push_back(header);
 }
@@ -122,11 +133,11 @@ esp_err_t PsychicResponse::send()
 void PsychicResponse::sendHeaders()
 {
   //get our global headers out of the way first
-  for (HTTPHeader header : DefaultHeaders::Instance().getHeaders())
+  for (const HTTPHeader &header : DefaultHeaders::Instance().getHeaders())
     httpd_resp_set_hdr(_request->request(), header.field, header.value);
 
   //now do our individual headers
-  for (HTTPHeader header : _headers)
+  for (const HTTPHeader &header : _headers)
     httpd_resp_set_hdr(this->_request->request(), header.field, header.value);
 }
 
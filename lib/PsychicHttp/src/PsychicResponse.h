@@ -2,6 +2,7 @@
 #define PsychicResponse_h
 
 #include "PsychicCore.h"
+#include "PsychicArena.h"
 #include "time.h"
 
 class PsychicRequest;
@@ -10,10 +11,11 @@ class PsychicResponse
 {
   protected:
     PsychicRequest *_request;
+    PsychicArena *_arena;
 
     int _code;
     char _status[60];
-    std::list<HTTPHeader> _headers;
+    std::list<HTTPHeader, PsychicArenaAllocator<HTTPHeader>> _headers;
     int64_t _contentLength;
     const char * _body;
 
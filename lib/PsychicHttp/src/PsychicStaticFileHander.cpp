@@ -144,7 +144,7 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
     DUMP(_filename);
 
     //is it not modified?
-    String etag = String(_file.size());
+    String etag = PsychicFileResponse::etag(_file);
     if (_last_modified.length() && _last_modified == request->header("If-Modified-Since"))
     {
       DUMP("Last Modified Hit");
@@ -153,7 +153,7 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
       request->reply(304); // Not modified
     }
     //does our Etag match?
-    else if (_cache_control.length() && request->hasHeader("If-None-Match") && request->header("If-None-Match").equals(etag))
+    else if (request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) != -1)
     {
       DUMP("Etag Hit");
       DUMP(etag);
@@ -162,29 +162,28 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
       _file.close();
 
       PsychicResponse response(request);
-      response.addHeader("Cache-Control", _cache_control.c_str());
+      if (_cache_control.length())
+        response.addHeader("Cache-Control", _cache_control.c_str());
       response.addHeader("ETag", etag.c_str());
       response.setCode(304);
       response.send();
     }
-    //nope, send them the full file.
+    //nope, send them the full file (or the requested range of it).
     else
     {
       DUMP("No cache hit");
       DUMP(_last_modified);
       DUMP(_cache_control);
 
-      PsychicFileResponse response(request, _fs, _filename);
+      //hand over the file we already opened, the response closes it when done
+      PsychicFileResponse response(request, _file, _filename);
+      _file = File();
 
       if (_last_modified.length())
         response.addHeader("Last-Modified", _last_modified.c_str());
-      if (_cache_control.length()) {
+      if (_cache_control.length())
         response.addHeader("Cache-Control", _cache_control.c_str());
-        response.addHeader("ETag", etag.c_str());
-      }
 
-      _file.close();
-      
       return response.send();
     }
   } else {
@@ -143,6 +143,7 @@ esp_err_t PsychicUploadHandler::_multipartUploadHandler(PsychicRequest *request)
   if (value.startsWith("multipart/")){
     _boundary = value.substring(value.indexOf('=')+1);
     _boundary.replace("\"","");
+    _delimiter = "\r\n--" + _boundary;
   } else {
     ESP_LOGE(PH_TAG, "No multipart boundary found.");
     return request->reply(400, "text/html", "No multipart boundary found.");
@@ -178,16 +179,33 @@ esp_err_t PsychicUploadHandler::_multipartUploadHandler(PsychicRequest *request)
       }
     }
 
-    //parse it 1 byte at a time.
-    for (int i=0; i<received; i++)
+    int i = 0;
+    while (i < received)
     {
+      //inside an item's data we can skip ahead to the next possible boundary in one go
+      if (_multiParseState == WAIT_FOR_RETURN1)
+      {
+        size_t span = _findItemSpan((uint8_t *)buf + i, received - i);
+        if (span > 0)
+        {
+          remaining -= span;
+          index += span;
+
+          _writeItemSpan((uint8_t *)buf + i, span, !remaining);
+          _parsedLength += span;
+          i += span;
+          continue;
+        }
+      }
+
       /* Keep track of remaining size of the file left to be uploaded */
       remaining--;
       index++;
 
-      //send it to our parser
+      //the boundary itself (and headers) still go through the byte parser
       _parseMultipartPostByte(buf[i], !remaining);
       _parsedLength++;
+      i++;
     }
   }
 
@@ -214,6 +232,61 @@ void PsychicUploadHandler::_handleUploadByte(uint8_t data, bool last)
   }
 }
 
+// how many bytes from here on are definitely item data: everything up to the first
+// \r that could still be the start of "\r\n--boundary" (or the whole block if there is none)
+size_t PsychicUploadHandler::_findItemSpan(const uint8_t *data, size_t len)
+{
+  const uint8_t *end = data + len;
+  const uint8_t *cr = (const uint8_t *)memchr(data, '\r', len);
+
+  while (cr != NULL)
+  {
+    size_t left = end - cr;
+
+    //can't tell yet, let the byte parser carry it over into the next block
+    if (left < _delimiter.length())
+    {
+      if (memcmp(cr, _delimiter.c_str(), left) == 0)
+        break;
+    }
+    else if (memcmp(cr, _delimiter.c_str(), _delimiter.length()) == 0)
+      break;
+
+    cr = (const uint8_t *)memchr(cr + 1, '\r', end - cr - 1);
+  }
+
+  return cr == NULL ? len : cr - data;
+}
+
+// block version of itemWriteByte: fields are appended in one go, files are copied into the item buffer
+void PsychicUploadHandler::_writeItemSpan(const uint8_t *data, size_t len, bool last)
+{
+  if (!_itemIsFile)
+  {
+    _itemValue.concat((const char *)data, len);
+    _itemSize += len;
+    return;
+  }
+
+  while (len > 0)
+  {
+    size_t count = min(len, (size_t)FILE_CHUNK_SIZE - _itemBufferIndex);
+    memcpy(_itemBuffer + _itemBufferIndex, data, count);
+
+    _itemBufferIndex += count;
+    _itemSize += count;
+    data += count;
+    len -= count;
+
+    if (_itemBufferIndex == FILE_CHUNK_SIZE || (last && len == 0))
+    {
+      if (_uploadCallback)
+        _uploadCallback(_request, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, last && len == 0);
+      _itemBufferIndex = 0;
+    }
+  }
+}
+
 #define itemWriteByte(b) do { _itemSize++; if(_itemIsFile) _handleUploadByte(b, last); else _itemValue+=(char)(b); } while(0)
 
 void PsychicUploadHandler::_parseMultipartPostByte(uint8_t data, bool last) 
@@ -24,6 +24,7 @@ class PsychicUploadHandler : public PsychicWebHandler {
     size_t _parsedLength;
     uint8_t _multiParseState;
     String _boundary;
+    String _delimiter;
     uint8_t _boundaryPosition;
     size_t _itemStartIndex;
     size_t _itemSize;
@@ -40,6 +41,8 @@ class PsychicUploadHandler : public PsychicWebHandler {
 
     void _handleUploadByte(uint8_t data, bool last);
     void _parseMultipartPostByte(uint8_t data, bool last);
+    size_t _findItemSpan(const uint8_t *data, size_t len);
+    void _writeItemSpan(const uint8_t *data, size_t len, bool last);
 
   public:
     PsychicUploadHandler();
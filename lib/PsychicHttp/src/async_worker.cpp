@@ -1,10 +1,30 @@
 #include "async_worker.h"
 
+// Requests are handed over here, there is only ever one for each worker that said it's ready
+static QueueHandle_t async_req_queue;
+
+// Counts the workers waiting for a request
+static SemaphoreHandle_t worker_ready_count;
+
+// Workers static assets may occupy, the others are kept for the api
+static SemaphoreHandle_t static_slot_count;
+
+// Each worker has its own thread
+static TaskHandle_t *worker_handles = NULL;
+static uint8_t worker_count = 0;
+
+// Admission statistics
+static portMUX_TYPE async_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t stats_handled = 0;
+static uint32_t stats_rejected = 0;
+static uint64_t stats_wait_total_ms = 0;
+static uint32_t stats_wait_max_ms = 0;
+
 bool is_on_async_worker_thread(void)
 {
     // is our handle one of the known async handles?
     TaskHandle_t handle = xTaskGetCurrentTaskHandle();
-    for (int i = 0; i < ASYNC_WORKER_COUNT; i++) {
+    for (int i = 0; i < worker_count; i++) {
         if (worker_handles[i] == handle) {
             return true;
         }
@@ -13,41 +33,76 @@ bool is_on_async_worker_thread(void)
 }
 
 // Submit an HTTP req to the async worker queue
-esp_err_t submit_async_req(httpd_req_t *req, httpd_req_handler_t handler)
+esp_err_t submit_async_req(httpd_req_t *req, httpd_req_handler_t handler, PsychicAsyncLane lane)
 {
+    if (worker_count == 0) {
+        return ESP_FAIL;
+    }
+
+    // Wait for a worker right here in the server task. The socket can't be marked as
+    // "in use" on 4.4.x, so a request copy must never sit in a queue while the
+    // server closes or purges its socket. Other connections wait meanwhile, which
+    // is the back pressure we want when all workers are busy.
+    TickType_t started = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(ASYNC_ADMISSION_TIMEOUT_MS);
+
+    if (lane == ASYNC_LANE_STATIC && xSemaphoreTake(static_slot_count, timeout) == false) {
+        ESP_LOGW(PH_TAG, "No worker for static requests available");
+        portENTER_CRITICAL(&async_stats_lock);
+        stats_rejected++;
+        portEXIT_CRITICAL(&async_stats_lock);
+        return ESP_FAIL;
+    }
+
+    TickType_t elapsed = xTaskGetTickCount() - started;
+    if (xSemaphoreTake(worker_ready_count, elapsed < timeout ? timeout - elapsed : 0) == false) {
+        ESP_LOGW(PH_TAG, "No workers are available");
+        if (lane == ASYNC_LANE_STATIC) {
+            xSemaphoreGive(static_slot_count);
+        }
+        portENTER_CRITICAL(&async_stats_lock);
+        stats_rejected++;
+        portEXIT_CRITICAL(&async_stats_lock);
+        return ESP_FAIL;
+    }
+
+    uint32_t waited = pdTICKS_TO_MS(xTaskGetTickCount() - started);
+
     // must create a copy of the request that we own
     httpd_req_t* copy = NULL;
     esp_err_t err = httpd_req_async_handler_begin(req, &copy);
     if (err != ESP_OK) {
+        xSemaphoreGive(worker_ready_count);
+        if (lane == ASYNC_LANE_STATIC) {
+            xSemaphoreGive(static_slot_count);
+        }
         return err;
     }
 
     httpd_async_req_t async_req = {
         .req = copy,
         .handler = handler,
+        .lane = lane,
     };
 
-    // How should we handle resource exhaustion?
-    // In this example, we immediately respond with an
-    // http error if no workers are available.
-    int ticks = 0;
-
-    // counting semaphore: if success, we know 1 or
-    // more asyncReqTaskWorkers are available.
-    if (xSemaphoreTake(worker_ready_count, ticks) == false) {
-        ESP_LOGE(PH_TAG, "No workers are available");
-        httpd_req_async_handler_complete(copy); // cleanup
-        return ESP_FAIL;
-    }
-
-    // Since worker_ready_count > 0 the queue should already have space.
-    // But lets wait up to 100ms just to be safe.
+    // Since we took a ready worker the queue already has space, and it picks it up right away
     if (xQueueSend(async_req_queue, &async_req, pdMS_TO_TICKS(100)) == false) {
         ESP_LOGE(PH_TAG, "worker queue is full");
         httpd_req_async_handler_complete(copy); // cleanup
+        if (lane == ASYNC_LANE_STATIC) {
+            xSemaphoreGive(static_slot_count);
+        }
         return ESP_FAIL;
     }
 
+    portENTER_CRITICAL(&async_stats_lock);
+    stats_handled++;
+    stats_wait_total_ms += waited;
+    if (waited > stats_wait_max_ms) {
+        stats_wait_max_ms = waited;
+    }
+    portEXIT_CRITICAL(&async_stats_lock);
+
     return ESP_OK;
 }
 
@@ -75,6 +130,10 @@ void async_req_worker_task(void *p)
             if (httpd_req_async_handler_complete(async_req.req) != ESP_OK) {
                 ESP_LOGE(PH_TAG, "failed to complete async req");
             }
+
+            if (async_req.lane == ASYNC_LANE_STATIC) {
+                xSemaphoreGive(static_slot_count);
+            }
         }
     }
 
@@ -82,42 +141,77 @@ void async_req_worker_task(void *p)
     vTaskDelete(NULL);
 }
 
-void start_async_req_workers(void)
+void start_async_req_workers(uint8_t count)
 {
+    // already running?
+    if (worker_count > 0) {
+        return;
+    }
 
     // counting semaphore keeps track of available workers
     worker_ready_count = xSemaphoreCreateCounting(
-        ASYNC_WORKER_COUNT,  // Max Count
+        count,  // Max Count
         0); // Initial Count
     if (worker_ready_count == NULL) {
         ESP_LOGE(PH_TAG, "Failed to create workers counting Semaphore");
         return;
     }
 
+    // static assets share all workers if there are too few to keep some back
+    uint8_t static_slots = count > ASYNC_API_RESERVED_WORKERS ? count - ASYNC_API_RESERVED_WORKERS : count;
+    static_slot_count = xSemaphoreCreateCounting(static_slots, static_slots);
+    if (static_slot_count == NULL) {
+        ESP_LOGE(PH_TAG, "Failed to create static slots counting Semaphore");
+        vSemaphoreDelete(worker_ready_count);
+        return;
+    }
+
     // create queue
-    async_req_queue = xQueueCreate(1, sizeof(httpd_async_req_t));
-    if (async_req_queue == NULL){
+    async_req_queue = xQueueCreate(count, sizeof(httpd_async_req_t));
+    if (async_req_queue == NULL) {
         ESP_LOGE(PH_TAG, "Failed to create async_req_queue");
+        vSemaphoreDelete(static_slot_count);
         vSemaphoreDelete(worker_ready_count);
         return;
     }
 
+    worker_handles = (TaskHandle_t *)calloc(count, sizeof(TaskHandle_t));
+    if (worker_handles == NULL) {
+        ESP_LOGE(PH_TAG, "Failed to allocate worker handles");
+        return;
+    }
+
     // start worker tasks
-    for (int i = 0; i < ASYNC_WORKER_COUNT; i++) {
+    for (int i = 0; i < count; i++) {
 
         bool success = xTaskCreate(async_req_worker_task, "async_req_worker",
                                     ASYNC_WORKER_TASK_STACK_SIZE, // stack size
                                     (void *)0, // argument
                                     ASYNC_WORKER_TASK_PRIORITY, // priority
-                                    &worker_handles[i]);
+                                    &worker_handles[worker_count]);
 
         if (!success) {
             ESP_LOGE(PH_TAG, "Failed to start asyncReqWorker");
             continue;
         }
+
+        worker_count++;
     }
 }
 
+void get_async_worker_stats(async_worker_stats_t *stats)
+{
+    stats->workers = worker_count;
+    stats->busy = worker_count > 0 ? worker_count - uxSemaphoreGetCount(worker_ready_count) : 0;
+
+    portENTER_CRITICAL(&async_stats_lock);
+    stats->handled = stats_handled;
+    stats->rejected = stats_rejected;
+    stats->waitAvgMs = stats_handled > 0 ? stats_wait_total_ms / stats_handled : 0;
+    stats->waitMaxMs = stats_wait_max_ms;
+    portEXIT_CRITICAL(&async_stats_lock);
+}
+
 /****
  * 
  * This code is backported from the 5.1.x branch
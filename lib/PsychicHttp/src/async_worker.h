@@ -5,30 +5,46 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
-#define ASYNC_WORKER_TASK_PRIORITY      5
-#define ASYNC_WORKER_TASK_STACK_SIZE    (4*1024)
-#define ASYNC_WORKER_COUNT 8
+#ifndef ASYNC_WORKER_TASK_PRIORITY
+  #define ASYNC_WORKER_TASK_PRIORITY 5
+#endif
 
-// Async requests are queued here while they wait to be processed by the workers
-static QueueHandle_t async_req_queue;
+#ifndef ASYNC_WORKER_TASK_STACK_SIZE
+  #define ASYNC_WORKER_TASK_STACK_SIZE PSYCHIC_STACK_SIZE //the handlers run here instead of the httpd task
+#endif
 
-// Track the number of free workers at any given time
-static SemaphoreHandle_t worker_ready_count;
+// how long the server task waits for a free worker before answering 503
+#ifndef ASYNC_ADMISSION_TIMEOUT_MS
+  #define ASYNC_ADMISSION_TIMEOUT_MS 300
+#endif
 
-// Each worker has its own thread
-static TaskHandle_t worker_handles[ASYNC_WORKER_COUNT];
+// workers static assets can't take, so api requests get through while a page loads
+#ifndef ASYNC_API_RESERVED_WORKERS
+  #define ASYNC_API_RESERVED_WORKERS 1
+#endif
 
 typedef esp_err_t (*httpd_req_handler_t)(httpd_req_t *req);
 
 typedef struct {
     httpd_req_t* req;
     httpd_req_handler_t handler;
+    PsychicAsyncLane lane;
 } httpd_async_req_t;
 
+typedef struct {
+    uint8_t workers;
+    uint8_t busy;          // workers handling a request right now
+    uint32_t handled;
+    uint32_t rejected;     // no worker got free within ASYNC_ADMISSION_TIMEOUT_MS
+    uint32_t waitAvgMs;    // time the server task waited for a worker
+    uint32_t waitMaxMs;
+} async_worker_stats_t;
+
 bool is_on_async_worker_thread(void);
-esp_err_t submit_async_req(httpd_req_t *req, httpd_req_handler_t handler);
+esp_err_t submit_async_req(httpd_req_t *req, httpd_req_handler_t handler, PsychicAsyncLane lane = ASYNC_LANE_API);
 void async_req_worker_task(void *p);
-void start_async_req_workers(void);
+void start_async_req_workers(uint8_t count = ASYNC_WORKER_COUNT);
+void get_async_worker_stats(async_worker_stats_t *stats);
 
 esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
 esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
@@ -18,7 +18,7 @@ APSettingsService::APSettingsService(PsychicHttpServer *server,
                                      FS *fs,
                                      SecurityManager *securityManager) : _server(server),
                                                                          _securityManager(securityManager),
-                                                                         _httpEndpoint(APSettings::read, APSettings::update, this, server, AP_SETTINGS_SERVICE_PATH, securityManager),
+                                                                         _httpEndpoint(APSettings::read, APSettings::update, this, server, AP_SETTINGS_SERVICE_PATH, securityManager, AuthenticationPredicates::CAN_CHANGE_SETTINGS),
                                                                          _fsPersistence(APSettings::read, APSettings::update, this, fs, AP_SETTINGS_FILE),
                                                                          _dnsServer(nullptr),
                                                                          _lastManaged(0),
@@ -15,7 +15,7 @@
 
 #include <WiFi.h>
 #include <ArduinoJson.h>
-#include <ESPFS.h>
+#include <FSUsage.h>
 #include <EventSocket.h>
 
 #define MAX_ESP_ANALYTICS_SIZE 1024
@@ -43,8 +43,8 @@ public:
             doc["total_heap"] = ESP.getHeapSize();
             doc["min_free_heap"] = ESP.getMinFreeHeap();
             doc["max_alloc_heap"] = ESP.getMaxAllocHeap();
-            doc["fs_used"] = ESPFS.usedBytes();
-            doc["fs_total"] = ESPFS.totalBytes();
+            doc["fs_used"] = FSUsage::used();
+            doc["fs_total"] = FSUsage::total();
             doc["core_temp"] = temperatureRead();
 
             JsonObject jsonObject = doc.as<JsonObject>();
@@ -28,6 +28,35 @@ String ArduinoJsonJWT::getSecret()
     return _secret;
 }
 
+// {"alg":"HS256","typ":"JWT"}
+static const char JWT_HEADER[] = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9";
+static const size_t JWT_HEADER_SIZE = sizeof(JWT_HEADER) - 1;
+
+static const char base64UrlChars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static const int8_t base64UrlValues[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1};
+
+/*
+ * Compares in constant time, so the signature check doesn't tell how many bytes matched.
+ */
+static bool secureCompare(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
 /*
  * ESP32 uses mbedtls,
  *
@@ -35,124 +64,197 @@ String ArduinoJsonJWT::getSecret()
  *
  * No need to pull in additional crypto libraries - lets use what we already have.
  */
-String ArduinoJsonJWT::sign(String &payload)
+void ArduinoJsonJWT::sign(const char *data, size_t len, uint8_t *signature)
 {
-    unsigned char hmacResult[32];
-    {
-        mbedtls_md_context_t ctx;
-        mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
-        mbedtls_md_init(&ctx);
-        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
-        mbedtls_md_hmac_starts(&ctx, (unsigned char *)_secret.c_str(), _secret.length());
-        mbedtls_md_hmac_update(&ctx, (unsigned char *)payload.c_str(), payload.length());
-        mbedtls_md_hmac_finish(&ctx, hmacResult);
-        mbedtls_md_free(&ctx);
-    }
-    return encode((char *)hmacResult, 32);
+    mbedtls_md_context_t ctx;
+    mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
+    mbedtls_md_hmac_starts(&ctx, (const unsigned char *)_secret.c_str(), _secret.length());
+    mbedtls_md_hmac_update(&ctx, (const unsigned char *)data, len);
+    mbedtls_md_hmac_finish(&ctx, signature);
+    mbedtls_md_free(&ctx);
 }
 
-String ArduinoJsonJWT::buildJWT(JsonObject &payload)
+size_t ArduinoJsonJWT::buildJWT(JsonObject &payload, char *jwt, size_t size)
 {
-    // serialize, then encode payload
-    String jwt;
-    serializeJson(payload, jwt);
-    jwt = encode(jwt.c_str(), jwt.length());
-
-    // add the header to payload
-    jwt = JWT_HEADER + '.' + jwt;
+    // serialize the payload
+    char json[JWT_MAX_PAYLOAD_SIZE];
+    size_t jsonLength = measureJson(payload);
+    if (jsonLength >= sizeof(json) || size <= JWT_HEADER_SIZE + 1)
+    {
+        return 0;
+    }
+    serializeJson(payload, json, sizeof(json));
 
-    // add signature
-    jwt += '.' + sign(jwt);
+    // header.payload
+    memcpy(jwt, JWT_HEADER, JWT_HEADER_SIZE);
+    jwt[JWT_HEADER_SIZE] = '.';
+    size_t len = JWT_HEADER_SIZE + 1;
+    int encoded = encode((const uint8_t *)json, jsonLength, jwt + len, size - len);
+    if (encoded < 0)
+    {
+        return 0;
+    }
+    len += encoded;
 
-    return jwt;
+    // .signature
+    uint8_t signature[JWT_SIGNATURE_SIZE];
+    sign(jwt, len, signature);
+    if (len + 1 >= size)
+    {
+        return 0;
+    }
+    jwt[len++] = '.';
+    encoded = encode(signature, sizeof(signature), jwt + len, size - len);
+    if (encoded < 0)
+    {
+        return 0;
+    }
+    return len + encoded;
 }
 
-void ArduinoJsonJWT::parseJWT(String jwt, JsonDocument &jsonDocument)
+bool ArduinoJsonJWT::parseJWT(const char *jwt, size_t len, JsonDocument &jsonDocument)
 {
     // clear json document before we begin, jsonDocument wil be null on failure
     jsonDocument.clear();
 
     // must have the correct header and delimiter
-    if (!jwt.startsWith(JWT_HEADER) || jwt.indexOf('.') != JWT_HEADER_SIZE)
+    if (len <= JWT_HEADER_SIZE || memcmp(jwt, JWT_HEADER, JWT_HEADER_SIZE) != 0 || jwt[JWT_HEADER_SIZE] != '.')
     {
-        return;
+        return false;
     }
 
     // check there is a signature delimieter
-    int signatureDelimiterIndex = jwt.lastIndexOf('.');
-    if (signatureDelimiterIndex == JWT_HEADER_SIZE)
+    const char *end = jwt + len;
+    const char *signatureDelimiter = end;
+    while (signatureDelimiter > jwt && *(signatureDelimiter - 1) != '.')
+    {
+        signatureDelimiter--;
+    }
+    signatureDelimiter--;
+    if (signatureDelimiter == jwt + JWT_HEADER_SIZE)
     {
-        return;
+        return false;
     }
 
     // check the signature is valid
-    String signature = jwt.substring(signatureDelimiterIndex + 1);
-    jwt = jwt.substring(0, signatureDelimiterIndex);
-    if (sign(jwt) != signature)
+    uint8_t expected[JWT_SIGNATURE_SIZE];
+    uint8_t signature[JWT_SIGNATURE_SIZE + 2];
+    if (decode(signatureDelimiter + 1, end - signatureDelimiter - 1, signature, sizeof(signature)) != JWT_SIGNATURE_SIZE)
+    {
+        return false;
+    }
+    sign(jwt, signatureDelimiter - jwt, expected);
+    if (!secureCompare(signature, expected, JWT_SIGNATURE_SIZE))
     {
-        return;
+        return false;
     }
 
     // decode payload
-    jwt = jwt.substring(JWT_HEADER_SIZE + 1);
-    jwt = decode(jwt);
+    char json[JWT_MAX_PAYLOAD_SIZE];
+    const char *payload = jwt + JWT_HEADER_SIZE + 1;
+    int jsonLength = decode(payload, signatureDelimiter - payload, (uint8_t *)json, sizeof(json));
+    if (jsonLength < 0)
+    {
+        return false;
+    }
 
     // parse payload, clearing json document after failure
-    DeserializationError error = deserializeJson(jsonDocument, jwt);
+    DeserializationError error = deserializeJson(jsonDocument, (const char *)json, jsonLength);
     if (error != DeserializationError::Ok || !jsonDocument.is<JsonObject>())
     {
         jsonDocument.clear();
+        return false;
     }
+    return true;
 }
 
-String ArduinoJsonJWT::encode(const char *cstr, int inputLen)
+String ArduinoJsonJWT::buildJWT(JsonObject &payload)
 {
-    // prepare encoder
-    base64_encodestate _state;
-    base64_init_encodestate(&_state);
-    size_t encodedLength = base64_encode_expected_len(inputLen) + 1;
-    // prepare buffer of correct length, returning an empty string on failure
-    char *buffer = (char *)malloc(encodedLength * sizeof(char));
-    if (buffer == nullptr)
+    char jwt[JWT_MAX_LENGTH];
+    size_t len = buildJWT(payload, jwt, sizeof(jwt));
+    jwt[len] = '\0';
+    return String(jwt);
+}
+
+void ArduinoJsonJWT::parseJWT(const String &jwt, JsonDocument &jsonDocument)
+{
+    parseJWT(jwt.c_str(), jwt.length(), jsonDocument);
+}
+
+int ArduinoJsonJWT::encode(const uint8_t *data, size_t len, char *out, size_t size)
+{
+    // room for the terminator
+    if (JWT_BASE64_LENGTH(len) >= size)
     {
-        return "";
+        return -1;
     }
 
-    // encode to buffer
-    int len = base64_encode_block(cstr, inputLen, &buffer[0], &_state);
-    len += base64_encode_blockend(&buffer[len], &_state);
-    buffer[len] = 0;
-
-    // convert to arduino string, freeing buffer
-    String value = String(buffer);
-    free(buffer);
-    buffer = nullptr;
+    char *pos = out;
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t block = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        *pos++ = base64UrlChars[(block >> 18) & 0x3F];
+        *pos++ = base64UrlChars[(block >> 12) & 0x3F];
+        *pos++ = base64UrlChars[(block >> 6) & 0x3F];
+        *pos++ = base64UrlChars[block & 0x3F];
+    }
 
-    // remove padding and convert to URL safe form
-    while (value.length() > 0 && value.charAt(value.length() - 1) == '=')
+    // no padding in base64url
+    if (i < len)
     {
-        value.remove(value.length() - 1);
+        uint32_t block = data[i] << 16;
+        if (i + 1 < len)
+        {
+            block |= data[i + 1] << 8;
+        }
+        *pos++ = base64UrlChars[(block >> 18) & 0x3F];
+        *pos++ = base64UrlChars[(block >> 12) & 0x3F];
+        if (i + 1 < len)
+        {
+            *pos++ = base64UrlChars[(block >> 6) & 0x3F];
+        }
     }
-    value.replace('+', '-');
-    value.replace('/', '_');
 
-    // return as string
-    return value;
+    *pos = '\0';
+    return pos - out;
 }
 
-String ArduinoJsonJWT::decode(String value)
+int ArduinoJsonJWT::decode(const char *data, size_t len, uint8_t *out, size_t size)
 {
-    // convert to standard base64
-    value.replace('-', '+');
-    value.replace('_', '/');
+    // a single character left over can't hold a full byte
+    if (len % 4 == 1 || len * 3 / 4 > size)
+    {
+        return -1;
+    }
 
-    // prepare buffer of correct length
-    char buffer[base64_decode_expected_len(value.length()) + 1];
+    uint8_t *pos = out;
+    uint32_t block = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t c = data[i];
+        int8_t value = c < 128 ? base64UrlValues[c] : -1;
+        if (value < 0)
+        {
+            return -1;
+        }
+        block = (block << 6) | value;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            *pos++ = (block >> bits) & 0xFF;
+        }
+    }
 
-    // decode
-    int len = base64_decode_chars(value.c_str(), value.length(), &buffer[0]);
-    buffer[len] = 0;
+    // the unused bits of the last character have to be zero, or several encodings pass for one signature
+    if ((block & ((1 << bits) - 1)) != 0)
+    {
+        return -1;
+    }
 
-    // return as string
-    return String(buffer);
+    return pos - out;
 }
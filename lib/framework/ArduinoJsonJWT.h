@@ -17,22 +17,26 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <libb64/cdecode.h>
-#include <libb64/cencode.h>
 #include <mbedtls/md.h>
 
+// Largest serialized payload a token may carry, decoded into a stack buffer of the httpd task (PSYCHIC_STACK_SIZE)
+#ifndef JWT_MAX_PAYLOAD_SIZE
+#define JWT_MAX_PAYLOAD_SIZE 256
+#endif
+
+#define JWT_SIGNATURE_SIZE 32
+#define JWT_BASE64_LENGTH(len) (((len) * 4 + 2) / 3)
+// header + '.' + payload + '.' + signature + terminator
+#define JWT_MAX_LENGTH (36 + 1 + JWT_BASE64_LENGTH(JWT_MAX_PAYLOAD_SIZE) + 1 + JWT_BASE64_LENGTH(JWT_SIGNATURE_SIZE) + 1)
+
 class ArduinoJsonJWT
 {
 private:
     String _secret;
 
-    const String JWT_HEADER = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9";
-    const int JWT_HEADER_SIZE = JWT_HEADER.length();
-
-    String sign(String &value);
-
-    static String encode(const char *cstr, int len);
-    static String decode(String value);
+protected:
+    // HMAC-SHA256 of data with the secret
+    void sign(const char *data, size_t len, uint8_t *signature);
 
 public:
     ArduinoJsonJWT(String secret);
@@ -40,8 +44,19 @@ public:
     void setSecret(String secret);
     String getSecret();
 
+    /*
+     * Work on caller buffers, nothing is allocated on the heap.
+     * buildJWT returns the token length or 0 if it doesn't fit, parseJWT false for invalid tokens.
+     */
+    size_t buildJWT(JsonObject &payload, char *jwt, size_t size);
+    bool parseJWT(const char *jwt, size_t len, JsonDocument &jsonDocument);
+
     String buildJWT(JsonObject &payload);
-    void parseJWT(String jwt, JsonDocument &jsonDocument);
+    void parseJWT(const String &jwt, JsonDocument &jsonDocument);
+
+    // unpadded base64url, return the output length or -1 if it doesn't fit / is invalid
+    static int encode(const uint8_t *data, size_t len, char *out, size_t size);
+    static int decode(const char *data, size_t len, uint8_t *out, size_t size);
 };
 
 #endif
@@ -33,7 +33,7 @@ void AuthenticationService::begin()
             if (authentication.authenticated) {
                 PsychicJsonResponse response = PsychicJsonResponse(request, false);
                 JsonObject root = response.getRoot();
-                root["access_token"] = _securityManager->generateJWT(authentication.user);
+                root["access_token"] = _securityManager->generateJWT(authentication);
                 return response.send();
             }
         }
@@ -0,0 +1,116 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <BufferedFileStream.h>
+
+// reading: _position to _length is unread data, writing: 0 to _length is pending data
+BufferedFileStream::BufferedFileStream(File &file) : _file(file),
+                                                     _position(0),
+                                                     _length(0),
+                                                     _writing(false),
+                                                     _failed(false)
+{
+}
+
+BufferedFileStream::~BufferedFileStream()
+{
+    flush();
+}
+
+bool BufferedFileStream::_fill()
+{
+    if (_position < _length)
+    {
+        return true;
+    }
+
+    int count = _file.read(_buffer, BUFFERED_FILE_STREAM_SIZE);
+    _position = 0;
+    _length = count > 0 ? count : 0;
+    return _length > 0;
+}
+
+int BufferedFileStream::available()
+{
+    return (_length - _position) + _file.available();
+}
+
+int BufferedFileStream::read()
+{
+    if (!_fill())
+    {
+        return -1;
+    }
+    return _buffer[_position++];
+}
+
+int BufferedFileStream::peek()
+{
+    if (!_fill())
+    {
+        return -1;
+    }
+    return _buffer[_position];
+}
+
+size_t BufferedFileStream::readBytes(char *buffer, size_t length)
+{
+    size_t done = 0;
+    while (done < length && _fill())
+    {
+        size_t count = min(length - done, _length - _position);
+        memcpy(buffer + done, _buffer + _position, count);
+        _position += count;
+        done += count;
+    }
+    return done;
+}
+
+size_t BufferedFileStream::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t BufferedFileStream::write(const uint8_t *buffer, size_t size)
+{
+    _writing = true;
+
+    size_t done = 0;
+    while (done < size)
+    {
+        size_t count = min(size - done, (size_t)BUFFERED_FILE_STREAM_SIZE - _length);
+        memcpy(_buffer + _length, buffer + done, count);
+        _length += count;
+        done += count;
+
+        if (_length == BUFFERED_FILE_STREAM_SIZE)
+        {
+            flush();
+        }
+    }
+    return done;
+}
+
+void BufferedFileStream::flush()
+{
+    if (!_writing || _length == 0)
+    {
+        return;
+    }
+
+    if (_file.write(_buffer, _length) != _length)
+    {
+        _failed = true;
+    }
+    _length = 0;
+}
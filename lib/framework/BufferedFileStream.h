@@ -0,0 +1,63 @@
+#ifndef BufferedFileStream_h
+#define BufferedFileStream_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <FS.h>
+
+/*
+ * Buffers a File for ArduinoJson and other byte wise readers and writers.
+ *
+ * serializeJson() and deserializeJson() work one token or character at a time, and against a File every
+ * one of those calls goes through VFS and LittleFS. This adapter moves whole BUFFERED_FILE_STREAM_SIZE
+ * blocks instead. The blocks start at the file position the stream was created at, so for a file opened
+ * at its start all accesses are block aligned. Use a stream either for reading or for writing, not both.
+ * Writes are flushed when the buffer is full, on flush() and in the destructor.
+ */
+
+#ifndef BUFFERED_FILE_STREAM_SIZE
+#define BUFFERED_FILE_STREAM_SIZE 512
+#endif
+
+class BufferedFileStream : public Stream
+{
+public:
+    BufferedFileStream(File &file);
+    ~BufferedFileStream();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+
+    // a write to the file came up short, e.g. because the file system is full
+    bool failed() { return _failed; }
+
+private:
+    File &_file;
+    uint8_t _buffer[BUFFERED_FILE_STREAM_SIZE];
+    size_t _position;
+    size_t _length;
+    bool _writing;
+    bool _failed;
+
+    bool _fill();
+};
+
+#endif // end BufferedFileStream_h
@@ -0,0 +1,422 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <DeltaPatcher.h>
+#include <esp_ota_ops.h>
+
+static uint32_t readU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+DeltaPatcher::DeltaPatcher() : _state(FAILED),
+                               _error(""),
+                               _oldPartition(nullptr),
+                               _oldSize(0),
+                               _newSize(0),
+                               _shaActive(false),
+                               _headerLength(0),
+                               _inflator(nullptr),
+                               _window(nullptr),
+                               _windowSize(0),
+                               _windowOffset(0),
+                               _controlLength(0),
+                               _diffLeft(0),
+                               _extraLeft(0),
+                               _seek(0),
+                               _oldPos(0),
+                               _output(nullptr),
+                               _outputLength(0),
+                               _written(0)
+{
+}
+
+DeltaPatcher::~DeltaPatcher()
+{
+    _release();
+}
+
+bool DeltaPatcher::isDelta(const uint8_t *data, size_t len)
+{
+    return len >= 4 && memcmp(data, DELTA_MAGIC, 4) == 0;
+}
+
+size_t DeltaPatcher::newImageSize(const uint8_t *header)
+{
+    return readU32(header + 12);
+}
+
+bool DeltaPatcher::begin(DeltaWriter writer)
+{
+    _release();
+
+    _writer = writer;
+    _state = READ_HEADER;
+    _error = "";
+    _headerLength = 0;
+    _controlLength = 0;
+    _diffLeft = 0;
+    _extraLeft = 0;
+    _seek = 0;
+    _oldPos = 0;
+    _outputLength = 0;
+    _written = 0;
+
+    _output = (uint8_t *)malloc(DELTA_OUTPUT_BUFFER_SIZE);
+    if (_output == nullptr)
+    {
+        return _fail("Out of memory");
+    }
+
+    mbedtls_sha256_init(&_sha);
+    mbedtls_sha256_starts_ret(&_sha, 0);
+    _shaActive = true;
+
+    return true;
+}
+
+bool DeltaPatcher::write(const uint8_t *data, size_t len)
+{
+    if (_state == FAILED)
+    {
+        return false;
+    }
+
+    // the header is stored uncompressed in front of the deflate stream
+    if (_state == READ_HEADER)
+    {
+        size_t count = min(len, (size_t)DELTA_HEADER_SIZE - _headerLength);
+        memcpy(_header + _headerLength, data, count);
+        _headerLength += count;
+        data += count;
+        len -= count;
+
+        if (_headerLength < DELTA_HEADER_SIZE)
+        {
+            return true;
+        }
+        if (!_parseHeader() || !_verifyOldImage())
+        {
+            return false;
+        }
+        _state = READ_CONTROL;
+    }
+
+    if (len == 0)
+    {
+        return true;
+    }
+
+    return _inflate(data, len);
+}
+
+bool DeltaPatcher::end()
+{
+    if (_state == FAILED)
+    {
+        return false;
+    }
+    if (_state != FINISHED)
+    {
+        return _fail("Patch is incomplete");
+    }
+    if (!_flush())
+    {
+        return false;
+    }
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&_sha, digest);
+    if (memcmp(digest, _newSha, 32) != 0)
+    {
+        return _fail("Patched image does not match its checksum");
+    }
+
+    _release();
+    return true;
+}
+
+void DeltaPatcher::abort()
+{
+    if (_state != FAILED)
+    {
+        _state = FAILED;
+        _error = "Aborted";
+    }
+    _release();
+}
+
+bool DeltaPatcher::_fail(const char *error)
+{
+    ESP_LOGE("DeltaPatcher", "%s", error);
+    _state = FAILED;
+    _error = error;
+    _release();
+    return false;
+}
+
+bool DeltaPatcher::_parseHeader()
+{
+    if (memcmp(_header, DELTA_MAGIC, 4) != 0)
+    {
+        return _fail("Not a delta patch");
+    }
+    if ((_header[4] | (_header[5] << 8)) != DELTA_VERSION)
+    {
+        return _fail("Unsupported delta patch version");
+    }
+
+    uint8_t windowBits = _header[6];
+    if (windowBits < 8 || windowBits > 15)
+    {
+        return _fail("Invalid deflate window");
+    }
+
+    _oldSize = readU32(_header + 8);
+    _newSize = readU32(_header + 12);
+    memcpy(_newSha, _header + 48, 32);
+    if (_newSize == 0)
+    {
+        return _fail("Invalid delta patch header");
+    }
+
+    // wrapping output buffer for inflate, must at least cover the deflate window
+    _windowSize = 1 << windowBits;
+    _windowOffset = 0;
+    _window = (uint8_t *)malloc(_windowSize);
+    _inflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+    if (_window == nullptr || _inflator == nullptr)
+    {
+        return _fail("Out of memory");
+    }
+    tinfl_init(_inflator);
+
+    ESP_LOGI("DeltaPatcher", "Patching %u byte image into %u bytes", _oldSize, _newSize);
+    return true;
+}
+
+bool DeltaPatcher::_verifyOldImage()
+{
+    // the patch only makes sense against the exact firmware it was made from
+    _oldPartition = esp_ota_get_running_partition();
+    if (_oldPartition == nullptr || _oldSize > _oldPartition->size)
+    {
+        return _fail("Running firmware does not match the patch");
+    }
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    for (size_t pos = 0; pos < _oldSize; pos += DELTA_OUTPUT_BUFFER_SIZE)
+    {
+        size_t count = min((size_t)DELTA_OUTPUT_BUFFER_SIZE, _oldSize - pos);
+        if (esp_partition_read(_oldPartition, pos, _output, count) != ESP_OK)
+        {
+            mbedtls_sha256_free(&sha);
+            return _fail("Could not read running firmware");
+        }
+        mbedtls_sha256_update_ret(&sha, _output, count);
+    }
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_free(&sha);
+
+    if (memcmp(digest, _header + 16, 32) != 0)
+    {
+        return _fail("Running firmware does not match the patch");
+    }
+    return true;
+}
+
+bool DeltaPatcher::_inflate(const uint8_t *data, size_t len)
+{
+    while (true)
+    {
+        size_t inBytes = len;
+        size_t outBytes = _windowSize - _windowOffset;
+        tinfl_status status = tinfl_decompress(_inflator, data, &inBytes, _window, _window + _windowOffset, &outBytes, TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        len -= inBytes;
+
+        if (outBytes > 0 && !_process(_window + _windowOffset, outBytes))
+        {
+            return false;
+        }
+        _windowOffset = (_windowOffset + outBytes) & (_windowSize - 1);
+
+        if (status < TINFL_STATUS_DONE)
+        {
+            return _fail("Corrupt delta patch");
+        }
+        if (status == TINFL_STATUS_DONE)
+        {
+            if (_state != FINISHED)
+            {
+                return _fail("Patch is incomplete");
+            }
+            return true;
+        }
+        // everything consumed, wait for the next piece
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0)
+        {
+            return true;
+        }
+    }
+}
+
+bool DeltaPatcher::_process(const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        switch (_state)
+        {
+        case READ_CONTROL:
+        {
+            size_t count = min(len, sizeof(_control) - _controlLength);
+            memcpy(_control + _controlLength, data, count);
+            _controlLength += count;
+            data += count;
+            len -= count;
+
+            if (_controlLength == sizeof(_control))
+            {
+                _controlLength = 0;
+                _diffLeft = readU32(_control);
+                _extraLeft = readU32(_control + 4);
+                _seek = (int32_t)readU32(_control + 8);
+
+                if (_written + _outputLength + _diffLeft + _extraLeft > _newSize)
+                {
+                    return _fail("Corrupt delta patch");
+                }
+                _state = _diffLeft ? READ_DIFF : READ_EXTRA;
+            }
+            break;
+        }
+        case READ_DIFF:
+        {
+            // new = old + diff, old is read from the running partition in small pieces
+            size_t count = min(len, _diffLeft);
+            if (_oldPos < 0 || _oldPos + count > _oldSize)
+            {
+                return _fail("Corrupt delta patch");
+            }
+
+            uint8_t old[128];
+            for (size_t done = 0; done < count;)
+            {
+                size_t piece = min(count - done, sizeof(old));
+                if (esp_partition_read(_oldPartition, _oldPos, old, piece) != ESP_OK)
+                {
+                    return _fail("Could not read running firmware");
+                }
+                for (size_t i = 0; i < piece; i++)
+                {
+                    old[i] += data[done + i];
+                }
+                if (!_emit(old, piece))
+                {
+                    return false;
+                }
+                _oldPos += piece;
+                done += piece;
+            }
+
+            data += count;
+            len -= count;
+            _diffLeft -= count;
+            if (_diffLeft == 0)
+            {
+                _state = READ_EXTRA;
+            }
+            break;
+        }
+        case READ_EXTRA:
+        {
+            size_t count = min(len, _extraLeft);
+            if (count > 0 && !_emit(data, count))
+            {
+                return false;
+            }
+            data += count;
+            len -= count;
+            _extraLeft -= count;
+            break;
+        }
+        case FINISHED:
+            return _fail("Delta patch has trailing data");
+        default:
+            return false;
+        }
+
+        // record done, move on in the old image
+        if (_state == READ_EXTRA && _extraLeft == 0)
+        {
+            _oldPos += _seek;
+            _state = _written + _outputLength >= _newSize ? FINISHED : READ_CONTROL;
+        }
+    }
+
+    return true;
+}
+
+bool DeltaPatcher::_emit(const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        size_t count = min(len, (size_t)DELTA_OUTPUT_BUFFER_SIZE - _outputLength);
+        memcpy(_output + _outputLength, data, count);
+        _outputLength += count;
+        data += count;
+        len -= count;
+
+        if (_outputLength == DELTA_OUTPUT_BUFFER_SIZE && !_flush())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeltaPatcher::_flush()
+{
+    if (_outputLength == 0)
+    {
+        return true;
+    }
+
+    mbedtls_sha256_update_ret(&_sha, _output, _outputLength);
+    if (!_writer(_output, _outputLength))
+    {
+        return _fail("Writing patched image failed");
+    }
+    _written += _outputLength;
+    _outputLength = 0;
+    return true;
+}
+
+void DeltaPatcher::_release()
+{
+    if (_shaActive)
+    {
+        mbedtls_sha256_free(&_sha);
+        _shaActive = false;
+    }
+    free(_inflator);
+    _inflator = nullptr;
+    free(_window);
+    _window = nullptr;
+    free(_output);
+    _output = nullptr;
+}
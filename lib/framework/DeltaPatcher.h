@@ -0,0 +1,127 @@
+#ifndef DeltaPatcher_h
+#define DeltaPatcher_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <functional>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+#if CONFIG_IDF_TARGET_ESP32
+#include <esp32/rom/miniz.h>
+#elif CONFIG_IDF_TARGET_ESP32S2
+#include <esp32s2/rom/miniz.h>
+#elif CONFIG_IDF_TARGET_ESP32C3
+#include <esp32c3/rom/miniz.h>
+#elif CONFIG_IDF_TARGET_ESP32S3
+#include <esp32s3/rom/miniz.h>
+#endif
+
+/*
+ * Applies a delta update created with scripts/delta_ota.py against the running firmware.
+ *
+ * Patch layout (little endian):
+ *   80 byte header   "ESPD", u16 version, u8 window bits, u8 reserved,
+ *                    u32 old size, u32 new size, sha256 of the old image, sha256 of the new image
+ *   raw deflate      sequence of bsdiff records: u32 diff length, u32 extra length, i32 seek,
+ *                    followed by the diff bytes (added to the old image) and the extra bytes
+ *
+ * The patch is fed in arbitrary pieces with write(). The rebuilt image is handed to the writer in
+ * pieces of at most DELTA_OUTPUT_BUFFER_SIZE bytes. RAM use is the inflate state (~11 kB) plus the
+ * deflate window (4 kB with the default window bits of the tool).
+ */
+
+#define DELTA_MAGIC "ESPD"
+#define DELTA_VERSION 1
+#define DELTA_HEADER_SIZE 80
+
+#ifndef DELTA_OUTPUT_BUFFER_SIZE
+#define DELTA_OUTPUT_BUFFER_SIZE 1024
+#endif
+
+typedef std::function<bool(const uint8_t *data, size_t len)> DeltaWriter;
+
+class DeltaPatcher
+{
+public:
+    DeltaPatcher();
+    ~DeltaPatcher();
+
+    // checks if the start of an upload looks like a delta patch
+    static bool isDelta(const uint8_t *data, size_t len);
+    // new image size from a complete header
+    static size_t newImageSize(const uint8_t *header);
+
+    bool begin(DeltaWriter writer);
+    bool write(const uint8_t *data, size_t len);
+    bool end();
+    void abort();
+
+    size_t newSize() { return _newSize; }
+    size_t written() { return _written; }
+    const char *errorString() { return _error; }
+
+private:
+    enum State
+    {
+        READ_HEADER,
+        READ_CONTROL,
+        READ_DIFF,
+        READ_EXTRA,
+        FINISHED,
+        FAILED
+    };
+
+    DeltaWriter _writer;
+    State _state;
+    const char *_error;
+
+    const esp_partition_t *_oldPartition;
+    size_t _oldSize;
+    size_t _newSize;
+    uint8_t _newSha[32];
+    mbedtls_sha256_context _sha;
+    bool _shaActive;
+
+    uint8_t _header[DELTA_HEADER_SIZE];
+    size_t _headerLength;
+
+    tinfl_decompressor *_inflator;
+    uint8_t *_window;
+    size_t _windowSize;
+    size_t _windowOffset;
+
+    uint8_t _control[12];
+    size_t _controlLength;
+    size_t _diffLeft;
+    size_t _extraLeft;
+    int32_t _seek;
+    int64_t _oldPos;
+
+    uint8_t *_output;
+    size_t _outputLength;
+    size_t _written;
+
+    bool _fail(const char *error);
+    bool _parseHeader();
+    bool _verifyOldImage();
+    bool _inflate(const uint8_t *data, size_t len);
+    bool _process(const uint8_t *data, size_t len);
+    bool _emit(const uint8_t *data, size_t len);
+    bool _flush();
+    void _release();
+};
+
+#endif // DeltaPatcher_h
@@ -12,96 +12,533 @@
  **/
 
 #include <DownloadFirmwareService.h>
+#include <DeltaPatcher.h>
+#include <EventLog.h>
+#include <FSUsage.h>
+#include <PersistenceScheduler.h>
+#include <RestartService.h>
+#include <SettingsFile.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
 
 extern const uint8_t rootca_crt_bundle_start[] asm("_binary_src_certs_x509_crt_bundle_bin_start");
 
-static EventSocket *_socket = nullptr;
-static int previousProgress = 0;
-JsonDocument doc;
+static EventSocket *_eventSocket = nullptr;
+static TaskHandle_t _updateTaskHandle = nullptr;
 
-void update_started()
+struct DownloadJob
 {
-    String output;
-    doc["status"] = "preparing";
+    String url;
+    String sha256;
+};
+
+struct ResumeState
+{
+    String url;
+    String etag;
+    String partition;
+    size_t total;
+    size_t offset;
+};
+
+static void emitStatus(const char *status, int progress, const char *error = "")
+{
+    JsonDocument doc;
+    doc["status"] = status;
+    doc["progress"] = progress;
+    doc["error"] = error;
     JsonObject jsonObject = doc.as<JsonObject>();
-    _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    _eventSocket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
 }
 
-void update_progress(int currentBytes, int totalBytes)
+static bool loadResumeState(ResumeState &state)
 {
-    doc["status"] = "progress";
-    int progress = ((currentBytes * 100) / totalBytes);
-    if (progress > previousProgress)
+    JsonDocument doc;
+    if (!SettingsFile::read(&ESPFS, OTA_RESUME_FILE, doc))
     {
-        doc["progress"] = progress;
-        JsonObject jsonObject = doc.as<JsonObject>();
-        _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
-        ESP_LOGV("Download OTA", "HTTP update process at %d of %d bytes... (%d %%)", currentBytes, totalBytes, progress);
+        return false;
     }
-    previousProgress = progress;
+
+    state.url = doc["url"] | "";
+    state.etag = doc["etag"] | "";
+    state.partition = doc["partition"] | "";
+    state.total = doc["total"] | 0;
+    state.offset = doc["offset"] | 0;
+    return state.total > 0;
 }
 
-void update_finished()
+static void saveResumeState(const ResumeState &state)
 {
-    doc["status"] = "finished";
-    JsonObject jsonObject = doc.as<JsonObject>();
-    _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    // written like the settings next to it, a power loss leaves the last complete state
+    JsonDocument doc;
+    doc["url"] = state.url;
+    doc["etag"] = state.etag;
+    doc["partition"] = state.partition;
+    doc["total"] = state.total;
+    doc["offset"] = state.offset;
+    SettingsFile::write(&ESPFS, OTA_RESUME_FILE, doc);
+}
 
-    // delay to allow the event to be sent out
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+static void clearResumeState()
+{
+    bool removed = false;
+    for (const char *suffix : {"", SETTINGS_FILE_TMP_SUFFIX, SETTINGS_FILE_BACKUP_SUFFIX})
+    {
+        String path = String(OTA_RESUME_FILE) + suffix;
+        if (ESPFS.exists(path))
+        {
+            removed = ESPFS.remove(path) || removed;
+        }
+    }
+    if (removed)
+    {
+        FSUsage::invalidate(&ESPFS);
+    }
 }
 
-void updateTask(void *param)
+static void restartHash(mbedtls_sha256_context *sha)
+{
+    mbedtls_sha256_free(sha);
+    mbedtls_sha256_init(sha);
+    mbedtls_sha256_starts_ret(sha, 0);
+}
+
+/*
+ * Downloads the image straight into the next OTA partition. Every sector is erased right before
+ * it is written, so an interrupted download can continue with a Range request from the last
+ * offset, even after a reboot. Returns an empty string on success, otherwise the error.
+ */
+static String downloadFirmware(DownloadJob *job, const esp_partition_t *partition, uint8_t *buffer, mbedtls_sha256_context *sha)
 {
+    ResumeState state;
+    state.url = job->url;
+    state.partition = partition->label;
+    state.total = 0;
+    state.offset = 0;
+
+    // pick up where an earlier attempt stopped
+    ResumeState saved;
+    if (loadResumeState(saved) && saved.url == job->url && saved.partition == partition->label && saved.total <= partition->size)
+    {
+        state = saved;
+        // redo the last sector, it may only have been written partially
+        state.offset -= state.offset % SPI_FLASH_SEC_SIZE;
+
+        // what is already in flash has to go through the hash again
+        for (size_t pos = 0; pos < state.offset; pos += SPI_FLASH_SEC_SIZE)
+        {
+            size_t count = min((size_t)SPI_FLASH_SEC_SIZE, state.offset - pos);
+            if (esp_partition_read(partition, pos, buffer, count) != ESP_OK)
+            {
+                return "Could not read OTA partition";
+            }
+            mbedtls_sha256_update_ret(sha, buffer, count);
+        }
+        ESP_LOGI("Download OTA", "Resuming download at %u of %u bytes", state.offset, state.total);
+    }
+
     WiFiClientSecure client;
     client.setCACertBundle(rootca_crt_bundle_start);
     client.setTimeout(10);
 
-    httpUpdate.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-    httpUpdate.rebootOnUpdate(true);
+    HTTPClient http;
+    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
+    const char *headerKeys[] = {"Content-Range", "ETag"};
 
-    String url = *((String *)param);
-    String output;
-    // httpUpdate.onStart(update_started);
-    // httpUpdate.onProgress(update_progress);
-    // httpUpdate.onEnd(update_finished);
+    size_t lastSaved = state.offset;
+    unsigned long lastProgress = 0;
+    int lastPercent = -1;
+    int retries = 0;
+
+    while (true)
+    {
+        if (!http.begin(client, job->url))
+        {
+            return "Invalid download URL";
+        }
+        http.collectHeaders(headerKeys, 2);
+        if (state.offset > 0)
+        {
+            http.addHeader("Range", "bytes=" + String(state.offset) + "-");
+            // weak validators are not allowed in If-Range
+            if (state.etag.length() && !state.etag.startsWith("W/"))
+            {
+                http.addHeader("If-Range", state.etag);
+            }
+        }
+
+        int code = http.GET();
+
+        // server can't do ranges or the file changed, start over
+        if (code == HTTP_CODE_OK && state.offset > 0)
+        {
+            ESP_LOGW("Download OTA", "Server sent the whole file, restarting download");
+            state.offset = 0;
+            lastSaved = 0;
+            restartHash(sha);
+        }
+
+        if (code == HTTP_CODE_OK || code == HTTP_CODE_PARTIAL_CONTENT)
+        {
+            if (code == HTTP_CODE_OK)
+            {
+                state.total = http.getSize() > 0 ? http.getSize() : 0;
+                state.etag = http.header("ETag");
+                saveResumeState(state);
+            }
+            else
+            {
+                // Content-Range: bytes start-end/total, anything but the requested offset can't be appended
+                String range = http.header("Content-Range");
+                size_t start = range.startsWith("bytes ") ? range.substring(6).toInt() : 0;
+                size_t total = range.substring(range.indexOf('/') + 1).toInt();
+                if (start != state.offset || (state.total > 0 && total != state.total))
+                {
+                    ESP_LOGW("Download OTA", "Server sent %s for offset %u, restarting download", range.c_str(), state.offset);
+                    http.end();
+                    state.offset = 0;
+                    state.total = 0;
+                    state.etag = "";
+                    lastSaved = 0;
+                    restartHash(sha);
+                    clearResumeState();
+                    if (++retries > OTA_DOWNLOAD_RETRIES)
+                    {
+                        return "Server does not resume downloads correctly";
+                    }
+                    continue;
+                }
+                state.total = total;
+            }
+
+            if (state.total == 0 || state.total > partition->size)
+            {
+                http.end();
+                return "Firmware size unknown or too large for the OTA partition";
+            }
+
+            WiFiClient *stream = http.getStreamPtr();
+            unsigned long lastData = millis();
+
+            while (state.offset < state.total)
+            {
+                // fill up to the end of the current sector
+                size_t want = min((size_t)SPI_FLASH_SEC_SIZE - state.offset % SPI_FLASH_SEC_SIZE, state.total - state.offset);
+                size_t fill = 0;
+                while (fill < want && millis() - lastData < 10000)
+                {
+                    int available = stream->available();
+                    if (available <= 0)
+                    {
+                        if (!http.connected())
+                        {
+                            break;
+                        }
+                        vTaskDelay(1);
+                        continue;
+                    }
+                    int received = stream->read(buffer + fill, min((size_t)available, want - fill));
+                    if (received > 0)
+                    {
+                        fill += received;
+                        lastData = millis();
+                    }
+                }
+
+                if (fill == 0)
+                {
+                    break;
+                }
+
+                if (state.offset % SPI_FLASH_SEC_SIZE == 0 &&
+                    esp_partition_erase_range(partition, state.offset, SPI_FLASH_SEC_SIZE) != ESP_OK)
+                {
+                    http.end();
+                    return "Erasing flash failed";
+                }
+                if (esp_partition_write(partition, state.offset, buffer, fill) != ESP_OK)
+                {
+                    http.end();
+                    return "Writing flash failed";
+                }
+                mbedtls_sha256_update_ret(sha, buffer, fill);
+                state.offset += fill;
+
+                if (state.offset - lastSaved >= OTA_RESUME_SAVE_INTERVAL)
+                {
+                    saveResumeState(state);
+                    lastSaved = state.offset;
+                    retries = 0; // we're making progress
+                }
+
+                int percent = (int)((uint64_t)state.offset * 100 / state.total);
+                if (percent != lastPercent && (millis() - lastProgress >= OTA_PROGRESS_INTERVAL || state.offset == state.total))
+                {
+                    emitStatus("progress", percent);
+                    lastPercent = percent;
+                    lastProgress = millis();
+                    ESP_LOGV("Download OTA", "HTTP update process at %u of %u bytes... (%d %%)", state.offset, state.total, percent);
+                }
+
+                if (fill < want)
+                {
+                    break; // connection dropped or stalled in the middle of a sector
+                }
+            }
+            http.end();
+
+            if (state.offset >= state.total)
+            {
+                return "";
+            }
+        }
+        else
+        {
+            http.end();
+
+            // connection level problems are worth another try, HTTP errors are not
+            if (code >= 0)
+            {
+                return "Download failed with HTTP code " + String(code);
+            }
+        }
+
+        if (++retries > OTA_DOWNLOAD_RETRIES)
+        {
+            saveResumeState(state);
+            return "Connection lost, download can be resumed";
+        }
+
+        ESP_LOGW("Download OTA", "Connection lost at %u of %u bytes, retry %d", state.offset, state.total, retries);
+        saveResumeState(state);
+        lastSaved = state.offset;
+        vTaskDelay(pdMS_TO_TICKS(1000 * retries));
+    }
+}
+
+/*
+ * Downloads a delta patch and rebuilds the new image from the running firmware while it streams in.
+ * The patch state can't be recreated at an arbitrary offset, so a dropped connection starts over
+ * instead of resuming. Returns an empty string on success, otherwise the error.
+ */
+static String downloadDelta(DownloadJob *job, const esp_partition_t *partition, uint8_t *buffer, mbedtls_sha256_context *sha)
+{
+    WiFiClientSecure client;
+    client.setCACertBundle(rootca_crt_bundle_start);
+    client.setTimeout(10);
 
-    t_httpUpdate_return ret = httpUpdate.update(client, url.c_str());
-    JsonObject jsonObject;
+    HTTPClient http;
+    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
 
-    switch (ret)
+    DeltaPatcher patcher;
+    size_t offset = 0;
+
+    // rebuilt image goes sequentially into the OTA partition, erasing sectors as we go
+    DeltaWriter writer = [partition, sha, &offset](const uint8_t *data, size_t len)
     {
-    case HTTP_UPDATE_FAILED:
+        if (offset + len > partition->size)
+        {
+            return false;
+        }
+        size_t end = offset + len;
+        for (size_t sector = (offset + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE; sector < end; sector += SPI_FLASH_SEC_SIZE)
+        {
+            if (esp_partition_erase_range(partition, sector, SPI_FLASH_SEC_SIZE) != ESP_OK)
+            {
+                return false;
+            }
+        }
+        if (esp_partition_write(partition, offset, data, len) != ESP_OK)
+        {
+            return false;
+        }
+        mbedtls_sha256_update_ret(sha, data, len);
+        offset = end;
+        return true;
+    };
 
-        doc["status"] = "error";
-        doc["error"] = httpUpdate.getLastErrorString().c_str();
-        jsonObject = doc.as<JsonObject>();
-        _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    unsigned long lastProgress = 0;
+    int lastPercent = -1;
+    int retries = 0;
 
-        ESP_LOGE("Download OTA", "HTTP Update failed with error (%d): %s", httpUpdate.getLastError(), httpUpdate.getLastErrorString().c_str());
-#ifdef SERIAL_INFO
-        Serial.printf("HTTP Update failed with error (%d): %s\n", httpUpdate.getLastError(), httpUpdate.getLastErrorString().c_str());
-#endif
-        break;
-    case HTTP_UPDATE_NO_UPDATES:
+    while (true)
+    {
+        if (!http.begin(client, job->url))
+        {
+            return "Invalid download URL";
+        }
+
+        int code = http.GET();
+        if (code != HTTP_CODE_OK)
+        {
+            http.end();
+            if (code >= 0)
+            {
+                return "Download failed with HTTP code " + String(code);
+            }
+        }
+        else
+        {
+            int total = http.getSize();
+            size_t received = 0;
+            offset = 0;
+            restartHash(sha);
+            if (!patcher.begin(writer))
+            {
+                http.end();
+                return patcher.errorString();
+            }
+
+            WiFiClient *stream = http.getStreamPtr();
+            unsigned long lastData = millis();
+
+            while ((total < 0 || received < (size_t)total) && millis() - lastData < 10000)
+            {
+                int available = stream->available();
+                if (available <= 0)
+                {
+                    if (!http.connected())
+                    {
+                        break;
+                    }
+                    vTaskDelay(1);
+                    continue;
+                }
+
+                int count = stream->read(buffer, min((size_t)available, (size_t)SPI_FLASH_SEC_SIZE));
+                if (count <= 0)
+                {
+                    continue;
+                }
+                lastData = millis();
+                received += count;
+
+                if (!patcher.write(buffer, count))
+                {
+                    http.end();
+                    return patcher.errorString();
+                }
+
+                int percent = total > 0 ? (int)((uint64_t)received * 100 / total) : 0;
+                if (percent != lastPercent && millis() - lastProgress >= OTA_PROGRESS_INTERVAL)
+                {
+                    emitStatus("progress", percent);
+                    lastPercent = percent;
+                    lastProgress = millis();
+                }
+            }
+            http.end();
+
+            if (total < 0 || received == (size_t)total)
+            {
+                if (!patcher.end())
+                {
+                    return patcher.errorString();
+                }
+                ESP_LOGI("Download OTA", "Rebuilt %u byte image from a %u byte delta", offset, received);
+                return "";
+            }
+            patcher.abort();
+        }
+
+        if (++retries > OTA_DOWNLOAD_RETRIES)
+        {
+            return "Connection lost";
+        }
+
+        ESP_LOGW("Download OTA", "Connection lost during delta download, retry %d", retries);
+        vTaskDelay(pdMS_TO_TICKS(1000 * retries));
+    }
+}
+
+void updateTask(void *param)
+{
+    DownloadJob *job = (DownloadJob *)param;
+    String error;
+
+    // pending settings go to flash before the update competes for it and ends in a restart
+    PersistenceScheduler::flush();
+    EventLog::log(EventType::OTA_STARTED, EVENT_SOURCE_DOWNLOAD);
+
+    const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+    uint8_t *buffer = (uint8_t *)malloc(SPI_FLASH_SEC_SIZE);
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+
+    unsigned long start = millis();
+
+    if (partition == nullptr)
+    {
+        error = "No OTA partition available";
+    }
+    else if (buffer == nullptr)
+    {
+        error = "Out of memory";
+    }
+    else if (job->url.endsWith(".delta"))
+    {
+        error = downloadDelta(job, partition, buffer, &sha);
+    }
+    else
+    {
+        error = downloadFirmware(job, partition, buffer, &sha);
+    }
+
+    if (error.length() == 0)
+    {
+        unsigned char digest[32];
+        char hex[65];
+        mbedtls_sha256_finish_ret(&sha, digest);
+        for (int i = 0; i < 32; i++)
+        {
+            sprintf(hex + 2 * i, "%02x", digest[i]);
+        }
+        ESP_LOGI("Download OTA", "Downloaded firmware in %lu ms, SHA-256 %s", millis() - start, hex);
+
+        if (job->sha256.length() && !job->sha256.equalsIgnoreCase(hex))
+        {
+            clearResumeState();
+            error = "SHA-256 checksum mismatch";
+        }
+        // validates the image before making it bootable
+        else if (esp_ota_set_boot_partition(partition) != ESP_OK)
+        {
+            clearResumeState();
+            error = "Downloaded firmware is not a valid image";
+        }
+    }
 
-        doc["status"] = "error";
-        doc["error"] = "Update failed, has same firmware version";
-        jsonObject = doc.as<JsonObject>();
-        _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    mbedtls_sha256_free(&sha);
+    free(buffer);
 
-        ESP_LOGE("Download OTA", "HTTP Update failed, has same firmware version");
+    if (error.length())
+    {
+        emitStatus("error", 0, error.c_str());
+        EventLog::log(EventType::OTA_FAILED, EVENT_SOURCE_DOWNLOAD);
+        ESP_LOGE("Download OTA", "HTTP Update failed: %s", error.c_str());
 #ifdef SERIAL_INFO
-        Serial.println("HTTP Update failed, has same firmware version");
+        Serial.printf("HTTP Update failed: %s\n", error.c_str());
 #endif
-        break;
-    case HTTP_UPDATE_OK:
+    }
+    else
+    {
+        clearResumeState();
+        emitStatus("finished", 100);
+        EventLog::log(EventType::OTA_SUCCEEDED, EVENT_SOURCE_DOWNLOAD);
+
         ESP_LOGI("Download OTA", "HTTP Update successful - Restarting");
 #ifdef SERIAL_INFO
         Serial.println("HTTP Update successful - Restarting");
 #endif
-        break;
+        // delay to allow the event to be sent out
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+        RestartService::restartNow();
     }
+
+    delete job;
+    _updateTaskHandle = nullptr;
     vTaskDelete(NULL);
 }
 
@@ -115,13 +552,14 @@ DownloadFirmwareService::DownloadFirmwareService(PsychicHttpServer *server,
 
 void DownloadFirmwareService::begin()
 {
+    _eventSocket = _socket;
     _socket->registerEvent(EVENT_DOWNLOAD_OTA);
 
     _server->on(GITHUB_FIRMWARE_PATH,
                 HTTP_POST,
                 _securityManager->wrapCallback(
                     std::bind(&DownloadFirmwareService::downloadUpdate, this, std::placeholders::_1, std::placeholders::_2),
-                    AuthenticationPredicates::IS_ADMIN));
+                    AuthenticationPredicates::CAN_UPDATE_FIRMWARE));
 
     ESP_LOGV("DownloadFirmwareService", "Registered POST endpoint: %s", GITHUB_FIRMWARE_PATH);
 }
@@ -133,30 +571,34 @@ esp_err_t DownloadFirmwareService::downloadUpdate(PsychicRequest *request, JsonV
         return request->reply(400);
     }
 
-    String downloadURL = json["download_url"];
-    ESP_LOGI("Download OTA", "Starting OTA from: %s", downloadURL.c_str());
+    // only one download at a time
+    if (_updateTaskHandle != nullptr)
+    {
+        return request->reply(409);
+    }
+
+    DownloadJob *job = new DownloadJob();
+    job->url = json["download_url"].as<String>();
+    job->sha256 = json["sha256"] | "";
+    ESP_LOGI("Download OTA", "Starting OTA from: %s", job->url.c_str());
 #ifdef SERIAL_INFO
-    Serial.println("Starting OTA from: " + downloadURL);
+    Serial.println("Starting OTA from: " + job->url);
 #endif
 
-    doc["status"] = "preparing";
-    doc["progress"] = 0;
-    doc["error"] = "";
-
-    JsonObject jsonObject = doc.as<JsonObject>();
-    _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    emitStatus("preparing", 0);
 
     if (xTaskCreatePinnedToCore(
             &updateTask,                // Function that should be called
             "Update",                   // Name of the task (for debugging)
             OTA_TASK_STACK_SIZE,        // Stack size (bytes)
-            &downloadURL,               // Pass reference to this class instance
+            job,                        // Pass the download job, the task deletes it
             (configMAX_PRIORITIES - 1), // Pretty high task priority
-            NULL,                       // Task handle
+            &_updateTaskHandle,         // Task handle
             1                           // Have it on application core
             ) != pdPASS)
     {
         ESP_LOGE("Download OTA", "Couldn't create download OTA task");
+        delete job;
         return request->reply(500);
     }
     return request->reply(200);
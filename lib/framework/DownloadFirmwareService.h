@@ -23,13 +23,32 @@
 #include <SecurityManager.h>
 
 #include <HTTPClient.h>
-#include <HTTPUpdate.h>
+#include <WiFiClientSecure.h>
+#include <ESPFS.h>
 // #include <SSLCertBundle.h>
 
 #define GITHUB_FIRMWARE_PATH "/rest/downloadUpdate"
 #define EVENT_DOWNLOAD_OTA "otastatus"
 #define OTA_TASK_STACK_SIZE 9216
 
+// Where the progress of an interrupted download is kept, so it can be resumed
+#define OTA_RESUME_FILE "/config/otaResume.json"
+
+// Persist the offset every n bytes, not on every chunk to spare the flash
+#ifndef OTA_RESUME_SAVE_INTERVAL
+#define OTA_RESUME_SAVE_INTERVAL (64 * 1024)
+#endif
+
+// How often a dropped connection is resumed before giving up
+#ifndef OTA_DOWNLOAD_RETRIES
+#define OTA_DOWNLOAD_RETRIES 5
+#endif
+
+// Minimum time between two progress events
+#ifndef OTA_PROGRESS_INTERVAL
+#define OTA_PROGRESS_INTERVAL 500
+#endif
+
 class DownloadFirmwareService
 {
 public:
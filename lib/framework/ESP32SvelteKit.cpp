@@ -14,6 +14,89 @@
 
 #include <ESP32SvelteKit.h>
 
+#if defined(EMBED_WWW) || defined(EMBED_WWW_PARTITION)
+// Checks an Accept-Encoding header for a coding, honouring an explicit q=0 as a refusal
+static bool acceptsEncoding(const String &acceptEncoding, const char *encoding)
+{
+    // an explicit entry for the coding wins over a wildcard
+    int wildcard = -1;
+    int start = 0;
+    while (start < (int)acceptEncoding.length())
+    {
+        int end = acceptEncoding.indexOf(',', start);
+        if (end < 0)
+            end = acceptEncoding.length();
+
+        String token = acceptEncoding.substring(start, end);
+        token.trim();
+        int params = token.indexOf(';');
+        String coding = params < 0 ? token : token.substring(0, params);
+        coding.trim();
+        int q = params < 0 ? -1 : token.indexOf("q=", params);
+        bool accepted = q < 0 || token.substring(q + 2).toFloat() > 0;
+
+        if (coding.equalsIgnoreCase(encoding))
+            return accepted;
+        if (coding.equals("*"))
+            wildcard = accepted ? 1 : 0;
+
+        start = end + 1;
+    }
+    return wildcard == 1;
+}
+
+static esp_err_t serveEmbeddedAsset(PsychicRequest *request, const String &contentType, const WWWAsset &asset, bool immutable)
+{
+    const char *cacheControl = immutable ? "public, immutable, max-age=31536000" : "no-cache";
+
+    // Pick the smallest representation the client accepts. Without any Accept-Encoding header we keep
+    // serving gzip like before, and if gzip is refused but no identity copy was embedded it is still the best we have.
+    String acceptEncoding = request->header("Accept-Encoding");
+    const uint8_t *content = asset.gzip;
+    size_t len = asset.gzipLength;
+    const char *encoding = "gzip";
+    const char *suffix = "-gz";
+    if (asset.brotli && acceptsEncoding(acceptEncoding, "br"))
+    {
+        content = asset.brotli;
+        len = asset.brotliLength;
+        encoding = "br";
+        suffix = "-br";
+    }
+    else if (asset.identity && acceptEncoding.length() && !acceptsEncoding(acceptEncoding, "gzip"))
+    {
+        content = asset.identity;
+        len = asset.identityLength;
+        encoding = NULL;
+        suffix = "";
+    }
+
+    // every encoding is its own representation and needs its own validator
+    char etag[40];
+    snprintf(etag, sizeof(etag), "\"%s%s\"", asset.etag, suffix);
+
+    PsychicResponse response(request);
+    response.addHeader("Cache-Control", cacheControl);
+    response.addHeader("ETag", etag);
+    if (asset.brotli || asset.identity)
+        response.addHeader("Vary", "Accept-Encoding");
+
+    String ifNoneMatch = request->header("If-None-Match");
+    if (ifNoneMatch.length() && (ifNoneMatch.equals("*") || ifNoneMatch.indexOf(etag) >= 0))
+    {
+        response.setCode(304);
+        return response.send();
+    }
+
+    response.setCode(200);
+    response.setContentType(contentType.c_str());
+    if (encoding)
+        response.addHeader("Content-Encoding", encoding);
+    response.setContent(content, len);
+    return response.send();
+}
+#endif
+
 ESP32SvelteKit::ESP32SvelteKit(PsychicHttpServer *server, unsigned int numberEndpoints) : _server(server),
                                                                                           _numberEndpoints(numberEndpoints),
                                                                                           _featureService(server, &_socket),
@@ -53,68 +136,73 @@ ESP32SvelteKit::ESP32SvelteKit(PsychicHttpServer *server, unsigned int numberEnd
 #endif
                                                                                           _restartService(server, &_securitySettingsService),
                                                                                           _factoryResetService(server, &ESPFS, &_securitySettingsService),
-                                                                                          _systemStatus(server, &_securitySettingsService)
+                                                                                          _systemStatus(server, &_securitySettingsService),
+                                                                                          _eventLogService(server, &_securitySettingsService, &_socket)
 {
 }
 
 void ESP32SvelteKit::begin()
 {
+    unsigned long start = millis();
+
     ESP_LOGV("ESP32SvelteKit", "Loading settings from files system");
     ESPFS.begin(true);
+    FSUsage::begin();
+    EventLog::begin(&ESPFS);
 
     _wifiSettingsService.initWiFi();
 
     // SvelteKit uses a lot of handlers, so we need to increase the max_uri_handlers
     // WWWData has 77 Endpoints, Framework has 27, and Lighstate Demo has 4
     _server->config.max_uri_handlers = _numberEndpoints;
+    // Several dashboards keep connections open, reap idle ones and purge the oldest when full
+    _server->useHighConcurrencyProfile();
     _server->listen(80);
 
-#ifdef EMBED_WWW
+#if defined(EMBED_WWW) || defined(EMBED_WWW_PARTITION)
+    RouteRegistrationHandler registerAsset = [&](const String &uri, const String &contentType, const WWWAsset &asset)
+    {
+        // SvelteKit fingerprints everything below /_app/immutable/, all other assets must be revalidated
+        bool immutable = uri.startsWith("/_app/immutable/");
+        PsychicHttpRequestCallback requestHandler = [contentType, asset, immutable](PsychicRequest *request)
+        {
+            return serveEmbeddedAsset(request, contentType, asset, immutable);
+        };
+        PsychicWebHandler *handler = new PsychicWebHandler();
+        handler->onRequest(requestHandler);
+        _server->on(uri.c_str(), HTTP_GET, handler)->setLane(ASYNC_LANE_STATIC);
+
+        // Set default end-point for all non matching requests
+        // this is easier than using webServer.onNotFound()
+        if (uri.equals("/index.html"))
+        {
+            _server->defaultEndpoint->setHandler(handler);
+        }
+    };
+#endif
+
+#if defined(EMBED_WWW_PARTITION)
+    // Serve static resources straight from the mapped www partition, fall back to FS without a valid image
+    if (WWWPartition::begin())
+    {
+        ESP_LOGV("ESP32SvelteKit", "Registering routes from www partition");
+        WWWPartition::registerRoutes(registerAsset);
+    }
+    else
+    {
+        _serveFilesystem();
+    }
+#elif defined(EMBED_WWW)
     // Serve static resources from PROGMEM
     ESP_LOGV("ESP32SvelteKit", "Registering routes from PROGMEM static resources");
-    WWWData::registerRoutes(
-        [&](const String &uri, const String &contentType, const uint8_t *content, size_t len)
-        {
-            PsychicHttpRequestCallback requestHandler = [contentType, content, len](PsychicRequest *request)
-            {
-                PsychicResponse response(request);
-                response.setCode(200);
-                response.setContentType(contentType.c_str());
-                response.addHeader("Content-Encoding", "gzip");
-                response.addHeader("Cache-Control", "public, immutable, max-age=31536000");
-                response.setContent(content, len);
-                return response.send();
-            };
-            PsychicWebHandler *handler = new PsychicWebHandler();
-            handler->onRequest(requestHandler);
-            _server->on(uri.c_str(), HTTP_GET, handler);
-
-            // Set default end-point for all non matching requests
-            // this is easier than using webServer.onNotFound()
-            if (uri.equals("/index.html"))
-            {
-                _server->defaultEndpoint->setHandler(handler);
-            }
-        });
+    WWWData::registerRoutes(registerAsset);
 #else
-    // Serve static resources from /www/
-    ESP_LOGV("ESP32SvelteKit", "Registering routes from FS /www/ static resources");
-    _server->serveStatic("/_app/", ESPFS, "/www/_app/");
-    _server->serveStatic("/favicon.png", ESPFS, "/www/favicon.png");
-    //  Serving all other get requests with "/www/index.htm"
-    _server->onNotFound([](PsychicRequest *request)
-                        {
-        if (request->method() == HTTP_GET) {
-            PsychicFileResponse response(request, ESPFS, "/www/index.html", "text/html");
-            return response.send();
-            // String url = "http://" + request->host() + "/index.html";
-            // request->redirect(url.c_str());
-        } });
+    _serveFilesystem();
 #endif
 
-    // Serve static resources from /config/ if set by platformio.ini
+    // Serve the settings files from /config/ if set by platformio.ini
 #if SERVE_CONFIG_FILES
-    _server->serveStatic("/config/", ESPFS, "/config/");
+    _server->on("/config/*", HTTP_GET, std::bind(&ESP32SvelteKit::_serveConfigFile, this, std::placeholders::_1));
 #endif
 
 #if defined(ENABLE_CORS)
@@ -144,6 +232,7 @@ void ESP32SvelteKit::begin()
     _featureService.begin();
     _restartService.begin();
     _systemStatus.begin();
+    _eventLogService.begin();
     _wifiSettingsService.begin();
     _wifiScanner.begin();
     _wifiStatus.begin();
@@ -187,8 +276,70 @@ void ESP32SvelteKit::begin()
         NULL,                       // Task handle
         ESP32SVELTEKIT_RUNNING_CORE // Pin to application core
     );
+
+    ESP_LOGI("ESP32SvelteKit", "Started in %lu ms", millis() - start);
 }
 
+void ESP32SvelteKit::_serveFilesystem()
+{
+    // Serve static resources from /www/
+    ESP_LOGV("ESP32SvelteKit", "Registering routes from FS /www/ static resources");
+    _server->serveStatic("/_app/", ESPFS, "/www/_app/");
+    _server->serveStatic("/favicon.png", ESPFS, "/www/favicon.png");
+    //  Serving all other get requests with "/www/index.htm"
+    _server->onNotFound([](PsychicRequest *request)
+                        {
+        if (request->method() == HTTP_GET) {
+            PsychicFileResponse response(request, ESPFS, "/www/index.html", "text/html");
+            return response.send();
+            // String url = "http://" + request->host() + "/index.html";
+            // request->redirect(url.c_str());
+        } });
+}
+
+#if SERVE_CONFIG_FILES
+esp_err_t ESP32SvelteKit::_serveConfigFile(PsychicRequest *request)
+{
+    // temporary files and backups belong to SettingsFile, the CRC footer is not part of the JSON
+    String path = request->path();
+    if (path.indexOf("..") >= 0 || path.endsWith(SETTINGS_FILE_TMP_SUFFIX) || path.endsWith(SETTINGS_FILE_BACKUP_SUFFIX) ||
+        !ESPFS.exists(path))
+    {
+        return request->reply(404);
+    }
+
+    File file = ESPFS.open(path, "r");
+    if (!file || file.isDirectory() || file.size() > SETTINGS_FILE_MAX_SIZE)
+    {
+        file.close();
+        return request->reply(404);
+    }
+
+    size_t size = file.size();
+    char *buffer = (char *)malloc(max(size, (size_t)1));
+    if (buffer == nullptr)
+    {
+        file.close();
+        return request->reply(500);
+    }
+    bool read = file.read((uint8_t *)buffer, size) == size;
+    file.close();
+    if (!read)
+    {
+        free(buffer);
+        return request->reply(500);
+    }
+
+    PsychicResponse response(request);
+    response.setCode(200);
+    response.setContentType(path.endsWith(".json") ? "application/json" : "application/octet-stream");
+    response.setContent((const uint8_t *)buffer, SettingsFile::contentLength(buffer, size));
+    esp_err_t result = response.send();
+    free(buffer);
+    return result;
+}
+#endif
+
 void ESP32SvelteKit::_loop()
 {
     TickType_t xLastWakeTime = xTaskGetTickCount();
@@ -208,6 +359,8 @@ void ESP32SvelteKit::_loop()
 #if FT_ENABLED(FT_ANALYTICS)
         _analyticsService.loop();
 #endif
+        FSUsage::loop();
+        _eventLogService.loop();
 
         // Query the connectivity status
         wifi = _wifiStatus.isConnected();
@@ -27,6 +27,7 @@
 #include <BatteryService.h>
 #include <FactoryResetService.h>
 #include <DownloadFirmwareService.h>
+#include <EventLogService.h>
 #include <EventSocket.h>
 #include <MqttSettingsService.h>
 #include <MqttStatus.h>
@@ -42,10 +43,14 @@
 #include <WiFiSettingsService.h>
 #include <WiFiStatus.h>
 #include <ESPFS.h>
+#include <FSUsage.h>
+#include <SettingsFile.h>
 #include <PsychicHttp.h>
 #include <vector>
 
-#ifdef EMBED_WWW
+#if defined(EMBED_WWW_PARTITION)
+#include <WWWPartition.h>
+#elif defined(EMBED_WWW)
 #include <WWWData.h>
 #endif
 
@@ -241,12 +246,17 @@ private:
     RestartService _restartService;
     FactoryResetService _factoryResetService;
     SystemStatus _systemStatus;
+    EventLogService _eventLogService;
 
     String _appName = APP_NAME;
 
 protected:
     static void _loopImpl(void *_this) { static_cast<ESP32SvelteKit *>(_this)->_loop(); }
     void _loop();
+    void _serveFilesystem();
+#if SERVE_CONFIG_FILES
+    esp_err_t _serveConfigFile(PsychicRequest *request);
+#endif
 
     std::vector<loopCallback> _loopFunctions;
 
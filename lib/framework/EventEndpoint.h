@@ -20,6 +20,10 @@
 #include <SecurityManager.h>
 #include <StatefulService.h>
 
+/*
+ * The read predicate decides who receives the state, the write predicate who may update it. Both are
+ * checked by the EventSocket against the authentication of the sending or receiving connection.
+ */
 template <class T>
 class EventEndpoint
 {
@@ -27,11 +31,15 @@ public:
     EventEndpoint(JsonStateReader<T> stateReader,
                   JsonStateUpdater<T> stateUpdater,
                   StatefulService<T> *statefulService,
-                  EventSocket *socket, const char *event) : _stateReader(stateReader),
-                                                            _stateUpdater(stateUpdater),
-                                                            _statefulService(statefulService),
-                                                            _socket(socket),
-                                                            _event(event)
+                  EventSocket *socket, const char *event,
+                  AuthenticationPredicate readPredicate = AuthenticationPredicates::IS_AUTHENTICATED,
+                  AuthenticationPredicate writePredicate = AuthenticationPredicates::IS_AUTHENTICATED) : _stateReader(stateReader),
+                                                                                                         _stateUpdater(stateUpdater),
+                                                                                                         _statefulService(statefulService),
+                                                                                                         _socket(socket),
+                                                                                                         _event(event),
+                                                                                                         _readPredicate(readPredicate),
+                                                                                                         _writePredicate(writePredicate)
     {
         _statefulService->addUpdateHandler([&](const String &originId)
                                            { syncState(originId); },
@@ -40,7 +48,7 @@ public:
 
     void begin()
     {
-        _socket->registerEvent(_event);
+        _socket->registerEvent(_event, _readPredicate, _writePredicate);
         _socket->onEvent(_event, std::bind(&EventEndpoint::updateState, this, std::placeholders::_1, std::placeholders::_2));
         _socket->onSubscribe(_event, [&](const String &originId)
                              { syncState(originId, true); });
@@ -52,6 +60,8 @@ private:
     StatefulService<T> *_statefulService;
     EventSocket *_socket;
     const char *_event;
+    AuthenticationPredicate _readPredicate;
+    AuthenticationPredicate _writePredicate;
 
     void updateState(JsonObject &root, int originId)
     {
@@ -0,0 +1,378 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <EventLog.h>
+#include <FSUsage.h>
+#include <PersistenceScheduler.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <vector>
+
+// 2020-01-01, older clocks have not been set by NTP yet
+#define VALID_TIME 1577836800
+#define STAGING_MASK (EVENT_LOG_STAGING_SIZE - 1)
+
+static_assert((EVENT_LOG_STAGING_SIZE & STAGING_MASK) == 0, "EVENT_LOG_STAGING_SIZE must be a power of two");
+static_assert(sizeof(EventRecord) == EVENT_LOG_RECORD_SIZE, "Event records must be 16 bytes");
+
+/*
+ * Bounded ring after Vyukov. A producer claims a position with a CAS on the head and publishes the
+ * slot by advancing its turn, the consumer takes the slots in order and hands them back for the next
+ * round. Turns are stored relative to the slot index, so the zero initialized ring works before begin().
+ */
+struct StagingSlot
+{
+    std::atomic<uint32_t> turn;
+    EventRecord record;
+};
+
+static StagingSlot staging[EVENT_LOG_STAGING_SIZE];
+static std::atomic<uint32_t> stagingHead(0);
+static std::atomic<uint32_t> droppedCount(0);
+
+// everything below is only touched with the mutex held, which makes the mutex holder the single consumer
+static SemaphoreHandle_t mutex = nullptr;
+static FS *logFs = nullptr;
+static persistence_id_t persistenceId = 0;
+static uint32_t stagingTail = 0;
+static uint32_t reportedDropped = 0;
+static std::vector<EventRecord> batch;
+static uint32_t sequence = 0;
+static uint32_t maxSegments = EVENT_LOG_MIN_SEGMENTS;
+static uint32_t firstSegment = 1;
+static uint32_t lastSegment = 1;
+static uint32_t segmentRecords = 0;
+
+static const char *typeNames[] = {"unknown", "boot", "restart", "sleep", "wifi_connected", "wifi_disconnected",
+                                  "mqtt_connected", "mqtt_disconnected", "mqtt_error", "ota_started",
+                                  "ota_succeeded", "ota_failed", "relay_switched", "events_dropped"};
+
+static String segmentPath(uint32_t segment)
+{
+    char path[32];
+    snprintf(path, sizeof(path), EVENT_LOG_DIRECTORY "/%08u.log", segment);
+    return String(path);
+}
+
+static uint32_t uptimeMillis()
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static bool takeStaged(EventRecord *record)
+{
+    StagingSlot &slot = staging[stagingTail & STAGING_MASK];
+    uint32_t round = stagingTail & ~STAGING_MASK;
+    if (slot.turn.load(std::memory_order_acquire) != round + 1)
+    {
+        return false;
+    }
+    *record = slot.record;
+    slot.turn.store(round + EVENT_LOG_STAGING_SIZE, std::memory_order_release);
+    stagingTail++;
+    return true;
+}
+
+// moves the staged events into the batch, returns the index of the first one
+static size_t drainStaged()
+{
+    size_t first = batch.size();
+    time_t now = time(nullptr);
+    uint32_t uptime = uptimeMillis();
+    EventRecord record;
+
+    // a full batch leaves the events in the ring, which drops further ones until the next flush
+    while (batch.size() < EVENT_LOG_SEGMENT_RECORDS && takeStaged(&record))
+    {
+        batch.push_back(record);
+    }
+    uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped && batch.size() < EVENT_LOG_SEGMENT_RECORDS)
+    {
+        batch.push_back({0, 0, uptime, (uint8_t)EventType::EVENTS_DROPPED, 0, (int16_t)min(dropped - reportedDropped, (uint32_t)INT16_MAX)});
+        reportedDropped = dropped;
+    }
+
+    // the ring only holds the uptime, reading the clock could block the caller
+    for (size_t i = first; i < batch.size(); i++)
+    {
+        EventRecord &drained = batch[i];
+        int32_t age = uptime - drained.uptime;
+        drained.sequence = ++sequence;
+        drained.time = now >= VALID_TIME ? now - max(age, (int32_t)0) / 1000 : 0;
+    }
+    return first;
+}
+
+// the open segment is never dropped
+static bool dropOldest()
+{
+    if (firstSegment >= lastSegment)
+    {
+        return false;
+    }
+    logFs->remove(segmentPath(firstSegment));
+    FSUsage::fileResized(logFs, EVENT_LOG_SEGMENT_RECORDS * EVENT_LOG_RECORD_SIZE, 0);
+    firstSegment++;
+    return true;
+}
+
+static void rotate()
+{
+    while (lastSegment - firstSegment + 1 > maxSegments)
+    {
+        if (!dropOldest())
+        {
+            break;
+        }
+    }
+}
+
+static bool writeBatch()
+{
+    size_t written = 0;
+    bool failed = false;
+    while (written < batch.size() && !failed)
+    {
+        if (segmentRecords >= EVENT_LOG_SEGMENT_RECORDS)
+        {
+            lastSegment++;
+            segmentRecords = 0;
+            rotate();
+        }
+
+        size_t count = min(batch.size() - written, (size_t)(EVENT_LOG_SEGMENT_RECORDS - segmentRecords));
+        File file = logFs->open(segmentPath(lastSegment), segmentRecords == 0 ? "w" : "a");
+        size_t bytes = file ? file.write((const uint8_t *)&batch[written], count * EVENT_LOG_RECORD_SIZE) : 0;
+        file.close();
+        FSUsage::fileResized(logFs, segmentRecords * EVENT_LOG_RECORD_SIZE, segmentRecords * EVENT_LOG_RECORD_SIZE + bytes);
+
+        if (bytes != count * EVENT_LOG_RECORD_SIZE)
+        {
+            // a torn record would shift all following ones, continue in a new segment
+            if (bytes % EVENT_LOG_RECORD_SIZE != 0)
+            {
+                segmentRecords = EVENT_LOG_SEGMENT_RECORDS;
+            }
+            count = bytes / EVENT_LOG_RECORD_SIZE;
+
+            // most likely the file system is full, make room at the expense of the oldest events
+            failed = !dropOldest();
+            ESP_LOGE("EventLog", "Could not write %s%s", segmentPath(lastSegment).c_str(), failed ? "" : ", dropped the oldest segment");
+        }
+        if (segmentRecords < EVENT_LOG_SEGMENT_RECORDS)
+        {
+            segmentRecords += count;
+        }
+        written += count;
+    }
+    batch.erase(batch.begin(), batch.begin() + written);
+    return !failed;
+}
+
+void EventLog::begin(FS *fileSystem)
+{
+    logFs = fileSystem;
+    mutex = xSemaphoreCreateMutex();
+    maxSegments = max(FSUsage::budget(EVENT_LOG_BUDGET_SHARE) / (EVENT_LOG_SEGMENT_RECORDS * EVENT_LOG_RECORD_SIZE), (size_t)EVENT_LOG_MIN_SEGMENTS);
+    if (!logFs->exists(EVENT_LOG_DIRECTORY))
+    {
+        logFs->mkdir(EVENT_LOG_DIRECTORY);
+    }
+
+    // segments are numbered, find the oldest and the newest
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    File directory = logFs->open(EVENT_LOG_DIRECTORY);
+    File file;
+    while (directory && (file = directory.openNextFile()))
+    {
+        const char *name = strrchr(file.name(), '/');
+        name = name != nullptr ? name + 1 : file.name();
+        uint32_t segment = file.isDirectory() || strstr(name, ".log") == nullptr ? 0 : strtoul(name, nullptr, 10);
+        file.close();
+        if (segment > 0)
+        {
+            first = min(first, segment);
+            last = max(last, segment);
+        }
+    }
+    directory.close();
+
+    if (last > 0)
+    {
+        firstSegment = first;
+        lastSegment = last;
+
+        // continue the sequence behind the last record, in a new segment if the last one is torn
+        file = logFs->open(segmentPath(last), "r");
+        size_t size = file.size();
+        segmentRecords = size / EVENT_LOG_RECORD_SIZE;
+        EventRecord record;
+        if (segmentRecords > 0 && file.seek((segmentRecords - 1) * EVENT_LOG_RECORD_SIZE) &&
+            file.read((uint8_t *)&record, EVENT_LOG_RECORD_SIZE) == EVENT_LOG_RECORD_SIZE)
+        {
+            sequence = record.sequence;
+        }
+        file.close();
+        if (size % EVENT_LOG_RECORD_SIZE != 0)
+        {
+            segmentRecords = EVENT_LOG_SEGMENT_RECORDS;
+        }
+    }
+    batch.reserve(EVENT_LOG_SEGMENT_RECORDS);
+
+    // not counted as settings writes
+    persistenceId = PersistenceScheduler::add(flush, EVENT_LOG_FLUSH_DELAY_MS, EVENT_LOG_FLUSH_DELAY_MS, false);
+
+    rotate();
+    ESP_LOGI("EventLog", "Segments %u to %u of at most %u, last event %u", firstSegment, lastSegment, maxSegments, sequence);
+    log(EventType::BOOT, 0, esp_reset_reason());
+}
+
+void EventLog::log(EventType type, uint8_t source, int16_t value)
+{
+    uint32_t uptime = uptimeMillis();
+    uint32_t position = stagingHead.load(std::memory_order_relaxed);
+    StagingSlot *slot;
+    while (true)
+    {
+        slot = &staging[position & STAGING_MASK];
+        int32_t lag = slot->turn.load(std::memory_order_acquire) - (position & ~STAGING_MASK);
+        if (lag == 0)
+        {
+            if (stagingHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (lag < 0)
+        {
+            // the consumer has not taken this slot from the last round yet
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = stagingHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = {0, 0, uptime, (uint8_t)type, source, value};
+    slot->turn.store((position & ~STAGING_MASK) + 1, std::memory_order_release);
+}
+
+size_t EventLog::drain(EventLogVisitor visitor)
+{
+    if (mutex == nullptr)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t first = drainStaged();
+    std::vector<EventRecord> drained;
+    if (visitor)
+    {
+        drained.assign(batch.begin() + first, batch.end());
+    }
+    size_t count = batch.size() - first;
+    xSemaphoreGive(mutex);
+
+    if (count > 0)
+    {
+        PersistenceScheduler::markDirty(persistenceId);
+    }
+    for (const EventRecord &record : drained)
+    {
+        if (!visitor(record))
+        {
+            break;
+        }
+    }
+    return count;
+}
+
+bool EventLog::flush()
+{
+    if (mutex == nullptr)
+    {
+        return true;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    drainStaged();
+    bool written = writeBatch();
+    xSemaphoreGive(mutex);
+    return written;
+}
+
+void EventLog::read(uint32_t since, EventLogVisitor visitor)
+{
+    if (mutex == nullptr)
+    {
+        return;
+    }
+
+    // one segment at a time, so writers only wait for a single file read
+    std::vector<EventRecord> records;
+    records.reserve(2 * EVENT_LOG_SEGMENT_RECORDS);
+    uint32_t segment = 0;
+    bool last = false;
+    while (!last)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        segment = max(segment, firstSegment);
+        last = segment >= lastSegment;
+        size_t count = last ? segmentRecords : EVENT_LOG_SEGMENT_RECORDS;
+        records.clear();
+        if (count > 0)
+        {
+            File file = logFs->open(segmentPath(segment), "r");
+            count = min(count, file.size() / EVENT_LOG_RECORD_SIZE);
+            records.resize(count);
+            count = file.read((uint8_t *)records.data(), count * EVENT_LOG_RECORD_SIZE) / EVENT_LOG_RECORD_SIZE;
+            records.resize(count);
+            file.close();
+        }
+        if (last)
+        {
+            records.insert(records.end(), batch.begin(), batch.end());
+        }
+        xSemaphoreGive(mutex);
+
+        for (const EventRecord &record : records)
+        {
+            if (record.sequence > since && !visitor(record))
+            {
+                return;
+            }
+        }
+        segment++;
+    }
+}
+
+const char *EventLog::typeName(uint8_t type)
+{
+    return type < sizeof(typeNames) / sizeof(typeNames[0]) ? typeNames[type] : typeNames[0];
+}
+
+uint32_t EventLog::lastSequence()
+{
+    return sequence;
+}
+
+uint32_t EventLog::dropped()
+{
+    return droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,124 @@
+#ifndef EventLog_h
+#define EventLog_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+
+/*
+ * Persistent log of the events that explain a field failure: restarts, relay switches, WiFi and
+ * MQTT connection changes and OTA results.
+ *
+ * log() only copies the event into a lock-free staging ring of EVENT_LOG_STAGING_SIZE slots, so it
+ * can be called from any task and never blocks. If the ring is full the event is dropped and
+ * counted, the count is logged as an EVENTS_DROPPED event later. The loop task drains the ring,
+ * assigns sequence numbers and wall clock time, and the batch is appended to flash through the
+ * PersistenceScheduler at most every EVENT_LOG_FLUSH_DELAY_MS, and before restarts and sleep.
+ *
+ * Records are appended to segment files of EVENT_LOG_SEGMENT_RECORDS records. The log gets
+ * EVENT_LOG_BUDGET_SHARE percent of the log budget of the file system (see FSUsage::budget()) and the
+ * oldest segment is deleted once the segments exceed it, so the flash use is bounded. If a write fails
+ * anyway because the file system is full, the oldest segment is deleted and the write is retried.
+ *
+ * Record layout (little endian, 16 bytes):
+ *   u32 sequence, u32 unix time (0 if the clock was not set), u32 uptime in ms, u8 type, u8 source,
+ *   i16 value
+ */
+
+#ifndef EVENT_LOG_DIRECTORY
+#define EVENT_LOG_DIRECTORY "/eventlog"
+#endif
+
+// 4 kB, one LittleFS block
+#ifndef EVENT_LOG_SEGMENT_RECORDS
+#define EVENT_LOG_SEGMENT_RECORDS 256
+#endif
+
+#ifndef EVENT_LOG_BUDGET_SHARE
+#define EVENT_LOG_BUDGET_SHARE 16
+#endif
+
+// at least two segments are kept, so rotating never empties the log
+#define EVENT_LOG_MIN_SEGMENTS 2
+
+// has to be a power of two
+#ifndef EVENT_LOG_STAGING_SIZE
+#define EVENT_LOG_STAGING_SIZE 64
+#endif
+
+#ifndef EVENT_LOG_FLUSH_DELAY_MS
+#define EVENT_LOG_FLUSH_DELAY_MS 10000
+#endif
+
+#define EVENT_LOG_RECORD_SIZE 16
+
+enum class EventType : uint8_t
+{
+    BOOT = 1,          // value: reset reason
+    RESTART,           // restart requested
+    SLEEP,             // going to deep sleep
+    WIFI_CONNECTED,    // value: RSSI
+    WIFI_DISCONNECTED, // value: disconnect reason
+    MQTT_CONNECTED,    //
+    MQTT_DISCONNECTED, //
+    MQTT_ERROR,        // value: socket errno
+    OTA_STARTED,       // source: 0 upload, 1 download
+    OTA_SUCCEEDED,     // source: 0 upload, 1 download
+    OTA_FAILED,        // source: 0 upload, 1 download, value: error code
+    RELAY_SWITCHED,    // source: relay index, value: new state
+    EVENTS_DROPPED     // value: events lost to a full staging ring
+};
+
+#define EVENT_SOURCE_UPLOAD 0
+#define EVENT_SOURCE_DOWNLOAD 1
+
+struct __attribute__((packed)) EventRecord
+{
+    uint32_t sequence;
+    uint32_t time;
+    uint32_t uptime;
+    uint8_t type;
+    uint8_t source;
+    int16_t value;
+};
+
+// return false to stop reading
+typedef std::function<bool(const EventRecord &record)> EventLogVisitor;
+
+namespace EventLog
+{
+    // continues the log on fs, the file system has to be mounted and FSUsage started
+    void begin(FS *fs);
+
+    // stages an event, safe from any task, never blocks and never touches flash
+    void log(EventType type, uint8_t source = 0, int16_t value = 0);
+
+    // moves staged events into the batch for the next flush, called from the loop task. The visitor
+    // sees every drained record, e.g. to stream it to clients.
+    size_t drain(EventLogVisitor visitor = nullptr);
+
+    // writes everything staged to flash now, false if a write failed
+    bool flush();
+
+    // visits records with sequence > since in order, including the ones not flushed yet
+    void read(uint32_t since, EventLogVisitor visitor);
+
+    const char *typeName(uint8_t type);
+    uint32_t lastSequence();
+    uint32_t dropped();
+}
+
+#endif // end EventLog_h
@@ -0,0 +1,93 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <EventLogService.h>
+
+static void writeRecord(JsonObject root, const EventRecord &record)
+{
+    root["seq"] = record.sequence;
+    root["time"] = record.time;
+    root["uptime"] = record.uptime;
+    root["type"] = EventLog::typeName(record.type);
+    root["source"] = record.source;
+    root["value"] = record.value;
+}
+
+EventLogService::EventLogService(PsychicHttpServer *server,
+                                 SecurityManager *securityManager,
+                                 EventSocket *socket) : _server(server),
+                                                        _securityManager(securityManager),
+                                                        _socket(socket)
+{
+}
+
+void EventLogService::begin()
+{
+    // the log is for admins only, like the REST endpoint
+    _socket->registerEvent(EVENT_EVENT_LOG, AuthenticationPredicates::IS_ADMIN, AuthenticationPredicates::IS_ADMIN);
+
+    _server->on(EVENT_LOG_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&EventLogService::eventLog, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_ADMIN));
+
+    ESP_LOGV("EventLogService", "Registered GET endpoint: %s", EVENT_LOG_SERVICE_PATH);
+}
+
+void EventLogService::loop()
+{
+    EventLog::drain([&](const EventRecord &record)
+                    {
+        JsonDocument doc;
+        writeRecord(doc.to<JsonObject>(), record);
+        JsonObject jsonObject = doc.as<JsonObject>();
+        _socket->emitEvent(EVENT_EVENT_LOG, jsonObject);
+        return true; });
+}
+
+esp_err_t EventLogService::eventLog(PsychicRequest *request)
+{
+    char value[16];
+    uint32_t since = request->getParam("since", value, sizeof(value)) ? strtoul(value, nullptr, 10) : 0;
+    bool binary = request->getParam("format", value, sizeof(value)) && strcmp(value, "binary") == 0;
+
+    PsychicStreamResponse response = PsychicStreamResponse(request, binary ? "application/octet-stream" : "application/json");
+    if (response.beginSend() != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    if (binary)
+    {
+        EventLog::read(since, [&](const EventRecord &record)
+                       { return response.write((const uint8_t *)&record, EVENT_LOG_RECORD_SIZE) == EVENT_LOG_RECORD_SIZE; });
+        return response.endSend();
+    }
+
+    response.printf("{\"last\":%u,\"dropped\":%u,\"events\":[", EventLog::lastSequence(), EventLog::dropped());
+    bool first = true;
+    JsonDocument doc;
+    EventLog::read(since, [&](const EventRecord &record)
+                   {
+        if (!first)
+        {
+            response.print(',');
+        }
+        first = false;
+        doc.clear();
+        writeRecord(doc.to<JsonObject>(), record);
+        serializeJson(doc, response);
+        return true; });
+    response.print("]}");
+    return response.endSend();
+}
@@ -0,0 +1,46 @@
+#ifndef EventLogService_h
+#define EventLogService_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <EventLog.h>
+#include <EventSocket.h>
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+
+#define EVENT_LOG_SERVICE_PATH "/rest/eventlog"
+#define EVENT_EVENT_LOG "eventlog"
+
+/*
+ * Streams the event log. GET /rest/eventlog?since=<sequence> returns the records behind since as
+ * JSON, with format=binary as the raw 16 byte records. New records are pushed as "eventlog" events
+ * to admins once the loop task has drained them.
+ */
+class EventLogService
+{
+public:
+    EventLogService(PsychicHttpServer *server, SecurityManager *securityManager, EventSocket *socket);
+
+    void begin();
+    void loop();
+
+private:
+    PsychicHttpServer *_server;
+    SecurityManager *_securityManager;
+    EventSocket *_socket;
+
+    esp_err_t eventLog(PsychicRequest *request);
+};
+
+#endif // end EventLogService_h
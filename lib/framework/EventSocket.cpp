@@ -21,12 +21,13 @@ void EventSocket::begin()
     ESP_LOGV("EventSocket", "Registered event socket endpoint: %s", EVENT_SERVICE_PATH);
 }
 
-void EventSocket::registerEvent(String event)
+void EventSocket::registerEvent(String event, AuthenticationPredicate readPredicate, AuthenticationPredicate writePredicate)
 {
     if (!isEventValid(event))
     {
         ESP_LOGD("EventSocket", "Registering event: %s", event.c_str());
         events.push_back(event);
+        event_predicates.emplace(event, EventPredicates{readPredicate, writePredicate});
     }
     else
     {
@@ -77,26 +78,34 @@ esp_err_t EventSocket::onFrame(PsychicWebSocketRequest *request, httpd_ws_frame
             String event = doc["event"];
             if (event == "subscribe")
             {
-                // only subscribe to events that are registered
-                if (isEventValid(doc["data"].as<String>()))
+                // only subscribe to events that are registered and readable by the client
+                if (!isEventValid(doc["data"].as<String>()))
                 {
-                    client_subscriptions[doc["data"]].push_back(request->client()->socket());
-                    handleSubscribeCallbacks(doc["data"], String(request->client()->socket()));
+                    ESP_LOGW("EventSocket", "Client tried to subscribe to unregistered event: %s", doc["data"].as<String>().c_str());
+                }
+                else if (!isClientAllowed(doc["data"].as<String>(), request->client()->socket(), false))
+                {
+                    ESP_LOGW("EventSocket", "Client not allowed to subscribe to event: %s", doc["data"].as<String>().c_str());
                 }
                 else
                 {
-                    ESP_LOGW("EventSocket", "Client tried to subscribe to unregistered event: %s", doc["data"].as<String>().c_str());
+                    client_subscriptions[doc["data"]].push_back(request->client()->socket());
+                    handleSubscribeCallbacks(doc["data"], String(request->client()->socket()));
                 }
             }
             else if (event == "unsubscribe")
             {
                 client_subscriptions[doc["data"]].remove(request->client()->socket());
             }
-            else
+            else if (isClientAllowed(event, request->client()->socket(), true))
             {
                 JsonObject jsonObject = doc["data"].as<JsonObject>();
                 handleEventCallbacks(event, jsonObject, request->client()->socket());
             }
+            else
+            {
+                ESP_LOGW("EventSocket", "Client not allowed to send event: %s", event.c_str());
+            }
             return ESP_OK;
         }
         ESP_LOGW("EventSocket", "Error[%d] parsing JSON: %s", error, (char *)frame->payload);
@@ -147,7 +156,7 @@ void EventSocket::emitEvent(String event, JsonObject &jsonObject, const char *or
     if (onlyToSameOrigin && originSubscriptionId > 0)
     {
         auto *client = _socket.getClient(originSubscriptionId);
-        if (client)
+        if (client && isClientAllowed(event, originSubscriptionId, false))
         {
             ESP_LOGV("EventSocket", "Emitting event: %s to %s, Message[%d]: %s", event, client->remoteIP().toString().c_str(), len, output);
 #if FT_ENABLED(EVENT_USE_JSON)
@@ -170,6 +179,11 @@ void EventSocket::emitEvent(String event, JsonObject &jsonObject, const char *or
                 subscriptions.remove(subscription);
                 continue;
             }
+            // permissions may have been changed since the client subscribed
+            if (!isClientAllowed(event, subscription, false))
+            {
+                continue;
+            }
             ESP_LOGV("EventSocket", "Emitting event: %s to %s, Message[%d]: %s", event, client->remoteIP().toString().c_str(), len, output);
 #if FT_ENABLED(EVENT_USE_JSON)
             client->sendMessage(HTTPD_WS_TYPE_TEXT, output, len);
@@ -225,6 +239,19 @@ bool EventSocket::isEventValid(String event)
     return std::find(events.begin(), events.end(), event) != events.end();
 }
 
+bool EventSocket::isClientAllowed(const String &event, int socket, bool write)
+{
+    auto predicates = event_predicates.find(event);
+    if (predicates == event_predicates.end())
+    {
+        return false;
+    }
+
+    // cached per connection, this runs for every subscriber of every emitted event
+    Authentication authentication = _securityManager->authenticateClient(socket);
+    return write ? predicates->second.write(authentication) : predicates->second.read(authentication);
+}
+
 unsigned int EventSocket::getConnectedClients()
 {
     return (unsigned int)_socket.getClientList().size();
@@ -27,6 +27,13 @@
 typedef std::function<void(JsonObject &root, int originId)> EventCallback;
 typedef std::function<void(const String &originId)> SubscribeCallback;
 
+// who may subscribe to an event and who may send it
+struct EventPredicates
+{
+  AuthenticationPredicate read;
+  AuthenticationPredicate write;
+};
+
 class EventSocket
 {
 public:
@@ -34,7 +41,9 @@ public:
 
   void begin();
 
-  void registerEvent(String event);
+  void registerEvent(String event,
+                     AuthenticationPredicate readPredicate = AuthenticationPredicates::IS_AUTHENTICATED,
+                     AuthenticationPredicate writePredicate = AuthenticationPredicates::IS_AUTHENTICATED);
 
   void onEvent(String event, EventCallback callback);
 
@@ -52,6 +61,7 @@ private:
   AuthenticationPredicate _authenticationPredicate;
 
   std::vector<String> events;
+  std::map<String, EventPredicates> event_predicates;
   std::map<String, std::list<int>> client_subscriptions;
   std::map<String, std::list<EventCallback>> event_callbacks;
   std::map<String, std::list<SubscribeCallback>> subscribe_callbacks;
@@ -59,6 +69,7 @@ private:
   void handleSubscribeCallbacks(String event, const String &originId);
 
   bool isEventValid(String event);
+  bool isClientAllowed(const String &event, int socket, bool write);
 
   void onWSOpen(PsychicWebSocketClient *client);
   void onWSClose(PsychicWebSocketClient *client);
@@ -16,6 +16,8 @@
  **/
 
 #include <StatefulService.h>
+#include <PersistenceScheduler.h>
+#include <SettingsStore.h>
 #include <FS.h>
 
 template <class T>
@@ -26,32 +28,42 @@ public:
                   JsonStateUpdater<T> stateUpdater,
                   StatefulService<T> *statefulService,
                   FS *fs,
-                  const char *filePath) : _stateReader(stateReader),
-                                          _stateUpdater(stateUpdater),
-                                          _statefulService(statefulService),
-                                          _fs(fs),
-                                          _filePath(filePath),
-                                          _updateHandlerId(0)
+                  const char *filePath,
+                  SettingsFormat format = SettingsFormat::JSON) : _stateReader(stateReader),
+                                                                  _stateUpdater(stateUpdater),
+                                                                  _statefulService(statefulService),
+                                                                  _fs(fs),
+                                                                  _store(SettingsStore::get(fs)),
+                                                                  _filePath(filePath),
+                                                                  _format(format),
+                                                                  _updateHandlerId(0),
+                                                                  _directoriesCreated(false)
     {
+        _persistenceId = PersistenceScheduler::add([this]()
+                                                   { return writeToFS(); });
         enableUpdateHandler();
     }
 
-    void readFromFS()
+    ~FSPersistence()
     {
-        File settingsFile = _fs->open(_filePath, "r");
+        disableUpdateHandler();
+        PersistenceScheduler::remove(_persistenceId);
+    }
 
-        if (settingsFile)
+    void readFromFS()
+    {
+        // recovered settings (from a backup or a migration) are written back to their regular place
+        JsonDocument jsonDocument;
+        bool recovered = false;
+        if (_store->read(_filePath, jsonDocument, &recovered, _format))
         {
-            JsonDocument jsonDocument;
-            DeserializationError error = deserializeJson(jsonDocument, settingsFile);
-            if (error == DeserializationError::Ok && jsonDocument.is<JsonObject>())
+            JsonObject jsonObject = jsonDocument.as<JsonObject>();
+            _statefulService->updateWithoutPropagation(jsonObject, _stateUpdater);
+            if (recovered)
             {
-                JsonObject jsonObject = jsonDocument.as<JsonObject>();
-                _statefulService->updateWithoutPropagation(jsonObject, _stateUpdater);
-                settingsFile.close();
-                return;
+                writeToFS();
             }
-            settingsFile.close();
+            return;
         }
 
         // If we reach here we have not been successful in loading the config and hard-coded defaults are now applied.
@@ -68,22 +80,14 @@ public:
         JsonObject jsonObject = jsonDocument.to<JsonObject>();
         _statefulService->read(jsonObject, _stateReader);
 
-        // make directories if required
-        mkdirs();
-
-        // serialize it to filesystem
-        File settingsFile = _fs->open(_filePath, "w");
-
-        // failed to open file, return false
-        if (!settingsFile)
+        // make directories if required, they stay once they exist
+        if (!_directoriesCreated)
         {
-            return false;
+            mkdirs();
+            _directoriesCreated = true;
         }
 
-        // serialize the data to the file
-        serializeJson(jsonDocument, settingsFile);
-        settingsFile.close();
-        return true;
+        return _store->write(_filePath, jsonDocument, _format);
     }
 
     void disableUpdateHandler()
@@ -99,8 +103,9 @@ public:
     {
         if (!_updateHandlerId)
         {
+            // the write is deferred and coalesced by the PersistenceScheduler
             _updateHandlerId = _statefulService->addUpdateHandler([&](const String &originId)
-                                                                  { writeToFS(); });
+                                                                  { PersistenceScheduler::markDirty(_persistenceId); });
         }
     }
 
@@ -109,8 +114,12 @@ private:
     JsonStateUpdater<T> _stateUpdater;
     StatefulService<T> *_statefulService;
     FS *_fs;
+    SettingsStore *_store;
     const char *_filePath;
+    SettingsFormat _format;
     update_handler_id_t _updateHandlerId;
+    persistence_id_t _persistenceId;
+    bool _directoriesCreated;
 
     // We assume we have a _filePath with format "/directory1/directory2/filename"
     // We create a directory for each missing parent
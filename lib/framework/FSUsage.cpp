@@ -0,0 +1,117 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <FSUsage.h>
+
+// writers report from any task, the counters are only touched inside the critical section
+static portMUX_TYPE usageMux = portMUX_INITIALIZER_UNLOCKED;
+static int32_t usedBytes = 0;
+static size_t totalBytes = 0;
+static bool dirty = false;
+static unsigned long firstChange = 0;
+static unsigned long lastChange = 0;
+
+static int32_t blocks(size_t size)
+{
+    return (size + FS_USAGE_BLOCK_SIZE - 1) / FS_USAGE_BLOCK_SIZE;
+}
+
+static void markDirty()
+{
+    unsigned long now = millis();
+    portENTER_CRITICAL(&usageMux);
+    if (!dirty)
+    {
+        dirty = true;
+        firstChange = now;
+    }
+    lastChange = now;
+    portEXIT_CRITICAL(&usageMux);
+}
+
+static void recount()
+{
+    unsigned long start = millis();
+    size_t counted = ESPFS.usedBytes();
+
+    portENTER_CRITICAL(&usageMux);
+    usedBytes = counted;
+    portEXIT_CRITICAL(&usageMux);
+
+    ESP_LOGD("FSUsage", "%u of %u bytes used, counted in %lu ms", counted, totalBytes, millis() - start);
+}
+
+void FSUsage::begin()
+{
+    totalBytes = ESPFS.totalBytes();
+    recount();
+}
+
+void FSUsage::loop()
+{
+    unsigned long now = millis();
+    portENTER_CRITICAL(&usageMux);
+    bool due = dirty && (now - lastChange >= FS_USAGE_QUIET_PERIOD_MS || now - firstChange >= FS_USAGE_MAX_DELAY_MS);
+    if (due)
+    {
+        dirty = false;
+    }
+    portEXIT_CRITICAL(&usageMux);
+
+    if (due)
+    {
+        recount();
+    }
+}
+
+size_t FSUsage::used()
+{
+    portENTER_CRITICAL(&usageMux);
+    int32_t used = usedBytes;
+    portEXIT_CRITICAL(&usageMux);
+    return used > 0 ? min((size_t)used, totalBytes) : 0;
+}
+
+size_t FSUsage::total()
+{
+    return totalBytes;
+}
+
+size_t FSUsage::budget(uint8_t share)
+{
+    return (uint64_t)totalBytes * FS_LOG_BUDGET_PERCENT * share / 10000;
+}
+
+void FSUsage::fileResized(FS *fs, size_t oldSize, size_t newSize)
+{
+    if (fs != &ESPFS)
+    {
+        return;
+    }
+
+    int32_t delta = (blocks(newSize) - blocks(oldSize)) * FS_USAGE_BLOCK_SIZE;
+    portENTER_CRITICAL(&usageMux);
+    usedBytes += delta;
+    portEXIT_CRITICAL(&usageMux);
+
+    // block counts are an estimate, metadata and copy-on-write are not accounted for
+    markDirty();
+}
+
+void FSUsage::invalidate(FS *fs)
+{
+    if (fs == &ESPFS)
+    {
+        markDirty();
+    }
+}
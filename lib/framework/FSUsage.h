@@ -0,0 +1,66 @@
+#ifndef FSUsage_h
+#define FSUsage_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <ESPFS.h>
+
+/*
+ * Cached file system usage. LittleFS counts used blocks by walking the whole allocator, which gets
+ * slower the fuller the file system is. The count is taken once at boot, writers report the size of
+ * the files they change and the estimate is corrected by a recount in the loop task once the file
+ * system has been quiet for FS_USAGE_QUIET_PERIOD_MS, or at the latest FS_USAGE_MAX_DELAY_MS after
+ * the first change.
+ *
+ * Logs and histories share FS_LOG_BUDGET_PERCENT of the file system, the rest is left for settings
+ * and certificates. Each log claims a share of that budget with budget().
+ */
+
+#ifndef FS_USAGE_BLOCK_SIZE
+#define FS_USAGE_BLOCK_SIZE 4096
+#endif
+
+#ifndef FS_USAGE_QUIET_PERIOD_MS
+#define FS_USAGE_QUIET_PERIOD_MS 30000
+#endif
+
+#ifndef FS_USAGE_MAX_DELAY_MS
+#define FS_USAGE_MAX_DELAY_MS 600000
+#endif
+
+#ifndef FS_LOG_BUDGET_PERCENT
+#define FS_LOG_BUDGET_PERCENT 50
+#endif
+
+namespace FSUsage
+{
+    // counts once, the file system has to be mounted
+    void begin();
+    // recounts if due, called from the loop task
+    void loop();
+
+    size_t used();
+    size_t total();
+    // bytes for a log with share percent of the log budget, valid after begin()
+    size_t budget(uint8_t share);
+
+    // a file changed from oldSize to newSize bytes, 0 for created or removed files. Changes on other
+    // file systems than ESPFS are ignored.
+    void fileResized(FS *fs, size_t oldSize, size_t newSize);
+    // something changed by an unknown amount
+    void invalidate(FS *fs);
+}
+
+#endif // end FSUsage_h
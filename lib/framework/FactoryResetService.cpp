@@ -46,6 +46,13 @@ esp_err_t FactoryResetService::handleRequest(PsychicRequest *request)
  */
 void FactoryResetService::factoryReset()
 {
+    // pending writes would bring the deleted settings back
+    PersistenceScheduler::discard();
+
+#ifdef SETTINGS_STORE_NVS
+    static_cast<NVSSettingsStore *>(SettingsStore::get(fs))->erase();
+#endif
+
     File root = fs->open(FS_CONFIG_DIRECTORY);
     File file;
     while (file = root.openNextFile())
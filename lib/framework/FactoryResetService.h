@@ -20,6 +20,8 @@
 #include <PsychicHttp.h>
 #include <SecurityManager.h>
 #include <RestartService.h>
+#include <PersistenceScheduler.h>
+#include <SettingsStore.h>
 #include <FS.h>
 
 #define FS_CONFIG_DIRECTORY "/config"
@@ -22,6 +22,7 @@ protected:
     StatefulService<T> *_statefulService;
     SecurityManager *_securityManager;
     AuthenticationPredicate _authenticationPredicate;
+    AuthenticationPredicate _readPredicate;
     PsychicHttpServer *_server;
     const char *_servicePath;
 
@@ -32,13 +33,33 @@ public:
                  PsychicHttpServer *server,
                  const char *servicePath,
                  SecurityManager *securityManager,
-                 AuthenticationPredicate authenticationPredicate = AuthenticationPredicates::IS_ADMIN) : _stateReader(stateReader),
-                                                                                                         _stateUpdater(stateUpdater),
-                                                                                                         _statefulService(statefulService),
-                                                                                                         _server(server),
-                                                                                                         _servicePath(servicePath),
-                                                                                                         _securityManager(securityManager),
-                                                                                                         _authenticationPredicate(authenticationPredicate)
+                 AuthenticationPredicate authenticationPredicate = AuthenticationPredicates::IS_ADMIN) : HttpEndpoint(stateReader,
+                                                                                                                      stateUpdater,
+                                                                                                                      statefulService,
+                                                                                                                      server,
+                                                                                                                      servicePath,
+                                                                                                                      securityManager,
+                                                                                                                      authenticationPredicate,
+                                                                                                                      authenticationPredicate)
+    {
+    }
+
+    // reading the state (GET) can be allowed for more users than changing it (POST)
+    HttpEndpoint(JsonStateReader<T> stateReader,
+                 JsonStateUpdater<T> stateUpdater,
+                 StatefulService<T> *statefulService,
+                 PsychicHttpServer *server,
+                 const char *servicePath,
+                 SecurityManager *securityManager,
+                 AuthenticationPredicate authenticationPredicate,
+                 AuthenticationPredicate readPredicate) : _stateReader(stateReader),
+                                                          _stateUpdater(stateUpdater),
+                                                          _statefulService(statefulService),
+                                                          _securityManager(securityManager),
+                                                          _authenticationPredicate(authenticationPredicate),
+                                                          _readPredicate(readPredicate),
+                                                          _server(server),
+                                                          _servicePath(servicePath)
     {
     }
 
@@ -69,7 +90,7 @@ public:
                             _statefulService->read(jsonObject, _stateReader);
                             return response.send();
                         },
-                        _authenticationPredicate));
+                        _readPredicate));
         ESP_LOGV("HttpEndpoint", "Registered GET endpoint: %s", _servicePath);
 
         // POST
@@ -0,0 +1,88 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <JWTCache.h>
+
+JWTCache::JWTCache() : _clock(0),
+                       _generation(0),
+                       _mutex(xSemaphoreCreateMutex())
+{
+}
+
+JWTCache::~JWTCache()
+{
+    vSemaphoreDelete(_mutex);
+}
+
+uint32_t JWTCache::hash(const String &jwt)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = jwt.c_str(); *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+bool JWTCache::lookup(const String &jwt, uint32_t hash, Authentication &authentication)
+{
+    bool found = false;
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    for (Entry &entry : _entries)
+    {
+        if (entry.hash == hash && entry.token.length() && entry.token == jwt)
+        {
+            entry.lastUsed = ++_clock;
+            authentication = entry.authentication;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_mutex);
+    return found;
+}
+
+void JWTCache::store(const String &jwt, uint32_t hash, uint32_t generation, const Authentication &authentication)
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (generation == _generation)
+    {
+        // replace the least recently used entry, empty ones have never been used
+        Entry *oldest = &_entries[0];
+        for (Entry &entry : _entries)
+        {
+            if (entry.lastUsed < oldest->lastUsed)
+            {
+                oldest = &entry;
+            }
+        }
+        oldest->hash = hash;
+        oldest->lastUsed = ++_clock;
+        oldest->token = jwt;
+        oldest->authentication = authentication;
+    }
+    xSemaphoreGive(_mutex);
+}
+
+void JWTCache::clear()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    for (Entry &entry : _entries)
+    {
+        entry.hash = 0;
+        entry.lastUsed = 0;
+        entry.token = String();
+    }
+    _generation++;
+    xSemaphoreGive(_mutex);
+}
@@ -0,0 +1,62 @@
+#ifndef JWTCache_h
+#define JWTCache_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <SecurityManager.h>
+
+// Number of verified tokens remembered, saves the HMAC and JSON parsing for repeated requests
+#ifndef JWT_CACHE_SIZE
+#define JWT_CACHE_SIZE 8
+#endif
+
+/*
+ * Tokens that were verified before, with the authentication they resolved to. Full entries are
+ * replaced least recently used first. The generation is bumped by clear(), a result that was
+ * verified before the last clear() is not stored.
+ */
+class JWTCache
+{
+public:
+    JWTCache();
+    ~JWTCache();
+
+    // FNV-1a of the token, only used to skip full compares
+    static uint32_t hash(const String &jwt);
+
+    // read before verifying a token, and passed to store() with its result
+    uint32_t generation() { return _generation; }
+
+    bool lookup(const String &jwt, uint32_t hash, Authentication &authentication);
+    void store(const String &jwt, uint32_t hash, uint32_t generation, const Authentication &authentication);
+
+    // forgets all tokens, after the secret or the users changed
+    void clear();
+
+private:
+    struct Entry
+    {
+        uint32_t hash = 0;
+        uint32_t lastUsed = 0;
+        String token;
+        Authentication authentication;
+    };
+
+    Entry _entries[JWT_CACHE_SIZE];
+    uint32_t _clock;
+    uint32_t _generation;
+    SemaphoreHandle_t _mutex;
+};
+
+#endif // end JWTCache_h
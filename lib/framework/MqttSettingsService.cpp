@@ -42,7 +42,7 @@ MqttSettingsService::MqttSettingsService(PsychicHttpServer *server,
                                          FS *fs,
                                          SecurityManager *securityManager) : _server(server),
                                                                              _securityManager(securityManager),
-                                                                             _httpEndpoint(MqttSettings::read, MqttSettings::update, this, server, MQTT_SETTINGS_SERVICE_PATH, securityManager),
+                                                                             _httpEndpoint(MqttSettings::read, MqttSettings::update, this, server, MQTT_SETTINGS_SERVICE_PATH, securityManager, AuthenticationPredicates::CAN_CHANGE_SETTINGS),
                                                                              _fsPersistence(MqttSettings::read, MqttSettings::update, this, fs, MQTT_SETTINGS_FILE),
                                                                              _retainedHost(nullptr),
                                                                              _retainedClientId(nullptr),
@@ -123,6 +123,9 @@ void MqttSettingsService::onMqttConnect(bool sessionPresent)
     Serial.printf("Connected to MQTT: %s\n", _mqttClient.getMqttConfig()->uri);
 #endif
     _lastError = "None";
+    _brokerConnected = true;
+    _loggedErrno = 0;
+    EventLog::log(EventType::MQTT_CONNECTED);
 }
 
 void MqttSettingsService::onMqttDisconnect(bool sessionPresent)
@@ -131,6 +134,12 @@ void MqttSettingsService::onMqttDisconnect(bool sessionPresent)
 #ifdef SERIAL_INFO
     Serial.println("Disconnected from MQTT.");
 #endif
+    // failed connection attempts are not worth a record each
+    if (_brokerConnected)
+    {
+        _brokerConnected = false;
+        EventLog::log(EventType::MQTT_DISCONNECTED);
+    }
 }
 
 void MqttSettingsService::onMqttError(esp_mqtt_error_codes_t error)
@@ -139,6 +148,11 @@ void MqttSettingsService::onMqttError(esp_mqtt_error_codes_t error)
     {
         _lastError = strerror(error.esp_transport_sock_errno);
         ESP_LOGE("MQTT", "MQTT TCP error: %s", _lastError.c_str());
+        if (error.esp_transport_sock_errno != _loggedErrno)
+        {
+            _loggedErrno = error.esp_transport_sock_errno;
+            EventLog::log(EventType::MQTT_ERROR, 0, _loggedErrno);
+        }
     }
 }
 
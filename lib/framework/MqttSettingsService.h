@@ -20,6 +20,7 @@
 #include <FSPersistence.h>
 #include <PsychicMqttClient.h>
 #include <SettingValue.h>
+#include <EventLog.h>
 #include <WiFi.h>
 
 #ifndef FACTORY_MQTT_ENABLED
@@ -138,6 +139,8 @@ private:
     // variable to help manage connection
     bool _reconfigureMqtt;
     String _lastError;
+    bool _brokerConnected = false;
+    int _loggedErrno = 0;
 
     // the MQTT client instance
     PsychicMqttClient _mqttClient;
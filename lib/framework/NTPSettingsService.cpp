@@ -18,7 +18,7 @@ NTPSettingsService::NTPSettingsService(PsychicHttpServer *server,
                                        FS *fs,
                                        SecurityManager *securityManager) : _server(server),
                                                                            _securityManager(securityManager),
-                                                                           _httpEndpoint(NTPSettings::read, NTPSettings::update, this, server, NTP_SETTINGS_SERVICE_PATH, securityManager),
+                                                                           _httpEndpoint(NTPSettings::read, NTPSettings::update, this, server, NTP_SETTINGS_SERVICE_PATH, securityManager, AuthenticationPredicates::CAN_CHANGE_SETTINGS),
                                                                            _fsPersistence(NTPSettings::read, NTPSettings::update, this, fs, NTP_SETTINGS_FILE)
 {
     addUpdateHandler([&](const String &originId)
@@ -39,7 +39,7 @@ void NTPSettingsService::begin()
                 HTTP_POST,
                 _securityManager->wrapCallback(
                     std::bind(&NTPSettingsService::configureTime, this, std::placeholders::_1, std::placeholders::_2),
-                    AuthenticationPredicates::IS_ADMIN));
+                    AuthenticationPredicates::CAN_CHANGE_SETTINGS));
 
     ESP_LOGV("NTPSettingsService", "Registered POST endpoint: %s", TIME_PATH);
 
@@ -0,0 +1,122 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <PasswordHash.h>
+#include <esp_random.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pkcs5.h>
+
+namespace PasswordHash
+{
+    static bool deriveKey(const String &password, const uint8_t *salt, uint32_t iterations, uint8_t *key)
+    {
+        mbedtls_md_context_t ctx;
+        mbedtls_md_init(&ctx);
+        bool ok = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) == 0 &&
+                  mbedtls_pkcs5_pbkdf2_hmac(&ctx, (const unsigned char *)password.c_str(), password.length(),
+                                            salt, PASSWORD_SALT_SIZE, iterations, PASSWORD_KEY_SIZE, key) == 0;
+        mbedtls_md_free(&ctx);
+        return ok;
+    }
+
+    static void toHex(const uint8_t *data, size_t len, char *hex)
+    {
+        static const char digits[] = "0123456789abcdef";
+        for (size_t i = 0; i < len; i++)
+        {
+            hex[2 * i] = digits[data[i] >> 4];
+            hex[2 * i + 1] = digits[data[i] & 0x0F];
+        }
+        hex[2 * len] = '\0';
+    }
+
+    static bool fromHex(const char *hex, size_t len, uint8_t *data)
+    {
+        for (size_t i = 0; i < 2 * len; i++)
+        {
+            char c = hex[i];
+            uint8_t value;
+            if (c >= '0' && c <= '9')
+                value = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value = c - 'a' + 10;
+            else
+                return false;
+            data[i / 2] = (i % 2) ? (data[i / 2] | value) : (value << 4);
+        }
+        return true;
+    }
+
+    String hash(const String &password)
+    {
+        uint8_t salt[PASSWORD_SALT_SIZE];
+        uint8_t key[PASSWORD_KEY_SIZE];
+        esp_fill_random(salt, sizeof(salt));
+        if (!deriveKey(password, salt, PASSWORD_HASH_ITERATIONS, key))
+        {
+            return "";
+        }
+
+        char saltHex[2 * PASSWORD_SALT_SIZE + 1];
+        char keyHex[2 * PASSWORD_KEY_SIZE + 1];
+        toHex(salt, sizeof(salt), saltHex);
+        toHex(key, sizeof(key), keyHex);
+        return String(PASSWORD_HASH_PREFIX) + PASSWORD_HASH_ITERATIONS + '$' + saltHex + '$' + keyHex;
+    }
+
+    bool verify(const String &password, const String &hash)
+    {
+        uint8_t salt[PASSWORD_SALT_SIZE] = {0};
+        uint8_t expected[PASSWORD_KEY_SIZE] = {0};
+        uint32_t iterations = PASSWORD_HASH_ITERATIONS;
+        bool valid = false;
+
+        // pbkdf2-sha256$<iterations>$<salt>$<key>
+        if (isHash(hash))
+        {
+            const char *pos = hash.c_str() + strlen(PASSWORD_HASH_PREFIX);
+            char *end;
+            // strtoul would also take blanks and signs, and wraps negative counts around
+            unsigned long count = isdigit((unsigned char)*pos) ? strtoul(pos, &end, 10) : 0;
+            iterations = count;
+            valid = count > 0 && count <= PASSWORD_HASH_MAX_ITERATIONS && *end == '$' &&
+                    strlen(end + 1) == 2 * PASSWORD_SALT_SIZE + 1 + 2 * PASSWORD_KEY_SIZE &&
+                    end[1 + 2 * PASSWORD_SALT_SIZE] == '$' &&
+                    fromHex(end + 1, PASSWORD_SALT_SIZE, salt) &&
+                    fromHex(end + 2 + 2 * PASSWORD_SALT_SIZE, PASSWORD_KEY_SIZE, expected);
+        }
+        if (!valid)
+        {
+            // still do the work, so a broken entry takes as long as a wrong password
+            iterations = PASSWORD_HASH_ITERATIONS;
+        }
+
+        uint8_t key[PASSWORD_KEY_SIZE];
+        if (!deriveKey(password, salt, iterations, key))
+        {
+            return false;
+        }
+
+        uint8_t diff = 0;
+        for (size_t i = 0; i < PASSWORD_KEY_SIZE; i++)
+        {
+            diff |= key[i] ^ expected[i];
+        }
+        return valid && diff == 0;
+    }
+
+    bool isHash(const String &value)
+    {
+        return value.startsWith(PASSWORD_HASH_PREFIX);
+    }
+};
@@ -0,0 +1,47 @@
+#ifndef PasswordHash_h
+#define PasswordHash_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+
+// PBKDF2-HMAC-SHA256 rounds for new hashes, about 60 ms per login on an ESP32-C3.
+// Stored hashes carry their own count, so raising it later keeps old passwords working.
+#ifndef PASSWORD_HASH_ITERATIONS
+#define PASSWORD_HASH_ITERATIONS 1000
+#endif
+
+// stored counts above this are rejected, a tampered settings file must not stall logins
+#define PASSWORD_HASH_MAX_ITERATIONS 100000
+
+#define PASSWORD_HASH_PREFIX "pbkdf2-sha256$"
+#define PASSWORD_SALT_SIZE 16
+#define PASSWORD_KEY_SIZE 32
+
+namespace PasswordHash
+{
+    /*
+     * pbkdf2-sha256$<iterations>$<salt hex>$<key hex> with a random salt
+     */
+    String hash(const String &password);
+
+    /*
+     * Checks a password against a stored hash, the keys are compared in constant time
+     */
+    bool verify(const String &password, const String &hash);
+
+    bool isHash(const String &value);
+};
+
+#endif // end PasswordHash_h
@@ -0,0 +1,283 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <PersistenceScheduler.h>
+#include <vector>
+
+#define NOTHING_PENDING UINT32_MAX
+
+struct PersistenceEntry
+{
+    persistence_id_t id;
+    PersistenceWriter writer;
+    uint32_t quietPeriod;
+    uint32_t maxDelay;
+    bool counted;
+    bool dirty;
+    unsigned long firstChange;
+    unsigned long lastChange;
+};
+
+static std::vector<PersistenceEntry> entries;
+static persistence_id_t nextId = 1;
+static bool discarded = false;
+static uint32_t changeCount = 0;
+static uint32_t writeCount = 0;
+
+// stateMutex guards the entries, writeMutex keeps the task and flush() from writing at the same time.
+// Writers read their service state, so they are never called with stateMutex held.
+static SemaphoreHandle_t stateMutex = nullptr;
+static SemaphoreHandle_t writeMutex = nullptr;
+static TaskHandle_t taskHandle = nullptr;
+
+static void persistenceTask(void *pvParameters);
+
+static void createMutexes()
+{
+    if (stateMutex == nullptr)
+    {
+        stateMutex = xSemaphoreCreateMutex();
+        writeMutex = xSemaphoreCreateMutex();
+    }
+}
+
+static PersistenceEntry *findEntry(persistence_id_t id)
+{
+    for (PersistenceEntry &entry : entries)
+    {
+        if (entry.id == id)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Writes all dirty entries that are due, or all of them if forced. Returns the time in ms until the
+ * next entry becomes due, NOTHING_PENDING if nothing is left.
+ */
+static uint32_t writeDue(bool force, bool *failed)
+{
+    struct DueWrite
+    {
+        persistence_id_t id;
+        PersistenceWriter writer;
+        bool counted;
+    };
+    std::vector<DueWrite> due;
+    uint32_t wait = NOTHING_PENDING;
+
+    xSemaphoreTake(writeMutex, portMAX_DELAY);
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    unsigned long now = millis();
+    for (PersistenceEntry &entry : entries)
+    {
+        if (!entry.dirty)
+        {
+            continue;
+        }
+        unsigned long quiet = now - entry.lastChange;
+        unsigned long pending = now - entry.firstChange;
+        if (force || quiet >= entry.quietPeriod || pending >= entry.maxDelay)
+        {
+            entry.dirty = false;
+            due.push_back({entry.id, entry.writer, entry.counted});
+        }
+        else
+        {
+            wait = min(wait, (uint32_t)min(entry.quietPeriod - quiet, entry.maxDelay - pending));
+        }
+    }
+    xSemaphoreGive(stateMutex);
+
+    for (DueWrite &write : due)
+    {
+        if (write.writer())
+        {
+            if (write.counted)
+            {
+                writeCount++;
+            }
+            continue;
+        }
+
+        // keep it dirty and try again after the next quiet period
+        ESP_LOGE("PersistenceScheduler", "Writing settings failed, retrying");
+        if (failed != nullptr)
+        {
+            *failed = true;
+        }
+        xSemaphoreTake(stateMutex, portMAX_DELAY);
+        PersistenceEntry *entry = findEntry(write.id);
+        if (entry != nullptr && !discarded)
+        {
+            if (!entry->dirty)
+            {
+                entry->dirty = true;
+                entry->firstChange = millis();
+            }
+            entry->lastChange = millis();
+            wait = min(wait, entry->quietPeriod);
+        }
+        xSemaphoreGive(stateMutex);
+    }
+
+    xSemaphoreGive(writeMutex);
+
+    if (!due.empty())
+    {
+        ESP_LOGD("PersistenceScheduler", "%u changes saved with %u writes", changeCount, writeCount);
+    }
+    return wait;
+}
+
+static void persistenceTask(void *pvParameters)
+{
+    TickType_t wait = portMAX_DELAY;
+    while (true)
+    {
+        // woken by every change, sleeps until the next entry is due otherwise
+        ulTaskNotifyTake(pdTRUE, wait);
+        uint32_t next = writeDue(false, nullptr);
+        wait = next == NOTHING_PENDING ? portMAX_DELAY : pdMS_TO_TICKS(next) + 1;
+    }
+}
+
+persistence_id_t PersistenceScheduler::add(PersistenceWriter writer, uint32_t quietPeriod, uint32_t maxDelay, bool counted)
+{
+    createMutexes();
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    persistence_id_t id = nextId++;
+    entries.push_back({id, writer, quietPeriod, maxDelay, counted, false, 0, 0});
+    xSemaphoreGive(stateMutex);
+
+    return id;
+}
+
+void PersistenceScheduler::remove(persistence_id_t id)
+{
+    if (stateMutex == nullptr)
+    {
+        return;
+    }
+
+    // wait for a running write, the writer may belong to an object that is about to go away
+    xSemaphoreTake(writeMutex, portMAX_DELAY);
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    for (auto i = entries.begin(); i != entries.end(); ++i)
+    {
+        if (i->id == id)
+        {
+            entries.erase(i);
+            break;
+        }
+    }
+    xSemaphoreGive(stateMutex);
+    xSemaphoreGive(writeMutex);
+}
+
+void PersistenceScheduler::markDirty(persistence_id_t id)
+{
+    if (stateMutex == nullptr)
+    {
+        return;
+    }
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    PersistenceEntry *entry = findEntry(id);
+    if (entry == nullptr || discarded)
+    {
+        xSemaphoreGive(stateMutex);
+        return;
+    }
+
+    unsigned long now = millis();
+    if (!entry->dirty)
+    {
+        entry->dirty = true;
+        entry->firstChange = now;
+    }
+    entry->lastChange = now;
+    if (entry->counted)
+    {
+        changeCount++;
+    }
+
+    // the task is started with the first change, the scheduler is not running yet when services are constructed
+    if (taskHandle == nullptr &&
+        xTaskCreate(persistenceTask, "Persistence", PERSISTENCE_TASK_STACK_SIZE, nullptr, tskIDLE_PRIORITY + 1, &taskHandle) != pdPASS)
+    {
+        taskHandle = nullptr;
+    }
+    TaskHandle_t task = taskHandle;
+    xSemaphoreGive(stateMutex);
+
+    if (task != nullptr)
+    {
+        xTaskNotifyGive(task);
+    }
+    else
+    {
+        ESP_LOGE("PersistenceScheduler", "Could not start persistence task, writing right away");
+        flush();
+    }
+}
+
+bool PersistenceScheduler::flush()
+{
+    if (stateMutex == nullptr)
+    {
+        return true;
+    }
+
+    bool failed = false;
+    writeDue(true, &failed);
+    return !failed;
+}
+
+void PersistenceScheduler::discard()
+{
+    if (stateMutex == nullptr)
+    {
+        return;
+    }
+
+    // a write in progress finishes first, so nothing is written after the files are gone
+    xSemaphoreTake(writeMutex, portMAX_DELAY);
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    discarded = true;
+    for (PersistenceEntry &entry : entries)
+    {
+        entry.dirty = false;
+    }
+    xSemaphoreGive(stateMutex);
+    xSemaphoreGive(writeMutex);
+}
+
+uint32_t PersistenceScheduler::changes()
+{
+    return changeCount;
+}
+
+uint32_t PersistenceScheduler::writes()
+{
+    return writeCount;
+}
+
+uint32_t PersistenceScheduler::writesAvoided()
+{
+    return changeCount > writeCount ? changeCount - writeCount : 0;
+}
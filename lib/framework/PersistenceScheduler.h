@@ -0,0 +1,68 @@
+#ifndef PersistenceScheduler_h
+#define PersistenceScheduler_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <functional>
+
+/*
+ * Write-behind for persisted settings.
+ *
+ * A change only marks its writer dirty. A background task calls the writer once the state has been
+ * quiet for PERSISTENCE_QUIET_PERIOD_MS, or at the latest PERSISTENCE_MAX_DELAY_MS after the first
+ * unsaved change. A burst of changes therefore ends up as a single write. flush() writes everything
+ * pending right away and has to be called before the device restarts, sleeps or flashes a new firmware.
+ */
+
+#ifndef PERSISTENCE_QUIET_PERIOD_MS
+#define PERSISTENCE_QUIET_PERIOD_MS 1000
+#endif
+
+#ifndef PERSISTENCE_MAX_DELAY_MS
+#define PERSISTENCE_MAX_DELAY_MS 10000
+#endif
+
+#ifndef PERSISTENCE_TASK_STACK_SIZE
+#define PERSISTENCE_TASK_STACK_SIZE 5120
+#endif
+
+typedef size_t persistence_id_t;
+typedef std::function<bool()> PersistenceWriter;
+
+namespace PersistenceScheduler
+{
+    // writers that are expensive to repeat (e.g. logs) can ask for longer delays. Logs grow with every
+    // append and are not counted, so changes() and writes() only tell about settings.
+    persistence_id_t add(PersistenceWriter writer,
+                         uint32_t quietPeriod = PERSISTENCE_QUIET_PERIOD_MS,
+                         uint32_t maxDelay = PERSISTENCE_MAX_DELAY_MS,
+                         bool counted = true);
+    void remove(persistence_id_t id);
+
+    // schedules a write, never blocks on the file system
+    void markDirty(persistence_id_t id);
+
+    // writes everything pending now, false if a write failed
+    bool flush();
+
+    // drops pending writes and ignores further changes until restart, used by the factory reset
+    void discard();
+
+    uint32_t changes();
+    uint32_t writes();
+    uint32_t writesAvoided();
+}
+
+#endif // end PersistenceScheduler_h
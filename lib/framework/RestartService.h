@@ -20,6 +20,8 @@
 #include <ESPmDNS.h>
 #include <PsychicHttp.h>
 #include <SecurityManager.h>
+#include <PersistenceScheduler.h>
+#include <EventLog.h>
 
 #define RESTART_SERVICE_PATH "/rest/restart"
 
@@ -32,16 +34,19 @@ public:
 
     static void restartNow()
     {
+        EventLog::log(EventType::RESTART);
         xTaskCreate(
             [](void *pvParams) {
                 delay(250);
+                PersistenceScheduler::flush();
+                EventLog::flush();
                 MDNS.end();
                 delay(100);
                 WiFi.disconnect(true);
                 delay(500);
                 ESP.restart();
             },
-            "Restart task", 4096, nullptr, 10, nullptr);
+            "Restart task", PERSISTENCE_TASK_STACK_SIZE, nullptr, 10, nullptr);
     }
 
 private:
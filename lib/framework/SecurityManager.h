@@ -22,59 +22,119 @@
 
 #define ACCESS_TOKEN_PARAMATER "access_token"
 
+// Longest access token accepted as query parameter, it is decoded into a stack buffer
+#ifndef ACCESS_TOKEN_MAX_LENGTH
+#define ACCESS_TOKEN_MAX_LENGTH 512
+#endif
+
 #define AUTHORIZATION_HEADER "Authorization"
 #define AUTHORIZATION_HEADER_PREFIX "Bearer "
 #define AUTHORIZATION_HEADER_PREFIX_LEN 7
 
+/*
+ * What a user may do, carried in the JWT so requests are checked with a single AND
+ */
+typedef uint8_t Permissions;
+
+#define PERMISSION_READ_RELAYS (1 << 0)
+#define PERMISSION_WRITE_RELAYS (1 << 1)
+#define PERMISSION_OTA (1 << 2)
+#define PERMISSION_SETTINGS (1 << 3)
+#define PERMISSION_ADMIN (1 << 6)
+#define PERMISSION_AUTHENTICATED (1 << 7)
+
+// the permissions that can be granted per user, admins have all of them
+#define PERMISSIONS_GRANTABLE (PERMISSION_READ_RELAYS | PERMISSION_WRITE_RELAYS | PERMISSION_OTA | PERMISSION_SETTINGS)
+// what users without explicit permissions get, same as before permissions existed
+#define PERMISSIONS_DEFAULT (PERMISSION_READ_RELAYS | PERMISSION_WRITE_RELAYS)
+
 class User
 {
 public:
     String username;
-    String password;
+    String password; // PBKDF2 hash, see PasswordHash
     bool admin;
+    Permissions permissions;
+    uint32_t usernameHash;
 
 public:
-    User(String username, String password, bool admin) : username(username), password(password), admin(admin)
+    User(String username, String password, bool admin, Permissions permissions = PERMISSIONS_DEFAULT) : username(username),
+                                                                                                         password(password),
+                                                                                                         admin(admin),
+                                                                                                         permissions(permissions & PERMISSIONS_GRANTABLE),
+                                                                                                         usernameHash(hashUsername(username))
     {
     }
+
+    // everything a request of this user is allowed to do
+    Permissions effectivePermissions() const
+    {
+        return PERMISSION_AUTHENTICATED | (admin ? PERMISSION_ADMIN | PERMISSIONS_GRANTABLE : permissions);
+    }
+
+    // FNV-1a, lets lookups skip most string compares
+    static uint32_t hashUsername(const String &username)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char *c = username.c_str(); *c; c++)
+        {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        return hash;
+    }
 };
 
+/*
+ * Result of authenticating a request, cheap to copy and return by value
+ */
 class Authentication
 {
 public:
-    User *user;
+    String username;
+    Permissions permissions;
     boolean authenticated;
 
 public:
-    Authentication(User &user) : user(new User(user)), authenticated(true)
+    Authentication(const User &user) : username(user.username), permissions(user.effectivePermissions()), authenticated(true)
     {
     }
-    Authentication() : user(nullptr), authenticated(false)
+    Authentication(const String &username, Permissions permissions) : username(username),
+                                                                      permissions(permissions),
+                                                                      authenticated(permissions & PERMISSION_AUTHENTICATED)
     {
     }
-    ~Authentication()
+    Authentication() : permissions(0), authenticated(false)
     {
-        delete (user);
     }
-};
 
-typedef std::function<boolean(Authentication &authentication)> AuthenticationPredicate;
+    bool admin() const { return permissions & PERMISSION_ADMIN; }
+};
 
-class AuthenticationPredicates
+/*
+ * Permissions a request needs, a request passes if it has all bits of the mask
+ */
+class AuthenticationPredicate
 {
 public:
-    static bool NONE_REQUIRED(Authentication &authentication)
-    {
-        return true;
-    };
-    static bool IS_AUTHENTICATED(Authentication &authentication)
-    {
-        return authentication.authenticated;
-    };
-    static bool IS_ADMIN(Authentication &authentication)
+    Permissions mask;
+
+    constexpr AuthenticationPredicate(Permissions mask) : mask(mask) {}
+
+    bool operator()(const Authentication &authentication) const
     {
-        return authentication.authenticated && authentication.user->admin;
-    };
+        return (authentication.permissions & mask) == mask;
+    }
+};
+
+namespace AuthenticationPredicates
+{
+    constexpr AuthenticationPredicate NONE_REQUIRED(0);
+    constexpr AuthenticationPredicate IS_AUTHENTICATED(PERMISSION_AUTHENTICATED);
+    constexpr AuthenticationPredicate IS_ADMIN(PERMISSION_AUTHENTICATED | PERMISSION_ADMIN);
+    constexpr AuthenticationPredicate CAN_READ_RELAYS(PERMISSION_AUTHENTICATED | PERMISSION_READ_RELAYS);
+    constexpr AuthenticationPredicate CAN_WRITE_RELAYS(PERMISSION_AUTHENTICATED | PERMISSION_WRITE_RELAYS);
+    constexpr AuthenticationPredicate CAN_UPDATE_FIRMWARE(PERMISSION_AUTHENTICATED | PERMISSION_OTA);
+    constexpr AuthenticationPredicate CAN_CHANGE_SETTINGS(PERMISSION_AUTHENTICATED | PERMISSION_SETTINGS);
 };
 
 class SecurityManager
@@ -87,9 +147,9 @@ public:
     virtual Authentication authenticate(const String &username, const String &password) = 0;
 
     /*
-     * Generate a JWT for the user provided
+     * Generate a JWT for the authenticated user
      */
-    virtual String generateJWT(User *user) = 0;
+    virtual String generateJWT(const Authentication &authentication) = 0;
 
 #endif
 
@@ -98,6 +158,13 @@ public:
      */
     virtual Authentication authenticateRequest(PsychicRequest *request) = 0;
 
+    /*
+     * Authentication of the websocket connection on the socket, taken from the token it was upgraded with.
+     * Cheap enough to call for every event and subscriber, the token is only verified again after the
+     * security settings changed.
+     */
+    virtual Authentication authenticateClient(int socket) = 0;
+
     /**
      * Filter a request with the provided predicate, only returning true if the predicate matches.
      */
@@ -16,10 +16,55 @@
 
 #if FT_ENABLED(FT_SECURITY)
 
+// tokens are built and parsed on the httpd stack, a larger JWT_MAX_PAYLOAD_SIZE needs a larger PSYCHIC_STACK_SIZE
+static_assert(JWT_MAX_LENGTH + JWT_MAX_PAYLOAD_SIZE <= PSYCHIC_STACK_SIZE / 4, "JWT buffers take too much of the httpd stack");
+static_assert(ACCESS_TOKEN_MAX_LENGTH <= PSYCHIC_STACK_SIZE / 4, "ACCESS_TOKEN_MAX_LENGTH takes too much of the httpd stack");
+
+// set when plaintext passwords from an older settings file were hashed on load
+static bool passwordsMigrated = false;
+
+static String storedPassword(const String &password)
+{
+    // hashes sent back unchanged by the UI are kept, anything else is a new password
+    if (PasswordHash::isHash(password))
+    {
+        return password;
+    }
+    return PasswordHash::hash(password);
+}
+
+StateUpdateResult SecuritySettings::update(JsonObject &root, SecuritySettings &settings)
+{
+    // secret
+    settings.jwtSecret = root["jwt_secret"] | SettingValue::format(FACTORY_JWT_SECRET);
+
+    // users
+    settings.users.clear();
+    if (root["users"].is<JsonArray>())
+    {
+        for (JsonVariant user : root["users"].as<JsonArray>())
+        {
+            String password = user["password"] | "";
+            if (!PasswordHash::isHash(password))
+            {
+                passwordsMigrated = true;
+            }
+            settings.users.push_back(User(user["username"], storedPassword(password), user["admin"], user["permissions"] | PERMISSIONS_DEFAULT));
+        }
+    }
+    else
+    {
+        settings.users.push_back(User(FACTORY_ADMIN_USERNAME, storedPassword(FACTORY_ADMIN_PASSWORD), true));
+        settings.users.push_back(User(FACTORY_GUEST_USERNAME, storedPassword(FACTORY_GUEST_PASSWORD), false));
+    }
+    return StateUpdateResult::CHANGED;
+}
+
 SecuritySettingsService::SecuritySettingsService(PsychicHttpServer *server, FS *fs) : _server(server),
                                                                                       _httpEndpoint(SecuritySettings::read, SecuritySettings::update, this, server, SECURITY_SETTINGS_PATH, this),
                                                                                       _fsPersistence(SecuritySettings::read, SecuritySettings::update, this, fs, SECURITY_SETTINGS_FILE),
-                                                                                      _jwtHandler(FACTORY_JWT_SECRET)
+                                                                                      _jwtHandler(FACTORY_JWT_SECRET),
+                                                                                      _connectionsMutex(xSemaphoreCreateMutex())
 {
     addUpdateHandler([&](const String &originId)
                      { configureJWTHandler(); },
@@ -36,28 +81,62 @@ void SecuritySettingsService::begin()
     ESP_LOGV("SecuritySettingsService", "Registered GET endpoint: %s", GENERATE_TOKEN_PATH);
 
     _httpEndpoint.begin();
+    passwordsMigrated = false;
     _fsPersistence.readFromFS();
+    if (passwordsMigrated)
+    {
+        ESP_LOGI("SecuritySettingsService", "Hashed plaintext passwords from the settings file");
+        _fsPersistence.writeToFS();
+    }
     configureJWTHandler();
 }
 
-Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *request)
+/*
+ * Owned by an upgraded websocket connection, drops its authentication when the connection closes.
+ * The authentication itself is kept by the service, so other tasks never touch the client's context.
+ */
+class WebSocketAuthentication : public PsychicClientContext
+{
+public:
+    WebSocketAuthentication(std::function<void()> onClose) : _onClose(onClose) {}
+    ~WebSocketAuthentication() { _onClose(); }
+
+private:
+    std::function<void()> _onClose;
+};
+
+bool SecuritySettingsService::extractToken(PsychicRequest *request, String &token)
 {
-    // Load the parameters from the request, as they are only loaded later with the regular handler
     if (request->hasHeader(AUTHORIZATION_HEADER))
     {
         auto value = request->header(AUTHORIZATION_HEADER);
         // ESP_LOGV("SecuritySettingsService", "Authorization header: %s", value.c_str());
         if (value.startsWith(AUTHORIZATION_HEADER_PREFIX))
         {
-            value = value.substring(AUTHORIZATION_HEADER_PREFIX_LEN);
-            return authenticateJWT(value);
+            token = value.substring(AUTHORIZATION_HEADER_PREFIX_LEN);
+            return true;
+        }
+    }
+    else
+    {
+        // decoded straight out of the query, websocket filters run this for every connection
+        char value[ACCESS_TOKEN_MAX_LENGTH];
+        if (request->getParam(ACCESS_TOKEN_PARAMATER, value, sizeof(value)))
+        {
+            // ESP_LOGV("SecuritySettingsService", "Access token parameter: %s", value);
+            token = value;
+            return true;
         }
     }
-    else if (request->hasParam(ACCESS_TOKEN_PARAMATER))
+    return false;
+}
+
+Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *request)
+{
+    String token;
+    if (extractToken(request, token))
     {
-        String value = request->getParam(ACCESS_TOKEN_PARAMATER)->value();
-        // ESP_LOGV("SecuritySettingsService", "Access token parameter: %s", value.c_str());
-        return authenticateJWT(value);
+        return authenticateJWT(token);
     }
     return Authentication();
 }
@@ -65,22 +144,36 @@ Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *requ
 void SecuritySettingsService::configureJWTHandler()
 {
     _jwtHandler.setSecret(_state.jwtSecret);
+
+    // new secret or changed users, the cached results are no longer valid
+    _jwtCache.clear();
 }
 
 Authentication SecuritySettingsService::authenticateJWT(String &jwt)
 {
+    uint32_t hash = JWTCache::hash(jwt);
+    Authentication cached;
+    if (_jwtCache.lookup(jwt, hash, cached))
+    {
+        return cached;
+    }
+
+    // a settings update while we verify must not leave a stale entry behind
+    uint32_t generation = _jwtCache.generation();
+
     JsonDocument payloadDocument;
     _jwtHandler.parseJWT(jwt, payloadDocument);
     if (payloadDocument.is<JsonObject>())
     {
         JsonObject parsedPayload = payloadDocument.as<JsonObject>();
         String username = parsedPayload["username"];
-        for (User _user : _state.users)
+        User *user = findUser(username);
+        if (user != nullptr && validatePayload(parsedPayload, user))
         {
-            if (_user.username == username && validatePayload(parsedPayload, &_user))
-            {
-                return Authentication(_user);
-            }
+            // only successful verifications are cached, so bad tokens can't push good ones out
+            Authentication authentication(*user);
+            _jwtCache.store(jwt, hash, generation, authentication);
+            return authentication;
         }
     }
     return Authentication();
@@ -88,35 +181,54 @@ Authentication SecuritySettingsService::authenticateJWT(String &jwt)
 
 Authentication SecuritySettingsService::authenticate(const String &username, const String &password)
 {
-    for (User _user : _state.users)
+    User *user = findUser(username);
+    if (user == nullptr)
+    {
+        // same work as for a wrong password, so the timing doesn't reveal valid usernames
+        PasswordHash::verify(password, "");
+        return Authentication();
+    }
+    if (PasswordHash::verify(password, user->password))
+    {
+        return Authentication(*user);
+    }
+    return Authentication();
+}
+
+User *SecuritySettingsService::findUser(const String &username)
+{
+    uint32_t hash = User::hashUsername(username);
+    for (User &user : _state.users)
     {
-        if (_user.username == username && _user.password == password)
+        if (user.usernameHash == hash && user.username == username)
         {
-            return Authentication(_user);
+            return &user;
         }
     }
-    return Authentication();
+    return nullptr;
 }
 
-inline void populateJWTPayload(JsonObject &payload, User *user)
+inline void populateJWTPayload(JsonObject &payload, const Authentication &authentication)
 {
-    payload["username"] = user->username;
-    payload["admin"] = user->admin;
+    payload["username"] = authentication.username;
+    payload["admin"] = authentication.admin();
+    payload["permissions"] = authentication.permissions;
 }
 
 boolean SecuritySettingsService::validatePayload(JsonObject &parsedPayload, User *user)
 {
-    JsonDocument jsonDocument;
-    JsonObject payload = jsonDocument.to<JsonObject>();
-    populateJWTPayload(payload, user);
-    return payload == parsedPayload;
+    // the token must still describe the user as it is now, changed permissions invalidate it
+    return parsedPayload.size() == 3 &&
+           parsedPayload["username"] == user->username &&
+           parsedPayload["admin"] == user->admin &&
+           parsedPayload["permissions"] == user->effectivePermissions();
 }
 
-String SecuritySettingsService::generateJWT(User *user)
+String SecuritySettingsService::generateJWT(const Authentication &authentication)
 {
     JsonDocument jsonDocument;
     JsonObject payload = jsonDocument.to<JsonObject>();
-    populateJWTPayload(payload, user);
+    populateJWTPayload(payload, authentication);
     return _jwtHandler.buildJWT(payload);
 }
 
@@ -127,25 +239,110 @@ PsychicRequestFilterFunction SecuritySettingsService::filterRequest(Authenticati
         // ESP_LOGV("SecuritySettingsService", "Authenticating filter request: %s", request->uri().c_str());
         // ESP_LOGV("SecuritySettingsService", "Request Method: %s", request->methodStr().c_str());
 
-        // TODO: This is a hack to allow bogus websocket filter requests to pass through
-        // This is a temporary fix until the PsychicHttp websocket handler is fixed to not send a bogus filter request
-
-        // Check if we have a bogus filter request and return true
+        // Websocket frames reach the filter without uri and method, they were authenticated on the upgrade
         if (request->uri().isEmpty() && request->method() == HTTP_DELETE)
         {
-            // ESP_LOGV("SecuritySettingsService", "Bogus filter request - allowing");
-            return true;
+            return authenticateFrame(request, predicate);
         }
-        else
-            request->loadParams();
 
-        Authentication authentication = authenticateRequest(request);
+        String token;
+        uint32_t generation = _jwtCache.generation();
+        Authentication authentication = extractToken(request, token) ? authenticateJWT(token) : Authentication();
         bool result = predicate(authentication);
         // ESP_LOGV("SecuritySettingsService", "Filter Request %s", result ? "allowed" : "denied");
+
+        // bind the result to the connection, so its frames and events don't need to authenticate again
+        PsychicClient *client = request->client();
+        if (result && client != nullptr && request->header("Upgrade").equalsIgnoreCase("websocket"))
+        {
+            // the previous context of the connection forgets its entry first
+            int socket = client->socket();
+            delete client->context;
+            client->context = new WebSocketAuthentication([this, socket]()
+                                                          { forgetConnection(socket); });
+
+            xSemaphoreTake(_connectionsMutex, portMAX_DELAY);
+            _connections[socket] = {token, generation, authentication};
+            xSemaphoreGive(_connectionsMutex);
+        }
         return result;
     };
 }
 
+bool SecuritySettingsService::authenticateFrame(PsychicRequest *request, const AuthenticationPredicate &predicate)
+{
+    PsychicClient *client = request->client();
+    if (client == nullptr)
+    {
+        return false;
+    }
+
+    // frames carry no credentials, a connection that wasn't upgraded through this filter has none
+    Authentication authentication;
+    if (!authenticateConnection(client->socket(), authentication))
+    {
+        ESP_LOGW("SecuritySettingsService", "Denying frame on websocket %d, it was not authenticated on upgrade", client->socket());
+        return false;
+    }
+
+    if (!predicate(authentication))
+    {
+        ESP_LOGI("SecuritySettingsService", "Closing websocket %d, its token is no longer valid", client->socket());
+        client->close();
+        return false;
+    }
+    return true;
+}
+
+Authentication SecuritySettingsService::authenticateClient(int socket)
+{
+    Authentication authentication;
+    authenticateConnection(socket, authentication);
+    return authentication;
+}
+
+bool SecuritySettingsService::authenticateConnection(int socket, Authentication &authentication)
+{
+    xSemaphoreTake(_connectionsMutex, portMAX_DELAY);
+    auto connection = _connections.find(socket);
+    if (connection == _connections.end())
+    {
+        xSemaphoreGive(_connectionsMutex);
+        return false;
+    }
+    if (connection->second.generation == _jwtCache.generation())
+    {
+        authentication = connection->second.authentication;
+        xSemaphoreGive(_connectionsMutex);
+        return true;
+    }
+
+    // secret or users changed since the token was checked. Verify it without holding the lock and keep
+    // the result, a token that is no longer valid is denied from now on without another HMAC.
+    String token = connection->second.token;
+    uint32_t generation = _jwtCache.generation();
+    xSemaphoreGive(_connectionsMutex);
+
+    authentication = authenticateJWT(token);
+
+    xSemaphoreTake(_connectionsMutex, portMAX_DELAY);
+    connection = _connections.find(socket);
+    if (connection != _connections.end() && connection->second.token == token)
+    {
+        connection->second.generation = generation;
+        connection->second.authentication = authentication;
+    }
+    xSemaphoreGive(_connectionsMutex);
+    return true;
+}
+
+void SecuritySettingsService::forgetConnection(int socket)
+{
+    xSemaphoreTake(_connectionsMutex, portMAX_DELAY);
+    _connections.erase(socket);
+    xSemaphoreGive(_connectionsMutex);
+}
+
 PsychicHttpRequestCallback SecuritySettingsService::wrapRequest(PsychicHttpRequestCallback onRequest, AuthenticationPredicate predicate)
 {
     return [this, onRequest, predicate](PsychicRequest *request)
@@ -175,15 +372,13 @@ PsychicJsonRequestCallback SecuritySettingsService::wrapCallback(PsychicJsonRequ
 esp_err_t SecuritySettingsService::generateToken(PsychicRequest *request)
 {
     String usernameParam = request->getParam("username")->value();
-    for (User _user : _state.users)
+    User *user = findUser(usernameParam);
+    if (user != nullptr)
     {
-        if (_user.username == usernameParam)
-        {
-            PsychicJsonResponse response = PsychicJsonResponse(request, false);
-            JsonObject root = response.getRoot();
-            root["token"] = generateJWT(&_user);
-            return response.send();
-        }
+        PsychicJsonResponse response = PsychicJsonResponse(request, false);
+        JsonObject root = response.getRoot();
+        root["token"] = generateJWT(Authentication(*user));
+        return response.send();
     }
     return request->reply(401);
 }
@@ -214,6 +409,11 @@ Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *requ
     return Authentication(ADMIN_USER);
 }
 
+Authentication SecuritySettingsService::authenticateClient(int socket)
+{
+    return Authentication(ADMIN_USER);
+}
+
 // Return the function unwrapped
 PsychicHttpRequestCallback SecuritySettingsService::wrapRequest(PsychicHttpRequestCallback onRequest,
                                                                 AuthenticationPredicate predicate)
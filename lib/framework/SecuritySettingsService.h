@@ -18,8 +18,11 @@
 #include <SettingValue.h>
 #include <Features.h>
 #include <SecurityManager.h>
+#include <PasswordHash.h>
 #include <HttpEndpoint.h>
 #include <FSPersistence.h>
+#include <JWTCache.h>
+#include <map>
 
 #ifndef FACTORY_JWT_SECRET
 #define FACTORY_JWT_SECRET "#{random}-#{random}"
@@ -61,36 +64,17 @@ public:
 
         // users
         JsonArray users = root["users"].to<JsonArray>();
-        for (User user : settings.users)
+        for (const User &user : settings.users)
         {
             JsonObject userRoot = users.add<JsonObject>();
             userRoot["username"] = user.username;
             userRoot["password"] = user.password;
             userRoot["admin"] = user.admin;
+            userRoot["permissions"] = user.permissions;
         }
     }
 
-    static StateUpdateResult update(JsonObject &root, SecuritySettings &settings)
-    {
-        // secret
-        settings.jwtSecret = root["jwt_secret"] | SettingValue::format(FACTORY_JWT_SECRET);
-
-        // users
-        settings.users.clear();
-        if (root["users"].is<JsonArray>())
-        {
-            for (JsonVariant user : root["users"].as<JsonArray>())
-            {
-                settings.users.push_back(User(user["username"], user["password"], user["admin"]));
-            }
-        }
-        else
-        {
-            settings.users.push_back(User(FACTORY_ADMIN_USERNAME, FACTORY_ADMIN_PASSWORD, true));
-            settings.users.push_back(User(FACTORY_GUEST_USERNAME, FACTORY_GUEST_PASSWORD, false));
-        }
-        return StateUpdateResult::CHANGED;
-    }
+    static StateUpdateResult update(JsonObject &root, SecuritySettings &settings);
 };
 
 class SecuritySettingsService : public StatefulService<SecuritySettings>, public SecurityManager
@@ -103,7 +87,8 @@ public:
     // Functions to implement SecurityManager
     Authentication authenticate(const String &username, const String &password);
     Authentication authenticateRequest(PsychicRequest *request);
-    String generateJWT(User *user);
+    Authentication authenticateClient(int socket);
+    String generateJWT(const Authentication &authentication);
 
     PsychicRequestFilterFunction filterRequest(AuthenticationPredicate predicate);
     PsychicHttpRequestCallback wrapRequest(PsychicHttpRequestCallback onRequest, AuthenticationPredicate predicate);
@@ -116,10 +101,47 @@ private:
     FSPersistence<SecuritySettings> _fsPersistence;
     ArduinoJsonJWT _jwtHandler;
 
+    // cleared, and its generation bumped, whenever the secret or the users change
+    JWTCache _jwtCache;
+
+    // authentication of an upgraded websocket connection, kept until the connection closes
+    struct ConnectionAuthentication
+    {
+        String token;
+        uint32_t generation;
+        Authentication authentication;
+    };
+
+    // by socket, read by the event emitters and written by the server task, so it's guarded
+    std::map<int, ConnectionAuthentication> _connections;
+    SemaphoreHandle_t _connectionsMutex;
+
     esp_err_t generateToken(PsychicRequest *request);
 
     void configureJWTHandler();
 
+    /*
+     * Token from the Authorization header or the access_token parameter
+     */
+    bool extractToken(PsychicRequest *request, String &token);
+
+    /*
+     * Websocket frames use the authentication of their connection
+     */
+    bool authenticateFrame(PsychicRequest *request, const AuthenticationPredicate &predicate);
+
+    /*
+     * Authentication of the connection on the socket, false if it was not upgraded through a filter.
+     * The token is verified again once after the secret or the users changed, the result is kept either way.
+     */
+    bool authenticateConnection(int socket, Authentication &authentication);
+    void forgetConnection(int socket);
+
+    /*
+     * Lookup by username without copying the user, nullptr if there is none
+     */
+    User *findUser(const String &username);
+
     /*
      * Lookup the user by JWT
      */
@@ -141,6 +163,7 @@ public:
 
     // minimal set of functions to support framework with security settings disabled
     Authentication authenticateRequest(PsychicRequest *request);
+    Authentication authenticateClient(int socket);
     PsychicRequestFilterFunction filterRequest(AuthenticationPredicate predicate);
     PsychicHttpRequestCallback wrapRequest(PsychicHttpRequestCallback onRequest, AuthenticationPredicate predicate);
     PsychicJsonRequestCallback wrapCallback(PsychicJsonRequestCallback onRequest, AuthenticationPredicate predicate);
@@ -0,0 +1,291 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <SettingsFile.h>
+#include <BufferedFileStream.h>
+#include <FSUsage.h>
+#include <esp_rom_crc.h>
+
+#define FOOTER_PREFIX "\n#crc32="
+#define FOOTER_PREFIX_LENGTH 8
+#define FOOTER_LENGTH (FOOTER_PREFIX_LENGTH + 8 + 1)
+
+// keeps a CRC of everything serialized into the target
+class CrcPrint : public Print
+{
+public:
+    CrcPrint(Print &target) : _target(target), _crc(0), _written(0), _failed(false) {}
+
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        _crc = esp_rom_crc32_le(_crc, buffer, size);
+        size_t written = _target.write(buffer, size);
+        _written += written;
+        if (written != size)
+        {
+            _failed = true;
+        }
+        return written;
+    }
+
+    uint32_t crc() { return _crc; }
+    size_t written() { return _written; }
+    bool failed() { return _failed; }
+
+private:
+    Print &_target;
+    uint32_t _crc;
+    size_t _written;
+    bool _failed;
+};
+
+static bool parseVerified(const char *buffer, size_t size, JsonDocument &jsonDocument, const String &path)
+{
+    size_t contentLength = SettingsFile::contentLength(buffer, size);
+    if (contentLength != size)
+    {
+        char hex[9];
+        memcpy(hex, buffer + size - FOOTER_LENGTH + FOOTER_PREFIX_LENGTH, 8);
+        hex[8] = '\0';
+
+        if (esp_rom_crc32_le(0, (const uint8_t *)buffer, contentLength) != strtoul(hex, nullptr, 16))
+        {
+            ESP_LOGW("SettingsFile", "CRC mismatch in %s", path.c_str());
+            return false;
+        }
+    }
+
+    DeserializationError error = SettingsFile::parse(buffer, contentLength, jsonDocument);
+    if (error != DeserializationError::Ok || !jsonDocument.is<JsonObject>())
+    {
+        ESP_LOGW("SettingsFile", "Could not parse %s: %s", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool readVerified(FS *fs, const String &path, JsonDocument &jsonDocument)
+{
+    // exists() only stats, open() would log an error for every missing candidate
+    if (!fs->exists(path))
+    {
+        return false;
+    }
+
+    // settings files are small, one read of the whole file beats any streaming parser
+    File file = fs->open(path, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    size_t size = file.size();
+    if (size == 0 || size > SETTINGS_FILE_MAX_SIZE)
+    {
+        file.close();
+        return false;
+    }
+
+    char *buffer = (char *)malloc(size);
+    if (buffer == nullptr)
+    {
+        file.close();
+        ESP_LOGE("SettingsFile", "Out of memory reading %s", path.c_str());
+        return false;
+    }
+
+    bool valid = file.read((uint8_t *)buffer, size) == size && parseVerified(buffer, size, jsonDocument, path);
+    file.close();
+    free(buffer);
+    return valid;
+}
+
+// <dir>/<name>.json becomes <dir>/<name>.msgpack
+static String formatPath(const char *path, SettingsFormat format)
+{
+    String formatPath(path);
+    if (format == SettingsFormat::MSGPACK)
+    {
+        int extension = formatPath.lastIndexOf('.');
+        if (extension > formatPath.lastIndexOf('/'))
+        {
+            formatPath.remove(extension);
+        }
+        formatPath += SETTINGS_FILE_MSGPACK_EXTENSION;
+    }
+    return formatPath;
+}
+
+static void removeWithBackups(FS *fs, const String &path)
+{
+    fs->remove(path);
+    fs->remove(path + SETTINGS_FILE_TMP_SUFFIX);
+    fs->remove(path + SETTINGS_FILE_BACKUP_SUFFIX);
+    FSUsage::invalidate(fs);
+}
+
+static bool readCandidates(FS *fs, const String &path, JsonDocument &jsonDocument, bool *recovered)
+{
+    const char *suffixes[] = {"", SETTINGS_FILE_TMP_SUFFIX, SETTINGS_FILE_BACKUP_SUFFIX};
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+    {
+        String candidate = path + suffixes[i];
+        if (readVerified(fs, candidate, jsonDocument))
+        {
+            if (i > 0)
+            {
+                ESP_LOGW("SettingsFile", "Recovered %s from %s", path.c_str(), candidate.c_str());
+            }
+            *recovered = i > 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+DeserializationError SettingsFile::parse(const char *buffer, size_t length, JsonDocument &jsonDocument)
+{
+    // a MessagePack map starts with 0x80 - 0x8f, 0xde or 0xdf, JSON with '{' or whitespace
+    if (length > 0 && (uint8_t)buffer[0] >= 0x80)
+    {
+        return deserializeMsgPack(jsonDocument, buffer, length);
+    }
+    return deserializeJson(jsonDocument, buffer, length);
+}
+
+size_t SettingsFile::write(FS *fs, const char *path, JsonDocument &jsonDocument, SettingsFormat format)
+{
+    String targetPath = formatPath(path, format);
+    String tmpPath = targetPath + SETTINGS_FILE_TMP_SUFFIX;
+    String backupPath = targetPath + SETTINGS_FILE_BACKUP_SUFFIX;
+
+    File file = fs->open(tmpPath, "w");
+    if (!file)
+    {
+        return 0;
+    }
+
+    BufferedFileStream stream(file);
+    CrcPrint print(stream);
+    if (format == SettingsFormat::MSGPACK)
+    {
+        serializeMsgPack(jsonDocument, print);
+    }
+    else
+    {
+        serializeJson(jsonDocument, print);
+    }
+
+    char footer[FOOTER_LENGTH + 1];
+    snprintf(footer, sizeof(footer), FOOTER_PREFIX "%08x\n", (unsigned int)print.crc());
+    stream.write((const uint8_t *)footer, FOOTER_LENGTH);
+    stream.flush();
+    bool complete = !print.failed() && !stream.failed();
+    file.close();
+
+    if (!complete)
+    {
+        ESP_LOGE("SettingsFile", "Could not write %s", tmpPath.c_str());
+        fs->remove(tmpPath);
+        return 0;
+    }
+
+    size_t written = print.written() + FOOTER_LENGTH;
+
+    // keep the current file as backup, read() picks up the temporary file if we lose power in between
+    size_t removed = 0;
+    if (fs->exists(targetPath))
+    {
+        if (fs->exists(backupPath))
+        {
+            File backup = fs->open(backupPath, "r");
+            removed = backup.size();
+            backup.close();
+            fs->remove(backupPath);
+        }
+        fs->rename(targetPath, backupPath);
+    }
+    // the new file replaces the old backup
+    FSUsage::fileResized(fs, removed, written);
+    if (!fs->rename(tmpPath, targetPath))
+    {
+        ESP_LOGE("SettingsFile", "Could not rename %s", tmpPath.c_str());
+        return 0;
+    }
+
+    if (format != SettingsFormat::JSON)
+    {
+#if SERVE_CONFIG_FILES
+        // readable copy for /config/, never read back
+        File jsonFile = fs->open(path, "w");
+        if (jsonFile)
+        {
+            BufferedFileStream jsonStream(jsonFile);
+            written += serializeJson(jsonDocument, jsonStream);
+            jsonStream.flush();
+            jsonFile.close();
+            FSUsage::invalidate(fs);
+        }
+#else
+        // the JSON file has been migrated now
+        if (fs->exists(path))
+        {
+            removeWithBackups(fs, path);
+        }
+#endif
+    }
+    return written;
+}
+
+bool SettingsFile::read(FS *fs, const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format)
+{
+    bool fromBackup = false;
+    bool found = readCandidates(fs, formatPath(path, format), jsonDocument, &fromBackup);
+
+    // not converted yet, migrate from the JSON file
+    if (!found && format != SettingsFormat::JSON && readCandidates(fs, path, jsonDocument, &fromBackup))
+    {
+        ESP_LOGI("SettingsFile", "Converting %s to %s", path, formatPath(path, format).c_str());
+        found = true;
+        fromBackup = true;
+    }
+
+    if (recovered != nullptr)
+    {
+        *recovered = found && fromBackup;
+    }
+    return found;
+}
+
+void SettingsFile::remove(FS *fs, const char *path, SettingsFormat format)
+{
+    removeWithBackups(fs, formatPath(path, format));
+    if (format != SettingsFormat::JSON)
+    {
+        removeWithBackups(fs, path);
+    }
+}
+
+size_t SettingsFile::contentLength(const char *buffer, size_t size)
+{
+    if (size >= FOOTER_LENGTH && memcmp(buffer + size - FOOTER_LENGTH, FOOTER_PREFIX, FOOTER_PREFIX_LENGTH) == 0)
+    {
+        return size - FOOTER_LENGTH;
+    }
+    return size;
+}
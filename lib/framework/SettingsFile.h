@@ -0,0 +1,67 @@
+#ifndef SettingsFile_h
+#define SettingsFile_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <FS.h>
+
+/*
+ * Crash safe settings files.
+ *
+ * The JSON is written to <path>.tmp, followed by a footer line "#crc32=xxxxxxxx". The previous file
+ * is kept as <path>.bak and the new one is renamed into place. A power loss at any point leaves at
+ * least one complete copy: read() takes the first of <path>, <path>.tmp and <path>.bak whose CRC
+ * matches. Files without a footer (written by older firmware) are accepted if they parse.
+ *
+ * Settings can be stored as MessagePack instead of JSON. They are kept in <name>.msgpack next to the
+ * JSON path, and an existing JSON file is read once and replaced on the next write. With
+ * SERVE_CONFIG_FILES a plain JSON copy is still written to the JSON path for inspection.
+ */
+
+#define SETTINGS_FILE_TMP_SUFFIX ".tmp"
+#define SETTINGS_FILE_BACKUP_SUFFIX ".bak"
+
+#ifndef SETTINGS_FILE_MAX_SIZE
+#define SETTINGS_FILE_MAX_SIZE 16384
+#endif
+
+#define SETTINGS_FILE_MSGPACK_EXTENSION ".msgpack"
+
+enum class SettingsFormat
+{
+    JSON,
+    MSGPACK
+};
+
+namespace SettingsFile
+{
+    // returns the number of bytes written, 0 on failure
+    size_t write(FS *fs, const char *path, JsonDocument &jsonDocument, SettingsFormat format = SettingsFormat::JSON);
+
+    // recovered is set if the file had to be taken from the temporary file, the backup or the old JSON file
+    bool read(FS *fs, const char *path, JsonDocument &jsonDocument, bool *recovered = nullptr, SettingsFormat format = SettingsFormat::JSON);
+
+    // removes the file with its temporary file and backup, for MessagePack also the JSON file it came from
+    void remove(FS *fs, const char *path, SettingsFormat format = SettingsFormat::JSON);
+
+    // parses JSON or MessagePack, told apart by the first byte
+    DeserializationError parse(const char *buffer, size_t length, JsonDocument &jsonDocument);
+
+    // length of the file content without the CRC footer
+    size_t contentLength(const char *buffer, size_t size);
+}
+
+#endif // end SettingsFile_h
@@ -0,0 +1,188 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <SettingsStore.h>
+
+uint32_t SettingsStore::_bytesWritten = 0;
+
+SettingsStore *SettingsStore::get(FS *fs)
+{
+#ifdef SETTINGS_STORE_NVS
+    static NVSSettingsStore store(fs);
+#else
+    static FSSettingsStore store(fs);
+#endif
+    return &store;
+}
+
+bool FSSettingsStore::read(const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format)
+{
+    return SettingsFile::read(_fs, path, jsonDocument, recovered, format);
+}
+
+bool FSSettingsStore::write(const char *path, JsonDocument &jsonDocument, SettingsFormat format)
+{
+    size_t length = SettingsFile::write(_fs, path, jsonDocument, format);
+    _bytesWritten += length;
+    return length > 0;
+}
+
+#ifdef SETTINGS_STORE_NVS
+
+bool NVSSettingsStore::_begin()
+{
+    if (!_open)
+    {
+        // the Arduino core has already initialized the NVS partition
+        esp_err_t err = nvs_open(SETTINGS_STORE_NAMESPACE, NVS_READWRITE, &_handle);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE("SettingsStore", "Could not open NVS namespace: %s", esp_err_to_name(err));
+            return false;
+        }
+        _open = true;
+    }
+    return true;
+}
+
+// NVS keys have at most 15 characters, "/config/wifiSettings.json" becomes "wifiSettings"
+String NVSSettingsStore::_key(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    name = name != nullptr ? name + 1 : path;
+    const char *extension = strrchr(name, '.');
+    size_t length = extension != nullptr ? extension - name : strlen(name);
+
+    // only the names in /config are unique by themselves
+    bool inConfig = (size_t)(name - path) == strlen(SETTINGS_STORE_DIRECTORY) &&
+                    strncmp(path, SETTINGS_STORE_DIRECTORY, name - path) == 0;
+    if (inConfig && length <= NVS_KEY_NAME_MAX_SIZE - 1)
+    {
+        return String(name).substring(0, length);
+    }
+
+    // shorten and keep it unique with a hash of the whole path
+    uint32_t hash = 2166136261u;
+    for (const char *c = path; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    snprintf(key, sizeof(key), "%.6s%08x", name, (unsigned int)hash);
+    return String(key);
+}
+
+bool NVSSettingsStore::read(const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format)
+{
+    *recovered = false;
+    if (!_begin())
+    {
+        return false;
+    }
+
+    String key = _key(path);
+    size_t length = 0;
+    esp_err_t err = nvs_get_blob(_handle, key.c_str(), nullptr, &length);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        // not migrated yet, take the file and have the caller write it to NVS
+        if (SettingsFile::read(_fs, path, jsonDocument, nullptr, format))
+        {
+            ESP_LOGI("SettingsStore", "Migrating %s to NVS key %s", path, key.c_str());
+            _migrating.push_back(path);
+            *recovered = true;
+            return true;
+        }
+        return false;
+    }
+    if (err != ESP_OK || length == 0)
+    {
+        ESP_LOGE("SettingsStore", "Could not read %s: %s", key.c_str(), esp_err_to_name(err));
+        return false;
+    }
+
+    char *buffer = (char *)malloc(length);
+    if (buffer == nullptr)
+    {
+        ESP_LOGE("SettingsStore", "Out of memory reading %s", key.c_str());
+        return false;
+    }
+
+    bool valid = nvs_get_blob(_handle, key.c_str(), buffer, &length) == ESP_OK &&
+                 SettingsFile::parse(buffer, length, jsonDocument) == DeserializationError::Ok &&
+                 jsonDocument.is<JsonObject>();
+    free(buffer);
+    return valid;
+}
+
+bool NVSSettingsStore::write(const char *path, JsonDocument &jsonDocument, SettingsFormat format)
+{
+    if (!_begin())
+    {
+        return false;
+    }
+
+    String key = _key(path);
+    bool msgPack = format == SettingsFormat::MSGPACK;
+    size_t length = msgPack ? measureMsgPack(jsonDocument) : measureJson(jsonDocument);
+    char *buffer = (char *)malloc(length + 1);
+    if (buffer == nullptr)
+    {
+        ESP_LOGE("SettingsStore", "Out of memory writing %s", key.c_str());
+        return false;
+    }
+    if (msgPack)
+    {
+        serializeMsgPack(jsonDocument, buffer, length + 1);
+    }
+    else
+    {
+        serializeJson(jsonDocument, buffer, length + 1);
+    }
+
+    // the NVS entry is replaced atomically, a power loss keeps the old value
+    esp_err_t err = nvs_set_blob(_handle, key.c_str(), buffer, length);
+    free(buffer);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(_handle);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGE("SettingsStore", "Could not write %s: %s", key.c_str(), esp_err_to_name(err));
+        return false;
+    }
+
+    _bytesWritten += length;
+
+    // NVS holds them now, the file would only be stale from here on
+    auto migrated = std::find(_migrating.begin(), _migrating.end(), String(path));
+    if (migrated != _migrating.end())
+    {
+        SettingsFile::remove(_fs, path, format);
+        _migrating.erase(migrated);
+        ESP_LOGI("SettingsStore", "Removed %s after migrating it to NVS", path);
+    }
+    return true;
+}
+
+void NVSSettingsStore::erase()
+{
+    if (_begin())
+    {
+        nvs_erase_all(_handle);
+        nvs_commit(_handle);
+    }
+}
+
+#endif
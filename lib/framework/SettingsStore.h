@@ -0,0 +1,95 @@
+#ifndef SettingsStore_h
+#define SettingsStore_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <FS.h>
+#include <SettingsFile.h>
+#include <vector>
+
+/*
+ * Backend for FSPersistence. Settings are addressed by their file path.
+ *
+ * By default every service keeps its own JSON file (FSSettingsStore). With -D SETTINGS_STORE_NVS all
+ * settings go into one NVS namespace instead (NVSSettingsStore). Boot then skips the per file open,
+ * stat and parse cycles, and a change only appends an NVS entry instead of rewriting a file and its
+ * metadata. Existing files are migrated into NVS the first time they are read, and removed once NVS
+ * holds them.
+ */
+
+#ifndef SETTINGS_STORE_NAMESPACE
+#define SETTINGS_STORE_NAMESPACE "settings"
+#endif
+
+// settings in this directory keep their name as NVS key, all others get a hash of their path
+#define SETTINGS_STORE_DIRECTORY "/config/"
+
+class SettingsStore
+{
+public:
+    virtual ~SettingsStore() {}
+
+    // recovered is set if the settings did not come from their regular place and should be written back
+    virtual bool read(const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format) = 0;
+    virtual bool write(const char *path, JsonDocument &jsonDocument, SettingsFormat format) = 0;
+
+    // the store selected by the build flags, all settings have to live on the same file system
+    static SettingsStore *get(FS *fs);
+
+    static uint32_t bytesWritten() { return _bytesWritten; }
+
+protected:
+    static uint32_t _bytesWritten;
+};
+
+class FSSettingsStore : public SettingsStore
+{
+public:
+    FSSettingsStore(FS *fs) : _fs(fs) {}
+
+    bool read(const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format) override;
+    bool write(const char *path, JsonDocument &jsonDocument, SettingsFormat format) override;
+
+private:
+    FS *_fs;
+};
+
+#ifdef SETTINGS_STORE_NVS
+#include <nvs.h>
+
+class NVSSettingsStore : public SettingsStore
+{
+public:
+    NVSSettingsStore(FS *fs) : _fs(fs), _handle(0), _open(false) {}
+
+    bool read(const char *path, JsonDocument &jsonDocument, bool *recovered, SettingsFormat format) override;
+    bool write(const char *path, JsonDocument &jsonDocument, SettingsFormat format) override;
+
+    // removes all settings, used by the factory reset
+    void erase();
+
+private:
+    FS *_fs;
+    nvs_handle_t _handle;
+    bool _open;
+    std::vector<String> _migrating; // read from a file, removed after they are written to NVS
+
+    bool _begin();
+    static String _key(const char *path);
+};
+#endif
+
+#endif // end SettingsStore_h
@@ -66,6 +66,9 @@ void SleepService::sleepNow()
     {
         _callbackSleep();
     }
+    EventLog::log(EventType::SLEEP);
+    PersistenceScheduler::flush();
+    EventLog::flush();
     delay(100);
 
     MDNS.end();
@@ -18,6 +18,8 @@
 
 #include <PsychicHttp.h>
 #include <SecurityManager.h>
+#include <PersistenceScheduler.h>
+#include <EventLog.h>
 #include "driver/rtc_io.h"
 
 #define SLEEP_SERVICE_PATH "/rest/sleep"
@@ -13,6 +13,9 @@
  **/
 
 #include <SystemStatus.h>
+#include <FSUsage.h>
+#include <PersistenceScheduler.h>
+#include <SettingsStore.h>
 #include <esp32-hal.h>
 
 #if CONFIG_IDF_TARGET_ESP32 // ESP32/PICO-D4
@@ -134,11 +137,26 @@ esp_err_t SystemStatus::systemStatus(PsychicRequest *request)
     root["arduino_version"] = ARDUINO_VERSION;
     root["flash_chip_size"] = ESP.getFlashChipSize();
     root["flash_chip_speed"] = ESP.getFlashChipSpeed();
-    root["fs_total"] = ESPFS.totalBytes();
-    root["fs_used"] = ESPFS.usedBytes();
+    root["fs_total"] = FSUsage::total();
+    root["fs_used"] = FSUsage::used();
+    root["fs_writes"] = PersistenceScheduler::writes();
+    root["fs_writes_avoided"] = PersistenceScheduler::writesAvoided();
+    root["fs_bytes_written"] = SettingsStore::bytesWritten();
     root["core_temp"] = temperatureRead();
     root["cpu_reset_reason"] = verbosePrintResetReason(rtc_get_reset_reason(0));
     root["uptime"] = millis() / 1000;
 
+#ifdef ENABLE_ASYNC
+    async_worker_stats_t stats;
+    get_async_worker_stats(&stats);
+    JsonObject async = root["async_workers"].to<JsonObject>();
+    async["workers"] = stats.workers;
+    async["busy"] = stats.busy;
+    async["handled"] = stats.handled;
+    async["rejected"] = stats.rejected;
+    async["wait_avg_ms"] = stats.waitAvgMs;
+    async["wait_max_ms"] = stats.waitMaxMs;
+#endif
+
     return response.send();
 }
@@ -0,0 +1,541 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <TimeSeriesStore.h>
+#include <FSUsage.h>
+
+#define HEADER_SIZE 16
+#define PAYLOAD_BITS ((TIMESERIES_BLOCK_SIZE - HEADER_SIZE) * 8)
+// longest variable bit field, 4 bit prefix and 32 bit value
+#define MAX_FIELD_BITS 36
+
+// values are clamped so deltas never overflow, NAN is stored as MISSING_VALUE
+#define MAX_VALUE (1 << 29)
+#define MISSING_VALUE (-(1 << 30))
+
+static void writeBits(uint8_t *payload, uint16_t &position, uint32_t value, uint8_t count)
+{
+    for (int i = count - 1; i >= 0; i--)
+    {
+        if ((value >> i) & 1)
+        {
+            payload[position >> 3] |= 0x80 >> (position & 7);
+        }
+        position++;
+    }
+}
+
+static uint32_t readBits(const uint8_t *payload, uint32_t &position, uint8_t count)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < count && position < PAYLOAD_BITS; i++)
+    {
+        value = (value << 1) | ((payload[position >> 3] >> (7 - (position & 7))) & 1);
+        position++;
+    }
+    return value;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// '0' for zero, '10' + 7 bits, '110' + 12 bits, '1110' + 20 bits or '1111' + 32 bits
+static void writeField(uint8_t *payload, uint16_t &position, uint32_t value)
+{
+    if (value == 0)
+    {
+        writeBits(payload, position, 0, 1);
+    }
+    else if (value < (1 << 7))
+    {
+        writeBits(payload, position, 0b10, 2);
+        writeBits(payload, position, value, 7);
+    }
+    else if (value < (1 << 12))
+    {
+        writeBits(payload, position, 0b110, 3);
+        writeBits(payload, position, value, 12);
+    }
+    else if (value < (1 << 20))
+    {
+        writeBits(payload, position, 0b1110, 4);
+        writeBits(payload, position, value, 20);
+    }
+    else
+    {
+        writeBits(payload, position, 0b1111, 4);
+        writeBits(payload, position, value, 32);
+    }
+}
+
+static uint32_t readField(const uint8_t *payload, uint32_t &position)
+{
+    if (!readBits(payload, position, 1))
+    {
+        return 0;
+    }
+    if (!readBits(payload, position, 1))
+    {
+        return readBits(payload, position, 7);
+    }
+    if (!readBits(payload, position, 1))
+    {
+        return readBits(payload, position, 12);
+    }
+    if (!readBits(payload, position, 1))
+    {
+        return readBits(payload, position, 20);
+    }
+    return readBits(payload, position, 32);
+}
+
+static int32_t scaleValue(float value)
+{
+    if (isnan(value))
+    {
+        return MISSING_VALUE;
+    }
+    float scaled = value * TIMESERIES_VALUE_SCALE;
+    return scaled > MAX_VALUE ? MAX_VALUE : scaled < -MAX_VALUE ? -MAX_VALUE
+                                                                : (int32_t)lroundf(scaled);
+}
+
+TimeSeriesStore::TimeSeriesStore(FS *fs, const char *directory, uint8_t channels, uint8_t budgetShare) : _fs(fs),
+                                                                                                        _directory(directory),
+                                                                                                        _channels(min(channels, (uint8_t)TIMESERIES_MAX_CHANNELS)),
+                                                                                                        _budgetShare(budgetShare),
+                                                                                                        _maxSegments(TIMESERIES_MIN_SEGMENTS),
+                                                                                                        _mutex(xSemaphoreCreateMutex()),
+                                                                                                        _firstSegment(1),
+                                                                                                        _lastSegment(1),
+                                                                                                        _openBlock(0),
+                                                                                                        _readers(0),
+                                                                                                        _firstTimestamp(0),
+                                                                                                        _lastTimestamp(0),
+                                                                                                        _unsynced(false),
+                                                                                                        _blockOnDisk(false)
+{
+    static_assert(sizeof(BlockHeader) == HEADER_SIZE, "Block header must be 16 bytes");
+    _resetBlock();
+
+    // the open block is written at most every TIMESERIES_SYNC_INTERVAL_MS, and before restarts.
+    // Every append marks it dirty, so it stays out of the settings write statistics.
+    _persistenceId = PersistenceScheduler::add([this]()
+                                               { return sync(); },
+                                               TIMESERIES_SYNC_INTERVAL_MS,
+                                               TIMESERIES_SYNC_INTERVAL_MS,
+                                               false);
+}
+
+void TimeSeriesStore::begin()
+{
+    // create the directory and its parents
+    String path = _directory + "/";
+    int index = 0;
+    while ((index = path.indexOf('/', index + 1)) != -1)
+    {
+        String segment = path.substring(0, index);
+        if (!_fs->exists(segment))
+        {
+            _fs->mkdir(segment);
+        }
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    _maxSegments = max(FSUsage::budget(_budgetShare) / (TIMESERIES_SEGMENT_BLOCKS * TIMESERIES_BLOCK_SIZE), (size_t)TIMESERIES_MIN_SEGMENTS);
+
+    // segments are numbered, find the oldest and the newest
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    File directory = _fs->open(_directory);
+    File file;
+    while (directory && (file = directory.openNextFile()))
+    {
+        const char *name = strrchr(file.name(), '/');
+        name = name != nullptr ? name + 1 : file.name();
+        uint32_t segment = file.isDirectory() || strstr(name, ".ts") == nullptr ? 0 : strtoul(name, nullptr, 10);
+        file.close();
+        if (segment > 0)
+        {
+            first = min(first, segment);
+            last = max(last, segment);
+        }
+    }
+    directory.close();
+
+    if (last > 0)
+    {
+        _firstSegment = first;
+        _lastSegment = last;
+
+        // continue behind the last block written, in a new segment if that one is full
+        file = _fs->open(_segmentPath(last), "r");
+        size_t size = file.size();
+        uint32_t blocks = size / TIMESERIES_BLOCK_SIZE;
+        BlockHeader header;
+        if (blocks > 0 && file.seek((blocks - 1) * TIMESERIES_BLOCK_SIZE) &&
+            file.read((uint8_t *)&header, HEADER_SIZE) == HEADER_SIZE && header.magic == TIMESERIES_BLOCK_MAGIC)
+        {
+            _lastTimestamp = header.lastTimestamp;
+        }
+        file.close();
+
+        _openBlock = blocks;
+        if (size % TIMESERIES_BLOCK_SIZE != 0 || blocks >= TIMESERIES_SEGMENT_BLOCKS)
+        {
+            _lastSegment++;
+            _openBlock = 0;
+        }
+    }
+    _rotate();
+
+    ESP_LOGI("TimeSeriesStore", "%s holds segments %u to %u of at most %u, %u bytes", _directory.c_str(), _firstSegment, _lastSegment, _maxSegments, flashBytes());
+    xSemaphoreGive(_mutex);
+}
+
+bool TimeSeriesStore::append(uint32_t timestamp, const float *values)
+{
+    int32_t scaled[TIMESERIES_MAX_CHANNELS];
+    for (uint8_t c = 0; c < _channels; c++)
+    {
+        scaled[c] = scaleValue(values[c]);
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    if (timestamp <= _lastTimestamp)
+    {
+        xSemaphoreGive(_mutex);
+        ESP_LOGW("TimeSeriesStore", "Dropping sample at %u, store is at %u already", timestamp, _lastTimestamp);
+        return false;
+    }
+
+    // make sure the worst case fits, start a new block otherwise
+    if (_header()->count > 0 && _header()->bits + (1 + _channels) * MAX_FIELD_BITS > PAYLOAD_BITS)
+    {
+        _sealBlock();
+    }
+
+    BlockHeader *header = _header();
+    uint8_t *payload = _block + HEADER_SIZE;
+    uint16_t position = header->bits;
+
+    if (header->count == 0)
+    {
+        // the first sample of a block is stored as is
+        header->firstTimestamp = timestamp;
+        for (uint8_t c = 0; c < _channels; c++)
+        {
+            writeBits(payload, position, (uint32_t)scaled[c], 32);
+        }
+        _lastDelta = 0;
+    }
+    else
+    {
+        uint32_t delta = timestamp - header->lastTimestamp;
+        writeField(payload, position, zigzag((int32_t)(delta - _lastDelta)));
+        for (uint8_t c = 0; c < _channels; c++)
+        {
+            writeField(payload, position, zigzag(scaled[c] - _lastValues[c]));
+        }
+        _lastDelta = delta;
+    }
+
+    memcpy(_lastValues, scaled, sizeof(int32_t) * _channels);
+    header->bits = position;
+    header->count++;
+    header->lastTimestamp = timestamp;
+    _lastTimestamp = timestamp;
+    if (_firstTimestamp == 0)
+    {
+        _firstTimestamp = timestamp;
+    }
+    _unsynced = true;
+
+    xSemaphoreGive(_mutex);
+
+    PersistenceScheduler::markDirty(_persistenceId);
+    return true;
+}
+
+void TimeSeriesStore::query(uint32_t from, uint32_t to, TimeSeriesVisitor visitor)
+{
+    // one buffer for blocks from flash, one for a copy of the open block
+    uint8_t *buffer = (uint8_t *)malloc(2 * TIMESERIES_BLOCK_SIZE);
+    if (buffer == nullptr)
+    {
+        ESP_LOGE("TimeSeriesStore", "Out of memory for query");
+        return;
+    }
+    uint8_t *openBlock = buffer + TIMESERIES_BLOCK_SIZE;
+
+    // segments are not deleted while a query runs, sealed blocks never change
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _readers++;
+    uint32_t first = _firstSegment;
+    uint32_t last = _lastSegment;
+    uint32_t openIndex = _openBlock;
+    memcpy(openBlock, _block, TIMESERIES_BLOCK_SIZE);
+    xSemaphoreGive(_mutex);
+
+    bool stop = false;
+    for (uint32_t segment = first; segment <= last && !stop; segment++)
+    {
+        if (segment == last && openIndex == 0)
+        {
+            break;
+        }
+        File file = _fs->open(_segmentPath(segment), "r");
+        if (!file)
+        {
+            continue;
+        }
+
+        uint32_t blocks = file.size() / TIMESERIES_BLOCK_SIZE;
+        if (segment == last)
+        {
+            blocks = min(blocks, openIndex);
+        }
+
+        // headers tell the time range, only matching blocks are read completely
+        for (uint32_t index = 0; index < blocks && !stop; index++)
+        {
+            BlockHeader header;
+            if (!file.seek(index * TIMESERIES_BLOCK_SIZE) || file.read((uint8_t *)&header, HEADER_SIZE) != HEADER_SIZE)
+            {
+                break;
+            }
+            if (header.magic != TIMESERIES_BLOCK_MAGIC || header.count == 0 || header.lastTimestamp < from)
+            {
+                continue;
+            }
+            if (header.firstTimestamp > to)
+            {
+                stop = true;
+                break;
+            }
+
+            memcpy(buffer, &header, HEADER_SIZE);
+            if (file.read(buffer + HEADER_SIZE, TIMESERIES_BLOCK_SIZE - HEADER_SIZE) != TIMESERIES_BLOCK_SIZE - HEADER_SIZE)
+            {
+                break;
+            }
+            _decodeBlock(buffer, from, to, visitor, stop);
+        }
+        file.close();
+    }
+
+    if (!stop)
+    {
+        _decodeBlock(openBlock, from, to, visitor, stop);
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _readers--;
+    xSemaphoreGive(_mutex);
+
+    free(buffer);
+}
+
+bool TimeSeriesStore::sync()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool synced = true;
+    if (_unsynced && _header()->count > 0)
+    {
+        synced = _writeBlock();
+        _unsynced = !synced;
+    }
+    xSemaphoreGive(_mutex);
+    return synced;
+}
+
+size_t TimeSeriesStore::flashBytes()
+{
+    return ((_lastSegment - _firstSegment) * TIMESERIES_SEGMENT_BLOCKS + _openBlock) * TIMESERIES_BLOCK_SIZE;
+}
+
+String TimeSeriesStore::_segmentPath(uint32_t segment)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "/%08u.ts", segment);
+    return _directory + name;
+}
+
+void TimeSeriesStore::_resetBlock()
+{
+    memset(_block, 0, TIMESERIES_BLOCK_SIZE);
+    BlockHeader *header = _header();
+    header->magic = TIMESERIES_BLOCK_MAGIC;
+    header->channels = _channels;
+    header->version = TIMESERIES_BLOCK_VERSION;
+    _lastDelta = 0;
+    _blockOnDisk = false;
+}
+
+// the open block is rewritten in its slot until it is full, LittleFS replaces it atomically
+bool TimeSeriesStore::_writeBlock()
+{
+    while (true)
+    {
+        File file = _fs->open(_segmentPath(_lastSegment), _openBlock == 0 ? "w" : "r+");
+        bool written = file && file.seek(_openBlock * TIMESERIES_BLOCK_SIZE) &&
+                       file.write(_block, TIMESERIES_BLOCK_SIZE) == TIMESERIES_BLOCK_SIZE;
+        file.close();
+
+        if (written)
+        {
+            // only the first write of a block grows the segment
+            if (!_blockOnDisk)
+            {
+                FSUsage::fileResized(_fs, _openBlock * TIMESERIES_BLOCK_SIZE, (_openBlock + 1) * TIMESERIES_BLOCK_SIZE);
+                _blockOnDisk = true;
+            }
+            return true;
+        }
+
+        // most likely the file system is full, make room at the expense of the oldest samples
+        if (!_dropOldest())
+        {
+            ESP_LOGE("TimeSeriesStore", "Could not write %s", _segmentPath(_lastSegment).c_str());
+            return false;
+        }
+        ESP_LOGW("TimeSeriesStore", "Could not write %s, dropped the oldest segment", _segmentPath(_lastSegment).c_str());
+    }
+}
+
+void TimeSeriesStore::_sealBlock()
+{
+    if (!_writeBlock())
+    {
+        ESP_LOGE("TimeSeriesStore", "Could not write block, %u samples lost", _header()->count);
+    }
+    ESP_LOGD("TimeSeriesStore", "Block with %u samples sealed, %u bits per sample",
+             _header()->count, _header()->bits / _header()->count);
+
+    _unsynced = false;
+    _resetBlock();
+    if (++_openBlock >= TIMESERIES_SEGMENT_BLOCKS)
+    {
+        _lastSegment++;
+        _openBlock = 0;
+        _rotate();
+    }
+}
+
+void TimeSeriesStore::_rotate()
+{
+    while (_lastSegment - _firstSegment + 1 > _maxSegments)
+    {
+        if (!_dropOldest())
+        {
+            break;
+        }
+    }
+
+    if (_firstTimestamp == 0)
+    {
+        _readFirstTimestamp();
+    }
+}
+
+// the open segment is never dropped, with a query running the oldest one stays until the next rotation
+bool TimeSeriesStore::_dropOldest()
+{
+    if (_firstSegment >= _lastSegment || _readers > 0)
+    {
+        return false;
+    }
+    _fs->remove(_segmentPath(_firstSegment));
+    FSUsage::fileResized(_fs, TIMESERIES_SEGMENT_BLOCKS * TIMESERIES_BLOCK_SIZE, 0);
+    _firstSegment++;
+    _readFirstTimestamp();
+    return true;
+}
+
+void TimeSeriesStore::_readFirstTimestamp()
+{
+    BlockHeader header;
+    File file = _firstSegment != _lastSegment || _openBlock > 0 ? _fs->open(_segmentPath(_firstSegment), "r") : File();
+    if (file && file.read((uint8_t *)&header, HEADER_SIZE) == HEADER_SIZE && header.magic == TIMESERIES_BLOCK_MAGIC)
+    {
+        _firstTimestamp = header.firstTimestamp;
+    }
+    file.close();
+}
+
+void TimeSeriesStore::_decodeBlock(const uint8_t *block, uint32_t from, uint32_t to, TimeSeriesVisitor &visitor, bool &stop)
+{
+    BlockHeader header;
+    memcpy(&header, block, HEADER_SIZE);
+    if (header.magic != TIMESERIES_BLOCK_MAGIC || header.version != TIMESERIES_BLOCK_VERSION ||
+        header.channels != _channels || header.count == 0)
+    {
+        return;
+    }
+
+    const uint8_t *payload = block + HEADER_SIZE;
+    uint32_t position = 0;
+    uint32_t timestamp = header.firstTimestamp;
+    uint32_t delta = 0;
+    int32_t values[TIMESERIES_MAX_CHANNELS];
+    float output[TIMESERIES_MAX_CHANNELS];
+
+    for (uint16_t i = 0; i < header.count; i++)
+    {
+        if (i == 0)
+        {
+            for (uint8_t c = 0; c < _channels; c++)
+            {
+                values[c] = (int32_t)readBits(payload, position, 32);
+            }
+        }
+        else
+        {
+            delta += unzigzag(readField(payload, position));
+            timestamp += delta;
+            for (uint8_t c = 0; c < _channels; c++)
+            {
+                values[c] += unzigzag(readField(payload, position));
+            }
+        }
+
+        if (timestamp > to)
+        {
+            stop = true;
+            return;
+        }
+        if (timestamp < from)
+        {
+            continue;
+        }
+
+        for (uint8_t c = 0; c < _channels; c++)
+        {
+            output[c] = values[c] == MISSING_VALUE ? NAN : (float)values[c] / TIMESERIES_VALUE_SCALE;
+        }
+        if (!visitor(timestamp, output))
+        {
+            stop = true;
+            return;
+        }
+    }
+}
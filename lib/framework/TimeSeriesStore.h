@@ -0,0 +1,133 @@
+#ifndef TimeSeriesStore_h
+#define TimeSeriesStore_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <PersistenceScheduler.h>
+
+/*
+ * Append-only storage for samples of a fixed set of channels, e.g. sensor readings.
+ *
+ * Samples are compressed into TIMESERIES_BLOCK_SIZE blocks. Timestamps are stored as delta-of-delta
+ * and values as deltas of fixed point integers (1 / TIMESERIES_VALUE_SCALE), both in Gorilla style
+ * variable bit fields. A regular series costs a few bits per channel and sample. Blocks are collected
+ * in segment files of TIMESERIES_SEGMENT_BLOCKS blocks. A store gets budgetShare percent of the log
+ * budget of the file system (see FSUsage::budget()) and the oldest segment is deleted once the
+ * segments exceed it, so the flash use is bounded. If a write fails anyway because the file system is
+ * full, the oldest segment is deleted and the write is retried.
+ *
+ * The block being filled lives in RAM. It is written to its slot every TIMESERIES_SYNC_INTERVAL_MS
+ * through the PersistenceScheduler, and before restarts, sleep and OTA updates.
+ *
+ * Block layout (little endian):
+ *   u16 magic, u8 channels, u8 version, u16 samples, u16 payload bits, u32 first timestamp,
+ *   u32 last timestamp, followed by the bit stream
+ */
+
+#ifndef TIMESERIES_BLOCK_SIZE
+#define TIMESERIES_BLOCK_SIZE 512
+#endif
+
+// 4 kB, one LittleFS block
+#ifndef TIMESERIES_SEGMENT_BLOCKS
+#define TIMESERIES_SEGMENT_BLOCKS 8
+#endif
+
+// at least two segments are kept, so rotating never empties a store
+#define TIMESERIES_MIN_SEGMENTS 2
+
+#ifndef TIMESERIES_SYNC_INTERVAL_MS
+#define TIMESERIES_SYNC_INTERVAL_MS 300000
+#endif
+
+// enough for min, max and average of 4 sensors
+#define TIMESERIES_MAX_CHANNELS 12
+#define TIMESERIES_VALUE_SCALE 100
+#define TIMESERIES_BLOCK_MAGIC 0x5354
+#define TIMESERIES_BLOCK_VERSION 1
+
+// called for every sample in the range, return false to stop the query
+typedef std::function<bool(uint32_t timestamp, const float *values)> TimeSeriesVisitor;
+
+class TimeSeriesStore
+{
+public:
+    TimeSeriesStore(FS *fs, const char *directory, uint8_t channels, uint8_t budgetShare);
+
+    // the file system has to be mounted and FSUsage started
+    void begin();
+
+    // timestamps are seconds and have to increase, older samples are dropped
+    bool append(uint32_t timestamp, const float *values);
+
+    // visits samples with from <= timestamp <= to in order
+    void query(uint32_t from, uint32_t to, TimeSeriesVisitor visitor);
+
+    // writes the open block to flash
+    bool sync();
+
+    uint8_t channels() { return _channels; }
+    uint32_t firstTimestamp() { return _firstTimestamp; }
+    uint32_t lastTimestamp() { return _lastTimestamp; }
+    size_t flashBytes();
+
+private:
+    struct __attribute__((packed)) BlockHeader
+    {
+        uint16_t magic;
+        uint8_t channels;
+        uint8_t version;
+        uint16_t count;
+        uint16_t bits;
+        uint32_t firstTimestamp;
+        uint32_t lastTimestamp;
+    };
+
+    FS *_fs;
+    String _directory;
+    uint8_t _channels;
+    uint8_t _budgetShare;
+    uint32_t _maxSegments;
+    SemaphoreHandle_t _mutex;
+    persistence_id_t _persistenceId;
+
+    uint32_t _firstSegment;
+    uint32_t _lastSegment;
+    uint32_t _openBlock;
+    int _readers;
+    uint32_t _firstTimestamp;
+    uint32_t _lastTimestamp;
+
+    // block being filled and the encoder state
+    uint8_t _block[TIMESERIES_BLOCK_SIZE];
+    uint32_t _lastDelta;
+    int32_t _lastValues[TIMESERIES_MAX_CHANNELS];
+    bool _unsynced;
+    bool _blockOnDisk;
+
+    String _segmentPath(uint32_t segment);
+    BlockHeader *_header() { return (BlockHeader *)_block; }
+    void _resetBlock();
+    bool _writeBlock();
+    void _sealBlock();
+    void _rotate();
+    bool _dropOldest();
+    void _readFirstTimestamp();
+    void _decodeBlock(const uint8_t *block, uint32_t from, uint32_t to, TimeSeriesVisitor &visitor, bool &stop);
+};
+
+#endif // end TimeSeriesStore_h
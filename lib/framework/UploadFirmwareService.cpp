@@ -13,8 +13,11 @@
  **/
 
 #include <UploadFirmwareService.h>
+#include <EventLog.h>
+#include <PersistenceScheduler.h>
 #include <esp_ota_ops.h>
 #include <esp_app_format.h>
+#include <mbedtls/sha256.h>
 
 using namespace std::placeholders; // for `_1` etc
 
@@ -22,6 +25,29 @@ static char md5[33] = "\0";
 
 static FileType fileType = ft_none;
 
+// rebuilds the image from the running firmware when a delta patch is uploaded
+static DeltaPatcher deltaPatcher;
+
+// state of the receive -> flash pipeline
+struct FlashChunk
+{
+    uint8_t *data;
+    size_t len;
+};
+
+static uint8_t *pipelineBuffers[2] = {nullptr, nullptr};
+static QueueHandle_t freeBuffers = nullptr;
+static QueueHandle_t fullBuffers = nullptr;
+static SemaphoreHandle_t writerDone = nullptr;
+static volatile bool writeFailed = false;
+static uint8_t *fillBuffer = nullptr;
+static size_t fillLength = 0;
+
+static mbedtls_sha256_context sha256Context;
+static char sha256[65] = "\0";
+static unsigned long otaStart = 0;
+static size_t otaBytes = 0;
+
 UploadFirmwareService::UploadFirmwareService(PsychicHttpServer *server,
                                              SecurityManager *securityManager) : _server(server),
                                                                                  _securityManager(securityManager)
@@ -51,7 +77,7 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
 {
     // quit if not authorized
     Authentication authentication = _securityManager->authenticateRequest(request);
-    if (!AuthenticationPredicates::IS_ADMIN(authentication))
+    if (!AuthenticationPredicates::CAN_UPDATE_FIRMWARE(authentication))
     {
         return handleError(request, 403); // forbidden
     }
@@ -70,6 +96,16 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
         {
             fileType = ft_firmware;
         }
+        else if (extension == "delta" && DeltaPatcher::isDelta(data, len) && len >= DELTA_HEADER_SIZE)
+        {
+            fileType = ft_delta;
+        }
+#ifdef EMBED_WWW_PARTITION
+        else if (extension == "www")
+        {
+            fileType = ft_www;
+        }
+#endif
         else if (extension == "md5")
         {
             fileType = ft_md5;
@@ -86,7 +122,37 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
             return handleError(request, 406); // Not Acceptable - unsupported file type
         }
 
-        if (fileType == ft_firmware)
+        // pending settings go to flash before the update competes for it and ends in a restart
+        PersistenceScheduler::flush();
+        EventLog::log(EventType::OTA_STARTED, EVENT_SOURCE_UPLOAD);
+
+        if (fileType == ft_delta)
+        {
+            // the patch header tells the size of the rebuilt image
+            if (!Update.begin(DeltaPatcher::newImageSize(data)))
+            {
+                return handleError(request, 507); // Insufficient Storage
+            }
+            if (strlen(md5) == 32)
+            {
+                Update.setMD5(md5);
+                md5[0] = '\0';
+            }
+            sha256[0] = '\0';
+
+            if (!beginPipeline())
+            {
+                Update.abort();
+                return handleError(request, 500);
+            }
+            if (!deltaPatcher.begin(std::bind(&UploadFirmwareService::pipelineWrite, this, _1, _2)))
+            {
+                endPipeline();
+                Update.abort();
+                return handleError(request, 500);
+            }
+        }
+        else if (fileType == ft_firmware)
         {
             // Check firmware header, 0xE9 magic offset 0 indicates esp bin, chip offset 12: esp32:0, S2:2, C3:5
 #if CONFIG_IDF_TARGET_ESP32 // ESP32/PICO-D4
@@ -123,28 +189,239 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
             {
                 return handleError(request, 507); // failed to begin, send an error response Insufficient Storage
             }
+
+            // optional sha256 of the image as query parameter, checked while the data flows in
+            if (!request->getParam("sha256", sha256, sizeof(sha256)) || strlen(sha256) != 64)
+            {
+                sha256[0] = '\0';
+            }
+
+            if (!beginPipeline())
+            {
+                Update.abort();
+                return handleError(request, 500);
+            }
         }
+#ifdef EMBED_WWW_PARTITION
+        else if (fileType == ft_www)
+        {
+            // an interface image goes straight to its partition, the firmware is left alone
+            if (!WWWPartition::beginUpdate(data, len))
+            {
+                return handleError(request, 400);
+            }
+            otaBytes = 0;
+            otaStart = millis();
+        }
+#endif
     }
 
     // if we haven't delt with an error, continue with the firmware update
     if (!request->_tempObject)
     {
-        if (Update.write(data, len) != len)
+#ifdef EMBED_WWW_PARTITION
+        if (fileType == ft_www)
         {
-            handleError(request, 500);
+            otaBytes += len;
+            if (!WWWPartition::writeUpdate(data, len))
+            {
+                WWWPartition::abortUpdate();
+                return handleError(request, 500);
+            }
+            if (final && !WWWPartition::endUpdate())
+            {
+                return handleError(request, 400);
+            }
+            return ESP_OK;
+        }
+#endif
+
+        bool written = fileType == ft_delta ? deltaPatcher.write(data, len) : pipelineWrite(data, len);
+        if (!written)
+        {
+            // a patch that doesn't fit the running firmware is the client's problem
+            bool patchError = fileType == ft_delta && !writeFailed;
+            deltaPatcher.abort();
+            endPipeline();
+            Update.abort();
+            return handleError(request, patchError ? 400 : 500);
         }
         if (final)
         {
+            if (fileType == ft_delta && !deltaPatcher.end())
+            {
+                endPipeline();
+                Update.abort();
+                return handleError(request, 400);
+            }
+            if (!endPipeline())
+            {
+                Update.abort();
+                return handleError(request, 500);
+            }
+
+            if (strlen(sha256) == 64)
+            {
+                unsigned char digest[32];
+                char hex[65];
+                mbedtls_sha256_finish_ret(&sha256Context, digest);
+                for (int i = 0; i < 32; i++)
+                {
+                    sprintf(hex + 2 * i, "%02x", digest[i]);
+                }
+
+                if (!String(sha256).equalsIgnoreCase(hex))
+                {
+                    ESP_LOGE("UploadFirmwareService", "SHA-256 mismatch, expected %s got %s", sha256, hex);
+                    sha256[0] = '\0';
+                    mbedtls_sha256_free(&sha256Context);
+                    Update.abort();
+                    return handleError(request, 400);
+                }
+                sha256[0] = '\0';
+            }
+            mbedtls_sha256_free(&sha256Context);
+
             if (!Update.end(true))
             {
                 handleError(request, 500);
             }
+
+            unsigned long duration = millis() - otaStart;
+            ESP_LOGI("UploadFirmwareService", "Received and flashed %u bytes in %lu ms (%lu kB/s)",
+                     otaBytes, duration, duration > 0 ? (unsigned long)(otaBytes / duration) : 0);
         }
     }
 
     return ESP_OK;
 }
 
+bool UploadFirmwareService::beginPipeline()
+{
+    pipelineBuffers[0] = (uint8_t *)malloc(OTA_PIPELINE_BUFFER_SIZE);
+    pipelineBuffers[1] = (uint8_t *)malloc(OTA_PIPELINE_BUFFER_SIZE);
+    freeBuffers = xQueueCreate(2, sizeof(uint8_t *));
+    fullBuffers = xQueueCreate(2, sizeof(FlashChunk));
+    writerDone = xSemaphoreCreateBinary();
+
+    writeFailed = false;
+    fillLength = 0;
+    otaBytes = 0;
+    otaStart = millis();
+
+    if (pipelineBuffers[0] == nullptr || pipelineBuffers[1] == nullptr ||
+        freeBuffers == nullptr || fullBuffers == nullptr || writerDone == nullptr ||
+        xTaskCreate(flashWriterTask, "OTA Writer", OTA_WRITER_STACK_SIZE, nullptr, tskIDLE_PRIORITY + 2, nullptr) != pdPASS)
+    {
+        ESP_LOGE("UploadFirmwareService", "Could not set up OTA pipeline");
+        writeFailed = true;
+        endPipeline();
+        return false;
+    }
+
+    fillBuffer = pipelineBuffers[0];
+    xQueueSend(freeBuffers, &pipelineBuffers[1], 0);
+
+    mbedtls_sha256_init(&sha256Context);
+    mbedtls_sha256_starts_ret(&sha256Context, 0);
+
+    return true;
+}
+
+bool UploadFirmwareService::pipelineWrite(const uint8_t *data, size_t len)
+{
+    if (fillBuffer == nullptr || writeFailed)
+    {
+        return false;
+    }
+
+    // hash on the receiving side, so it overlaps with the flash writes
+    if (strlen(sha256) == 64)
+    {
+        mbedtls_sha256_update_ret(&sha256Context, data, len);
+    }
+    otaBytes += len;
+
+    while (len > 0)
+    {
+        size_t count = min(len, (size_t)OTA_PIPELINE_BUFFER_SIZE - fillLength);
+        memcpy(fillBuffer + fillLength, data, count);
+        fillLength += count;
+        data += count;
+        len -= count;
+
+        // hand the full buffer to the writer and continue in the other one
+        if (fillLength == OTA_PIPELINE_BUFFER_SIZE)
+        {
+            FlashChunk chunk = {fillBuffer, fillLength};
+            xQueueSend(fullBuffers, &chunk, portMAX_DELAY);
+            xQueueReceive(freeBuffers, &fillBuffer, portMAX_DELAY);
+            fillLength = 0;
+        }
+    }
+
+    return !writeFailed;
+}
+
+bool UploadFirmwareService::endPipeline()
+{
+    // flush what's left and tell the writer to stop
+    if (fullBuffers != nullptr && writerDone != nullptr && fillBuffer != nullptr)
+    {
+        if (fillLength > 0)
+        {
+            FlashChunk chunk = {fillBuffer, fillLength};
+            xQueueSend(fullBuffers, &chunk, portMAX_DELAY);
+        }
+        FlashChunk stop = {nullptr, 0};
+        xQueueSend(fullBuffers, &stop, portMAX_DELAY);
+        xSemaphoreTake(writerDone, portMAX_DELAY);
+    }
+
+    fillBuffer = nullptr;
+    fillLength = 0;
+
+    for (int i = 0; i < 2; i++)
+    {
+        free(pipelineBuffers[i]);
+        pipelineBuffers[i] = nullptr;
+    }
+    if (freeBuffers != nullptr)
+    {
+        vQueueDelete(freeBuffers);
+        freeBuffers = nullptr;
+    }
+    if (fullBuffers != nullptr)
+    {
+        vQueueDelete(fullBuffers);
+        fullBuffers = nullptr;
+    }
+    if (writerDone != nullptr)
+    {
+        vSemaphoreDelete(writerDone);
+        writerDone = nullptr;
+    }
+
+    return !writeFailed;
+}
+
+void UploadFirmwareService::flashWriterTask(void *param)
+{
+    FlashChunk chunk;
+    while (xQueueReceive(fullBuffers, &chunk, portMAX_DELAY) == pdTRUE && chunk.data != nullptr)
+    {
+        // once a write failed we only keep the buffers moving until the receiver notices
+        if (!writeFailed && Update.write(chunk.data, chunk.len) != chunk.len)
+        {
+            writeFailed = true;
+        }
+        xQueueSend(freeBuffers, &chunk.data, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(writerDone);
+    vTaskDelete(NULL);
+}
+
 esp_err_t UploadFirmwareService::uploadComplete(PsychicRequest *request)
 {
     // if we completed uploading a md5 file create a JSON response
@@ -163,7 +440,14 @@ esp_err_t UploadFirmwareService::uploadComplete(PsychicRequest *request)
     // if no error, send the success response
     if (!request->_tempObject)
     {
-        request->reply(200);
+        unsigned long duration = millis() - otaStart;
+        PsychicJsonResponse response = PsychicJsonResponse(request, false);
+        JsonObject root = response.getRoot();
+        root["bytes"] = otaBytes;
+        root["duration_ms"] = duration;
+        root["throughput_kBps"] = duration > 0 ? otaBytes / duration : 0; // bytes per ms
+        response.send();
+        EventLog::log(EventType::OTA_SUCCEEDED, EVENT_SOURCE_UPLOAD);
         RestartService::restartNow();
         return ESP_OK;
     }
@@ -188,12 +472,30 @@ esp_err_t UploadFirmwareService::handleError(PsychicRequest *request, int code)
     }
 
     // send the error code to the client and record the error code in the temp object
+    EventLog::log(EventType::OTA_FAILED, EVENT_SOURCE_UPLOAD, code);
     request->_tempObject = new int(code);
     return request->reply(code);
 }
 
 esp_err_t UploadFirmwareService::handleEarlyDisconnect()
 {
+#ifdef EMBED_WWW_PARTITION
+    if (fileType == ft_www)
+    {
+        WWWPartition::abortUpdate();
+        return ESP_OK;
+    }
+#endif
+
+    // stop the flash writer if it is still running
+    if (fillBuffer != nullptr)
+    {
+        deltaPatcher.abort();
+        endPipeline();
+        Update.abort();
+        return ESP_OK;
+    }
+
     // if updated has not ended on connection close, abort it
     if (!Update.end(true))
     {
@@ -23,14 +23,30 @@
 #include <PsychicHttp.h>
 #include <SecurityManager.h>
 #include <RestartService.h>
+#include <DeltaPatcher.h>
+
+#ifdef EMBED_WWW_PARTITION
+#include <WWWPartition.h>
+#endif
 
 #define UPLOAD_FIRMWARE_PATH "/rest/uploadFirmware"
 
+// Firmware is received into one buffer while the other one is written to flash
+#ifndef OTA_PIPELINE_BUFFER_SIZE
+#define OTA_PIPELINE_BUFFER_SIZE 4096
+#endif
+
+#ifndef OTA_WRITER_STACK_SIZE
+#define OTA_WRITER_STACK_SIZE 3072
+#endif
+
 enum FileType
 {
     ft_none = 0,
     ft_firmware = 1,
-    ft_md5 = 2
+    ft_md5 = 2,
+    ft_delta = 3,
+    ft_www = 4
 };
 
 class UploadFirmwareService
@@ -52,7 +68,14 @@ private:
                            bool final);
     esp_err_t uploadComplete(PsychicRequest *request);
     esp_err_t handleError(PsychicRequest *request, int code);
+
+protected:
     esp_err_t handleEarlyDisconnect();
+
+    bool beginPipeline();
+    bool pipelineWrite(const uint8_t *data, size_t len);
+    bool endPipeline();
+    static void flashWriterTask(void *param);
 };
 
 #endif // end UploadFirmwareService_h
@@ -0,0 +1,34 @@
+#ifndef WWWAsset_h
+#define WWWAsset_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <functional>
+
+// An embedded asset, either compiled into the firmware (WWWData.h) or mapped from the www partition
+struct WWWAsset
+{
+    const char *etag;
+    const uint8_t *gzip;
+    size_t gzipLength;
+    const uint8_t *brotli;
+    size_t brotliLength;
+    const uint8_t *identity;
+    size_t identityLength;
+};
+
+typedef std::function<void(const String &uri, const String &contentType, const WWWAsset &asset)> RouteRegistrationHandler;
+
+#endif // end WWWAsset_h
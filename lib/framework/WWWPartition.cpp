@@ -0,0 +1,246 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <WWWPartition.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+struct __attribute__((packed)) WWWImageHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t size;
+    uint32_t crc;
+};
+
+struct __attribute__((packed)) WWWImageEntry
+{
+    uint32_t path;
+    uint32_t mime;
+    uint32_t etag;
+    uint32_t gzip;
+    uint32_t gzipLength;
+    uint32_t brotli;
+    uint32_t brotliLength;
+    uint32_t identity;
+    uint32_t identityLength;
+};
+
+static const char *labels[] = {WWW_PARTITION_LABEL_A, WWW_PARTITION_LABEL_B};
+static const esp_partition_t *slots[2] = {nullptr, nullptr};
+static int served = -1;
+static const uint8_t *image = nullptr;
+static spi_flash_mmap_handle_t mapping;
+
+// state of an update
+static const esp_partition_t *updateSlot = nullptr;
+static WWWImageHeader updateHeader;
+static size_t updateOffset = 0;
+static uint32_t updateCrc = 0;
+
+static bool findSlots()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (slots[i] == nullptr)
+        {
+            slots[i] = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, labels[i]);
+        }
+    }
+    return slots[0] != nullptr && slots[1] != nullptr;
+}
+
+static bool validHeader(const WWWImageHeader &header, const esp_partition_t *slot)
+{
+    return header.magic == WWW_IMAGE_MAGIC && header.version == WWW_IMAGE_VERSION &&
+           header.size >= WWW_IMAGE_HEADER_SIZE + header.count * WWW_IMAGE_ENTRY_SIZE &&
+           header.size <= slot->size;
+}
+
+// all offsets have to stay inside the image, strings have to be terminated
+static bool validEntry(const WWWImageEntry &entry, size_t size)
+{
+    const uint32_t strings[] = {entry.path, entry.mime, entry.etag};
+    for (uint32_t offset : strings)
+    {
+        if (offset == 0 || offset >= size || memchr(image + offset, 0, size - offset) == nullptr)
+        {
+            return false;
+        }
+    }
+    return entry.gzip != 0 && entry.gzip + entry.gzipLength <= size &&
+           entry.brotli + entry.brotliLength <= size &&
+           entry.identity + entry.identityLength <= size;
+}
+
+static bool mapSlot(int slot)
+{
+    WWWImageHeader header;
+    if (esp_partition_read(slots[slot], 0, &header, sizeof(header)) != ESP_OK || !validHeader(header, slots[slot]))
+    {
+        ESP_LOGW("WWWPartition", "No interface image in partition %s", labels[slot]);
+        return false;
+    }
+
+    const void *mapped;
+    if (esp_partition_mmap(slots[slot], 0, header.size, SPI_FLASH_MMAP_DATA, &mapped, &mapping) != ESP_OK)
+    {
+        ESP_LOGE("WWWPartition", "Could not map partition %s", labels[slot]);
+        return false;
+    }
+    image = (const uint8_t *)mapped;
+
+    unsigned long start = millis();
+    uint32_t crc = esp_rom_crc32_le(0, image + WWW_IMAGE_HEADER_SIZE, header.size - WWW_IMAGE_HEADER_SIZE);
+    const WWWImageEntry *entries = (const WWWImageEntry *)(image + WWW_IMAGE_HEADER_SIZE);
+    bool valid = crc == header.crc;
+    for (uint16_t i = 0; valid && i < header.count; i++)
+    {
+        valid = validEntry(entries[i], header.size);
+    }
+    if (!valid)
+    {
+        ESP_LOGE("WWWPartition", "Interface image in partition %s is damaged", labels[slot]);
+        spi_flash_munmap(mapping);
+        image = nullptr;
+        return false;
+    }
+
+    ESP_LOGI("WWWPartition", "Mapped %u assets from %s, %u bytes, checked in %lu ms", header.count, labels[slot], header.size, millis() - start);
+    return true;
+}
+
+bool WWWPartition::begin()
+{
+    if (image != nullptr)
+    {
+        return true;
+    }
+    if (!findSlots())
+    {
+        ESP_LOGE("WWWPartition", "No partitions labeled %s and %s", WWW_PARTITION_LABEL_A, WWW_PARTITION_LABEL_B);
+        return false;
+    }
+
+    for (int slot = 0; slot < 2; slot++)
+    {
+        if (mapSlot(slot))
+        {
+            served = slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WWWPartition::registerRoutes(RouteRegistrationHandler handler)
+{
+    if (image == nullptr)
+    {
+        return;
+    }
+
+    const WWWImageHeader *header = (const WWWImageHeader *)image;
+    const WWWImageEntry *entries = (const WWWImageEntry *)(image + WWW_IMAGE_HEADER_SIZE);
+    for (uint16_t i = 0; i < header->count; i++)
+    {
+        const WWWImageEntry &entry = entries[i];
+        WWWAsset asset = {(const char *)image + entry.etag,
+                          image + entry.gzip, entry.gzipLength,
+                          entry.brotli ? image + entry.brotli : nullptr, entry.brotliLength,
+                          entry.identity ? image + entry.identity : nullptr, entry.identityLength};
+        handler(String((const char *)image + entry.path), String((const char *)image + entry.mime), asset);
+    }
+}
+
+size_t WWWPartition::imageSize()
+{
+    return image != nullptr ? ((const WWWImageHeader *)image)->size : 0;
+}
+
+bool WWWPartition::beginUpdate(const uint8_t *header, size_t len)
+{
+    if (!findSlots() || len < WWW_IMAGE_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    // never the slot being served, its assets stay mapped until the restart
+    updateSlot = slots[served == 0 ? 1 : 0];
+    memcpy(&updateHeader, header, sizeof(updateHeader));
+    if (!validHeader(updateHeader, updateSlot))
+    {
+        return false;
+    }
+
+    size_t eraseSize = (updateHeader.size + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE;
+    if (esp_partition_erase_range(updateSlot, 0, eraseSize) != ESP_OK)
+    {
+        return false;
+    }
+    updateOffset = 0;
+    updateCrc = 0;
+    return true;
+}
+
+bool WWWPartition::writeUpdate(const uint8_t *data, size_t len)
+{
+    if (updateOffset + len > updateHeader.size)
+    {
+        return false;
+    }
+
+    // the header is checked by its crc field, everything behind it goes into the crc. It is written
+    // last, until then the slot holds no valid image.
+    size_t skip = updateOffset < WWW_IMAGE_HEADER_SIZE ? min(len, (size_t)(WWW_IMAGE_HEADER_SIZE - updateOffset)) : 0;
+    updateCrc = esp_rom_crc32_le(updateCrc, data + skip, len - skip);
+
+    if (len > skip && esp_partition_write(updateSlot, updateOffset + skip, data + skip, len - skip) != ESP_OK)
+    {
+        return false;
+    }
+    updateOffset += len;
+    return true;
+}
+
+bool WWWPartition::endUpdate()
+{
+    if (updateOffset != updateHeader.size || updateCrc != updateHeader.crc)
+    {
+        ESP_LOGE("WWWPartition", "Interface image incomplete or damaged");
+        abortUpdate();
+        return false;
+    }
+    updateOffset = 0;
+
+    // switch slots, clearing bits needs no erase and leaves the served assets intact until the restart
+    if (esp_partition_write(updateSlot, 0, &updateHeader, sizeof(updateHeader)) != ESP_OK)
+    {
+        ESP_LOGE("WWWPartition", "Could not write the interface image header");
+        return false;
+    }
+    if (served >= 0)
+    {
+        uint32_t retired = 0;
+        esp_partition_write(slots[served], 0, &retired, sizeof(retired));
+    }
+    ESP_LOGI("WWWPartition", "Interface image with %u assets written to %s", updateHeader.count, updateSlot->label);
+    return true;
+}
+
+void WWWPartition::abortUpdate()
+{
+    // the header of the new image was never written and the served one is untouched
+    updateOffset = 0;
+}
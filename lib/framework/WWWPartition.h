@@ -0,0 +1,65 @@
+#ifndef WWWPartition_h
+#define WWWPartition_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <WWWAsset.h>
+
+/*
+ * Serves the interface from a data partition instead of arrays compiled into the firmware
+ * (-D EMBED_WWW_PARTITION). The image is built by scripts/www_image.py, memory mapped once and the
+ * responses point straight into the mapping, nothing is copied to RAM. A new image can be flashed
+ * with `pio run -t uploadwww` or uploaded as a .www file, without touching the firmware.
+ *
+ * There are two slots, WWW_PARTITION_LABEL_A and WWW_PARTITION_LABEL_B. An upload goes into the slot
+ * that is not served, and its header is written last, once the CRC of the whole image matched. Only
+ * then the magic of the served image is cleared, so a failed or interrupted upload leaves the current
+ * interface in place. If the power fails between the two writes both slots are valid and either one
+ * is served. `pio run -t uploadwww` flashes slot A and erases the header of slot B.
+ *
+ * Image layout (little endian, offsets from the start of the image, 0 if a variant is missing):
+ *   header: u32 magic, u16 version, u16 asset count, u32 image size, u32 crc32 of everything after the header
+ *   index:  per asset u32 path, mime type, etag, gzip, gzip length, brotli, brotli length, identity, identity length
+ *   followed by the NUL terminated strings and the 4 byte aligned asset data
+ */
+
+#ifndef WWW_PARTITION_LABEL_A
+#define WWW_PARTITION_LABEL_A "www0"
+#endif
+
+#ifndef WWW_PARTITION_LABEL_B
+#define WWW_PARTITION_LABEL_B "www1"
+#endif
+
+#define WWW_IMAGE_MAGIC 0x31575757 // "WWW1"
+#define WWW_IMAGE_VERSION 1
+#define WWW_IMAGE_HEADER_SIZE 16
+#define WWW_IMAGE_ENTRY_SIZE 36
+
+namespace WWWPartition
+{
+    // maps the image of a valid slot, false if the partitions are missing or no image is intact
+    bool begin();
+    void registerRoutes(RouteRegistrationHandler handler);
+    size_t imageSize();
+
+    // writes the image to the other slot, the new one is served after a restart
+    bool beginUpdate(const uint8_t *header, size_t len);
+    bool writeUpdate(const uint8_t *data, size_t len);
+    bool endUpdate();
+    void abortUpdate();
+}
+
+#endif // end WWWPartition_h
@@ -32,13 +32,15 @@ public:
                     PsychicHttpServer *server,
                     const char *webSocketPath,
                     SecurityManager *securityManager,
-                    AuthenticationPredicate authenticationPredicate = AuthenticationPredicates::IS_ADMIN) : _stateReader(stateReader),
-                                                                                                            _stateUpdater(stateUpdater),
-                                                                                                            _statefulService(statefulService),
-                                                                                                            _server(server),
-                                                                                                            _webSocketPath(webSocketPath),
-                                                                                                            _authenticationPredicate(authenticationPredicate),
-                                                                                                            _securityManager(securityManager)
+                    AuthenticationPredicate readPredicate = AuthenticationPredicates::IS_ADMIN,
+                    AuthenticationPredicate writePredicate = AuthenticationPredicates::IS_ADMIN) : _stateReader(stateReader),
+                                                                                                   _stateUpdater(stateUpdater),
+                                                                                                   _statefulService(statefulService),
+                                                                                                   _server(server),
+                                                                                                   _webSocketPath(webSocketPath),
+                                                                                                   _readPredicate(readPredicate),
+                                                                                                   _writePredicate(writePredicate),
+                                                                                                   _securityManager(securityManager)
     {
         _statefulService->addUpdateHandler(
             [&](const String &originId)
@@ -48,7 +50,8 @@ public:
 
     void begin()
     {
-        _webSocket.setFilter(_securityManager->filterRequest(_authenticationPredicate));
+        // connecting only needs read access, updates are checked per frame
+        _webSocket.setFilter(_securityManager->filterRequest(_readPredicate));
         _webSocket.onOpen(std::bind(&WebSocketServer::onWSOpen,
                                     this,
                                     std::placeholders::_1));
@@ -86,6 +89,14 @@ public:
         {
             ESP_LOGV("WebSocketServer", "ws[%s][%u] request: %s", request->client()->remoteIP().toString().c_str(), request->client()->socket(), (char *)frame->payload);
 
+            // cached per connection, the token is not verified again for every frame
+            Authentication authentication = _securityManager->authenticateClient(request->client()->socket());
+            if (!_writePredicate(authentication))
+            {
+                ESP_LOGW("WebSocketServer", "ws[%s][%u] not allowed to update the state", request->client()->remoteIP().toString().c_str(), request->client()->socket());
+                return ESP_OK;
+            }
+
             JsonDocument jsonDocument;
             DeserializationError error = deserializeJson(jsonDocument, (char *)frame->payload, frame->len);
 
@@ -108,7 +119,8 @@ private:
     JsonStateReader<T> _stateReader;
     JsonStateUpdater<T> _stateUpdater;
     StatefulService<T> *_statefulService;
-    AuthenticationPredicate _authenticationPredicate;
+    AuthenticationPredicate _readPredicate;
+    AuthenticationPredicate _writePredicate;
     SecurityManager *_securityManager;
     PsychicHttpServer *_server;
     PsychicWebSocketHandler _webSocket;
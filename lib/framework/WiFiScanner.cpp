@@ -25,14 +25,14 @@ void WiFiScanner::begin()
     _server->on(SCAN_NETWORKS_SERVICE_PATH,
                 HTTP_GET,
                 _securityManager->wrapRequest(std::bind(&WiFiScanner::scanNetworks, this, std::placeholders::_1),
-                                              AuthenticationPredicates::IS_ADMIN));
+                                              AuthenticationPredicates::CAN_CHANGE_SETTINGS));
 
     ESP_LOGV("WiFiScanner", "Registered GET endpoint: %s", SCAN_NETWORKS_SERVICE_PATH);
 
     _server->on(LIST_NETWORKS_SERVICE_PATH,
                 HTTP_GET,
                 _securityManager->wrapRequest(std::bind(&WiFiScanner::listNetworks, this, std::placeholders::_1),
-                                              AuthenticationPredicates::IS_ADMIN));
+                                              AuthenticationPredicates::CAN_CHANGE_SETTINGS));
 
     ESP_LOGV("WiFiScanner", "Registered GET endpoint: %s", LIST_NETWORKS_SERVICE_PATH);
 }
@@ -20,8 +20,8 @@ WiFiSettingsService::WiFiSettingsService(PsychicHttpServer *server,
                                          EventSocket *socket) : _server(server),
                                                                 _securityManager(securityManager),
                                                                 _httpEndpoint(WiFiSettings::read, WiFiSettings::update, this, server, WIFI_SETTINGS_SERVICE_PATH, securityManager,
-                                                                              AuthenticationPredicates::IS_ADMIN),
-                                                                _fsPersistence(WiFiSettings::read, WiFiSettings::update, this, fs, WIFI_SETTINGS_FILE), _lastConnectionAttempt(0),
+                                                                              AuthenticationPredicates::CAN_CHANGE_SETTINGS),
+                                                                _fsPersistence(WiFiSettings::read, WiFiSettings::update, this, fs, WIFI_SETTINGS_FILE, SettingsFormat::MSGPACK), _lastConnectionAttempt(0),
                                                                 _socket(socket)
 {
     addUpdateHandler([&](const String &originId)
@@ -37,6 +37,8 @@ void WiFiSettingsService::initWiFi()
     WiFi.persistent(false);
     WiFi.setAutoReconnect(false);
 
+    WiFi.onEvent(std::bind(&WiFiSettingsService::onStationModeGotIP, this, std::placeholders::_1, std::placeholders::_2),
+                 WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_GOT_IP);
     WiFi.onEvent(
         std::bind(&WiFiSettingsService::onStationModeDisconnected, this, std::placeholders::_1, std::placeholders::_2),
         WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
@@ -247,8 +249,20 @@ void WiFiSettingsService::updateRSSI()
     _socket->emitEvent(EVENT_RSSI, jsonObject);
 }
 
+void WiFiSettingsService::onStationModeGotIP(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    _stationConnected = true;
+    EventLog::log(EventType::WIFI_CONNECTED, 0, WiFi.RSSI());
+}
+
 void WiFiSettingsService::onStationModeDisconnected(WiFiEvent_t event, WiFiEventInfo_t info)
 {
+    // failed connection attempts are not worth a record each
+    if (_stationConnected)
+    {
+        _stationConnected = false;
+        EventLog::log(EventType::WIFI_DISCONNECTED, 0, info.wifi_sta_disconnected.reason);
+    }
     WiFi.disconnect(true);
 }
 
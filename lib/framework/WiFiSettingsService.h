@@ -18,6 +18,7 @@
 #include <WiFi.h>
 #include <WiFiMulti.h>
 #include <SettingValue.h>
+#include <EventLog.h>
 #include <StatefulService.h>
 #include <EventSocket.h>
 #include <FSPersistence.h>
@@ -227,6 +228,8 @@ private:
     unsigned long _lastRssiUpdate;
 
     bool _stopping;
+    bool _stationConnected = false;
+    void onStationModeGotIP(WiFiEvent_t event, WiFiEventInfo_t info);
     void onStationModeDisconnected(WiFiEvent_t event, WiFiEventInfo_t info);
     void onStationModeStop(WiFiEvent_t event, WiFiEventInfo_t info);
 
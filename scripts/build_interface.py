@@ -17,9 +17,17 @@ from shutil import copytree, rmtree, copyfileobj
 from os.path import exists, getmtime
 import os
 import gzip
+import hashlib
 import mimetypes
 import glob
 from datetime import datetime
+import csv
+import sys
+
+try:
+    import brotli
+except ImportError:
+    brotli = None
 
 Import("env")
 
@@ -31,6 +39,10 @@ output_file = project_dir + "/lib/framework/WWWData.h"
 source_www_dir = interface_dir + "/src"
 build_dir = interface_dir + "/build"
 filesystem_dir = project_dir + "/data/www"
+image_file = env.subst("$BUILD_DIR") + "/www.bin"
+
+sys.path.insert(0, project_dir + "/scripts")
+import www_image
 
 
 def find_latest_timestamp_for_app():
@@ -40,10 +52,11 @@ def find_latest_timestamp_for_app():
 
 
 def should_regenerate_output_file():
-    if not flag_exists("EMBED_WWW") or not exists(output_file):
+    target_file = image_file if flag_exists("EMBED_WWW_PARTITION") else output_file
+    if not (flag_exists("EMBED_WWW") or flag_exists("EMBED_WWW_PARTITION")) or not exists(target_file):
         return True
     last_source_change = find_latest_timestamp_for_app()
-    last_build = getmtime(output_file)
+    last_build = getmtime(target_file)
 
     print(
         f"Newest file: {datetime.fromtimestamp(last_source_change)}, output file: {datetime.fromtimestamp(last_build)}"
@@ -89,6 +102,10 @@ def build_webapp():
 
 
 def embed_webapp():
+    if flag_exists("EMBED_WWW_PARTITION"):
+        print("Packing interface into the www partition image")
+        build_partition_image()
+        return
     if flag_exists("EMBED_WWW"):
         print("Converting interface to PROGMEM")
         build_progmem()
@@ -96,11 +113,27 @@ def embed_webapp():
     add_app_to_filesystem()
 
 
+def write_progmem_array(progmem, asset_var, file_data):
+    progmem.write(f"const uint8_t {asset_var}[] = {{\n\t")
+    for i, byte in enumerate(file_data):
+        if i and not (i % 16):
+            progmem.write("\n\t")
+        progmem.write(f"0x{byte:02X},")
+    progmem.write("\n};\n\n")
+
+
 def build_progmem():
     mimetypes.init()
+
+    # Optional variants: brotli for browsers that accept it, identity for clients without gzip support
+    embed_brotli = flag_exists("EMBED_WWW_BROTLI")
+    embed_identity = flag_exists("EMBED_WWW_IDENTITY")
+    if embed_brotli and brotli is None:
+        print("EMBED_WWW_BROTLI is set but the brotli module is missing (pip install brotli), skipping brotli variants")
+        embed_brotli = False
+
     with open(output_file, "w") as progmem:
-        progmem.write("#include <functional>\n")
-        progmem.write("#include <Arduino.h>\n")
+        progmem.write("#include <WWWAsset.h>\n\n")
 
         assetMap = {}
 
@@ -111,26 +144,35 @@ def build_progmem():
             )
             print(f"Converting {asset_path}")
 
-            asset_var = f"ESP_SVELTEKIT_DATA_{idx}"
+            raw_data = path.read_bytes()
+            asset = {
+                "mime": asset_mime,
+                "etag": hashlib.sha256(raw_data).hexdigest()[:16],
+                "gzip": (f"ESP_SVELTEKIT_DATA_{idx}", None),
+                "br": ("nullptr", 0),
+                "identity": ("nullptr", 0),
+            }
+
             progmem.write(f"// {asset_path}\n")
-            progmem.write(f"const uint8_t {asset_var}[] = {{\n\t")
-            file_data = gzip.compress(path.read_bytes())
+            file_data = gzip.compress(raw_data)
+            write_progmem_array(progmem, asset["gzip"][0], file_data)
+            asset["gzip"] = (asset["gzip"][0], len(file_data))
 
-            for i, byte in enumerate(file_data):
-                if i and not (i % 16):
-                    progmem.write("\n\t")
-                progmem.write(f"0x{byte:02X},")
+            if embed_brotli:
+                br_data = brotli.compress(raw_data)
+                # only worth the flash if it actually beats gzip
+                if len(br_data) < len(file_data):
+                    asset_var = f"ESP_SVELTEKIT_DATA_{idx}_BR"
+                    write_progmem_array(progmem, asset_var, br_data)
+                    asset["br"] = (asset_var, len(br_data))
 
-            progmem.write("\n};\n\n")
-            assetMap[asset_path] = {
-                "name": asset_var,
-                "mime": asset_mime,
-                "size": len(file_data),
-            }
+            if embed_identity:
+                asset_var = f"ESP_SVELTEKIT_DATA_{idx}_IDENTITY"
+                write_progmem_array(progmem, asset_var, raw_data)
+                asset["identity"] = (asset_var, len(raw_data))
+
+            assetMap[asset_path] = asset
 
-        progmem.write(
-            "typedef std::function<void(const String& uri, const String& contentType, const uint8_t * content, size_t len)> RouteRegistrationHandler;\n\n"
-        )
         progmem.write("class WWWData {\n")
         progmem.write("\tpublic:\n")
         progmem.write(
@@ -138,14 +180,44 @@ def build_progmem():
         )
 
         for asset_path, asset in assetMap.items():
+            variants = ", ".join(
+                f"{name}, {size}" for name, size in (asset["gzip"], asset["br"], asset["identity"])
+            )
             progmem.write(
-                f'\t\t\thandler("/{asset_path}", "{asset["mime"]}", {asset["name"]}, {asset["size"]});\n'
+                f'\t\t\thandler("/{asset_path}", "{asset["mime"]}", WWWAsset{{"{asset["etag"]}", {variants}}});\n'
             )
 
         progmem.write("\t\t}\n")
         progmem.write("};\n\n")
 
 
+def partition_offset(label):
+    partitions = env.BoardConfig().get("build.partitions", "")
+    path = os.path.join(project_dir, partitions)
+    if not exists(path):
+        return None
+    with open(path) as table:
+        for row in csv.reader(line for line in table if not line.lstrip().startswith("#")):
+            if row and row[0].strip() == label:
+                return row[3].strip(), int(row[4].strip(), 0)
+    return None
+
+
+def build_partition_image():
+    embed_brotli = flag_exists("EMBED_WWW_BROTLI")
+    if embed_brotli and www_image.brotli is None:
+        print("EMBED_WWW_BROTLI is set but the brotli module is missing (pip install brotli), skipping brotli variants")
+        embed_brotli = False
+
+    image = www_image.build(build_dir, embed_brotli, flag_exists("EMBED_WWW_IDENTITY"))
+    partition = partition_offset("www0")
+    www_image.verify(image, partition[1] if partition else None)
+    os.makedirs(os.path.dirname(image_file), exist_ok=True)
+    with open(image_file, "wb") as file:
+        file.write(image)
+    print(f"Interface image {image_file}: {len(image)} bytes")
+
+
 def add_app_to_filesystem():
     build_path = Path(build_dir)
     www_path = Path(filesystem_dir)
@@ -160,6 +232,24 @@ def add_app_to_filesystem():
     env.Execute("pio run --target uploadfs")
 
 
+if flag_exists("EMBED_WWW_PARTITION"):
+    # flashes only the interface to slot A and retires slot B, the firmware stays as it is
+    partition = partition_offset("www0")
+    other = partition_offset("www1")
+    if partition and other:
+        env.AddCustomTarget(
+            name="uploadwww",
+            dependencies=None,
+            actions=[
+                f'"$PYTHONEXE" "$UPLOADER" --chip $BOARD_MCU --port "$UPLOAD_PORT" --baud $UPLOAD_SPEED write_flash {partition[0]} "{image_file}"',
+                f'"$PYTHONEXE" "$UPLOADER" --chip $BOARD_MCU --port "$UPLOAD_PORT" --baud $UPLOAD_SPEED erase_region {other[0]} 0x1000',
+            ],
+            title="Upload www",
+            description="Flash the interface image to the www0 partition",
+        )
+    else:
+        print("EMBED_WWW_PARTITION is set but the partition table has no www0 and www1 partitions")
+
 print("running: build_interface.py")
 if should_regenerate_output_file():
     build_webapp()
@@ -0,0 +1,176 @@
+#   ESP32 SvelteKit --
+#
+#   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+#   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+#   https://github.com/theelims/ESP32-sveltekit
+#
+#   Copyright (C) 2023 - 2024 theelims
+#
+#   All Rights Reserved. This software may be modified and distributed under
+#   the terms of the LGPL v3 license. See the LICENSE file for details.
+
+"""
+Creates delta OTA patches for lib/framework/DeltaPatcher.
+
+    python scripts/delta_ota.py create old.bin new.bin firmware.delta
+    python scripts/delta_ota.py apply old.bin firmware.delta rebuilt.bin
+    python scripts/delta_ota.py verify old.bin new.bin firmware.delta
+
+old.bin must be the exact image running on the device, the patch is rejected otherwise.
+Uses bsdiff4 for the matching if it is installed, a simpler built-in matcher otherwise.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+try:
+    import bsdiff4.core as bsdiff_core
+except ImportError:
+    bsdiff_core = None
+
+MAGIC = b"ESPD"
+VERSION = 1
+# deflate window, the device allocates 1 << WINDOW_BITS bytes for it
+WINDOW_BITS = 12
+HEADER = struct.Struct("<4sHBBII32s32s")
+
+BLOCK = 16
+MAX_CANDIDATES = 8
+MIN_MATCH = 32
+
+
+def _extend(old, new, o, n):
+    # bsdiff style approximate extension: keep going while more bytes match than not
+    score = best_score = best = k = 0
+    limit = min(len(old) - o, len(new) - n)
+    while k < limit:
+        score += 1 if old[o + k] == new[n + k] else -1
+        k += 1
+        if score > best_score:
+            best_score = score
+            best = k
+        elif score < best_score - 64:
+            break
+    return best
+
+
+def _builtin_diff(old, new):
+    index = {}
+    for pos in range(0, len(old) - BLOCK + 1, 4):
+        candidates = index.setdefault(old[pos:pos + BLOCK], [])
+        if len(candidates) < MAX_CANDIDATES:
+            candidates.append(pos)
+
+    records = []
+    cur_new = cur_old = cur_len = 0
+    n = 0
+    while n <= len(new) - BLOCK:
+        best_old = best_len = 0
+        for o in index.get(new[n:n + BLOCK], ()):
+            length = _extend(old, new, o, n)
+            if length > best_len:
+                best_old, best_len = o, length
+        if best_len < MIN_MATCH:
+            n += 1
+            continue
+
+        diff_end = cur_new + cur_len
+        records.append((cur_new, cur_old, cur_len, n - diff_end, best_old - (cur_old + cur_len)))
+        cur_new, cur_old, cur_len = n, best_old, best_len
+        n += best_len
+    records.append((cur_new, cur_old, cur_len, len(new) - cur_new - cur_len, 0))
+
+    control, diff, extra = [], bytearray(), bytearray()
+    for new_pos, old_pos, diff_len, extra_len, seek in records:
+        diff += bytes((new[new_pos + i] - old[old_pos + i]) & 0xFF for i in range(diff_len))
+        extra += new[new_pos + diff_len:new_pos + diff_len + extra_len]
+        control.append((diff_len, extra_len, seek))
+    return control, bytes(diff), bytes(extra)
+
+
+def create(old, new):
+    if bsdiff_core is not None:
+        control, diff, extra = bsdiff_core.diff(old, new)
+    else:
+        control, diff, extra = _builtin_diff(old, new)
+
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -WINDOW_BITS)
+    body = bytearray()
+    diff_pos = extra_pos = 0
+    for diff_len, extra_len, seek in control:
+        body += compressor.compress(struct.pack("<IIi", diff_len, extra_len, seek))
+        body += compressor.compress(diff[diff_pos:diff_pos + diff_len])
+        body += compressor.compress(extra[extra_pos:extra_pos + extra_len])
+        diff_pos += diff_len
+        extra_pos += extra_len
+    body += compressor.flush()
+
+    header = HEADER.pack(MAGIC, VERSION, WINDOW_BITS, 0, len(old), len(new),
+                         hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return header + bytes(body)
+
+
+def apply(old, patch):
+    magic, version, window_bits, _, old_size, new_size, old_sha, new_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a delta patch")
+    if old_size != len(old) or hashlib.sha256(old).digest() != old_sha:
+        raise ValueError("patch was not made for this image")
+
+    body = zlib.decompressobj(-window_bits).decompress(patch[HEADER.size:])
+    new = bytearray()
+    pos = old_pos = 0
+    while len(new) < new_size:
+        diff_len, extra_len, seek = struct.unpack_from("<IIi", body, pos)
+        pos += 12
+        new += bytes((body[pos + i] + old[old_pos + i]) & 0xFF for i in range(diff_len))
+        pos += diff_len
+        old_pos += diff_len
+        new += body[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += seek
+
+    if hashlib.sha256(new).digest() != new_sha:
+        raise ValueError("patched image does not match its checksum")
+    return bytes(new)
+
+
+def _read(path):
+    with open(path, "rb") as file:
+        return file.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Delta OTA patches for ESP32 SvelteKit")
+    sub = parser.add_subparsers(dest="command", required=True)
+    for name, args in (("create", ("old", "new", "patch")),
+                       ("apply", ("old", "patch", "out")),
+                       ("verify", ("old", "new", "patch"))):
+        cmd = sub.add_parser(name)
+        for arg in args:
+            cmd.add_argument(arg)
+    args = parser.parse_args()
+
+    old = _read(args.old)
+    if args.command == "create":
+        new = _read(args.new)
+        patch = create(old, new)
+        apply(old, patch)
+        with open(args.patch, "wb") as file:
+            file.write(patch)
+        print("Delta patch %s: %d bytes for a %d byte image, %d bytes (%.1f %%) saved"
+              % (args.patch, len(patch), len(new), len(new) - len(patch), 100.0 * (len(new) - len(patch)) / len(new)))
+    elif args.command == "apply":
+        with open(args.out, "wb") as file:
+            file.write(apply(old, _read(args.patch)))
+    else:
+        if apply(old, _read(args.patch)) != _read(args.new):
+            sys.exit("Patch does not rebuild " + args.new)
+        print("Patch OK")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,160 @@
+#   ESP32 SvelteKit --
+#
+#   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+#   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+#   https://github.com/theelims/ESP32-sveltekit
+#
+#   Copyright (C) 2023 - 2024 theelims
+#
+#   All Rights Reserved. This software may be modified and distributed under
+#   the terms of the LGPL v3 license. See the LICENSE file for details.
+
+"""
+Builds the interface image for the www partition, see lib/framework/WWWPartition.h.
+
+    python scripts/www_image.py build interface/build www.bin [--brotli] [--identity] [--size 0x60000]
+    python scripts/www_image.py verify www.bin [--size 0x60000]
+
+build_interface.py calls this with -D EMBED_WWW_PARTITION. Flash the image with `pio run -t uploadwww`
+or upload www.bin renamed to .www on the firmware update page.
+"""
+
+import argparse
+import gzip
+import hashlib
+import mimetypes
+import struct
+import sys
+import zlib
+from pathlib import Path
+
+try:
+    import brotli
+except ImportError:
+    brotli = None
+
+MAGIC = 0x31575757  # "WWW1"
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<9I")
+ALIGN = 4
+
+
+def _align(data):
+    data.extend(b"\0" * (-len(data) % ALIGN))
+
+
+def build(build_dir, embed_brotli=False, embed_identity=False):
+    mimetypes.init()
+    assets = []
+    for path in sorted(Path(build_dir).rglob("*.*")):
+        asset_path = path.relative_to(build_dir).as_posix()
+        raw_data = path.read_bytes()
+        variants = [gzip.compress(raw_data, mtime=0), None, None]
+        if embed_brotli:
+            br_data = brotli.compress(raw_data)
+            # only worth the flash if it actually beats gzip
+            if len(br_data) < len(variants[0]):
+                variants[1] = br_data
+        if embed_identity:
+            variants[2] = raw_data
+        assets.append({
+            "path": "/" + asset_path,
+            "mime": mimetypes.guess_type(asset_path)[0] or "application/octet-stream",
+            "etag": hashlib.sha256(raw_data).hexdigest()[:16],
+            "variants": variants,
+        })
+
+    # header and index first, then strings, then the asset data
+    image = bytearray(HEADER.size + ENTRY.size * len(assets))
+    entries = []
+    for asset in assets:
+        offsets = []
+        for key in ("path", "mime", "etag"):
+            offsets.append(len(image))
+            image.extend(asset[key].encode() + b"\0")
+        entries.append(offsets)
+    for asset, offsets in zip(assets, entries):
+        for variant in asset["variants"]:
+            _align(image)
+            offsets.extend((len(image), len(variant)) if variant is not None else (0, 0))
+            if variant is not None:
+                image.extend(variant)
+    _align(image)
+
+    for i, offsets in enumerate(entries):
+        ENTRY.pack_into(image, HEADER.size + i * ENTRY.size, *offsets)
+    HEADER.pack_into(image, 0, MAGIC, VERSION, len(assets), len(image), zlib.crc32(image[HEADER.size:]))
+    return bytes(image)
+
+
+def _string(image, offset):
+    end = image.index(b"\0", offset)
+    return image[offset:end].decode()
+
+
+def verify(image, size=None):
+    """Checks the image like the device does and returns its assets as (path, mime, etag, lengths)."""
+    if len(image) < HEADER.size:
+        raise ValueError("image too short")
+    magic, version, count, length, crc = HEADER.unpack_from(image)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a www image")
+    if length != len(image) or length < HEADER.size + count * ENTRY.size:
+        raise ValueError("image size %d does not match header %d" % (len(image), length))
+    if size is not None and length > size:
+        raise ValueError("image of %d bytes does not fit the %d byte partition" % (length, size))
+    if zlib.crc32(image[HEADER.size:]) != crc:
+        raise ValueError("crc mismatch")
+
+    assets = []
+    for i in range(count):
+        path, mime, etag, gz, gz_len, br, br_len, ident, ident_len = ENTRY.unpack_from(image, HEADER.size + i * ENTRY.size)
+        if gz == 0:
+            raise ValueError("asset %d has no gzip variant" % i)
+        for offset, variant_len in ((gz, gz_len), (br, br_len), (ident, ident_len)):
+            if offset + variant_len > length:
+                raise ValueError("asset %d points outside the image" % i)
+        data = gzip.decompress(image[gz:gz + gz_len])
+        etag_value = _string(image, etag)
+        if hashlib.sha256(data).hexdigest()[:16] != etag_value:
+            raise ValueError("asset %s does not match its etag" % _string(image, path))
+        assets.append((_string(image, path), _string(image, mime), etag_value, (gz_len, br_len, ident_len)))
+    return assets
+
+
+def main():
+    parser = argparse.ArgumentParser(description="www partition images for ESP32 SvelteKit")
+    sub = parser.add_subparsers(dest="command", required=True)
+    cmd = sub.add_parser("build")
+    cmd.add_argument("build_dir")
+    cmd.add_argument("image")
+    cmd.add_argument("--brotli", action="store_true")
+    cmd.add_argument("--identity", action="store_true")
+    cmd.add_argument("--size", type=lambda value: int(value, 0))
+    cmd = sub.add_parser("verify")
+    cmd.add_argument("image")
+    cmd.add_argument("--size", type=lambda value: int(value, 0))
+    args = parser.parse_args()
+
+    if args.command == "build":
+        if args.brotli and brotli is None:
+            sys.exit("--brotli needs the brotli module (pip install brotli)")
+        image = build(args.build_dir, args.brotli, args.identity)
+        with open(args.image, "wb") as file:
+            file.write(image)
+    else:
+        with open(args.image, "rb") as file:
+            image = file.read()
+
+    try:
+        assets = verify(image, args.size)
+    except ValueError as error:
+        sys.exit("Invalid image %s: %s" % (args.image, error))
+    for path, mime, etag, lengths in assets:
+        print("%-60s %-24s %s %s" % (path, mime, etag, "/".join(str(length) for length in lengths)))
+    print("Image %s OK: %d assets, %d bytes" % (args.image, len(assets), len(image)))
+
+
+if __name__ == "__main__":
+    main()
@@ -23,12 +23,15 @@ RelayStateService::RelayStateService(PsychicHttpServer *server,
                                                                                                          server,
                                                                                                          RELAY_SETTINGS_ENDPOINT_PATH,
                                                                                                          sveltekit->getSecurityManager(),
-                                                                                                         AuthenticationPredicates::IS_AUTHENTICATED),
+                                                                                                         AuthenticationPredicates::CAN_WRITE_RELAYS,
+                                                                                                         AuthenticationPredicates::CAN_READ_RELAYS),
                                                                                            _eventEndpoint(RelayState::read,
                                                                                                           RelayState::update,
                                                                                                           this,
                                                                                                           sveltekit->getSocket(),
-                                                                                                          RELAY_SETTINGS_EVENT),
+                                                                                                          RELAY_SETTINGS_EVENT,
+                                                                                                          AuthenticationPredicates::CAN_READ_RELAYS,
+                                                                                                          AuthenticationPredicates::CAN_WRITE_RELAYS),
                                                                                            _mqttEndpoint(RelayState::homeAssistRead,
                                                                                                          RelayState::homeAssistUpdate,
                                                                                                          this,
@@ -39,7 +42,8 @@ RelayStateService::RelayStateService(PsychicHttpServer *server,
                                                                                                             server,
                                                                                                             RELAY_SETTINGS_SOCKET_PATH,
                                                                                                             sveltekit->getSecurityManager(),
-                                                                                                            AuthenticationPredicates::IS_AUTHENTICATED),
+                                                                                                            AuthenticationPredicates::CAN_READ_RELAYS,
+                                                                                                            AuthenticationPredicates::CAN_WRITE_RELAYS),
                                                                                            _mqttClient(sveltekit->getMqttClient()),
                                                                                            _relayMqttSettingsService(relayMqttSettingsService)
 {
@@ -49,6 +53,9 @@ RelayStateService::RelayStateService(PsychicHttpServer *server,
         {false, "Pump", RELAY_PUMP, "pump"},
         {false, "Extra", RELAY_EXTRA, "extra"}};
 
+    // all relays start off
+    _switchedOn.assign(_state.relays.size(), false);
+
     // Configure pins for all relays
     for (const auto &relay : _state.relays)
     {
@@ -82,9 +89,16 @@ void RelayStateService::onConfigUpdated()
     log_d("RelayStateService::onConfigUpdated");
 
     // Update physical relay states
-    for (const auto &relay : _state.relays)
+    for (size_t i = 0; i < _state.relays.size(); i++)
     {
+        const auto &relay = _state.relays[i];
         digitalWrite(relay.pin, relay.state ? HIGH : LOW);
+
+        if (relay.state != _switchedOn[i])
+        {
+            _switchedOn[i] = relay.state;
+            EventLog::log(EventType::RELAY_SWITCHED, i, relay.state);
+        }
     }
 }
 
@@ -23,6 +23,7 @@
 #include <EventEndpoint.h>
 #include <WebSocketServer.h>
 #include <ESP32SvelteKit.h>
+#include <EventLog.h>
 
 #define DEFAULT_RELAY_STATE false
 #define OFF_STATE "OFF"
@@ -152,6 +153,8 @@ private:
     WebSocketServer<RelayState> _webSocketServer;
     PsychicMqttClient *_mqttClient;
     RelayMqttSettingsService *_relayMqttSettingsService;
+    // relay states as last switched
+    std::vector<bool> _switchedOn;
 
     void registerConfig();
     void onConfigUpdated();
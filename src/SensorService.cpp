@@ -0,0 +1,413 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <SensorService.h>
+#include <EventLog.h>
+#include <pinout.h>
+#include <vector>
+
+// 2020-01-01, samples are only stored once the clock is set by NTP
+#define VALID_TIME 1577836800
+
+static_assert(SENSOR_HISTORY_BUDGET_SHARE + SENSOR_ROLLUP_1M_BUDGET_SHARE + SENSOR_ROLLUP_15M_BUDGET_SHARE +
+                      SENSOR_ROLLUP_1H_BUDGET_SHARE + EVENT_LOG_BUDGET_SHARE <=
+                  100,
+              "The sensor history and the event log exceed the log budget");
+
+struct HistorySample
+{
+    uint32_t timestamp;
+    float value[SENSOR_CHANNELS];
+    float low[SENSOR_CHANNELS];
+    float high[SENSOR_CHANNELS];
+};
+
+struct SensorChannel
+{
+    const char *name;
+    uint8_t pin;
+    float offset;
+    float scale;
+};
+
+static const SensorChannel sensorChannels[SENSOR_CHANNELS] = {
+    {"temperature", SENSOR_TEMP, SENSOR_TEMP_OFFSET_MV, SENSOR_TEMP_SCALE},
+    {"ph", SENSOR_PH, SENSOR_PH_OFFSET_MV, SENSOR_PH_SCALE},
+    {"ec", SENSOR_EC, SENSOR_EC_OFFSET_MV, SENSOR_EC_SCALE},
+    {"level", SENSOR_LEVEL, SENSOR_LEVEL_OFFSET_MV, SENSOR_LEVEL_SCALE}};
+
+SensorService::SensorService(PsychicHttpServer *server, ESP32SvelteKit *sveltekit) : _server(server),
+                                                                                    _sveltekit(sveltekit),
+                                                                                    _securityManager(sveltekit->getSecurityManager()),
+                                                                                    _store(sveltekit->getFS(), SENSORS_HISTORY_DIRECTORY, SENSOR_CHANNELS, SENSOR_HISTORY_BUDGET_SHARE),
+                                                                                    // on 128 kB roughly a day of 1 minute, a week of 15 minute and weeks of hourly rollups
+                                                                                    _rollups{{sveltekit->getFS(), SENSORS_HISTORY_DIRECTORY "/1m", 60, SENSOR_ROLLUP_1M_BUDGET_SHARE},
+                                                                                             {sveltekit->getFS(), SENSORS_HISTORY_DIRECTORY "/15m", 900, SENSOR_ROLLUP_15M_BUDGET_SHARE},
+                                                                                             {sveltekit->getFS(), SENSORS_HISTORY_DIRECTORY "/1h", 3600, SENSOR_ROLLUP_1H_BUDGET_SHARE}},
+                                                                                    _timestamp(0),
+                                                                                    _lastSample(0)
+{
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        _values[c] = NAN;
+    }
+}
+
+void SensorService::begin()
+{
+    _store.begin();
+    for (SensorRollup &rollup : _rollups)
+    {
+        rollup.begin();
+    }
+
+    _server->on(SENSORS_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&SensorService::_sensors, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+
+    _server->on(SENSORS_HISTORY_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&SensorService::_history, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+
+    ESP_LOGV("SensorService", "Registered GET endpoint: %s", SENSORS_SERVICE_PATH);
+    ESP_LOGV("SensorService", "Registered GET endpoint: %s", SENSORS_HISTORY_SERVICE_PATH);
+
+    _sveltekit->addLoopFunction(std::bind(&SensorService::_loop, this));
+}
+
+void SensorService::_loop()
+{
+    unsigned long now = millis();
+    if (now - _lastSample >= SENSOR_SAMPLE_INTERVAL)
+    {
+        _lastSample = now;
+        _sample();
+    }
+}
+
+void SensorService::_sample()
+{
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        const SensorChannel &channel = sensorChannels[c];
+        _values[c] = (analogReadMilliVolts(channel.pin) - channel.offset) * channel.scale;
+    }
+
+    time_t now = time(nullptr);
+    if (now < VALID_TIME)
+    {
+        return;
+    }
+    _timestamp = now;
+    _store.append(_timestamp, _values);
+    for (SensorRollup &rollup : _rollups)
+    {
+        rollup.add(_timestamp, _values);
+    }
+}
+
+esp_err_t SensorService::_sensors(PsychicRequest *request)
+{
+    PsychicJsonResponse response = PsychicJsonResponse(request, false);
+    JsonObject root = response.getRoot();
+
+    root["timestamp"] = _timestamp;
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        if (!isnan(_values[c]))
+        {
+            root[sensorChannels[c].name] = _values[c];
+        }
+    }
+    root["history_first"] = _store.firstTimestamp();
+    root["history_last"] = _store.lastTimestamp();
+    root["history_bytes"] = _store.flashBytes();
+
+    return response.send();
+}
+
+
+/*
+ * Picks one sample per channel and bucket in the style of largest-triangle-three-buckets: the one
+ * spanning the largest triangle with the sample picked in the previous bucket and the average of the
+ * next bucket. The lowest and highest value of the bucket are reported with it, so short spikes stay
+ * visible. Buckets have a fixed duration, which allows to stream with only two buckets in memory.
+ */
+class HistoryDownsampler
+{
+public:
+    HistoryDownsampler(Print &out, uint32_t from, uint32_t width) : _out(out),
+                                                                    _from(from),
+                                                                    _width(width),
+                                                                    _bucket(0),
+                                                                    _first(true)
+    {
+        for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+        {
+            _picked[c] = false;
+        }
+    }
+
+    void add(const HistorySample &sample)
+    {
+        uint32_t bucket = (sample.timestamp - _from) / _width;
+        if (!_filling.empty() && bucket != _bucket)
+        {
+            if (!_pending.empty())
+            {
+                _pick(_pending, &_filling);
+            }
+            _pending.swap(_filling);
+            _filling.clear();
+        }
+        _bucket = bucket;
+
+        if (_filling.size() < SENSOR_HISTORY_MAX_BUCKET)
+        {
+            _filling.push_back(sample);
+            return;
+        }
+        HistorySample &last = _filling.back();
+        for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+        {
+            last.low[c] = isnan(last.low[c]) ? sample.low[c] : min(last.low[c], sample.low[c]);
+            last.high[c] = isnan(last.high[c]) ? sample.high[c] : max(last.high[c], sample.high[c]);
+        }
+    }
+
+    void finish()
+    {
+        if (!_pending.empty())
+        {
+            _pick(_pending, _filling.empty() ? nullptr : &_filling);
+        }
+        if (!_filling.empty())
+        {
+            _pick(_filling, nullptr);
+        }
+    }
+
+private:
+    Print &_out;
+    uint32_t _from;
+    uint32_t _width;
+    uint32_t _bucket;
+    bool _first;
+    std::vector<HistorySample> _pending;
+    std::vector<HistorySample> _filling;
+
+    // the sample picked in the previous bucket, relative to _from
+    bool _picked[SENSOR_CHANNELS];
+    float _pickedTime[SENSOR_CHANNELS];
+    float _pickedValue[SENSOR_CHANNELS];
+
+    void _pick(const std::vector<HistorySample> &bucket, const std::vector<HistorySample> *next)
+    {
+        _out.print(_first ? "[" : ",[");
+        _first = false;
+
+        for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+        {
+            // average of the next bucket, the bucket itself for the last one
+            const std::vector<HistorySample> &target = next != nullptr ? *next : bucket;
+            float sumTime = 0;
+            float sumValue = 0;
+            uint32_t count = 0;
+            for (const HistorySample &sample : target)
+            {
+                if (!isnan(sample.value[c]))
+                {
+                    sumTime += sample.timestamp - _from;
+                    sumValue += sample.value[c];
+                    count++;
+                }
+            }
+
+            const HistorySample *best = nullptr;
+            float bestArea = -1;
+            float low = NAN;
+            float high = NAN;
+            for (const HistorySample &sample : bucket)
+            {
+                if (isnan(sample.value[c]))
+                {
+                    continue;
+                }
+                low = isnan(low) ? sample.low[c] : min(low, sample.low[c]);
+                high = isnan(high) ? sample.high[c] : max(high, sample.high[c]);
+                if (!_picked[c] || count == 0)
+                {
+                    // nothing to compare with, the first sample starts the line
+                    if (best == nullptr)
+                    {
+                        best = &sample;
+                    }
+                    continue;
+                }
+
+                float elapsed = sample.timestamp - _from;
+                float area = fabsf((_pickedTime[c] - sumTime / count) * (sample.value[c] - _pickedValue[c]) -
+                                   (_pickedTime[c] - elapsed) * (sumValue / count - _pickedValue[c]));
+                if (area > bestArea)
+                {
+                    bestArea = area;
+                    best = &sample;
+                }
+            }
+
+            if (best == nullptr)
+            {
+                _out.print(c > 0 ? ",null,null,null,null" : "null,null,null,null");
+                continue;
+            }
+            _out.printf("%s%u,%.2f,%.2f,%.2f", c > 0 ? "," : "", best->timestamp, best->value[c], low, high);
+            _picked[c] = true;
+            _pickedTime[c] = best->timestamp - _from;
+            _pickedValue[c] = best->value[c];
+        }
+
+        _out.print("]");
+    }
+};
+
+SensorRollup::SensorRollup(FS *fs, const char *directory, uint32_t period, uint8_t budgetShare) : _store(fs, directory, 3 * SENSOR_CHANNELS, budgetShare),
+                                                                                                 _period(period)
+{
+    _reset();
+}
+
+void SensorRollup::add(uint32_t timestamp, const float *values)
+{
+    uint32_t start = timestamp - timestamp % _period;
+    if (_samples > 0 && start != _start)
+    {
+        float rollup[3 * SENSOR_CHANNELS];
+        for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+        {
+            rollup[3 * c] = _count[c] > 0 ? _min[c] : NAN;
+            rollup[3 * c + 1] = _count[c] > 0 ? _max[c] : NAN;
+            rollup[3 * c + 2] = _count[c] > 0 ? _sum[c] / _count[c] : NAN;
+        }
+        _store.append(_start, rollup);
+        _reset();
+    }
+
+    _start = start;
+    _samples++;
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        if (isnan(values[c]))
+        {
+            continue;
+        }
+        _min[c] = _count[c] > 0 ? min(_min[c], values[c]) : values[c];
+        _max[c] = _count[c] > 0 ? max(_max[c], values[c]) : values[c];
+        _sum[c] += values[c];
+        _count[c]++;
+    }
+}
+
+void SensorRollup::_reset()
+{
+    _start = 0;
+    _samples = 0;
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        _min[c] = 0;
+        _max[c] = 0;
+        _sum[c] = 0;
+        _count[c] = 0;
+    }
+}
+
+/*
+ * Streams the samples between from and to (unix seconds, default is the last day) reduced to at most
+ * points rows:
+ *
+ * {"channels":["temperature","ph","ec","level"],"resolution":900,
+ *  "points":[[t1,v1,low1,high1,t2,v2,low2,high2,...],...]}
+ *
+ * Each row holds timestamp, value, lowest and highest value of a bucket for every channel, or nulls
+ * if the channel has no valid sample in it. The data is read from the coarsest rollup that still has
+ * at least points periods in the range, resolution is its period in seconds.
+ */
+esp_err_t SensorService::_history(PsychicRequest *request)
+{
+    char value[16];
+    uint32_t to = request->getParam("to", value, sizeof(value)) ? strtoul(value, nullptr, 10) : _store.lastTimestamp();
+    uint32_t from = request->getParam("from", value, sizeof(value)) ? strtoul(value, nullptr, 10) : (to > 86400 ? to - 86400 : 0);
+    uint32_t points = request->getParam("points", value, sizeof(value)) ? strtoul(value, nullptr, 10) : SENSOR_HISTORY_DEFAULT_POINTS;
+    if (from > to || points == 0)
+    {
+        return request->reply(400);
+    }
+    points = min(points, (uint32_t)SENSOR_HISTORY_MAX_POINTS);
+    uint32_t width = max((uint32_t)1, (to - from) / points + 1);
+
+    SensorRollup *rollup = nullptr;
+    for (SensorRollup &level : _rollups)
+    {
+        if ((to - from) / level.period() >= points)
+        {
+            rollup = &level;
+        }
+    }
+
+    PsychicStreamResponse response = PsychicStreamResponse(request, "application/json");
+    if (response.beginSend() != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    response.print("{\"channels\":[");
+    for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+    {
+        response.printf("%s\"%s\"", c > 0 ? "," : "", sensorChannels[c].name);
+    }
+    response.printf("],\"resolution\":%u,\"points\":[", rollup != nullptr ? rollup->period() : SENSOR_SAMPLE_INTERVAL / 1000);
+
+    HistoryDownsampler downsampler(response, from, width);
+    HistorySample sample;
+    if (rollup != nullptr)
+    {
+        rollup->getStore()->query(from, to, [&](uint32_t timestamp, const float *values)
+                                  {
+            sample.timestamp = timestamp;
+            for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+            {
+                sample.low[c] = values[3 * c];
+                sample.high[c] = values[3 * c + 1];
+                sample.value[c] = values[3 * c + 2];
+            }
+            downsampler.add(sample);
+            return true; });
+    }
+    else
+    {
+        _store.query(from, to, [&](uint32_t timestamp, const float *values)
+                     {
+            sample.timestamp = timestamp;
+            for (uint8_t c = 0; c < SENSOR_CHANNELS; c++)
+            {
+                sample.low[c] = sample.high[c] = sample.value[c] = values[c];
+            }
+            downsampler.add(sample);
+            return true; });
+    }
+    downsampler.finish();
+
+    response.print("]}");
+    return response.endSend();
+}
@@ -0,0 +1,139 @@
+#ifndef SensorService_h
+#define SensorService_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <ESP32SvelteKit.h>
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+#include <TimeSeriesStore.h>
+
+#define SENSORS_SERVICE_PATH "/rest/sensors"
+#define SENSORS_HISTORY_SERVICE_PATH "/rest/sensors/history"
+#define SENSORS_HISTORY_DIRECTORY "/history"
+
+#define SENSOR_CHANNELS 4
+
+#ifndef SENSOR_SAMPLE_INTERVAL
+#define SENSOR_SAMPLE_INTERVAL 10000
+#endif
+
+#define SENSOR_HISTORY_DEFAULT_POINTS 200
+#define SENSOR_HISTORY_MAX_POINTS 1000
+// samples kept per bucket while downsampling, more are merged into the last one
+#define SENSOR_HISTORY_MAX_BUCKET 64
+
+#define SENSOR_ROLLUP_LEVELS 3
+
+// shares of the log budget of the file system (FSUsage::budget()) in percent, together with the event
+// log's EVENT_LOG_BUDGET_SHARE they must not exceed 100
+#ifndef SENSOR_HISTORY_BUDGET_SHARE
+#define SENSOR_HISTORY_BUDGET_SHARE 35
+#endif
+#ifndef SENSOR_ROLLUP_1M_BUDGET_SHARE
+#define SENSOR_ROLLUP_1M_BUDGET_SHARE 25
+#endif
+#ifndef SENSOR_ROLLUP_15M_BUDGET_SHARE
+#define SENSOR_ROLLUP_15M_BUDGET_SHARE 12
+#endif
+#ifndef SENSOR_ROLLUP_1H_BUDGET_SHARE
+#define SENSOR_ROLLUP_1H_BUDGET_SHARE 12
+#endif
+
+// linear conversion from millivolts, value = (mV - offset) * scale. Calibrate these for your probes.
+#ifndef SENSOR_TEMP_OFFSET_MV
+#define SENSOR_TEMP_OFFSET_MV 500.0
+#endif
+#ifndef SENSOR_TEMP_SCALE
+#define SENSOR_TEMP_SCALE 0.1
+#endif
+
+#ifndef SENSOR_PH_OFFSET_MV
+#define SENSOR_PH_OFFSET_MV 2878.0
+#endif
+#ifndef SENSOR_PH_SCALE
+#define SENSOR_PH_SCALE -0.0057
+#endif
+
+#ifndef SENSOR_EC_OFFSET_MV
+#define SENSOR_EC_OFFSET_MV 0.0
+#endif
+#ifndef SENSOR_EC_SCALE
+#define SENSOR_EC_SCALE 0.001
+#endif
+
+#ifndef SENSOR_LEVEL_OFFSET_MV
+#define SENSOR_LEVEL_OFFSET_MV 0.0
+#endif
+#ifndef SENSOR_LEVEL_SCALE
+#define SENSOR_LEVEL_SCALE 0.0303
+#endif
+
+/*
+ * Minimum, maximum and average of every channel over a fixed period, e.g. 1 minute. Samples are
+ * accumulated in RAM and the period is appended to its own TimeSeriesStore once the first sample of
+ * the next period arrives. The values of channel c are stored as channels 3c, 3c + 1 and 3c + 2.
+ */
+class SensorRollup
+{
+public:
+    SensorRollup(FS *fs, const char *directory, uint32_t period, uint8_t budgetShare);
+
+    void begin() { _store.begin(); }
+    void add(uint32_t timestamp, const float *values);
+
+    uint32_t period() { return _period; }
+    TimeSeriesStore *getStore() { return &_store; }
+
+private:
+    TimeSeriesStore _store;
+    uint32_t _period;
+
+    uint32_t _start;
+    uint32_t _samples;
+    float _min[SENSOR_CHANNELS];
+    float _max[SENSOR_CHANNELS];
+    float _sum[SENSOR_CHANNELS];
+    uint32_t _count[SENSOR_CHANNELS];
+
+    void _reset();
+};
+
+class SensorService
+{
+public:
+    SensorService(PsychicHttpServer *server, ESP32SvelteKit *sveltekit);
+
+    void begin();
+
+    TimeSeriesStore *getStore() { return &_store; }
+
+private:
+    PsychicHttpServer *_server;
+    ESP32SvelteKit *_sveltekit;
+    SecurityManager *_securityManager;
+    TimeSeriesStore _store;
+    SensorRollup _rollups[SENSOR_ROLLUP_LEVELS];
+
+    float _values[SENSOR_CHANNELS];
+    uint32_t _timestamp;
+    unsigned long _lastSample;
+
+    void _loop();
+    void _sample();
+    esp_err_t _sensors(PsychicRequest *request);
+    esp_err_t _history(PsychicRequest *request);
+};
+
+#endif // end SensorService_h
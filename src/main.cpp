@@ -15,6 +15,7 @@
 #include <ESP32SvelteKit.h>
 #include <RelayMqttSettingsService.h>
 #include <RelayStateService.h>
+#include <SensorService.h>
 #include <PsychicHttpServer.h>
 
 #define SERIAL_BAUD_RATE 115200
@@ -30,6 +31,9 @@ RelayStateService relayStateService = RelayStateService(&server,
                                                         &esp32sveltekit,
                                                         &relayMqttSettingsService);
 
+SensorService sensorService = SensorService(&server,
+                                            &esp32sveltekit);
+
 void setup()
 {
     // start serial and filesystem
@@ -42,6 +46,9 @@ void setup()
     relayStateService.begin();
     // start the relay service
     relayMqttSettingsService.begin();
+
+    // start sampling the sensors and serve their history
+    sensorService.begin();
 }
 
 void loop()
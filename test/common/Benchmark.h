@@ -0,0 +1,97 @@
+#ifndef Benchmark_h
+#define Benchmark_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * Microbenchmarks for the native tests. They print the time (and on x86 the TSC ticks) per operation
+ * next to the test results, run `pio test -e native -v` to see them. Timings depend on the host, the
+ * tests only assert on what can be counted.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// how long each benchmark runs
+#ifndef BENCHMARK_MIN_MS
+#define BENCHMARK_MIN_MS 200
+#endif
+
+struct BenchmarkResult
+{
+    uint64_t operations;
+    double nsPerOperation;
+    double cyclesPerOperation; // 0 where there is no cycle counter
+};
+
+inline uint64_t benchmarkCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// keeps the compiler from dropping a result nobody reads
+template <typename T>
+inline void benchmarkKeep(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*
+ * Calls operation in growing batches until BENCHMARK_MIN_MS have passed, after one call to warm up.
+ * Each call counts as operationsPerCall operations, for benchmarks that work on a batch per call.
+ */
+template <typename Operation>
+inline BenchmarkResult benchmark(const char *name, Operation operation, uint64_t operationsPerCall = 1)
+{
+    using clock = std::chrono::steady_clock;
+
+    operation();
+
+    uint64_t calls = 0;
+    uint64_t batch = 1;
+    clock::time_point start = clock::now();
+    uint64_t startCycles = benchmarkCycles();
+    clock::duration elapsed;
+    do
+    {
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            operation();
+        }
+        calls += batch;
+        batch *= 2;
+        elapsed = clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(BENCHMARK_MIN_MS));
+    uint64_t cycles = benchmarkCycles() - startCycles;
+
+    BenchmarkResult result;
+    result.operations = calls * operationsPerCall;
+    result.nsPerOperation = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / result.operations;
+    result.cyclesPerOperation = (double)cycles / result.operations;
+
+    printf("BENCH %-44s %12.1f ns/op %12.0f cycles/op %10llu ops\n", name, result.nsPerOperation,
+           result.cyclesPerOperation, (unsigned long long)result.operations);
+    return result;
+}
+
+#endif // end Benchmark_h
@@ -0,0 +1,46 @@
+#ifndef PsychicHttpSources_h
+#define PsychicHttpSources_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * PsychicHttp built into the test on top of the fake esp_http_server, without the https server
+ */
+
+#include <Arduino.h>
+#include <ArduinoTrace.h>
+#include <PsychicHttp.h>
+
+#include <ChunkPrinter.cpp>
+#include <PsychicArena.cpp>
+#include <PsychicClient.cpp>
+#include <PsychicEndpoint.cpp>
+#include <PsychicEventSource.cpp>
+#include <PsychicFileResponse.cpp>
+#include <PsychicHandler.cpp>
+#include <PsychicHttpServer.cpp>
+#include <PsychicJson.cpp>
+#include <PsychicRequest.cpp>
+#include <PsychicResponse.cpp>
+#include <PsychicStaticFileHander.cpp>
+#include <PsychicStreamResponse.cpp>
+#include <PsychicUploadHandler.cpp>
+#include <PsychicWebHandler.cpp>
+#include <PsychicWebSocket.cpp>
+#include <http_status.cpp>
+#ifdef ENABLE_ASYNC
+#include <async_worker.cpp>
+#endif
+
+#endif // end PsychicHttpSources_h
@@ -0,0 +1,357 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * The part of the Arduino core and ESP-IDF the platform independent framework code uses, for the
+ * native unit tests. Only what the tested files need, tasks and semaphores are threads and mutexes.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <math.h>
+#include <string>
+#include <strings.h>
+
+#include <sdkconfig.h>
+#include <esp_system.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+// one level for all tags, benchmarks turn the per chunk logging off
+inline esp_log_level_t stubLogLevel = ESP_LOG_INFO;
+
+inline void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    stubLogLevel = level;
+}
+
+#define ESP_LOG_STUB(level, letter, tag, format, ...)                 \
+    do                                                                \
+    {                                                                 \
+        if (stubLogLevel >= level)                                    \
+            printf(letter " (%s) " format "\n", tag, ##__VA_ARGS__);  \
+    } while (0)
+#define ESP_LOGE(tag, format, ...) ESP_LOG_STUB(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_STUB(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_STUB(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGV(tag, format, ...)
+
+// glibc only has it since 2.38
+inline size_t stubStrlcpy(char *destination, const char *source, size_t size)
+{
+    size_t length = strlen(source);
+    if (size > 0)
+    {
+        size_t copied = length < size - 1 ? length : size - 1;
+        memcpy(destination, source, copied);
+        destination[copied] = '\0';
+    }
+    return length;
+}
+#define strlcpy stubStrlcpy
+
+// a test that calls fakeMillis() owns the clock, it then only moves with advanceMillis() and vTaskDelay()
+inline void fakeMillis(unsigned long now)
+{
+    stubMillis = now;
+    stubMillisFaked = true;
+}
+
+inline void advanceMillis(unsigned long ms)
+{
+    stubMillis += ms;
+}
+
+inline unsigned long millis()
+{
+    if (stubMillisFaked)
+    {
+        return stubMillis;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void delay(unsigned long ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+// ESP.restart() only takes note, the test keeps running
+class EspClass
+{
+public:
+    bool restarted = false;
+
+    void restart() { restarted = true; }
+};
+
+inline EspClass ESP;
+
+#define F(string) (string)
+#define DEC 10
+#define HEX 16
+
+inline long random(long max)
+{
+    return max > 0 ? ::random() % max : 0;
+}
+
+inline long random(long min, long max)
+{
+    return min < max ? min + random(max - min) : min;
+}
+
+typedef enum
+{
+    ESP_MAC_WIFI_STA,
+    ESP_MAC_WIFI_SOFTAP,
+    ESP_MAC_BT,
+    ESP_MAC_ETH
+} esp_mac_type_t;
+
+// the same made up address for every interface
+inline int esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    static const uint8_t address[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+    memcpy(mac, address, sizeof(address));
+    return 0;
+}
+
+class String
+{
+public:
+    String() {}
+    String(const char *value) : _value(value != nullptr ? value : "") {}
+    String(const char *value, size_t length) : _value(value, length) {}
+    explicit String(char c) : _value(1, c) {}
+    String(int value) : _value(std::to_string(value)) {}
+    String(unsigned int value) : _value(std::to_string(value)) {}
+    String(long value) : _value(std::to_string(value)) {}
+    String(unsigned long value) : _value(std::to_string(value)) {}
+    String(long long value) : _value(std::to_string(value)) {}
+    String(unsigned long long value) : _value(std::to_string(value)) {}
+    String(long value, unsigned char base) : String((unsigned long)value, base) {}
+    String(unsigned long value, unsigned char base)
+    {
+        static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+        do
+        {
+            _value.insert(_value.begin(), digits[value % base]);
+            value /= base;
+        } while (value > 0);
+    }
+
+    const char *c_str() const { return _value.c_str(); }
+    size_t length() const { return _value.length(); }
+    bool isEmpty() const { return _value.empty(); }
+    void reserve(size_t size) { _value.reserve(size); }
+    long toInt() const { return atol(_value.c_str()); }
+
+    int indexOf(char c, int from = 0) const { return position(_value.find(c, from)); }
+    int indexOf(const char *s, int from = 0) const { return position(_value.find(s, from)); }
+    int indexOf(const String &s, int from = 0) const { return position(_value.find(s._value, from)); }
+    int lastIndexOf(char c) const { return position(_value.rfind(c)); }
+    int lastIndexOf(const char *s) const { return position(_value.rfind(s)); }
+    String substring(size_t from) const { return from < _value.length() ? String(_value.c_str() + from) : String(); }
+    String substring(size_t from, size_t to) const
+    {
+        if (from > to)
+        {
+            std::swap(from, to);
+        }
+        from = min(from, _value.length());
+        return String(_value.c_str() + from, min(to, _value.length()) - from);
+    }
+    bool startsWith(const String &prefix) const { return _value.compare(0, prefix.length(), prefix._value) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return _value.length() >= suffix.length() && _value.compare(_value.length() - suffix.length(), suffix.length(), suffix._value) == 0;
+    }
+    bool equals(const String &other) const { return _value == other._value; }
+    bool equalsIgnoreCase(const String &other) const { return strcasecmp(c_str(), other.c_str()) == 0 && length() == other.length(); }
+    bool equalsConstantTime(const String &other) const
+    {
+        if (_value.length() != other._value.length())
+        {
+            return false;
+        }
+        unsigned char difference = 0;
+        for (size_t i = 0; i < _value.length(); i++)
+        {
+            difference |= _value[i] ^ other._value[i];
+        }
+        return difference == 0;
+    }
+
+    void remove(size_t index) { _value.erase(min(index, _value.length())); }
+    void remove(size_t index, size_t count) { _value.erase(min(index, _value.length()), count); }
+    void trim()
+    {
+        size_t start = _value.find_first_not_of(" \t\r\n");
+        size_t end = _value.find_last_not_of(" \t\r\n");
+        _value = start == std::string::npos ? std::string() : _value.substr(start, end - start + 1);
+    }
+    void replace(const String &find, const String &replacement)
+    {
+        if (find.isEmpty())
+        {
+            return;
+        }
+        for (size_t index = _value.find(find._value); index != std::string::npos;
+             index = _value.find(find._value, index + replacement.length()))
+        {
+            _value.replace(index, find.length(), replacement._value);
+        }
+    }
+    void toLowerCase()
+    {
+        for (char &c : _value)
+        {
+            c = tolower(c);
+        }
+    }
+
+    bool concat(const String &s)
+    {
+        _value += s._value;
+        return true;
+    }
+    bool concat(const char *s)
+    {
+        _value += s;
+        return true;
+    }
+    bool concat(const char *s, size_t length)
+    {
+        _value.append(s, length);
+        return true;
+    }
+    bool concat(char c)
+    {
+        _value += c;
+        return true;
+    }
+
+    char operator[](size_t index) const { return index < _value.length() ? _value[index] : 0; }
+    char &operator[](size_t index) { return _value[index]; }
+
+    String &operator+=(const char *s)
+    {
+        _value += s;
+        return *this;
+    }
+    String &operator+=(const String &s)
+    {
+        _value += s._value;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        _value += c;
+        return *this;
+    }
+    String operator+(const char *s) const { return String(*this) += s; }
+    String operator+(const String &s) const { return String(*this) += s; }
+    String operator+(char c) const { return String(*this) += c; }
+    // numbers are appended as text, like Arduino's StringSumHelper does
+    String operator+(int value) const { return String(*this) += String(value); }
+    String operator+(unsigned int value) const { return String(*this) += String(value); }
+    String operator+(long value) const { return String(*this) += String(value); }
+    String operator+(unsigned long value) const { return String(*this) += String(value); }
+    friend String operator+(const char *a, const String &b) { return String(a) += b; }
+    bool operator==(const String &other) const { return _value == other._value; }
+    bool operator==(const char *other) const { return _value == other; }
+    bool operator!=(const String &other) const { return _value != other._value; }
+    bool operator!=(const char *other) const { return _value != other; }
+    bool operator<(const String &other) const { return _value < other._value; }
+
+private:
+    std::string _value;
+
+    static int position(size_t index) { return index == std::string::npos ? -1 : (int)index; }
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+        while (written < size && write(buffer[written]) == 1)
+        {
+            written++;
+        }
+        return written;
+    }
+    virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(char *buffer, size_t length)
+    {
+        size_t done = 0;
+        int c;
+        while (done < length && (c = read()) >= 0)
+        {
+            buffer[done++] = c;
+        }
+        return done;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+};
+
+// prints to stdout
+class HardwareSerial : public Print
+{
+public:
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+};
+
+inline HardwareSerial Serial;
+
+#include <IPAddress.h>
+
+#endif // end Arduino_h
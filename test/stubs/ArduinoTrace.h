@@ -0,0 +1,22 @@
+#ifndef ArduinoTrace_h
+#define ArduinoTrace_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+// the tracing is compiled out, like with ARDUINOTRACE_ENABLE 0
+#define TRACE()
+#define DUMP(variable)
+#define BREAK()
+
+#endif // end ArduinoTrace_h
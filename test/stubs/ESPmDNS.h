@@ -0,0 +1,29 @@
+#ifndef ESPmDNS_h
+#define ESPmDNS_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+
+class MDNSResponder
+{
+public:
+    bool begin(const String &hostname) { return true; }
+    void end() {}
+    void addService(const String &service, const String &protocol, uint16_t port) {}
+};
+
+inline MDNSResponder MDNS;
+
+#endif // end ESPmDNS_h
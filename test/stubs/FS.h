@@ -0,0 +1,214 @@
+#ifndef FS_h
+#define FS_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <map>
+#include <set>
+#include <vector>
+
+/*
+ * In memory file system with the Arduino FS interface. Tests can inspect and damage the files
+ * directly, and limit the capacity to run into a full file system. Every File::read() and write()
+ * is counted, on the device each of them is a call through VFS into LittleFS.
+ */
+
+namespace fs
+{
+
+class FS;
+
+class File
+{
+public:
+    File() : _fs(nullptr), _position(0), _writable(false), _directory(false), _next(0) {}
+    File(FS *fs, const String &path, size_t position, bool writable, bool directory);
+
+    operator bool() const { return _fs != nullptr; }
+
+    size_t size();
+    bool seek(uint32_t position);
+    int available() { return size() - _position; }
+    size_t read(uint8_t *buffer, size_t size);
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    void close() { _fs = nullptr; }
+
+    bool isDirectory() { return _directory; }
+    time_t getLastWrite() { return 0; }
+    const char *name() { return _path.c_str() + _path.lastIndexOf('/') + 1; }
+    File openNextFile();
+
+private:
+    FS *_fs;
+    String _path;
+    size_t _position;
+    bool _writable;
+    bool _directory;
+    size_t _next;
+};
+
+class FS
+{
+public:
+    std::map<String, std::vector<uint8_t>> files;
+    std::set<String> directories;
+    size_t capacity = SIZE_MAX;
+    size_t reads = 0;
+    size_t writes = 0;
+
+    size_t used()
+    {
+        size_t used = 0;
+        for (auto &file : files)
+        {
+            used += file.second.size();
+        }
+        return used;
+    }
+
+    bool exists(const String &path) { return files.count(path) > 0 || directories.count(path) > 0; }
+
+    bool mkdir(const String &path)
+    {
+        directories.insert(path);
+        return true;
+    }
+
+    bool remove(const String &path) { return files.erase(path) > 0; }
+
+    bool rename(const String &from, const String &to)
+    {
+        auto file = files.find(from);
+        if (file == files.end())
+        {
+            return false;
+        }
+        files[to] = file->second;
+        files.erase(from);
+        return true;
+    }
+
+    File open(const String &path, const char *mode = "r")
+    {
+        if (directories.count(path) > 0)
+        {
+            return File(this, path, 0, false, true);
+        }
+        bool exists = files.count(path) > 0;
+        if (mode[0] == 'w')
+        {
+            files[path].clear();
+            return File(this, path, 0, true, false);
+        }
+        if (!exists)
+        {
+            return File();
+        }
+        if (mode[0] == 'a')
+        {
+            return File(this, path, files[path].size(), true, false);
+        }
+        return File(this, path, 0, mode[1] == '+', false);
+    }
+};
+
+inline File::File(FS *fs, const String &path, size_t position, bool writable, bool directory) : _fs(fs),
+                                                                                                _path(path),
+                                                                                                _position(position),
+                                                                                                _writable(writable),
+                                                                                                _directory(directory),
+                                                                                                _next(0)
+{
+}
+
+inline size_t File::size()
+{
+    return _fs != nullptr && !_directory ? _fs->files[_path].size() : 0;
+}
+
+inline bool File::seek(uint32_t position)
+{
+    if (position > size())
+    {
+        return false;
+    }
+    _position = position;
+    return true;
+}
+
+inline size_t File::read(uint8_t *buffer, size_t size)
+{
+    if (_fs == nullptr || _directory)
+    {
+        return 0;
+    }
+    _fs->reads++;
+    std::vector<uint8_t> &data = _fs->files[_path];
+    size_t count = _position < data.size() ? min(size, data.size() - _position) : 0;
+    memcpy(buffer, data.data() + _position, count);
+    _position += count;
+    return count;
+}
+
+// a write that would exceed the capacity is cut short, like on a full flash
+inline size_t File::write(const uint8_t *buffer, size_t size)
+{
+    if (_fs == nullptr || !_writable)
+    {
+        return 0;
+    }
+    _fs->writes++;
+    std::vector<uint8_t> &data = _fs->files[_path];
+    size_t growth = _position + size > data.size() ? _position + size - data.size() : 0;
+    size_t used = _fs->used();
+    size_t room = used < _fs->capacity ? _fs->capacity - used : 0;
+    if (growth > room)
+    {
+        size -= growth - room;
+    }
+    if (_position + size > data.size())
+    {
+        data.resize(_position + size);
+    }
+    memcpy(data.data() + _position, buffer, size);
+    _position += size;
+    return size;
+}
+
+// direct children only, like LittleFS
+inline File File::openNextFile()
+{
+    String prefix = _path + "/";
+    auto file = _fs->files.begin();
+    std::advance(file, min(_next, _fs->files.size()));
+    for (; file != _fs->files.end(); ++file)
+    {
+        _next++;
+        const String &path = file->first;
+        if (strncmp(path.c_str(), prefix.c_str(), prefix.length()) == 0 && strchr(path.c_str() + prefix.length(), '/') == nullptr)
+        {
+            return File(_fs, path, 0, false, false);
+        }
+    }
+    return File();
+}
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // end FS_h
@@ -0,0 +1,35 @@
+#ifndef FSUsage_h
+#define FSUsage_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <FS.h>
+
+// stands in for lib/framework/FSUsage.h, the budget of a 128 kB LittleFS unless a test sets another total
+
+#ifndef FS_LOG_BUDGET_PERCENT
+#define FS_LOG_BUDGET_PERCENT 50
+#endif
+
+namespace FSUsage
+{
+    inline size_t totalBytes = 131072;
+
+    inline size_t total() { return totalBytes; }
+    inline size_t budget(uint8_t share) { return (uint64_t)totalBytes * FS_LOG_BUDGET_PERCENT * share / 10000; }
+    inline void fileResized(FS *fs, size_t oldSize, size_t newSize) {}
+    inline void invalidate(FS *fs) {}
+}
+
+#endif // end FSUsage_h
@@ -0,0 +1,132 @@
+#ifndef HTTPClient_h
+#define HTTPClient_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+/*
+ * HTTPClient against a single file served from memory. The test sets up httpc_fake: what the file is,
+ * how the server answers Range requests and after how many bytes each response is cut off.
+ */
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_PARTIAL_CONTENT 206
+#define HTTP_CODE_NOT_FOUND 404
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+
+typedef enum
+{
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+struct httpc_fake_server
+{
+    std::string file;
+    String etag;
+    int status = HTTP_CODE_OK;      // anything but 200 is sent without a body
+    bool ranges = true;             // answers Range requests with 206
+    long rangeOffset = 0;           // 206 responses start this many bytes away from the requested offset
+    std::deque<size_t> cutAfter;    // the next responses break off after this many bytes
+    int refuse = 0;                 // the next connections fail before there is a response
+    std::vector<String> requests;   // Range header of every request, empty without one
+};
+
+inline httpc_fake_server httpc_fake;
+
+class HTTPClient
+{
+public:
+    bool begin(WiFiClient &client, const String &url)
+    {
+        _client = &client;
+        _requestHeaders.clear();
+        _responseHeaders.clear();
+        _size = -1;
+        return url.startsWith("http://") || url.startsWith("https://");
+    }
+
+    void setFollowRedirects(followRedirects_t follow) {}
+    void collectHeaders(const char *headerKeys[], size_t count) {}
+    void addHeader(const String &name, const String &value) { _requestHeaders[name] = value; }
+
+    int GET()
+    {
+        httpc_fake_server &server = httpc_fake;
+        String range = _requestHeaders.count("Range") ? _requestHeaders["Range"] : String();
+        server.requests.push_back(range);
+        if (server.refuse > 0)
+        {
+            server.refuse--;
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        if (server.status != HTTP_CODE_OK)
+        {
+            _client->receive("");
+            return server.status;
+        }
+
+        // Range: bytes=<start>-, If-Range with another ETag gets the whole file
+        size_t start = 0;
+        int code = HTTP_CODE_OK;
+        bool sameFile = !_requestHeaders.count("If-Range") || _requestHeaders["If-Range"] == server.etag;
+        if (server.ranges && range.startsWith("bytes=") && sameFile)
+        {
+            start = min((size_t)max(0L, range.substring(6).toInt() + server.rangeOffset), server.file.size());
+            code = HTTP_CODE_PARTIAL_CONTENT;
+            _responseHeaders["Content-Range"] = String("bytes ") + String((unsigned long)start) + "-" +
+                                                String((unsigned long)server.file.size() - 1) + "/" +
+                                                String((unsigned long)server.file.size());
+        }
+        _responseHeaders["ETag"] = server.etag;
+        _size = server.file.size() - start;
+
+        size_t length = _size;
+        if (!server.cutAfter.empty())
+        {
+            length = min(length, server.cutAfter.front());
+            server.cutAfter.pop_front();
+        }
+        _client->receive(server.file.substr(start, length));
+        return code;
+    }
+
+    int getSize() { return _size; }
+    String header(const char *name) { return _responseHeaders.count(name) ? _responseHeaders[name] : String(); }
+    WiFiClient *getStreamPtr() { return _client; }
+    bool connected() { return _client != nullptr && _client->connected(); }
+
+    void end()
+    {
+        if (_client != nullptr)
+        {
+            _client->stop();
+        }
+    }
+
+private:
+    WiFiClient *_client = nullptr;
+    std::map<String, String> _requestHeaders;
+    std::map<String, String> _responseHeaders;
+    int _size = -1;
+};
+
+#endif // end HTTPClient_h
@@ -0,0 +1,50 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+
+class IPAddress
+{
+public:
+    IPAddress() : IPAddress(0, 0, 0, 0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d} {}
+
+    bool fromString(const char *address)
+    {
+        unsigned int a, b, c, d;
+        if (sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+        {
+            return false;
+        }
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+
+    String toString() const
+    {
+        char address[16];
+        snprintf(address, sizeof(address), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+        return String(address);
+    }
+
+    uint8_t operator[](int index) const { return _address[index]; }
+    bool operator==(const IPAddress &other) const { return memcmp(_address, other._address, sizeof(_address)) == 0; }
+
+private:
+    uint8_t _address[4];
+};
+
+#endif // end IPAddress_h
@@ -0,0 +1,39 @@
+#ifndef PersistenceScheduler_h
+#define PersistenceScheduler_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <functional>
+
+// stands in for lib/framework/PersistenceScheduler.h, nothing is written behind the test's back
+
+#ifndef PERSISTENCE_TASK_STACK_SIZE
+#define PERSISTENCE_TASK_STACK_SIZE 5120
+#endif
+
+typedef size_t persistence_id_t;
+typedef std::function<bool()> PersistenceWriter;
+
+namespace PersistenceScheduler
+{
+    template <typename... Options>
+    persistence_id_t add(PersistenceWriter writer, Options... options) { return 0; }
+    inline void remove(persistence_id_t id) {}
+    inline void markDirty(persistence_id_t id) {}
+    inline bool flush() { return true; }
+    inline void discard() {}
+}
+
+#endif // end PersistenceScheduler_h
@@ -0,0 +1,147 @@
+#ifndef Update_h
+#define Update_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+/*
+ * The Arduino Update library over memory, what is written ends up in image. A test can make the flash
+ * fail from some offset on, and hold write() in onWrite to see what the caller does meanwhile.
+ */
+
+#define UPDATE_ERROR_OK 0
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_SIZE 5
+#define UPDATE_ERROR_MD5 8
+#define UPDATE_ERROR_ABORT 12
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+
+class UpdateClass
+{
+public:
+    std::string image;
+    std::string md5;
+    size_t size = 0;
+    size_t failAt = SIZE_MAX;       // a write reaching this offset fails
+    std::function<void()> onWrite;  // runs before every write, on the writing thread
+    std::atomic<size_t> writes{0};  // completed writes
+    std::atomic<bool> writerIsCaller{false}; // a write came from the thread that called begin()
+    bool ended = false;
+    bool aborted = false;
+
+    // starts over, for the next test
+    void reset()
+    {
+        image.clear();
+        md5.clear();
+        size = 0;
+        failAt = SIZE_MAX;
+        onWrite = nullptr;
+        writes = 0;
+        writerIsCaller = false;
+        ended = false;
+        aborted = false;
+        _running = false;
+        _error = UPDATE_ERROR_OK;
+        _caller = std::this_thread::get_id();
+    }
+
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH)
+    {
+        reset();
+        this->size = size;
+        _running = true;
+        return true;
+    }
+
+    size_t write(uint8_t *data, size_t len)
+    {
+        if (onWrite)
+        {
+            onWrite();
+        }
+        if (std::this_thread::get_id() == _caller)
+        {
+            writerIsCaller = true;
+        }
+        if (!_running || _error != UPDATE_ERROR_OK)
+        {
+            return 0;
+        }
+        if (image.size() + len > failAt)
+        {
+            _error = UPDATE_ERROR_WRITE;
+            return 0;
+        }
+        image.append((const char *)data, len);
+        writes++;
+        return len;
+    }
+
+    bool end(bool evenIfRemaining = false)
+    {
+        if (!_running || _error != UPDATE_ERROR_OK)
+        {
+            return false;
+        }
+        if (!evenIfRemaining && size != UPDATE_SIZE_UNKNOWN && image.size() != size)
+        {
+            _error = UPDATE_ERROR_SIZE;
+            return false;
+        }
+        _running = false;
+        ended = true;
+        return true;
+    }
+
+    void abort()
+    {
+        _running = false;
+        aborted = true;
+        _error = UPDATE_ERROR_ABORT;
+    }
+
+    bool setMD5(const char *expected)
+    {
+        md5 = expected;
+        return true;
+    }
+
+    bool isRunning() { return _running; }
+    bool hasError() { return _error != UPDATE_ERROR_OK; }
+    uint8_t getError() { return _error; }
+
+    void printError(Print &out)
+    {
+        char message[32];
+        int length = snprintf(message, sizeof(message), "Update error %u\n", _error);
+        out.write((const uint8_t *)message, length);
+    }
+
+private:
+    bool _running = false;
+    uint8_t _error = UPDATE_ERROR_OK;
+    std::thread::id _caller;
+};
+
+inline UpdateClass Update;
+
+#endif // end Update_h
@@ -0,0 +1,39 @@
+#ifndef UrlEncode_h
+#define UrlEncode_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+
+inline String urlEncode(const String &value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    String encoded;
+    for (const char *c = value.c_str(); *c != '\0'; c++)
+    {
+        if (isalnum((unsigned char)*c) || *c == '-' || *c == '_' || *c == '.' || *c == '~')
+        {
+            char plain[2] = {*c, '\0'};
+            encoded += plain;
+        }
+        else
+        {
+            char escaped[4] = {'%', hex[(uint8_t)*c >> 4], hex[*c & 0xF], '\0'};
+            encoded += escaped;
+        }
+    }
+    return encoded;
+}
+
+#endif // end UrlEncode_h
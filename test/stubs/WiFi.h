@@ -0,0 +1,34 @@
+#ifndef WiFi_h
+#define WiFi_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <IPAddress.h>
+#include <WiFiClient.h>
+
+// station and access point addresses, the fake sockets are connected to the access point
+class WiFiClass
+{
+public:
+    IPAddress stationIP = IPAddress(192, 168, 1, 2);
+    IPAddress accessPointIP = IPAddress(192, 168, 4, 1);
+
+    IPAddress localIP() { return stationIP; }
+    IPAddress softAPIP() { return accessPointIP; }
+    bool disconnect(bool wifiOff = false) { return true; }
+};
+
+inline WiFiClass WiFi;
+
+#endif // end WiFi_h
@@ -0,0 +1,60 @@
+#ifndef WiFiClient_h
+#define WiFiClient_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+#include <string>
+
+/*
+ * A connection that already holds everything the server is going to send. It hands the data out in
+ * TCP sized pieces and is closed once it is read.
+ */
+
+#define WIFI_CLIENT_SEGMENT_SIZE 1460
+
+class WiFiClient : public Stream
+{
+public:
+    virtual ~WiFiClient() {}
+
+    void receive(const std::string &data)
+    {
+        _data = data;
+        _position = 0;
+    }
+
+    int available() override { return min(_data.size() - _position, (size_t)WIFI_CLIENT_SEGMENT_SIZE); }
+    int read() override { return _position < _data.size() ? (uint8_t)_data[_position++] : -1; }
+    int peek() override { return _position < _data.size() ? (uint8_t)_data[_position] : -1; }
+
+    int read(uint8_t *buffer, size_t size)
+    {
+        size_t count = min(size, _data.size() - _position);
+        memcpy(buffer, _data.data() + _position, count);
+        _position += count;
+        return count;
+    }
+
+    size_t write(uint8_t c) override { return 1; }
+    uint8_t connected() { return _position < _data.size(); }
+    void setTimeout(uint32_t seconds) {}
+    void stop() { _data.clear(); }
+
+private:
+    std::string _data;
+    size_t _position = 0;
+};
+
+#endif // end WiFiClient_h
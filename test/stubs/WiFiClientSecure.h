@@ -0,0 +1,27 @@
+#ifndef WiFiClientSecure_h
+#define WiFiClientSecure_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <WiFiClient.h>
+
+// no TLS, the certificates are ignored
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    void setCACertBundle(const uint8_t *bundle) {}
+    void setInsecure() {}
+};
+
+#endif // end WiFiClientSecure_h
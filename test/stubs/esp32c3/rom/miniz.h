@@ -0,0 +1,123 @@
+#ifndef miniz_h
+#define miniz_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+/*
+ * The tinfl part of the ROM miniz on top of zlib (link with -lz). Only raw deflate into a wrapping
+ * output buffer, which is what the firmware uses. zlib keeps its own window, the memory for it comes
+ * from the decompressor so it can be freed like the ROM one.
+ */
+
+typedef enum
+{
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+enum
+{
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef struct
+{
+    z_stream stream;
+    bool started;
+    size_t used;
+    uint8_t memory[48 * 1024]; // inflate state and a 32 kB window
+} tinfl_decompressor;
+
+static inline voidpf tinflAlloc(voidpf opaque, uInt items, uInt size)
+{
+    tinfl_decompressor *r = (tinfl_decompressor *)opaque;
+    size_t length = ((size_t)items * size + 15) & ~(size_t)15;
+    if (r->used + length > sizeof(r->memory))
+    {
+        return Z_NULL;
+    }
+    void *memory = r->memory + r->used;
+    r->used += length;
+    return memory;
+}
+
+static inline void tinflFree(voidpf opaque, voidpf address)
+{
+}
+
+static inline void tinfl_init(tinfl_decompressor *r)
+{
+    r->started = false;
+    r->used = 0;
+}
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *pIn_buf_next, size_t *pIn_buf_size,
+                                            uint8_t *pOut_buf_start, uint8_t *pOut_buf_next, size_t *pOut_buf_size,
+                                            const uint32_t decomp_flags)
+{
+    if (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)
+    {
+        return TINFL_STATUS_BAD_PARAM;
+    }
+    if (!r->started)
+    {
+        r->stream = z_stream();
+        r->stream.zalloc = tinflAlloc;
+        r->stream.zfree = tinflFree;
+        r->stream.opaque = r;
+        if (inflateInit2(&r->stream, -15) != Z_OK)
+        {
+            return TINFL_STATUS_FAILED;
+        }
+        r->started = true;
+    }
+
+    size_t inSize = *pIn_buf_size;
+    size_t outSize = *pOut_buf_size;
+    r->stream.next_in = (Bytef *)pIn_buf_next;
+    r->stream.avail_in = inSize;
+    r->stream.next_out = pOut_buf_next;
+    r->stream.avail_out = outSize;
+    int result = inflate(&r->stream, Z_NO_FLUSH);
+    *pIn_buf_size = inSize - r->stream.avail_in;
+    *pOut_buf_size = outSize - r->stream.avail_out;
+
+    if (result == Z_STREAM_END)
+    {
+        return TINFL_STATUS_DONE;
+    }
+    if (result != Z_OK && result != Z_BUF_ERROR)
+    {
+        return TINFL_STATUS_FAILED;
+    }
+    if (r->stream.avail_out == 0)
+    {
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+    }
+    return decomp_flags & TINFL_FLAG_HAS_MORE_INPUT ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
+
+#endif // end miniz_h
@@ -0,0 +1,36 @@
+#ifndef esp_app_format_h
+#define esp_app_format_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+
+// the header every ESP32 image starts with
+typedef struct
+{
+    uint8_t magic;
+    uint8_t segment_count;
+    uint8_t spi_mode;
+    uint8_t spi_speed : 4;
+    uint8_t spi_size : 4;
+    uint32_t entry_addr;
+    uint8_t wp_pin;
+    uint8_t spi_pin_drv[3];
+    uint16_t chip_id;
+    uint8_t min_chip_rev;
+    uint8_t reserved[8];
+    uint8_t hash_appended;
+} __attribute__((packed)) esp_image_header_t;
+
+#endif // end esp_app_format_h
@@ -0,0 +1,702 @@
+#ifndef esp_http_server_h
+#define esp_http_server_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * The esp_http_server API of ESP-IDF 4.4 without a network. Requests are built by the tests with
+ * httpd_fake_request, which also keeps the response the handler sent. There is no server task: sessions
+ * are opened and closed with httpd_fake_open / httpd_fake_close, queued work runs right away and
+ * httpd_fake_dispatch hands a request to the registered handler like the server task would.
+ */
+
+#include <esp_err.h>
+#include <lwip/sockets.h>
+#include <sdkconfig.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <map>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#define HTTPD_MAX_REQ_HDR_LEN 512
+#define HTTPD_MAX_URI_LEN 512
+
+#define HTTPD_SOCK_ERR_FAIL -1
+#define HTTPD_SOCK_ERR_INVALID -2
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+
+#define ESP_ERR_HTTPD_BASE 0xb000
+#define ESP_ERR_HTTPD_HANDLERS_FULL (ESP_ERR_HTTPD_BASE + 1)
+#define ESP_ERR_HTTPD_HANDLER_EXISTS (ESP_ERR_HTTPD_BASE + 2)
+#define ESP_ERR_HTTPD_INVALID_REQ (ESP_ERR_HTTPD_BASE + 3)
+#define ESP_ERR_HTTPD_RESULT_TRUNC (ESP_ERR_HTTPD_BASE + 4)
+#define ESP_ERR_HTTPD_RESP_HDR (ESP_ERR_HTTPD_BASE + 5)
+#define ESP_ERR_HTTPD_RESP_SEND (ESP_ERR_HTTPD_BASE + 6)
+#define ESP_ERR_HTTPD_ALLOC_MEM (ESP_ERR_HTTPD_BASE + 7)
+#define ESP_ERR_HTTPD_TASK (ESP_ERR_HTTPD_BASE + 8)
+
+typedef void *httpd_handle_t;
+typedef void (*httpd_free_ctx_fn_t)(void *ctx);
+typedef int httpd_method_t;
+
+enum http_method
+{
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+    HTTP_OPTIONS = 6,
+    HTTP_PATCH = 28,
+};
+
+inline const char *http_method_str(enum http_method method)
+{
+    switch (method)
+    {
+    case HTTP_DELETE:
+        return "DELETE";
+    case HTTP_GET:
+        return "GET";
+    case HTTP_HEAD:
+        return "HEAD";
+    case HTTP_POST:
+        return "POST";
+    case HTTP_PUT:
+        return "PUT";
+    case HTTP_OPTIONS:
+        return "OPTIONS";
+    case HTTP_PATCH:
+        return "PATCH";
+    }
+    return "<unknown>";
+}
+
+// only the size matters, the async worker copies it
+struct http_parser_url
+{
+    uint16_t field_set;
+    uint16_t port;
+    struct
+    {
+        uint16_t off;
+        uint16_t len;
+    } field_data[7];
+};
+
+struct sock_db;
+
+typedef struct httpd_req
+{
+    httpd_handle_t handle;
+    int method;
+    const char uri[HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void *aux;
+    void *user_ctx;
+    void *sess_ctx;
+    httpd_free_ctx_fn_t free_ctx;
+    bool ignore_sess_ctx_changes;
+} httpd_req_t;
+
+typedef enum
+{
+    HTTPD_500_INTERNAL_SERVER_ERROR = 0,
+    HTTPD_501_METHOD_NOT_IMPLEMENTED,
+    HTTPD_505_VERSION_NOT_SUPPORTED,
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_401_UNAUTHORIZED,
+    HTTPD_403_FORBIDDEN,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_405_METHOD_NOT_ALLOWED,
+    HTTPD_408_REQ_TIMEOUT,
+    HTTPD_411_LENGTH_REQUIRED,
+    HTTPD_414_URI_TOO_LONG,
+    HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE,
+    HTTPD_ERR_CODE_MAX
+} httpd_err_code_t;
+
+typedef esp_err_t (*httpd_err_handler_func_t)(httpd_req_t *req, httpd_err_code_t error);
+typedef esp_err_t (*httpd_open_func_t)(httpd_handle_t hd, int sockfd);
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+typedef bool (*httpd_uri_match_func_t)(const char *reference_uri, const char *uri_to_match, size_t match_upto);
+typedef void (*httpd_work_fn_t)(void *arg);
+
+typedef struct
+{
+    unsigned task_priority;
+    size_t stack_size;
+    int core_id;
+    uint16_t server_port;
+    uint16_t ctrl_port;
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    uint16_t max_resp_headers;
+    uint16_t backlog_conn;
+    bool lru_purge_enable;
+    uint16_t recv_wait_timeout;
+    uint16_t send_wait_timeout;
+    void *global_user_ctx;
+    httpd_free_ctx_fn_t global_user_ctx_free_fn;
+    void *global_transport_ctx;
+    httpd_free_ctx_fn_t global_transport_ctx_free_fn;
+    httpd_open_func_t open_fn;
+    httpd_close_func_t close_fn;
+    httpd_uri_match_func_t uri_match_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG()                \
+    {                                         \
+        .task_priority = 5,                   \
+        .stack_size = 4096,                   \
+        .core_id = 0x7FFFFFFF,                \
+        .server_port = 80,                    \
+        .ctrl_port = 32768,                   \
+        .max_open_sockets = 7,                \
+        .max_uri_handlers = 8,                \
+        .max_resp_headers = 8,                \
+        .backlog_conn = 5,                    \
+        .lru_purge_enable = false,            \
+        .recv_wait_timeout = 5,               \
+        .send_wait_timeout = 5,               \
+        .global_user_ctx = NULL,              \
+        .global_user_ctx_free_fn = NULL,      \
+        .global_transport_ctx = NULL,         \
+        .global_transport_ctx_free_fn = NULL, \
+        .open_fn = NULL,                      \
+        .close_fn = NULL,                     \
+        .uri_match_fn = NULL                  \
+    }
+
+/*
+ * Websockets
+ */
+
+typedef enum
+{
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT = 0x1,
+    HTTPD_WS_TYPE_BINARY = 0x2,
+    HTTPD_WS_TYPE_CLOSE = 0x8,
+    HTTPD_WS_TYPE_PING = 0x9,
+    HTTPD_WS_TYPE_PONG = 0xA
+} httpd_ws_type_t;
+
+typedef enum
+{
+    HTTPD_WS_CLIENT_INVALID = 0x0,
+    HTTPD_WS_CLIENT_HTTP = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+typedef struct httpd_ws_frame
+{
+    bool final;
+    bool fragmented;
+    httpd_ws_type_t type;
+    uint8_t *payload;
+    size_t len;
+} httpd_ws_frame_t;
+
+typedef struct
+{
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *r);
+    void *user_ctx;
+    bool is_websocket;
+    bool handle_ws_control_frames;
+    const char *supported_subprotocol;
+} httpd_uri_t;
+
+/*
+ * The fake server
+ */
+
+struct httpd_fake_server
+{
+    httpd_config_t config;
+    std::vector<httpd_uri_t> handlers;
+    std::map<httpd_err_code_t, httpd_err_handler_func_t> errorHandlers;
+    std::set<int> sessions;
+    std::set<int> websockets;
+    std::map<int, std::string> sent; // what was sent to a socket outside of a request
+};
+
+inline httpd_fake_server *httpd_fake_server_of(httpd_handle_t handle)
+{
+    return (httpd_fake_server *)handle;
+}
+
+struct httpd_fake_header_less
+{
+    bool operator()(const std::string &a, const std::string &b) const { return strcasecmp(a.c_str(), b.c_str()) < 0; }
+};
+
+/*
+ * What the fake server knows about a request, aux points here
+ */
+
+struct httpd_fake_request_data
+{
+    int socket = 1000;
+    std::map<std::string, std::string, httpd_fake_header_less> headers;
+    std::string query;
+
+    std::string body;
+    size_t received = 0;
+    size_t recvChunk = 0;     // hand out the body in pieces of at most this size, 0 for all at once
+    size_t failAt = SIZE_MAX; // fail receiving once this much of the body was received
+
+    httpd_ws_frame_t frame = {};
+
+    std::string status = "200 OK";
+    std::string contentType = "text/html";
+    std::vector<std::pair<std::string, std::string>> responseHeaders;
+    std::string response;
+    bool chunked = false;
+    bool finished = false;
+};
+
+// sized like the real aux, the async worker copies that many bytes
+struct httpd_fake_aux
+{
+    httpd_fake_request_data *data;
+    char scratch[HTTPD_MAX_URI_LEN + 512] = {};
+};
+
+class httpd_fake_request
+{
+public:
+    httpd_fake_request(const char *uri, int method = HTTP_GET, httpd_handle_t handle = NULL)
+    {
+        strncpy((char *)req.uri, uri, HTTPD_MAX_URI_LEN);
+        req.method = method;
+        req.handle = handle;
+        aux.data = &data;
+        req.aux = &aux;
+
+        const char *query = strchr(uri, '?');
+        if (query != nullptr)
+        {
+            data.query = query + 1;
+        }
+    }
+
+    void setBody(const std::string &body, const char *contentType = nullptr)
+    {
+        data.body = body;
+        data.received = 0;
+        req.content_len = body.size();
+        if (contentType != nullptr)
+        {
+            data.headers["Content-Type"] = contentType;
+        }
+    }
+
+    httpd_req_t req{};
+    httpd_fake_request_data data;
+
+private:
+    httpd_fake_aux aux;
+};
+
+inline httpd_fake_request_data *httpd_fake_data(httpd_req_t *r)
+{
+    return ((httpd_fake_aux *)r->aux)->data;
+}
+
+/*
+ * Server
+ */
+
+inline esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    httpd_fake_server *server = new httpd_fake_server();
+    server->config = *config;
+    *handle = server;
+    return ESP_OK;
+}
+
+// like the real one this frees the global user context
+inline esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    httpd_fake_server *server = httpd_fake_server_of(handle);
+    if (server == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (server->config.global_user_ctx_free_fn != NULL)
+    {
+        server->config.global_user_ctx_free_fn(server->config.global_user_ctx);
+    }
+    delete server;
+    return ESP_OK;
+}
+
+inline void *httpd_get_global_user_ctx(httpd_handle_t handle)
+{
+    return httpd_fake_server_of(handle)->config.global_user_ctx;
+}
+
+inline esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    httpd_fake_server *server = httpd_fake_server_of(handle);
+    if (server->handlers.size() >= server->config.max_uri_handlers)
+    {
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    server->handlers.push_back(*uri_handler);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_register_err_handler(httpd_handle_t handle, httpd_err_code_t error, httpd_err_handler_func_t handler)
+{
+    httpd_fake_server_of(handle)->errorHandlers[error] = handler;
+    return ESP_OK;
+}
+
+// runs right away, the caller plays the server task
+inline esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg)
+{
+    work(arg);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_fake_open(httpd_handle_t handle, int sockfd)
+{
+    httpd_fake_server *server = httpd_fake_server_of(handle);
+    server->sessions.insert(sockfd);
+    return server->config.open_fn != NULL ? server->config.open_fn(handle, sockfd) : ESP_OK;
+}
+
+inline void httpd_fake_close(httpd_handle_t handle, int sockfd)
+{
+    httpd_fake_server *server = httpd_fake_server_of(handle);
+    if (server->sessions.erase(sockfd) == 0)
+    {
+        return;
+    }
+    server->websockets.erase(sockfd);
+    if (server->config.close_fn != NULL)
+    {
+        server->config.close_fn(handle, sockfd);
+    }
+    else
+    {
+        close(sockfd);
+    }
+}
+
+inline esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    if (httpd_fake_server_of(handle)->sessions.count(sockfd) == 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    httpd_fake_close(handle, sockfd);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_sess_update_lru_counter(httpd_handle_t handle, int sockfd)
+{
+    return ESP_OK;
+}
+
+inline bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match, size_t match_upto)
+{
+    // a trailing * matches anything, a trailing ? (before or after it) makes the last character optional
+    size_t length = strlen(uri_template);
+    char last = length > 0 ? uri_template[length - 1] : 0;
+    char previous = length > 1 ? uri_template[length - 2] : 0;
+    bool asterisk = last == '*' || (previous == '*' && last == '?');
+    bool question = last == '?' || (previous == '?' && last == '*');
+    size_t exact = length - asterisk - question;
+
+    if (question && exact > 0 && match_upto == exact - 1 && strncmp(uri_template, uri_to_match, exact - 1) == 0)
+    {
+        return true;
+    }
+    if (match_upto < exact || strncmp(uri_template, uri_to_match, exact) != 0)
+    {
+        return false;
+    }
+    return asterisk || match_upto == exact;
+}
+
+/*
+ * Hands the request to the matching handler, or the error handler for HTTPD_404_NOT_FOUND
+ */
+inline esp_err_t httpd_fake_dispatch(httpd_handle_t handle, httpd_req_t *req)
+{
+    httpd_fake_server *server = httpd_fake_server_of(handle);
+    req->handle = handle;
+    const char *query = strchr(req->uri, '?');
+    size_t length = query != NULL ? query - req->uri : strlen(req->uri);
+
+    for (httpd_uri_t &handler : server->handlers)
+    {
+        bool matches = server->config.uri_match_fn != NULL ? server->config.uri_match_fn(handler.uri, req->uri, length)
+                                                           : strlen(handler.uri) == length && strncmp(handler.uri, req->uri, length) == 0;
+        if (matches && handler.method == req->method)
+        {
+            req->user_ctx = handler.user_ctx;
+            return handler.handler(req);
+        }
+    }
+
+    auto notFound = server->errorHandlers.find(HTTPD_404_NOT_FOUND);
+    return notFound != server->errorHandlers.end() ? notFound->second(req, HTTPD_404_NOT_FOUND) : ESP_FAIL;
+}
+
+/*
+ * Requests
+ */
+
+inline int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return r != NULL ? httpd_fake_data(r)->socket : -1;
+}
+
+inline int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    if (data->received >= data->failAt)
+    {
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+
+    size_t length = data->body.size() - data->received;
+    length = length < buf_len ? length : buf_len;
+    if (data->recvChunk > 0 && length > data->recvChunk)
+    {
+        length = data->recvChunk;
+    }
+    if (data->failAt - data->received < length)
+    {
+        length = data->failAt - data->received;
+    }
+    memcpy(buf, data->body.data() + data->received, length);
+    data->received += length;
+    return length;
+}
+
+inline size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    auto header = data->headers.find(field);
+    return header != data->headers.end() ? header->second.size() : 0;
+}
+
+inline esp_err_t httpd_fake_copy(const std::string &value, char *buf, size_t buf_len)
+{
+    if (buf_len == 0)
+    {
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    size_t length = value.size() < buf_len - 1 ? value.size() : buf_len - 1;
+    memcpy(buf, value.data(), length);
+    buf[length] = '\0';
+    return length < value.size() ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+inline esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    auto header = data->headers.find(field);
+    return header != data->headers.end() ? httpd_fake_copy(header->second, val, val_size) : ESP_ERR_NOT_FOUND;
+}
+
+inline size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    return httpd_fake_data(r)->query.size();
+}
+
+inline esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    return data->query.empty() ? ESP_ERR_NOT_FOUND : httpd_fake_copy(data->query, buf, buf_len);
+}
+
+inline esp_err_t httpd_req_get_cookie_val(httpd_req_t *req, const char *cookie_name, char *val, size_t *val_size)
+{
+    httpd_fake_request_data *data = httpd_fake_data(req);
+    auto header = data->headers.find("Cookie");
+    if (header == data->headers.end())
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const std::string &cookies = header->second;
+    size_t nameLength = strlen(cookie_name);
+    size_t start = 0;
+    while (start < cookies.size())
+    {
+        while (start < cookies.size() && cookies[start] == ' ')
+        {
+            start++;
+        }
+        size_t end = cookies.find(';', start);
+        end = end == std::string::npos ? cookies.size() : end;
+        size_t equal = cookies.find('=', start);
+        if (equal < end && equal - start == nameLength && cookies.compare(start, nameLength, cookie_name) == 0)
+        {
+            std::string value = cookies.substr(equal + 1, end - equal - 1);
+            esp_err_t err = httpd_fake_copy(value, val, *val_size);
+            if (err == ESP_ERR_HTTPD_RESULT_TRUNC)
+            {
+                *val_size = value.size() + 1;
+            }
+            return err;
+        }
+        start = end + 1;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/*
+ * Responses
+ */
+
+inline esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    httpd_fake_data(r)->status = status;
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    httpd_fake_data(r)->contentType = type;
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    httpd_fake_data(r)->responseHeaders.emplace_back(field, value);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    if (buf != NULL)
+    {
+        data->response.append(buf, buf_len);
+    }
+    data->finished = true;
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send(r, str, str != NULL ? strlen(str) : 0);
+}
+
+inline esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    httpd_fake_request_data *data = httpd_fake_data(r);
+    data->chunked = true;
+    if (buf == NULL || buf_len == 0)
+    {
+        data->finished = true;
+    }
+    else
+    {
+        data->response.append(buf, buf_len);
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send_chunk(r, str, str != NULL ? strlen(str) : 0);
+}
+
+inline esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    static const char *statuses[] = {"500 Internal Server Error", "501 Method Not Implemented", "505 Version Not Supported",
+                                     "400 Bad Request", "401 Unauthorized", "403 Forbidden", "404 Not Found",
+                                     "405 Method Not Allowed", "408 Request Timeout", "411 Length Required",
+                                     "414 URI Too Long", "431 Request Header Fields Too Large"};
+    httpd_resp_set_status(req, statuses[error]);
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_sendstr(req, msg != NULL ? msg : statuses[error]);
+}
+
+inline int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len)
+{
+    httpd_fake_data(r)->response.append(buf, buf_len);
+    return buf_len;
+}
+
+inline int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    httpd_fake_server *server = httpd_fake_server_of(hd);
+    if (server->sessions.count(sockfd) == 0)
+    {
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    server->sent[sockfd].append(buf, buf_len);
+    return buf_len;
+}
+
+/*
+ * Websocket frames, received from httpd_fake_request_data::frame
+ */
+
+inline esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    httpd_fake_request_data *data = httpd_fake_data(req);
+    pkt->type = data->frame.type;
+    pkt->final = true;
+    pkt->len = data->frame.len;
+    if (max_len == 0)
+    {
+        return ESP_OK;
+    }
+    if (max_len < data->frame.len)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(pkt->payload, data->frame.payload, data->frame.len);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt)
+{
+    httpd_fake_data(req)->response.append((const char *)pkt->payload, pkt->len);
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    return httpd_socket_send(hd, fd, (const char *)frame->payload, frame->len, 0) < 0 ? ESP_FAIL : ESP_OK;
+}
+
+inline httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd)
+{
+    httpd_fake_server *server = httpd_fake_server_of(hd);
+    if (server->sessions.count(fd) == 0)
+    {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    return server->websockets.count(fd) > 0 ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_HTTP;
+}
+
+#endif // end esp_http_server_h
@@ -0,0 +1,40 @@
+#ifndef esp_ota_ops_h
+#define esp_ota_ops_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <esp_partition.h>
+
+// the tests set which partitions are running and next
+inline const esp_partition_t *esp_fake_running_partition = NULL;
+inline const esp_partition_t *esp_fake_update_partition = NULL;
+inline const esp_partition_t *esp_fake_boot_partition = NULL;
+
+inline const esp_partition_t *esp_ota_get_running_partition()
+{
+    return esp_fake_running_partition;
+}
+
+inline const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+    return esp_fake_update_partition;
+}
+
+inline esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+    esp_fake_boot_partition = partition;
+    return partition != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+#endif // end esp_ota_ops_h
@@ -0,0 +1,119 @@
+#ifndef esp_partition_h
+#define esp_partition_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <esp_err.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/*
+ * Partitions are plain memory. Erasing sets the bytes to 0xff and writes can only clear bits, like on
+ * NOR flash, so a missing erase shows up in the tests.
+ */
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum
+{
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum
+{
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct
+{
+    void *flash_chip;
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+// the partition comes first, so the esp_partition_t pointers the code passes around lead back here
+struct esp_fake_partition
+{
+    esp_partition_t partition;
+    std::vector<uint8_t> data;
+    size_t reads = 0;
+    size_t writes = 0;
+    size_t erases = 0;
+
+    esp_fake_partition(const char *label, uint32_t address, uint32_t size, esp_partition_subtype_t subtype = ESP_PARTITION_SUBTYPE_APP_OTA_0)
+        : partition(), data(size, 0xff)
+    {
+        partition.type = ESP_PARTITION_TYPE_APP;
+        partition.subtype = subtype;
+        partition.address = address;
+        partition.size = size;
+        strncpy(partition.label, label, sizeof(partition.label) - 1);
+    }
+};
+
+inline esp_fake_partition *esp_fake_partition_of(const esp_partition_t *partition)
+{
+    return (esp_fake_partition *)partition;
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (partition == NULL || src_offset + size > partition->size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    esp_fake_partition *fake = esp_fake_partition_of(partition);
+    memcpy(dst, fake->data.data() + src_offset, size);
+    fake->reads++;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (partition == NULL || dst_offset + size > partition->size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    esp_fake_partition *fake = esp_fake_partition_of(partition);
+    for (size_t i = 0; i < size; i++)
+    {
+        fake->data[dst_offset + i] &= ((const uint8_t *)src)[i];
+    }
+    fake->writes++;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (partition == NULL || offset % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0 || offset + size > partition->size)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_fake_partition *fake = esp_fake_partition_of(partition);
+    memset(fake->data.data() + offset, 0xff, size);
+    fake->erases++;
+    return ESP_OK;
+}
+
+#endif // end esp_partition_h
@@ -0,0 +1,36 @@
+#ifndef esp_random_h
+#define esp_random_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <random>
+#include <stddef.h>
+#include <stdint.h>
+
+inline uint32_t esp_random()
+{
+    static thread_local std::mt19937 generator(std::random_device{}());
+    return generator();
+}
+
+inline void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *bytes = (uint8_t *)buf;
+    for (size_t i = 0; i < len; i++)
+    {
+        bytes[i] = esp_random();
+    }
+}
+
+#endif // end esp_random_h
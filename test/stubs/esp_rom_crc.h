@@ -0,0 +1,35 @@
+#ifndef esp_rom_crc_h
+#define esp_rom_crc_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 as in zlib, continued from crc like the ROM function
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buffer, uint32_t length)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= buffer[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+#endif // end esp_rom_crc_h
@@ -0,0 +1,258 @@
+#ifndef FreeRTOS_h
+#define FreeRTOS_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * Tasks, queues and semaphores on top of std::thread for the native unit tests. Tasks run as detached
+ * threads, ticks are milliseconds since the first call. Priorities, stack sizes and cores are ignored.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xffffffff
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks) ((uint32_t)(ticks))
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define taskYIELD() std::this_thread::yield()
+
+inline TickType_t xTaskGetTickCount()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Critical sections
+ */
+
+typedef struct
+{
+    std::recursive_mutex mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+
+/*
+ * Queues, semaphores are queues of empty items like in FreeRTOS
+ */
+
+struct QueueDefinition
+{
+    QueueDefinition(UBaseType_t length, UBaseType_t itemSize) : length(length), itemSize(itemSize) {}
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+
+    // recursive mutexes only
+    std::thread::id owner;
+    UBaseType_t depth = 0;
+
+    template <typename Predicate>
+    bool wait(std::unique_lock<std::mutex> &lock, TickType_t ticks, Predicate predicate)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            changed.wait(lock, predicate);
+            return true;
+        }
+        return changed.wait_for(lock, std::chrono::milliseconds(ticks), predicate);
+    }
+};
+
+typedef QueueDefinition *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    return new QueueDefinition(length, itemSize);
+}
+
+inline void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->wait(lock, ticks, [queue]
+                     { return queue->items.size() < queue->length; }))
+    {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = (const uint8_t *)item;
+    queue->items.emplace_back(bytes, bytes + (item != nullptr ? queue->itemSize : 0));
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+#define xQueueSendToBack xQueueSend
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->wait(lock, ticks, [queue]
+                     { return !queue->items.empty(); }))
+    {
+        return pdFALSE;
+    }
+    if (item != nullptr && queue->itemSize > 0)
+    {
+        memcpy(item, queue->items.front().data(), queue->itemSize);
+    }
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+/*
+ * Tasks
+ */
+
+typedef void (*TaskFunction_t)(void *);
+
+struct tskTaskControlBlock
+{
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+};
+
+typedef tskTaskControlBlock *TaskHandle_t;
+
+inline TaskHandle_t &currentTaskHandle()
+{
+    static thread_local TaskHandle_t task = nullptr;
+    return task;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    // threads not started by xTaskCreate (the test runner) get a handle on first use
+    if (currentTaskHandle() == nullptr)
+    {
+        currentTaskHandle() = new tskTaskControlBlock();
+    }
+    return currentTaskHandle();
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters,
+                                          UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    TaskHandle_t task = new tskTaskControlBlock();
+    if (handle != nullptr)
+    {
+        *handle = task;
+    }
+    std::thread([function, parameters, task]()
+                {
+                    currentTaskHandle() = task;
+                    function(parameters); })
+        .detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters,
+                              UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+// only a task deleting itself is supported
+inline void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == currentTaskHandle())
+    {
+        pthread_exit(nullptr);
+    }
+}
+
+// the fake clock behind millis() in Arduino.h, delays move it instead of sleeping
+inline std::atomic<bool> stubMillisFaked(false);
+inline std::atomic<unsigned long> stubMillis(0);
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    if (stubMillisFaked)
+    {
+        stubMillis += ticks;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 0;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto pending = [task]
+    { return task->notifications > 0; };
+    if (ticks == portMAX_DELAY)
+    {
+        task->notified.wait(lock, pending);
+    }
+    else if (!task->notified.wait_for(lock, std::chrono::milliseconds(ticks), pending))
+    {
+        return 0;
+    }
+    uint32_t value = task->notifications;
+    task->notifications = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notifications++;
+    task->notified.notify_all();
+    return pdPASS;
+}
+
+#endif // end FreeRTOS_h
@@ -0,0 +1,102 @@
+#ifndef semphr_h
+#define semphr_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <freertos/FreeRTOS.h>
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    SemaphoreHandle_t semaphore = xQueueCreate(maxCount, 0);
+    semaphore->items.resize(initialCount);
+    return semaphore;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+// not recursive and without priority inheritance, a binary semaphore that starts out given
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+// recursive mutexes remember which thread holds them and how often it took them
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    return xSemaphoreCreateMutex();
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->depth > 0 && semaphore->owner == std::this_thread::get_id())
+        {
+            semaphore->depth++;
+            return pdTRUE;
+        }
+    }
+    if (!xQueueReceive(semaphore, nullptr, ticks))
+    {
+        return pdFALSE;
+    }
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    semaphore->owner = std::this_thread::get_id();
+    semaphore->depth = 1;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->depth == 0 || semaphore->owner != std::this_thread::get_id())
+        {
+            return pdFALSE;
+        }
+        if (--semaphore->depth > 0)
+        {
+            return pdTRUE;
+        }
+        semaphore->owner = std::thread::id();
+    }
+    return xQueueSend(semaphore, nullptr, 0);
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    return xQueueReceive(semaphore, nullptr, ticks);
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    return xQueueSend(semaphore, nullptr, 0);
+}
+
+inline UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore)
+{
+    return uxQueueMessagesWaiting(semaphore);
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    vQueueDelete(semaphore);
+}
+
+#endif // end semphr_h
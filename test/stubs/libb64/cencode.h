@@ -0,0 +1,42 @@
+#ifndef cencode_h
+#define cencode_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <stddef.h>
+
+#define base64_encode_expected_len(n) ((((4 * (n)) / 3) + 3) & ~3)
+
+inline int base64_encode_chars(const char *plaintext_in, int length_in, char *code_out)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned char *in = (const unsigned char *)plaintext_in;
+    int out = 0;
+    for (int i = 0; i < length_in; i += 3)
+    {
+        unsigned int value = in[i] << 16;
+        if (i + 1 < length_in)
+            value |= in[i + 1] << 8;
+        if (i + 2 < length_in)
+            value |= in[i + 2];
+        code_out[out++] = alphabet[(value >> 18) & 0x3F];
+        code_out[out++] = alphabet[(value >> 12) & 0x3F];
+        code_out[out++] = i + 1 < length_in ? alphabet[(value >> 6) & 0x3F] : '=';
+        code_out[out++] = i + 2 < length_in ? alphabet[value & 0x3F] : '=';
+    }
+    code_out[out] = '\0';
+    return out;
+}
+
+#endif // end cencode_h
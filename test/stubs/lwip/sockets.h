@@ -0,0 +1,93 @@
+#ifndef sockets_h
+#define sockets_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+/*
+ * lwIP sockets without a network. Every socket is connected from 192.168.4.2 to 192.168.4.1, so tests
+ * can use any number as a socket.
+ */
+
+#include <sdkconfig.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h> // close() comes from the VFS like on the ESP32, closing a fake socket just fails
+
+#define AF_INET 2
+#define AF_INET6 10
+#define INET_ADDRSTRLEN 16
+#define INET6_ADDRSTRLEN 46
+
+typedef uint32_t socklen_t;
+
+struct sockaddr
+{
+    uint8_t sa_len;
+    uint8_t sa_family;
+    char sa_data[14];
+};
+
+struct in6_addr
+{
+    union
+    {
+        uint32_t u32_addr[4];
+        uint8_t u8_addr[16];
+    } un;
+};
+
+struct sockaddr_in6
+{
+    uint8_t sin6_len;
+    uint8_t sin6_family;
+    uint16_t sin6_port;
+    uint32_t sin6_flowinfo;
+    struct in6_addr sin6_addr;
+    uint32_t sin6_scope_id;
+};
+
+// IPv4 mapped, the way esp_http_server reports addresses
+inline int lwipFakeAddress(struct sockaddr *addr, socklen_t *len, uint8_t host)
+{
+    struct sockaddr_in6 *in6 = (struct sockaddr_in6 *)addr;
+    *in6 = {};
+    in6->sin6_family = AF_INET6;
+    in6->sin6_addr.un.u8_addr[10] = 0xFF;
+    in6->sin6_addr.un.u8_addr[11] = 0xFF;
+    in6->sin6_addr.un.u8_addr[12] = 192;
+    in6->sin6_addr.un.u8_addr[13] = 168;
+    in6->sin6_addr.un.u8_addr[14] = 4;
+    in6->sin6_addr.un.u8_addr[15] = host;
+    *len = sizeof(struct sockaddr_in6);
+    return 0;
+}
+
+inline int getsockname(int s, struct sockaddr *name, socklen_t *namelen)
+{
+    return lwipFakeAddress(name, namelen, 1);
+}
+
+inline int getpeername(int s, struct sockaddr *name, socklen_t *namelen)
+{
+    return lwipFakeAddress(name, namelen, 2);
+}
+
+inline const char *inet_ntop(int af, const void *src, char *dst, socklen_t size)
+{
+    const uint8_t *address = (const uint8_t *)src;
+    snprintf(dst, size, "%u.%u.%u.%u", address[0], address[1], address[2], address[3]);
+    return dst;
+}
+
+#endif // end sockets_h
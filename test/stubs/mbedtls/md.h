@@ -0,0 +1,200 @@
+#ifndef mbedtls_md_h
+#define mbedtls_md_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * HMAC-SHA256 (FIPS 180-4, RFC 2104) behind the mbedtls_md calls ArduinoJsonJWT makes, other digests
+ * are not supported.
+ */
+
+typedef enum
+{
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 6
+} mbedtls_md_type_t;
+
+typedef struct
+{
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct
+{
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    uint8_t outerKey[64];
+} mbedtls_md_context_t;
+
+static const uint32_t sha256Constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t sha256Rotate(uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static inline void sha256Block(mbedtls_md_context_t *ctx)
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = (uint32_t)ctx->block[4 * i] << 24 | (uint32_t)ctx->block[4 * i + 1] << 16 |
+               (uint32_t)ctx->block[4 * i + 2] << 8 | ctx->block[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = sha256Rotate(w[i - 15], 7) ^ sha256Rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = sha256Rotate(w[i - 2], 17) ^ sha256Rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t v[8];
+    memcpy(v, ctx->state, sizeof(v));
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t s1 = sha256Rotate(v[4], 6) ^ sha256Rotate(v[4], 11) ^ sha256Rotate(v[4], 25);
+        uint32_t t1 = v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) + sha256Constants[i] + w[i];
+        uint32_t s0 = sha256Rotate(v[0], 2) ^ sha256Rotate(v[0], 13) ^ sha256Rotate(v[0], 22);
+        uint32_t t2 = s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        memmove(v + 1, v, 7 * sizeof(uint32_t));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        ctx->state[i] += v[i];
+    }
+}
+
+static inline void sha256Start(mbedtls_md_context_t *ctx)
+{
+    static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+}
+
+static inline void sha256Update(mbedtls_md_context_t *ctx, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        ctx->block[ctx->length++ % 64] = data[i];
+        if (ctx->length % 64 == 0)
+        {
+            sha256Block(ctx);
+        }
+    }
+}
+
+static inline void sha256Finish(mbedtls_md_context_t *ctx, uint8_t *digest)
+{
+    uint64_t bits = ctx->length * 8;
+    uint8_t padding = 0x80;
+    sha256Update(ctx, &padding, 1);
+    padding = 0;
+    while (ctx->length % 64 != 56)
+    {
+        sha256Update(ctx, &padding, 1);
+    }
+    for (int i = 7; i >= 0; i--)
+    {
+        uint8_t byte = bits >> (8 * i);
+        sha256Update(ctx, &byte, 1);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        digest[4 * i] = ctx->state[i] >> 24;
+        digest[4 * i + 1] = ctx->state[i] >> 16;
+        digest[4 * i + 2] = ctx->state[i] >> 8;
+        digest[4 * i + 3] = ctx->state[i];
+    }
+}
+
+static inline const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type)
+{
+    static const mbedtls_md_info_t sha256 = {MBEDTLS_MD_SHA256};
+    return type == MBEDTLS_MD_SHA256 ? &sha256 : NULL;
+}
+
+static inline void mbedtls_md_init(mbedtls_md_context_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info, int hmac)
+{
+    return info != NULL && hmac ? 0 : -1;
+}
+
+static inline int mbedtls_md_hmac_starts(mbedtls_md_context_t *ctx, const unsigned char *key, size_t keylen)
+{
+    uint8_t block[64] = {0};
+    if (keylen > 64)
+    {
+        sha256Start(ctx);
+        sha256Update(ctx, key, keylen);
+        sha256Finish(ctx, block);
+    }
+    else
+    {
+        memcpy(block, key, keylen);
+    }
+
+    uint8_t innerKey[64];
+    for (int i = 0; i < 64; i++)
+    {
+        innerKey[i] = block[i] ^ 0x36;
+        ctx->outerKey[i] = block[i] ^ 0x5c;
+    }
+    sha256Start(ctx);
+    sha256Update(ctx, innerKey, 64);
+    return 0;
+}
+
+static inline int mbedtls_md_hmac_update(mbedtls_md_context_t *ctx, const unsigned char *input, size_t ilen)
+{
+    sha256Update(ctx, input, ilen);
+    return 0;
+}
+
+static inline int mbedtls_md_hmac_finish(mbedtls_md_context_t *ctx, unsigned char *output)
+{
+    uint8_t inner[32];
+    sha256Finish(ctx, inner);
+    sha256Start(ctx);
+    sha256Update(ctx, ctx->outerKey, 64);
+    sha256Update(ctx, inner, 32);
+    sha256Finish(ctx, output);
+    return 0;
+}
+
+static inline void mbedtls_md_free(mbedtls_md_context_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+#endif // end mbedtls_md_h
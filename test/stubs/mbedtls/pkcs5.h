@@ -0,0 +1,62 @@
+#ifndef mbedtls_pkcs5_h
+#define mbedtls_pkcs5_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <mbedtls/md.h>
+
+/*
+ * PBKDF2 (RFC 8018) over the HMAC in md.h. Counts the rounds it runs, so tests can check how much work a
+ * call did.
+ */
+
+inline uint64_t mbedtls_fake_pbkdf2_rounds = 0;
+
+static inline int mbedtls_pkcs5_pbkdf2_hmac(mbedtls_md_context_t *ctx, const unsigned char *password, size_t plen,
+                                            const unsigned char *salt, size_t slen, unsigned int iteration_count,
+                                            uint32_t key_length, unsigned char *output)
+{
+    uint32_t counter = 1;
+    while (key_length > 0)
+    {
+        uint8_t block[4] = {(uint8_t)(counter >> 24), (uint8_t)(counter >> 16), (uint8_t)(counter >> 8), (uint8_t)counter};
+        uint8_t u[32];
+        uint8_t t[32];
+        mbedtls_md_hmac_starts(ctx, password, plen);
+        mbedtls_md_hmac_update(ctx, salt, slen);
+        mbedtls_md_hmac_update(ctx, block, sizeof(block));
+        mbedtls_md_hmac_finish(ctx, u);
+        memcpy(t, u, sizeof(t));
+        for (unsigned int i = 1; i < iteration_count; i++)
+        {
+            mbedtls_md_hmac_starts(ctx, password, plen);
+            mbedtls_md_hmac_update(ctx, u, sizeof(u));
+            mbedtls_md_hmac_finish(ctx, u);
+            for (int j = 0; j < 32; j++)
+            {
+                t[j] ^= u[j];
+            }
+        }
+        mbedtls_fake_pbkdf2_rounds += iteration_count;
+
+        uint32_t used = key_length < 32 ? key_length : 32;
+        memcpy(output, t, used);
+        output += used;
+        key_length -= used;
+        counter++;
+    }
+    return 0;
+}
+
+#endif // end mbedtls_pkcs5_h
@@ -0,0 +1,122 @@
+#ifndef nvs_h
+#define nvs_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <esp_err.h>
+#include <map>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * NVS in memory, one map of blobs per namespace. Keys longer than the real limit are refused, so a
+ * key that would not fit on the device fails here too.
+ */
+
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+#define ESP_ERR_NVS_BASE 0x1100
+#define ESP_ERR_NVS_NOT_FOUND (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_INVALID_NAME (ESP_ERR_NVS_BASE + 0x08)
+#define ESP_ERR_NVS_KEY_TOO_LONG (ESP_ERR_NVS_BASE + 0x0a)
+#define ESP_ERR_NVS_INVALID_LENGTH (ESP_ERR_NVS_BASE + 0x0c)
+#define ESP_ERR_NVS_NOT_ENOUGH_SPACE (ESP_ERR_NVS_BASE + 0x05)
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode_t;
+
+struct esp_fake_nvs
+{
+    std::vector<std::string> namespaces;
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> blobs;
+    size_t writes = 0;
+    size_t commits = 0;
+    bool full = false; // writes fail with ESP_ERR_NVS_NOT_ENOUGH_SPACE
+
+    std::map<std::string, std::vector<uint8_t>> &entries(nvs_handle_t handle) { return blobs[namespaces[handle - 1]]; }
+};
+
+inline esp_fake_nvs nvs_fake;
+
+inline esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (strlen(name) > NVS_KEY_NAME_MAX_SIZE - 1)
+    {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    nvs_fake.namespaces.push_back(name);
+    *out_handle = nvs_fake.namespaces.size();
+    return ESP_OK;
+}
+
+inline esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    if (strlen(key) > NVS_KEY_NAME_MAX_SIZE - 1)
+    {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    auto &entries = nvs_fake.entries(handle);
+    auto entry = entries.find(key);
+    if (entry == entries.end())
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    // without a buffer only the length is returned
+    if (out_value != nullptr)
+    {
+        if (*length < entry->second.size())
+        {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, entry->second.data(), entry->second.size());
+    }
+    *length = entry->second.size();
+    return ESP_OK;
+}
+
+inline esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (strlen(key) > NVS_KEY_NAME_MAX_SIZE - 1)
+    {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    if (nvs_fake.full)
+    {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+    nvs_fake.entries(handle)[key].assign((const uint8_t *)value, (const uint8_t *)value + length);
+    nvs_fake.writes++;
+    return ESP_OK;
+}
+
+inline esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    nvs_fake.entries(handle).clear();
+    return ESP_OK;
+}
+
+inline esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    nvs_fake.commits++;
+    return ESP_OK;
+}
+
+#endif // end nvs_h
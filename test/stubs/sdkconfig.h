@@ -0,0 +1,22 @@
+#ifndef sdkconfig_h
+#define sdkconfig_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+// the options of the Arduino ESP32 core the tested code depends on, for the ESP32-C3 the firmware is built for
+#define CONFIG_IDF_TARGET_ESP32C3 1
+#define CONFIG_LWIP_MAX_SOCKETS 16
+#define CONFIG_HTTPD_WS_SUPPORT 1
+
+#endif // end sdkconfig_h
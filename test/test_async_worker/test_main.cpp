@@ -0,0 +1,232 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <async_worker.cpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#define WORKERS 4
+
+// the test runner plays the httpd task, the workers are threads
+static std::atomic<int> running;
+static std::atomic<int> maxRunning;
+static std::atomic<int> finished;
+static std::atomic<int> offWorkerThread;
+
+// blocking requests hang until the gate opens
+static std::mutex gateMutex;
+static std::condition_variable gateChanged;
+static bool gateOpen;
+
+static void setGate(bool open)
+{
+    std::lock_guard<std::mutex> lock(gateMutex);
+    gateOpen = open;
+    gateChanged.notify_all();
+}
+
+static void enter()
+{
+    int now = ++running;
+    int max = maxRunning;
+    while (now > max && !maxRunning.compare_exchange_weak(max, now))
+    {
+    }
+    if (!is_on_async_worker_thread())
+    {
+        offWorkerThread++;
+    }
+}
+
+static esp_err_t leave(httpd_req_t *req)
+{
+    running--;
+    finished++;
+    return httpd_resp_sendstr(req, "done");
+}
+
+static esp_err_t blockingHandler(httpd_req_t *req)
+{
+    enter();
+    std::unique_lock<std::mutex> lock(gateMutex);
+    gateChanged.wait(lock, []
+                     { return gateOpen; });
+    lock.unlock();
+    return leave(req);
+}
+
+static esp_err_t shortHandler(httpd_req_t *req)
+{
+    enter();
+    vTaskDelay(pdMS_TO_TICKS(1));
+    return leave(req);
+}
+
+static async_worker_stats_t stats()
+{
+    async_worker_stats_t stats;
+    get_async_worker_stats(&stats);
+    return stats;
+}
+
+static void waitForIdleWorkers()
+{
+    for (int i = 0; i < 5000 && (running > 0 || stats().busy > 0); i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    TEST_ASSERT_EQUAL(0, running);
+    TEST_ASSERT_EQUAL(0, stats().busy);
+}
+
+// the requests must outlive the async copies the workers hold
+static std::vector<std::unique_ptr<httpd_fake_request>> requests;
+
+static esp_err_t submit(httpd_req_handler_t handler, PsychicAsyncLane lane, uint32_t *waited = nullptr)
+{
+    requests.emplace_back(new httpd_fake_request("/rest/test"));
+    TickType_t started = xTaskGetTickCount();
+    esp_err_t err = submit_async_req(&requests.back()->req, handler, lane);
+    if (waited != nullptr)
+    {
+        *waited = pdTICKS_TO_MS(xTaskGetTickCount() - started);
+    }
+    return err;
+}
+
+void setUp()
+{
+    running = 0;
+    maxRunning = 0;
+    finished = 0;
+    offWorkerThread = 0;
+    setGate(false);
+}
+
+void tearDown()
+{
+    setGate(true);
+    waitForIdleWorkers();
+    requests.clear();
+}
+
+void test_busy_workers_reject_after_admission_timeout()
+{
+    TEST_ASSERT_FALSE(is_on_async_worker_thread());
+
+    async_worker_stats_t before = stats();
+    uint32_t waited;
+    for (int i = 0; i < WORKERS; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(blockingHandler, ASYNC_LANE_API, &waited));
+        TEST_ASSERT_LESS_THAN(50, waited);
+    }
+
+    // nothing waits in a queue, the server task blocks for a bounded time and gives up
+    TEST_ASSERT_EQUAL(ESP_FAIL, submit(blockingHandler, ASYNC_LANE_API, &waited));
+    TEST_ASSERT_GREATER_THAN(ASYNC_ADMISSION_TIMEOUT_MS - 20, waited);
+    TEST_ASSERT_LESS_THAN(ASYNC_ADMISSION_TIMEOUT_MS + 200, waited);
+    TEST_ASSERT_EQUAL_STRING("", requests.back()->data.response.c_str());
+
+    async_worker_stats_t after = stats();
+    TEST_ASSERT_EQUAL(WORKERS, after.busy);
+    TEST_ASSERT_EQUAL(1, after.rejected - before.rejected);
+    TEST_ASSERT_EQUAL(WORKERS, after.handled - before.handled);
+}
+
+void test_request_waits_for_worker_that_gets_free()
+{
+    for (int i = 0; i < WORKERS; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(blockingHandler, ASYNC_LANE_API));
+    }
+
+    std::thread release([]
+                        {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        setGate(true); });
+    uint32_t waited;
+    esp_err_t err = submit(shortHandler, ASYNC_LANE_API, &waited);
+    release.join();
+
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+    TEST_ASSERT_GREATER_THAN(80, waited);
+    TEST_ASSERT_LESS_THAN(ASYNC_ADMISSION_TIMEOUT_MS, waited);
+    waitForIdleWorkers();
+    TEST_ASSERT_EQUAL_STRING("done", requests.back()->data.response.c_str());
+}
+
+void test_static_requests_leave_workers_for_the_api()
+{
+    async_worker_stats_t before = stats();
+    for (int i = 0; i < WORKERS - ASYNC_API_RESERVED_WORKERS; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(blockingHandler, ASYNC_LANE_STATIC));
+    }
+    TEST_ASSERT_EQUAL(ESP_FAIL, submit(blockingHandler, ASYNC_LANE_STATIC));
+
+    uint32_t waited;
+    TEST_ASSERT_EQUAL(ESP_OK, submit(blockingHandler, ASYNC_LANE_API, &waited));
+    TEST_ASSERT_LESS_THAN(50, waited);
+    TEST_ASSERT_EQUAL(1, stats().rejected - before.rejected);
+
+    // the static slots come back once those requests are done
+    setGate(true);
+    waitForIdleWorkers();
+    setGate(false);
+    for (int i = 0; i < WORKERS - ASYNC_API_RESERVED_WORKERS; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(blockingHandler, ASYNC_LANE_STATIC, &waited));
+        TEST_ASSERT_LESS_THAN(50, waited);
+    }
+}
+
+void test_queue_under_load()
+{
+    const int count = 200;
+    async_worker_stats_t before = stats();
+
+    // a page load, every third request is a static asset
+    for (int i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(shortHandler, i % 3 == 0 ? ASYNC_LANE_STATIC : ASYNC_LANE_API));
+    }
+    waitForIdleWorkers();
+
+    async_worker_stats_t after = stats();
+    TEST_ASSERT_EQUAL(count, finished);
+    TEST_ASSERT_EQUAL(0, offWorkerThread);
+    TEST_ASSERT_LESS_OR_EQUAL(WORKERS, maxRunning);
+    TEST_ASSERT_EQUAL(count, after.handled - before.handled);
+    TEST_ASSERT_EQUAL(0, after.rejected - before.rejected);
+    TEST_ASSERT_LESS_THAN(ASYNC_ADMISSION_TIMEOUT_MS, after.waitMaxMs);
+    for (auto &request : requests)
+    {
+        TEST_ASSERT_EQUAL_STRING("done", request->data.response.c_str());
+    }
+}
+
+int main()
+{
+    start_async_req_workers(WORKERS);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_busy_workers_reject_after_admission_timeout);
+    RUN_TEST(test_request_waits_for_worker_that_gets_free);
+    RUN_TEST(test_static_requests_leave_workers_for_the_api);
+    RUN_TEST(test_queue_under_load);
+    return UNITY_END();
+}
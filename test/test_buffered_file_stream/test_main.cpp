@@ -0,0 +1,219 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <BufferedFileStream.cpp>
+
+#define PATH "/config/test.json"
+#define SIZE 2000
+
+static FS fileSystem;
+
+// what the JSON serializer does, one character at a time
+static void writeBytes(Print &print, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        print.write((uint8_t)('a' + i % 26));
+    }
+}
+
+static size_t blocks(size_t size)
+{
+    return (size + BUFFERED_FILE_STREAM_SIZE - 1) / BUFFERED_FILE_STREAM_SIZE;
+}
+
+static void writeFile(size_t size)
+{
+    File file = fileSystem.open(PATH, "w");
+    BufferedFileStream stream(file);
+    writeBytes(stream, size);
+    stream.flush();
+    file.close();
+}
+
+void setUp()
+{
+    fileSystem = FS();
+    fileSystem.mkdir("/config");
+}
+
+void tearDown()
+{
+}
+
+void test_byte_writes_go_out_in_blocks()
+{
+    File file = fileSystem.open(PATH, "w");
+    {
+        BufferedFileStream stream(file);
+        writeBytes(stream, SIZE);
+        TEST_ASSERT_EQUAL(SIZE / BUFFERED_FILE_STREAM_SIZE, fileSystem.writes);
+        // the rest goes out when the stream ends
+    }
+    file.close();
+
+    TEST_ASSERT_EQUAL(blocks(SIZE), fileSystem.writes);
+    std::vector<uint8_t> &data = fileSystem.files[PATH];
+    TEST_ASSERT_EQUAL(SIZE, data.size());
+    for (size_t i = 0; i < SIZE; i++)
+    {
+        TEST_ASSERT_EQUAL('a' + i % 26, data[i]);
+    }
+}
+
+void test_large_writes_are_split_into_blocks()
+{
+    std::vector<uint8_t> data(SIZE, 'x');
+    File file = fileSystem.open(PATH, "w");
+    BufferedFileStream stream(file);
+    TEST_ASSERT_EQUAL(100, stream.write(data.data(), 100));
+    TEST_ASSERT_EQUAL(SIZE, stream.write(data.data(), SIZE));
+    stream.flush();
+
+    TEST_ASSERT_EQUAL(blocks(SIZE + 100), fileSystem.writes);
+    TEST_ASSERT_EQUAL(SIZE + 100, fileSystem.files[PATH].size());
+    TEST_ASSERT_FALSE(stream.failed());
+}
+
+void test_byte_reads_come_in_blocks()
+{
+    writeFile(SIZE);
+    fileSystem.reads = 0;
+
+    File file = fileSystem.open(PATH, "r");
+    BufferedFileStream stream(file);
+    TEST_ASSERT_EQUAL(SIZE, stream.available());
+    for (size_t i = 0; i < SIZE; i++)
+    {
+        TEST_ASSERT_EQUAL('a' + i % 26, stream.peek());
+        TEST_ASSERT_EQUAL('a' + i % 26, stream.read());
+    }
+    TEST_ASSERT_EQUAL(0, stream.available());
+    TEST_ASSERT_EQUAL(-1, stream.read());
+
+    // one more read finds the end of the file
+    TEST_ASSERT_EQUAL(blocks(SIZE) + 1, fileSystem.reads);
+}
+
+void test_read_bytes_across_blocks()
+{
+    writeFile(SIZE);
+
+    File file = fileSystem.open(PATH, "r");
+    BufferedFileStream stream(file);
+    TEST_ASSERT_EQUAL('a', stream.read());
+    char buffer[SIZE];
+    TEST_ASSERT_EQUAL(SIZE - 1, stream.readBytes(buffer, SIZE));
+    for (size_t i = 1; i < SIZE; i++)
+    {
+        TEST_ASSERT_EQUAL('a' + i % 26, buffer[i - 1]);
+    }
+}
+
+void test_full_file_system_fails()
+{
+    fileSystem.capacity = SIZE / 2;
+    File file = fileSystem.open(PATH, "w");
+    BufferedFileStream stream(file);
+    writeBytes(stream, SIZE);
+    stream.flush();
+
+    TEST_ASSERT_TRUE(stream.failed());
+    TEST_ASSERT_EQUAL(SIZE / 2, fileSystem.files[PATH].size());
+}
+
+void test_benchmark()
+{
+    writeFile(SIZE);
+    std::vector<uint8_t> content = fileSystem.files[PATH];
+
+    // on the device every call costs a trip through VFS and LittleFS, the counts show what is saved
+    fileSystem.reads = 0;
+    fileSystem.writes = 0;
+    {
+        File file = fileSystem.open(PATH, "w");
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            file.write(content[i]);
+        }
+        file = fileSystem.open(PATH, "r");
+        uint8_t c;
+        while (file.read(&c, 1) == 1)
+        {
+        }
+    }
+    printf("unbuffered %u bytes: %u reads %u writes\n", SIZE, (unsigned int)fileSystem.reads, (unsigned int)fileSystem.writes);
+    TEST_ASSERT_EQUAL(SIZE + 1, fileSystem.reads);
+    TEST_ASSERT_EQUAL(SIZE, fileSystem.writes);
+
+    fileSystem.reads = 0;
+    fileSystem.writes = 0;
+    {
+        File file = fileSystem.open(PATH, "w");
+        BufferedFileStream writer(file);
+        writeBytes(writer, SIZE);
+        writer.flush();
+        file = fileSystem.open(PATH, "r");
+        BufferedFileStream reader(file);
+        while (reader.read() >= 0)
+        {
+        }
+    }
+    printf("buffered %u bytes: %u reads %u writes\n", SIZE, (unsigned int)fileSystem.reads, (unsigned int)fileSystem.writes);
+    TEST_ASSERT_EQUAL(blocks(SIZE) + 1, fileSystem.reads);
+    TEST_ASSERT_EQUAL(blocks(SIZE), fileSystem.writes);
+
+    benchmark("file write byte wise", [&]()
+              {
+        File file = fileSystem.open(PATH, "w");
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            file.write(content[i]);
+        } }, SIZE);
+    benchmark("buffered file stream write byte wise", [&]()
+              {
+        File file = fileSystem.open(PATH, "w");
+        BufferedFileStream stream(file);
+        writeBytes(stream, SIZE); }, SIZE);
+    benchmark("file read byte wise", [&]()
+              {
+        File file = fileSystem.open(PATH, "r");
+        uint8_t c;
+        while (file.read(&c, 1) == 1)
+        {
+            benchmarkKeep(c);
+        } }, SIZE);
+    benchmark("buffered file stream read byte wise", [&]()
+              {
+        File file = fileSystem.open(PATH, "r");
+        BufferedFileStream stream(file);
+        int c;
+        while ((c = stream.read()) >= 0)
+        {
+            benchmarkKeep(c);
+        } }, SIZE);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_byte_writes_go_out_in_blocks);
+    RUN_TEST(test_large_writes_are_split_into_blocks);
+    RUN_TEST(test_byte_reads_come_in_blocks);
+    RUN_TEST(test_read_bytes_across_blocks);
+    RUN_TEST(test_full_file_system_fails);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
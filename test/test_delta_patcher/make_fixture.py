@@ -0,0 +1,70 @@
+#   ESP32 SvelteKit --
+#
+#   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+#   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+#   https://github.com/theelims/ESP32-sveltekit
+#
+#   Copyright (C) 2023 - 2024 theelims
+#
+#   All Rights Reserved. This software may be modified and distributed under
+#   the terms of the LGPL v3 license. See the LICENSE file for details.
+
+"""
+Writes patch_fixture.h, a patch made by scripts/delta_ota.py for the test images.
+
+    python test/test_delta_patcher/make_fixture.py
+
+The images are generated the same way by test_main.cpp, keep both in sync. The built-in matcher is
+used even if bsdiff4 is installed, so the fixture does not depend on the machine.
+"""
+
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "..", "scripts"))
+
+import delta_ota  # noqa: E402
+
+
+class Random:
+    def __init__(self, seed):
+        self.state = seed
+
+    def byte(self):
+        self.state = (self.state * 1103515245 + 12345) & 0x7FFFFFFF
+        return (self.state >> 16) & 0xFF
+
+    def bytes(self, count):
+        return bytes(self.byte() for _ in range(count))
+
+
+def images():
+    # firmware like data: words from a small instruction set
+    random = Random(1)
+    words = [random.bytes(4) for _ in range(64)]
+    old = b"".join(words[random.byte() % 64] for _ in range(6144))
+
+    changed = bytearray(old[5000:12000])
+    for i in range(0, len(changed), 97):
+        changed[i] = (changed[i] + 1) & 0xFF
+    new = old[:5000] + random.bytes(200) + bytes(changed) + old[13000:] + random.bytes(1500)
+    return old, new
+
+
+def main():
+    old, new = images()
+    delta_ota.bsdiff_core = None
+    patch = delta_ota.create(old, new)
+    if delta_ota.apply(old, patch) != new:
+        sys.exit("patch does not rebuild the new image")
+
+    lines = ["    " + ", ".join("0x%02x" % b for b in patch[i:i + 16]) + "," for i in range(0, len(patch), 16)]
+    with open(os.path.join(HERE, "patch_fixture.h"), "w") as file:
+        file.write("// generated by make_fixture.py, %d byte image patched into %d bytes\n" % (len(old), len(new)))
+        file.write("static const uint8_t patchFixture[] = {\n%s\n};\n" % "\n".join(lines))
+    print("patch_fixture.h: %d byte patch" % len(patch))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+// generated by make_fixture.py, 24576 byte image patched into 25276 bytes
+static const uint8_t patchFixture[] = {
+    0x45, 0x53, 0x50, 0x44, 0x01, 0x00, 0x0c, 0x00, 0x00, 0x60, 0x00, 0x00, 0xbc, 0x62, 0x00, 0x00,
+    0xe7, 0x45, 0x9c, 0x9d, 0x12, 0x1f, 0x22, 0x29, 0x53, 0x64, 0x3e, 0xbf, 0xa9, 0xe3, 0x0c, 0xc9,
+    0x17, 0x9e, 0x61, 0x6b, 0x66, 0x06, 0xc7, 0xaa, 0x26, 0xae, 0xc1, 0xb5, 0xca, 0xbc, 0x57, 0xec,
+    0xaf, 0x26, 0x10, 0xb8, 0x53, 0xeb, 0xb1, 0xbd, 0x17, 0x5e, 0x2f, 0x42, 0xe9, 0x42, 0x3a, 0x14,
+    0x24, 0xf4, 0x52, 0xeb, 0xf7, 0xbd, 0x6c, 0x3e, 0x12, 0xb4, 0x3f, 0xf1, 0x05, 0x00, 0xc7, 0x38,
+    0xed, 0xd0, 0xf9, 0x3f, 0xd4, 0x8b, 0x1e, 0xc7, 0xf1, 0x2f, 0x59, 0x4a, 0x91, 0x2d, 0xc7, 0xe0,
+    0x90, 0x63, 0x4f, 0x62, 0x90, 0x69, 0x30, 0x39, 0x35, 0xb6, 0x71, 0xec, 0x84, 0x83, 0x68, 0x2c,
+    0xc9, 0x1e, 0x33, 0xe1, 0x08, 0x91, 0xc8, 0xbe, 0x65, 0x19, 0x7b, 0xf6, 0x54, 0xc7, 0x30, 0x88,
+    0x16, 0xeb, 0xb1, 0x5e, 0xd4, 0x15, 0x22, 0xd9, 0xb7, 0x42, 0x23, 0xb2, 0x8c, 0xc2, 0x71, 0xee,
+    0xe3, 0x71, 0x7f, 0xb8, 0x7f, 0xc1, 0xbd, 0x8f, 0xc7, 0x7d, 0x9c, 0xcf, 0xf3, 0x97, 0xcf, 0x8f,
+    0xaf, 0xc7, 0xfb, 0x83, 0x20, 0xff, 0x11, 0xc3, 0x87, 0x20, 0xfd, 0xff, 0xba, 0x2c, 0x08, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x7f, 0xe1, 0xa4, 0x62, 0x1d,
+    0x95, 0xa3, 0xc0, 0xe7, 0xe4, 0x2b, 0x7c, 0xe2, 0xdb, 0x75, 0x6c, 0xaa, 0xcd, 0x29, 0xfc, 0x89,
+    0x90, 0x3e, 0x57, 0xee, 0x54, 0xb4, 0x96, 0xcd, 0x8f, 0xf4, 0xb3, 0x58, 0x9b, 0x5d, 0x51, 0x3d,
+    0x27, 0x45, 0x4c, 0x97, 0x7e, 0xb6, 0xec, 0x68, 0xfd, 0x6f, 0x06, 0x8e, 0x41, 0x7c, 0x61, 0xcf,
+    0x9e, 0x6b, 0x75, 0xf2, 0xef, 0x51, 0x0b, 0x5e, 0x0d, 0x1e, 0x4a, 0x2c, 0x5d, 0x8b, 0x98, 0xf3,
+    0xa6, 0x74, 0x85, 0xe0, 0xd0, 0x74, 0x24, 0xd8, 0xed, 0x09, 0xab, 0x5f, 0x80, 0x68, 0xac, 0xd6,
+    0x88, 0x59, 0x22, 0x5e, 0x39, 0xc9, 0x4b, 0x47, 0xc9, 0xed, 0xd0, 0x79, 0x3e, 0x92, 0xd4, 0xc2,
+    0x2e, 0xb7, 0xb8, 0xc2, 0x92, 0xd4, 0x7e, 0xb2, 0x78, 0x6a, 0x76, 0x3a, 0xe1, 0xc4, 0xd5, 0x9f,
+    0xa3, 0x6d, 0x55, 0xeb, 0x7d, 0x1e, 0x15, 0x25, 0x6c, 0x85, 0x60, 0x7b, 0x05, 0x47, 0xba, 0x47,
+    0x6e, 0x50, 0x97, 0x97, 0x18, 0x56, 0x6e, 0xe7, 0x44, 0x3c, 0xad, 0xfe, 0x58, 0x6f, 0xd8, 0x30,
+    0x8b, 0xaa, 0x55, 0x8e, 0x58, 0x1a, 0x52, 0x95, 0x1d, 0xca, 0xd4, 0x57, 0xc2, 0x9a, 0xbc, 0xd7,
+    0x23, 0x55, 0x23, 0x04, 0xbc, 0xf0, 0x92, 0x4f, 0x72, 0xe5, 0xa4, 0xca, 0x87, 0x1d, 0xdc, 0xb1,
+    0xb8, 0x5a, 0xa4, 0x75, 0x78, 0xf9, 0x47, 0x5a, 0x34, 0x57, 0x19, 0x35, 0xb4, 0xb7, 0xe0, 0xe9,
+    0x4c, 0x54, 0xf1, 0x99, 0xd3, 0x5d, 0xe5, 0x15, 0x51, 0x96, 0xc2, 0xff, 0xde, 0xf4, 0xe9, 0xc8,
+    0x7f, 0xf9, 0x69, 0x4c, 0x08, 0x04, 0x20, 0x00, 0x01, 0x08, 0x40, 0x00, 0x02, 0x10, 0x80, 0x00,
+    0x04, 0x20, 0x00, 0x01, 0x08, 0x40, 0x00, 0x02, 0x10, 0x80, 0x00, 0x04, 0x20, 0x00, 0x01, 0x08,
+    0x40, 0x00, 0x02, 0x10, 0x80, 0x00, 0x04, 0x20, 0xf0, 0x7f, 0x1f, 0xb8, 0xa0, 0x80, 0x20, 0x13,
+    0xac, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x2d, 0x34,
+    0x60, 0x6e, 0xd4, 0xac, 0xd3, 0xf5, 0xa3, 0x8a, 0xd5, 0x99, 0x8d, 0x68, 0x02, 0x71, 0xbe, 0x6d,
+    0x57, 0xda, 0xbb, 0xd4, 0xbb, 0xaf, 0x89, 0x88, 0x70, 0xe7, 0xbb, 0x45, 0x11, 0x4a, 0xba, 0x99,
+    0x2d, 0x6a, 0x35, 0x28, 0x87, 0x28, 0x99, 0xd4, 0x99, 0xc1, 0xe8, 0xa3, 0x2b, 0x8c, 0x2f, 0xaa,
+    0x43, 0x5f, 0x08, 0x64, 0x69, 0x1b, 0x23, 0x51, 0x19, 0x5a, 0x2b, 0xbb, 0x47, 0xaf, 0xcf, 0x5b,
+    0xe5, 0xe5, 0xc5, 0x6f, 0x71, 0xad, 0x8c, 0x7c, 0x29, 0x1e, 0x3a, 0x27, 0x43, 0x34, 0x5e, 0x30,
+    0x79, 0xa8, 0x87, 0x4f, 0x83, 0x66, 0x50, 0x39, 0x7e, 0xb7, 0xc4, 0xf5, 0x4e, 0x83, 0x31, 0x53,
+    0xdf, 0xc3, 0x1b, 0x5e, 0xec, 0x16, 0xe7, 0xf2, 0x59, 0x6c, 0xd4, 0x85, 0x68, 0x82, 0xa1, 0x7a,
+    0x91, 0x47, 0xf6, 0x7c, 0x43, 0xef, 0x11, 0xd2, 0xc5, 0xcb, 0x7b, 0x18, 0x48, 0x64, 0xa1, 0xab,
+    0xc0, 0xcd, 0x60, 0x7d, 0xfa, 0x0a, 0x8b, 0xbb, 0xbf, 0x96, 0x54, 0x74, 0xe6, 0xfe, 0x1e, 0xa5,
+    0x54, 0x28, 0x67, 0xc6, 0xf5, 0xe3, 0xbd, 0x86, 0xed, 0x67, 0x1f, 0xf9, 0x9c, 0x75, 0xb3, 0xc7,
+    0x4e, 0x6c, 0x0e, 0x2f, 0xd6, 0x15, 0xd6, 0xbc, 0x77, 0x77, 0x70, 0xad, 0x14, 0x9c, 0xd7, 0x9a,
+    0xff, 0x5c, 0x75, 0xb5, 0xc5, 0x63, 0x13, 0xbd, 0x62, 0x4c, 0x68, 0xe0, 0x95, 0xf8, 0x81, 0xac,
+    0x5c, 0xda, 0xa2, 0x90, 0x3b, 0x72, 0xdf, 0xbb, 0x6b, 0xd6, 0xb0, 0xee, 0x03, 0x6d, 0xf1, 0x0e,
+    0x62, 0x6e, 0xb3, 0xef, 0xcc, 0xda, 0x12, 0xc7, 0xf6, 0xd3, 0xee, 0x57, 0xa3, 0x7a, 0x6e, 0x37,
+    0xc2, 0x3b, 0x6f, 0xad, 0xf6, 0x9e, 0x26, 0x5f, 0xb6, 0xc1, 0xe2, 0x5e, 0xf2, 0x84, 0xd0, 0x56,
+    0xf7, 0x9b, 0x6a, 0x45, 0xc9, 0xdf, 0x5d, 0x3a, 0xe7, 0x3c, 0xed, 0x4c, 0x84, 0xd3, 0xf5, 0x9e,
+    0xee, 0xe4, 0xa5, 0xb7, 0xd1, 0x8e, 0xd8, 0x6c, 0x90, 0xd0, 0x0c, 0xbb, 0x81, 0x13, 0xd9, 0xef,
+    0x78, 0x6c, 0x8d, 0xaa, 0x6c, 0xc7, 0xbf, 0x0b, 0x5b, 0x89, 0x73, 0x44, 0x0d, 0x9f, 0x1f, 0x0e,
+    0xe6, 0x5d, 0x1d, 0xf0, 0xec, 0x60, 0xf2, 0x3d, 0xb3, 0xf0, 0x7d, 0x51, 0x12, 0xd7, 0x74, 0xdb,
+    0xa1, 0xfe, 0x73, 0x8f, 0xd2, 0x55, 0x56, 0x4a, 0x87, 0xba, 0x46, 0x9e, 0xf1, 0x20, 0xef, 0xe0,
+    0x51, 0x72, 0x53, 0xf5, 0xb6, 0x09, 0x46, 0xc8, 0x0c, 0x2d, 0xc1, 0x3c, 0x2e, 0xec, 0x3a, 0xd6,
+    0x1e, 0x1f, 0xf2, 0xdc, 0x37, 0xaa, 0xdc, 0x7a, 0xf7, 0x3a, 0xed, 0xf1, 0xb5, 0x1b, 0x25, 0x96,
+    0x29, 0x5b, 0xc7, 0x46, 0x04, 0x9e, 0x88, 0x91, 0x1e, 0xaa, 0x94, 0x2d, 0xa9, 0xb5, 0x87, 0x74,
+    0x6b, 0x78, 0x1e, 0x69, 0x10, 0x97, 0x57, 0x35, 0xf9, 0x42, 0x0b, 0xed, 0x23, 0x6f, 0x3a, 0xde,
+    0x22, 0x78, 0xf4, 0x0c, 0xc5, 0x28, 0xa1, 0x53, 0x8c, 0x5a, 0x03, 0xe5, 0x37, 0xee, 0x07, 0x13,
+    0x99, 0x14, 0x82, 0xec, 0x90, 0x72, 0x19, 0xca, 0x2c, 0x23, 0x9d, 0x82, 0xef, 0x6d, 0x36, 0xf6,
+    0xa0, 0x6e, 0xe0, 0x99, 0x30, 0x0b, 0x71, 0x69, 0xb4, 0x34, 0xb7, 0xb6, 0x3f, 0xc6, 0x9a, 0x0d,
+    0x1f, 0x0f, 0xe1, 0xda, 0x8d, 0x19, 0x04, 0xb6, 0x13, 0xeb, 0x95, 0x91, 0x97, 0xb1, 0xdb, 0x67,
+    0xb3, 0x43, 0x5f, 0x69, 0x08, 0x54, 0x07, 0x95, 0xcd, 0xd0, 0x55, 0x1c, 0xdf, 0x70, 0x6d, 0x5b,
+    0x3c, 0xe7, 0xdc, 0x12, 0xbf, 0x2d, 0x7a, 0x3b, 0xb3, 0x37, 0x26, 0x93, 0xfe, 0x4c, 0xef, 0x6e,
+    0x0f, 0xb3, 0xf3, 0xd8, 0x67, 0x19, 0x2e, 0x52, 0xcb, 0x4f, 0xe1, 0xd2, 0x91, 0xcc, 0x0f, 0xc4,
+    0x4c, 0x95, 0x45, 0x51, 0x43, 0x51, 0x3c, 0x3a, 0xbd, 0x6c, 0x57, 0x76, 0xb0, 0xa1, 0xc4, 0x93,
+    0xe4, 0xb6, 0x3c, 0x85, 0x81, 0xb6, 0x5b, 0x0f, 0x50, 0xa6, 0xda, 0xef, 0x17, 0xeb, 0xa6, 0x2d,
+    0x83, 0xe9, 0xfb, 0xda, 0xa9, 0x9d, 0x06, 0xad, 0xef, 0xf2, 0x8c, 0x9d, 0xc4, 0xd6, 0xff, 0xa4,
+    0xb9, 0x53, 0xc5, 0x2c, 0xb2, 0x34, 0x1d, 0xd6, 0x97, 0xf1, 0x4a, 0x0b, 0x38, 0x9c, 0xe7, 0xd3,
+    0x63, 0xed, 0x45, 0x9c, 0xfc, 0x69, 0x97, 0x58, 0x18, 0x44, 0x4f, 0x7f, 0xeb, 0xeb, 0x99, 0xf7,
+    0xa6, 0x8b, 0x17, 0x16, 0x90, 0x8d, 0x9f, 0x8b, 0x6e, 0xbc, 0xc5, 0x4d, 0xe1, 0xb7, 0xab, 0x2e,
+    0xaa, 0xc6, 0xb2, 0x1e, 0xe7, 0xd5, 0xf6, 0x92, 0x73, 0x56, 0x2c, 0x6b, 0xca, 0xc6, 0x14, 0xe7,
+    0x71, 0x91, 0x17, 0x02, 0xda, 0xd4, 0xd2, 0x5b, 0x5e, 0x0f, 0x3b, 0x11, 0xa9, 0xe7, 0xc5, 0x25,
+    0xce, 0x0b, 0x8b, 0x8d, 0x6a, 0xab, 0xe8, 0xea, 0x9a, 0x4d, 0x6e, 0x4d, 0xe4, 0xbf, 0xcc, 0xe1,
+    0x3b, 0xb7, 0x27, 0x50, 0x94, 0xe6, 0x3a, 0x48, 0xb4, 0x90, 0xa4, 0x30, 0x63, 0x2d, 0x35, 0xfc,
+    0x2f, 0x9b, 0x7c, 0x3a, 0xea, 0xd4, 0xa0, 0x43, 0xde, 0xc3, 0x9b, 0xb8, 0x09, 0x19, 0x6c, 0x33,
+    0x05, 0xf2, 0x90, 0x0e, 0xe5, 0x47, 0x7c, 0x8b, 0x14, 0xb3, 0xde, 0xd9, 0x53, 0x1e, 0xdf, 0xd2,
+    0xce, 0x38, 0xb0, 0xc6, 0x48, 0xca, 0xcd, 0xf6, 0x65, 0x61, 0xab, 0xb6, 0xff, 0x81, 0x93, 0x0f,
+    0x13, 0x4f, 0xfc, 0x2a, 0xad, 0x3d, 0xf5, 0x31, 0x23, 0x87, 0xed, 0x14, 0x6b, 0x74, 0xb2, 0x6e,
+    0x8d, 0xcb, 0x81, 0xcb, 0xfe, 0xe5, 0xe9, 0x34, 0x27, 0x07, 0x0a, 0x87, 0x98, 0xcb, 0x6a, 0x7d,
+    0x91, 0x8b, 0x7e, 0x42, 0x55, 0xc6, 0x58, 0xcd, 0x95, 0x7e, 0x03, 0xc3, 0xcc, 0x17, 0x76, 0xd2,
+    0x83, 0x9f, 0x64, 0x8f, 0x7e, 0x21, 0xab, 0x0c, 0x9a, 0xc7, 0x62, 0x6c, 0x43, 0x0b, 0x9f, 0x72,
+    0x44, 0x06, 0x09, 0x5e, 0x40, 0x8f, 0x88, 0xe0, 0xf7, 0xf6, 0xd5, 0x49, 0x15, 0xab, 0x6e, 0x49,
+    0x2f, 0x7f, 0xb5, 0x54, 0xaf, 0xf0, 0x0b, 0x11, 0xa8, 0x35, 0x5e, 0xcb, 0xac, 0x38, 0x3f, 0x56,
+    0xac, 0x99, 0x3e, 0xba, 0xa6, 0xd3, 0x8c, 0x08, 0xe6, 0xbb, 0x54, 0x45, 0xbe, 0x19, 0xe2, 0xd8,
+    0x89, 0xf9, 0x62, 0xb7, 0xd9, 0xb4, 0xc9, 0x37, 0x96, 0xb7, 0x94, 0xd1, 0xa8, 0x3a, 0xd1, 0xbd,
+    0x33, 0xff, 0xd5, 0xbe, 0x22, 0x92, 0x7d, 0xaa, 0xcc, 0x42, 0x23, 0x8c, 0x54, 0x21, 0x9b, 0x3b,
+    0x6c, 0x3a, 0xcf, 0x7f, 0xa6, 0xb7, 0xc6, 0x38, 0x59, 0x3a, 0x96, 0xa5, 0xbe, 0xc9, 0xf8, 0x6d,
+    0x58, 0x6a, 0xcf, 0x1d, 0xdb, 0xbb, 0x6e, 0x9c, 0x2e, 0x98, 0xc6, 0xbb, 0x9a, 0xdd, 0x25, 0xe4,
+    0xe2, 0x33, 0x9e, 0xd6, 0xa3, 0x4e, 0x4e, 0xf7, 0xeb, 0xdc, 0x7d, 0xf9, 0xef, 0xbf, 0xbf, 0x64,
+    0x52, 0xe3, 0x60, 0x2a, 0x88, 0x4c, 0x50, 0x16, 0x07, 0x1c, 0x4f, 0x3d, 0x18, 0xe9, 0x3a, 0xa0,
+    0x8f, 0x29, 0xb6, 0x1e, 0x6c, 0x8a, 0xb7, 0x9e, 0x6a, 0x0e, 0xf9, 0x67, 0xae, 0x94, 0xb8, 0x0f,
+    0x85, 0x9d, 0xd8, 0x8a, 0xa4, 0xc8, 0x98, 0xb5, 0x58, 0x2f, 0xc4, 0xc4, 0x60, 0x70, 0x9f, 0xed,
+    0xe9, 0x81, 0xa8, 0x89, 0x80, 0x82, 0x08, 0x53, 0xe9, 0xa0, 0x05, 0x52, 0x8c, 0x42, 0x22, 0xcb,
+    0xb7, 0x5a, 0x73, 0xce, 0x23, 0x7b, 0x84, 0x8d, 0xe0, 0x49, 0x03, 0xec, 0xaf, 0x1d, 0x72, 0xc2,
+    0xb6, 0xa8, 0xea, 0xd7, 0xd6, 0x7e, 0x8e, 0x29, 0xce, 0xb7, 0xe6, 0x49, 0x15, 0x19, 0x56, 0xab,
+    0x7f, 0x7a, 0x69, 0xa2, 0x4c, 0x37, 0xb0, 0x23, 0x54, 0xe7, 0xf4, 0x30, 0x95, 0x4d, 0xaf, 0x88,
+    0xcc, 0x73, 0xaf, 0x1e, 0x27, 0xa1, 0xb9, 0x15, 0xd6, 0xe2, 0x59, 0x48, 0xb7, 0xd7, 0x23, 0xca,
+    0x93, 0x4b, 0x1a, 0xf6, 0x6e, 0x16, 0x8d, 0xb7, 0x7b, 0x27, 0xe5, 0x29, 0x36, 0x13, 0xbd, 0x97,
+    0x50, 0xaf, 0x6f, 0xe9, 0xf3, 0x07, 0x18, 0x85, 0x5f, 0x1c, 0x8c, 0x30, 0xdc, 0x1b, 0xed, 0x8a,
+    0x97, 0xf0, 0xdb, 0x8f, 0xb7, 0x2d, 0x99, 0xe3, 0x56, 0x08, 0xc8, 0x95, 0xdc, 0x28, 0x5f, 0x28,
+    0xb6, 0xe7, 0xe6, 0x0d, 0x9f, 0x19, 0x7f, 0x3d, 0xdd, 0x77, 0x2d, 0x75, 0xf8, 0xf4, 0xdc, 0xe4,
+    0x96, 0xca, 0xda, 0xa5, 0x62, 0xb6, 0x24, 0x0e, 0xc1, 0xeb, 0xca, 0xbd, 0x6a, 0x9d, 0xf6, 0xb1,
+    0x9c, 0xef, 0xb8, 0x06, 0xe4, 0x57, 0x37, 0x0d, 0x4b, 0xb9, 0x4c, 0x3c, 0x17, 0x67, 0x1f, 0x85,
+    0x5d, 0x50, 0x53, 0x6e, 0x11, 0xf0, 0xde, 0xe3, 0x50, 0x4a, 0xfd, 0xe0, 0xa0, 0x89, 0x46, 0xf1,
+    0x87, 0x23, 0x93, 0x93, 0x62, 0x67, 0x6d, 0x43, 0x65, 0xc2, 0x1a, 0x09, 0x56, 0x6a, 0xed, 0x44,
+    0x6a, 0xa9, 0x65, 0x55, 0x5b, 0xf4, 0xdd, 0x1c, 0x9a, 0x54, 0x6c, 0x1a, 0xd7, 0xb9, 0x00, 0x9c,
+    0xb9, 0x19, 0xe5, 0x37, 0xb5, 0xdc, 0x0a, 0xa1, 0xe6, 0xf4, 0x1a, 0xe2, 0xa1, 0x60, 0xcf, 0x45,
+    0xda, 0x8e, 0xb7, 0x6e, 0xb0, 0xc1, 0x0b, 0xff, 0xed, 0x1c, 0x8b, 0xfc, 0x7b, 0xb5, 0xc7, 0x5f,
+    0x7e, 0xb8, 0x7c, 0x65, 0x5c, 0x0f, 0xed, 0xf7, 0xa1, 0xbd, 0xdb, 0x9c, 0xfe, 0x3c, 0xcc, 0x6c,
+    0x20, 0xab, 0x24, 0xbd, 0x19, 0x55, 0xad, 0x69, 0x60, 0xe6, 0x6e, 0xde, 0x10, 0xf8, 0xdc, 0x57,
+    0x9f, 0x64, 0xa0, 0x80, 0x95, 0x5f, 0x32, 0x0b, 0x4a, 0x48, 0xa9, 0x97, 0xb0, 0x25, 0xee, 0x74,
+    0x36, 0x4a, 0xce, 0x9b, 0x06, 0xd6, 0x3c, 0x1c, 0x17, 0xe5, 0xc8, 0x17, 0x6c, 0xc2, 0x68, 0xe4,
+    0xfa, 0xcf, 0x5e, 0xe8, 0x6f, 0xac, 0x9e, 0x7a, 0x44, 0xba, 0xbe, 0xae, 0xf9, 0xaa, 0xd1, 0x64,
+    0xc6, 0x6b, 0xdd, 0x57, 0xc5, 0x43, 0x3b, 0x6c, 0xbc, 0x7e, 0xd3, 0x98, 0xa1, 0x24, 0xc5, 0xe6,
+    0x89, 0x0e, 0x4f, 0xec, 0xef, 0x89, 0xa3, 0x49, 0xbd, 0x69, 0x13, 0xbe, 0xf9, 0x2c, 0x64, 0x6b,
+    0xf8, 0x78, 0xb8, 0x45, 0x61, 0x3f, 0xd1, 0x9b, 0xd9, 0xbb, 0xf0, 0x76, 0x52, 0x45, 0x88, 0x87,
+    0x3f, 0x5b, 0x81, 0x8e, 0x1f, 0xda, 0xdd, 0xb9, 0x7c, 0x57, 0xc8, 0x74, 0xf7, 0x74, 0x69, 0x88,
+    0xdd, 0xda, 0x2f, 0x65, 0x7d, 0x64, 0x26, 0xb6, 0x63, 0xf9, 0x91, 0x38, 0xfe, 0xef, 0x2a, 0x07,
+    0xd7, 0x7f, 0xa9, 0x0b, 0xda, 0x1a, 0xd0, 0x8f, 0x9d, 0xd3, 0x5b, 0x2e, 0xe3, 0x78, 0x2b, 0x1b,
+    0x2e, 0xef, 0xd9, 0x1b, 0xb6, 0xa1, 0x2e, 0x32, 0x53, 0x59, 0x88, 0x7a, 0xd2, 0xca, 0x8c, 0xb7,
+    0x46, 0xac, 0xb1, 0xb8, 0x78, 0xb2, 0x48, 0xf3, 0x03, 0xde, 0x52, 0xe5, 0xe9, 0x32, 0xa6, 0xac,
+    0x83, 0x09, 0xd2, 0x8e, 0xde, 0xce, 0xa3, 0x74, 0x4a, 0xdf, 0xfb, 0xa9, 0xfe, 0x8c, 0x12, 0xde,
+    0x6f, 0x91, 0xe5, 0xbf, 0xfb, 0xec, 0x4f, 0x53, 0x6e, 0xd6, 0x76, 0xf1, 0x50, 0x7d, 0x65, 0x6c,
+    0xe3, 0x28, 0xad, 0x92, 0xec, 0x11, 0x0f, 0x5f, 0xa4, 0x04, 0xaa, 0xaf, 0xf9, 0x24, 0x1a, 0x76,
+    0xb0, 0x4b, 0xf9, 0xcf, 0x8c, 0x6a, 0xc5, 0x52, 0x95, 0x22, 0x3a, 0x6c, 0x6a, 0x38, 0x52, 0x88,
+    0x31, 0x0c, 0x39, 0x71, 0xb7, 0x9a, 0x6f, 0x2b, 0x7a, 0x07, 0x75, 0x5f, 0xa7, 0xdb, 0xce, 0xb3,
+    0xcd, 0x67, 0x9d, 0xa2, 0x1f, 0xf0, 0x71, 0xe7, 0x27, 0x0c, 0xa3, 0x4e, 0x8b, 0x19, 0x61, 0xb4,
+    0xab, 0xff, 0x02,
+};
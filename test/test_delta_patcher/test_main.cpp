@@ -0,0 +1,202 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <DeltaPatcher.cpp>
+#include <string>
+#include <vector>
+
+#include "patch_fixture.h"
+
+// the images make_fixture.py made the patch from
+class Random
+{
+public:
+    Random(uint32_t seed) : _state(seed) {}
+
+    uint8_t byte()
+    {
+        _state = (_state * 1103515245 + 12345) & 0x7FFFFFFF;
+        return (_state >> 16) & 0xFF;
+    }
+
+    std::string bytes(size_t count)
+    {
+        std::string bytes;
+        while (bytes.size() < count)
+        {
+            bytes += (char)byte();
+        }
+        return bytes;
+    }
+
+private:
+    uint32_t _state;
+};
+
+static std::string oldImage;
+static std::string newImage;
+
+static void makeImages()
+{
+    Random random(1);
+    std::vector<std::string> words;
+    for (int i = 0; i < 64; i++)
+    {
+        words.push_back(random.bytes(4));
+    }
+    for (int i = 0; i < 6144; i++)
+    {
+        oldImage += words[random.byte() % 64];
+    }
+
+    std::string changed = oldImage.substr(5000, 7000);
+    for (size_t i = 0; i < changed.size(); i += 97)
+    {
+        changed[i]++;
+    }
+    std::string inserted = random.bytes(200);
+    std::string appended = random.bytes(1500);
+    newImage = oldImage.substr(0, 5000) + inserted + changed + oldImage.substr(13000) + appended;
+}
+
+static esp_fake_partition *running;
+static std::string rebuilt;
+
+static DeltaWriter collect()
+{
+    return [](const uint8_t *data, size_t len)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL(DELTA_OUTPUT_BUFFER_SIZE, len);
+        rebuilt.append((const char *)data, len);
+        return true;
+    };
+}
+
+// feeds the patch in pieces of at most piece bytes, stops at the first failure
+static bool applyPatch(DeltaPatcher &patcher, const uint8_t *patch, size_t size, size_t piece)
+{
+    if (!patcher.begin(collect()))
+    {
+        return false;
+    }
+    for (size_t pos = 0; pos < size; pos += piece)
+    {
+        if (!patcher.write(patch + pos, min(piece, size - pos)))
+        {
+            return false;
+        }
+    }
+    return patcher.end();
+}
+
+void setUp()
+{
+    running = new esp_fake_partition("app0", 0x10000, 64 * 1024);
+    memcpy(running->data.data(), oldImage.data(), oldImage.size());
+    esp_fake_running_partition = &running->partition;
+    rebuilt.clear();
+}
+
+void tearDown()
+{
+    esp_fake_running_partition = NULL;
+    delete running;
+}
+
+void test_header()
+{
+    TEST_ASSERT_TRUE(DeltaPatcher::isDelta(patchFixture, sizeof(patchFixture)));
+    TEST_ASSERT_FALSE(DeltaPatcher::isDelta((const uint8_t *)"\xe9\x03", 2));
+    TEST_ASSERT_EQUAL(newImage.size(), DeltaPatcher::newImageSize(patchFixture));
+}
+
+void test_apply_patch_from_delta_ota()
+{
+    // any split of the upload gives the same image
+    for (size_t piece : {sizeof(patchFixture), (size_t)1460, (size_t)100, (size_t)7, (size_t)1})
+    {
+        rebuilt.clear();
+        DeltaPatcher patcher;
+        TEST_ASSERT_TRUE(applyPatch(patcher, patchFixture, sizeof(patchFixture), piece));
+        TEST_ASSERT_EQUAL(newImage.size(), patcher.written());
+        TEST_ASSERT_EQUAL(newImage.size(), rebuilt.size());
+        TEST_ASSERT_TRUE(rebuilt == newImage);
+    }
+}
+
+void test_reject_wrong_base()
+{
+    // one flipped bit in the running firmware
+    running->data[1234] ^= 0x10;
+    DeltaPatcher patcher;
+    TEST_ASSERT_TRUE(patcher.begin(collect()));
+    TEST_ASSERT_FALSE(patcher.write(patchFixture, sizeof(patchFixture)));
+    TEST_ASSERT_EQUAL_STRING("Running firmware does not match the patch", patcher.errorString());
+    TEST_ASSERT_FALSE(patcher.end());
+    TEST_ASSERT_EQUAL(0, rebuilt.size());
+}
+
+void test_reject_base_larger_than_partition()
+{
+    delete running;
+    running = new esp_fake_partition("app0", 0x10000, 16 * 1024);
+    esp_fake_running_partition = &running->partition;
+
+    DeltaPatcher patcher;
+    TEST_ASSERT_FALSE(applyPatch(patcher, patchFixture, sizeof(patchFixture), 1460));
+    TEST_ASSERT_EQUAL_STRING("Running firmware does not match the patch", patcher.errorString());
+}
+
+void test_reject_truncated_patch()
+{
+    DeltaPatcher patcher;
+    TEST_ASSERT_FALSE(applyPatch(patcher, patchFixture, sizeof(patchFixture) - 100, 1460));
+    TEST_ASSERT_EQUAL_STRING("Patch is incomplete", patcher.errorString());
+    TEST_ASSERT_LESS_THAN(newImage.size(), rebuilt.size());
+}
+
+void test_reject_wrong_checksum()
+{
+    std::vector<uint8_t> patch(patchFixture, patchFixture + sizeof(patchFixture));
+    patch[48] ^= 0xff;
+
+    DeltaPatcher patcher;
+    TEST_ASSERT_FALSE(applyPatch(patcher, patch.data(), patch.size(), 1460));
+    TEST_ASSERT_EQUAL_STRING("Patched image does not match its checksum", patcher.errorString());
+}
+
+void test_reject_corrupt_stream()
+{
+    std::vector<uint8_t> patch(patchFixture, patchFixture + sizeof(patchFixture));
+    patch[DELTA_HEADER_SIZE] = 0xff; // reserved deflate block type
+
+    DeltaPatcher patcher;
+    TEST_ASSERT_FALSE(applyPatch(patcher, patch.data(), patch.size(), 1460));
+    TEST_ASSERT_EQUAL_STRING("Corrupt delta patch", patcher.errorString());
+}
+
+int main()
+{
+    makeImages();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_header);
+    RUN_TEST(test_apply_patch_from_delta_ota);
+    RUN_TEST(test_reject_wrong_base);
+    RUN_TEST(test_reject_base_larger_than_partition);
+    RUN_TEST(test_reject_truncated_patch);
+    RUN_TEST(test_reject_wrong_checksum);
+    RUN_TEST(test_reject_corrupt_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,248 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#define OTA_RESUME_SAVE_INTERVAL 4096
+#define OTA_DOWNLOAD_RETRIES 2
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <ArduinoJsonJWT.cpp>
+#include <BufferedFileStream.cpp>
+#include <DeltaPatcher.cpp>
+#include <EventLog.cpp>
+#include <EventSocket.cpp>
+#include <SettingsFile.cpp>
+#include <DownloadFirmwareService.cpp>
+#include <random>
+
+extern const uint8_t rootca_crt_bundle_start[] asm("_binary_src_certs_x509_crt_bundle_bin_start");
+const uint8_t rootca_crt_bundle_start[] = {0};
+
+#define URL "https://example.com/firmware.bin"
+#define FIRMWARE_SIZE (10 * SPI_FLASH_SEC_SIZE + 1000)
+
+static PsychicHttpServer *server;
+static EventSocket *socket;
+static esp_fake_partition *partition;
+static std::string firmware;
+
+static String hex(const uint8_t *digest)
+{
+    char hex[65];
+    for (int i = 0; i < 32; i++)
+    {
+        sprintf(hex + 2 * i, "%02x", digest[i]);
+    }
+    return hex;
+}
+
+// downloads into the partition, the hash has to come out as the one of the firmware
+static String download(bool *hashMatches = nullptr)
+{
+    DownloadJob job;
+    job.url = URL;
+    uint8_t buffer[SPI_FLASH_SEC_SIZE];
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+
+    String error = downloadFirmware(&job, &partition->partition, buffer, &sha);
+
+    uint8_t digest[32];
+    uint8_t expected[32];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_ret((const uint8_t *)firmware.data(), firmware.size(), expected, 0);
+    if (hashMatches != nullptr)
+    {
+        *hashMatches = hex(digest) == hex(expected);
+    }
+    return error;
+}
+
+static void assertFlashed()
+{
+    TEST_ASSERT_TRUE(memcmp(partition->data.data(), firmware.data(), firmware.size()) == 0);
+}
+
+static JsonDocument resumeState()
+{
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(SettingsFile::read(&LittleFS, OTA_RESUME_FILE, doc));
+    return doc;
+}
+
+void setUp()
+{
+    // the waits between retries only move the clock
+    fakeMillis(0);
+
+    std::mt19937 random(1);
+    firmware.resize(FIRMWARE_SIZE);
+    for (char &c : firmware)
+    {
+        c = random();
+    }
+
+    httpc_fake = httpc_fake_server();
+    httpc_fake.file = firmware;
+    httpc_fake.etag = "\"v2\"";
+
+    LittleFS.files.clear();
+    LittleFS.directories.clear();
+    LittleFS.mkdir("/config");
+
+    server = new PsychicHttpServer();
+    socket = new EventSocket(server, nullptr);
+    _eventSocket = socket;
+    partition = new esp_fake_partition("app1", 0x150000, 16 * SPI_FLASH_SEC_SIZE, ESP_PARTITION_SUBTYPE_APP_OTA_1);
+    // left over from the image before
+    memset(partition->data.data(), 0x5a, partition->data.size());
+}
+
+void tearDown()
+{
+    delete partition;
+    delete socket;
+    delete server;
+}
+
+void test_download()
+{
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+    TEST_ASSERT_EQUAL(1, httpc_fake.requests.size());
+    TEST_ASSERT_EQUAL(11, partition->erases);
+}
+
+void test_resume_after_disconnect()
+{
+    // dropped in the middle of a sector, and again right at the end of one
+    httpc_fake.cutAfter = {10000, 2 * SPI_FLASH_SEC_SIZE};
+
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+
+    TEST_ASSERT_EQUAL(3, httpc_fake.requests.size());
+    TEST_ASSERT_EQUAL_STRING("", httpc_fake.requests[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("bytes=10000-", httpc_fake.requests[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("bytes=18192-", httpc_fake.requests[2].c_str());
+}
+
+void test_resume_after_reboot()
+{
+    // gives up after the retries, the offset is kept
+    httpc_fake.cutAfter = {9000, 0, 0};
+    TEST_ASSERT_EQUAL_STRING("Connection lost, download can be resumed", download().c_str());
+    JsonDocument state = resumeState();
+    TEST_ASSERT_EQUAL(9000, state["offset"].as<int>());
+    TEST_ASSERT_EQUAL(FIRMWARE_SIZE, state["total"].as<int>());
+    TEST_ASSERT_TRUE(LittleFS.exists(OTA_RESUME_FILE SETTINGS_FILE_BACKUP_SUFFIX));
+
+    // the next attempt starts over at the sector the last one stopped in, and hashes what is in flash
+    httpc_fake.requests.clear();
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+    TEST_ASSERT_EQUAL(1, httpc_fake.requests.size());
+    TEST_ASSERT_EQUAL_STRING("bytes=8192-", httpc_fake.requests[0].c_str());
+}
+
+void test_resume_state_survives_a_torn_write()
+{
+    httpc_fake.cutAfter = {9000, 0, 0};
+    download();
+
+    // power lost while the file was rewritten, the backup still has the previous state
+    LittleFS.files[OTA_RESUME_FILE].resize(20);
+    JsonDocument state = resumeState();
+    TEST_ASSERT_EQUAL(FIRMWARE_SIZE, state["total"].as<int>());
+
+    clearResumeState();
+    TEST_ASSERT_FALSE(LittleFS.exists(OTA_RESUME_FILE));
+    TEST_ASSERT_FALSE(LittleFS.exists(OTA_RESUME_FILE SETTINGS_FILE_BACKUP_SUFFIX));
+    TEST_ASSERT_FALSE(LittleFS.exists(OTA_RESUME_FILE SETTINGS_FILE_TMP_SUFFIX));
+}
+
+void test_wrong_range_restarts()
+{
+    // the server answers the resume with data from a different offset
+    httpc_fake.cutAfter = {10000};
+    httpc_fake.rangeOffset = 100;
+
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+
+    TEST_ASSERT_EQUAL(3, httpc_fake.requests.size());
+    TEST_ASSERT_EQUAL_STRING("bytes=10000-", httpc_fake.requests[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("", httpc_fake.requests[2].c_str());
+}
+
+void test_server_without_ranges_restarts()
+{
+    httpc_fake.cutAfter = {10000};
+    httpc_fake.ranges = false;
+
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+    TEST_ASSERT_EQUAL(2, httpc_fake.requests.size());
+}
+
+void test_changed_file_restarts()
+{
+    httpc_fake.cutAfter = {9000, 0, 0};
+    download();
+
+    // a new release under the same URL, If-Range makes the server send all of it
+    std::reverse(firmware.begin(), firmware.end());
+    httpc_fake.file = firmware;
+    httpc_fake.etag = "\"v3\"";
+    httpc_fake.requests.clear();
+
+    bool hashMatches;
+    TEST_ASSERT_EQUAL_STRING("", download(&hashMatches).c_str());
+    TEST_ASSERT_TRUE(hashMatches);
+    assertFlashed();
+    TEST_ASSERT_EQUAL_STRING("bytes=8192-", httpc_fake.requests[0].c_str());
+}
+
+void test_http_error_is_not_retried()
+{
+    httpc_fake.status = HTTP_CODE_NOT_FOUND;
+    TEST_ASSERT_EQUAL_STRING("Download failed with HTTP code 404", download().c_str());
+    TEST_ASSERT_EQUAL(1, httpc_fake.requests.size());
+}
+
+int main()
+{
+    esp_log_level_set("*", ESP_LOG_ERROR);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_download);
+    RUN_TEST(test_resume_after_disconnect);
+    RUN_TEST(test_resume_after_reboot);
+    RUN_TEST(test_resume_state_survives_a_torn_write);
+    RUN_TEST(test_wrong_range_restarts);
+    RUN_TEST(test_server_without_ranges_restarts);
+    RUN_TEST(test_changed_file_restarts);
+    RUN_TEST(test_http_error_is_not_retried);
+    return UNITY_END();
+}
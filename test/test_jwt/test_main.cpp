@@ -0,0 +1,187 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <ArduinoJsonJWT.cpp>
+
+// RFC 7515 appendix A.1, JWS using HMAC SHA-256
+static const char A1_HEADER[] = "eyJ0eXAiOiJKV1QiLA0KICJhbGciOiJIUzI1NiJ9";
+static const char A1_PAYLOAD[] = "eyJpc3MiOiJqb2UiLA0KICJleHAiOjEzMDA4MTkzODAsDQogImh0dHA6Ly9leGFtcGxlLmNvbS9pc19yb290Ijp0cnVlfQ";
+static const char A1_SIGNATURE[] = "dBjftJeZ4CVP-mB92K27uhbUJU1p1r_wW1gFWFOEjXk";
+static const char A1_KEY[] = "AyM1SysPpbyDfgZld3umj1qzKObwVMkoqQ-EstJQLr_T-1qS0gZH75aKtMN3Yj0iPS4hcgUuTwjAzZr1Z9CAow";
+static const char A1_PAYLOAD_JSON[] = "{\"iss\":\"joe\",\r\n \"exp\":1300819380,\r\n \"http://example.com/is_root\":true}";
+
+// the signature is only reachable for subclasses
+class TestJWT : public ArduinoJsonJWT
+{
+public:
+    TestJWT(String secret) : ArduinoJsonJWT(secret) {}
+    using ArduinoJsonJWT::sign;
+};
+
+static String a1Key()
+{
+    uint8_t key[64];
+    int length = ArduinoJsonJWT::decode(A1_KEY, strlen(A1_KEY), key, sizeof(key));
+    TEST_ASSERT_EQUAL(64, length);
+    return String((const char *)key, length);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_a1_payload_decodes()
+{
+    char json[sizeof(A1_PAYLOAD_JSON) + 2];
+    int length = ArduinoJsonJWT::decode(A1_PAYLOAD, strlen(A1_PAYLOAD), (uint8_t *)json, sizeof(json));
+    TEST_ASSERT_EQUAL(strlen(A1_PAYLOAD_JSON), length);
+    TEST_ASSERT_EQUAL_MEMORY(A1_PAYLOAD_JSON, json, length);
+
+    char encoded[sizeof(A1_PAYLOAD)];
+    length = ArduinoJsonJWT::encode((const uint8_t *)A1_PAYLOAD_JSON, strlen(A1_PAYLOAD_JSON), encoded, sizeof(encoded));
+    TEST_ASSERT_EQUAL(strlen(A1_PAYLOAD), length);
+    TEST_ASSERT_EQUAL_STRING(A1_PAYLOAD, encoded);
+}
+
+void test_a1_signature()
+{
+    TestJWT jwt(a1Key());
+    String signingInput = String(A1_HEADER) + "." + A1_PAYLOAD;
+
+    uint8_t signature[JWT_SIGNATURE_SIZE];
+    jwt.sign(signingInput.c_str(), signingInput.length(), signature);
+    char encoded[JWT_BASE64_LENGTH(JWT_SIGNATURE_SIZE) + 1];
+    TEST_ASSERT_EQUAL(strlen(A1_SIGNATURE), ArduinoJsonJWT::encode(signature, sizeof(signature), encoded, sizeof(encoded)));
+    TEST_ASSERT_EQUAL_STRING(A1_SIGNATURE, encoded);
+}
+
+// only {"alg":"HS256","typ":"JWT"} is accepted, even with a valid signature
+void test_a1_token_rejected_for_its_header()
+{
+    ArduinoJsonJWT jwt(a1Key());
+    String token = String(A1_HEADER) + "." + A1_PAYLOAD + "." + A1_SIGNATURE;
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(jwt.parseJWT(token.c_str(), token.length(), doc));
+    TEST_ASSERT_TRUE(doc.isNull());
+}
+
+void test_round_trip()
+{
+    ArduinoJsonJWT jwt(a1Key());
+    JsonDocument payload;
+    payload["iss"] = "joe";
+    payload["exp"] = 1300819380;
+    payload["http://example.com/is_root"] = true;
+    JsonObject object = payload.as<JsonObject>();
+
+    char token[JWT_MAX_LENGTH];
+    size_t length = jwt.buildJWT(object, token, sizeof(token));
+    TEST_ASSERT_GREATER_THAN(0, length);
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(jwt.parseJWT(token, length, doc));
+    TEST_ASSERT_EQUAL_STRING("joe", doc["iss"].as<const char *>());
+    TEST_ASSERT_EQUAL(1300819380, doc["exp"].as<long>());
+    TEST_ASSERT_TRUE(doc["http://example.com/is_root"].as<bool>());
+}
+
+void test_tampered_tokens_rejected()
+{
+    ArduinoJsonJWT jwt(a1Key());
+    JsonDocument payload;
+    payload["username"] = "guest";
+    JsonObject object = payload.as<JsonObject>();
+    char token[JWT_MAX_LENGTH];
+    size_t length = jwt.buildJWT(object, token, sizeof(token));
+    JsonDocument doc;
+
+    // every single changed character has to break the token
+    for (size_t i = 0; i < length; i++)
+    {
+        char original = token[i];
+        token[i] = original == 'A' ? 'B' : 'A';
+        TEST_ASSERT_FALSE(jwt.parseJWT(token, length, doc));
+        token[i] = original;
+    }
+
+    ArduinoJsonJWT other("secret");
+    TEST_ASSERT_FALSE(other.parseJWT(token, length, doc));
+    TEST_ASSERT_FALSE(jwt.parseJWT(token, length - 1, doc));
+    TEST_ASSERT_TRUE(jwt.parseJWT(token, length, doc));
+}
+
+void test_oversized_payload_rejected()
+{
+    ArduinoJsonJWT jwt("secret");
+    JsonDocument payload;
+    payload["data"] = std::string(JWT_MAX_PAYLOAD_SIZE, 'x');
+    JsonObject object = payload.as<JsonObject>();
+    char token[JWT_MAX_LENGTH];
+    TEST_ASSERT_EQUAL(0, jwt.buildJWT(object, token, sizeof(token)));
+}
+
+// what a request costs without the token cache, step by step
+void test_benchmark()
+{
+    TestJWT jwt(a1Key());
+    JsonDocument payload;
+    payload["username"] = "admin";
+    payload["admin"] = true;
+    payload["permissions"] = 0xFFFF;
+    JsonObject object = payload.as<JsonObject>();
+    char token[JWT_MAX_LENGTH];
+    size_t length = jwt.buildJWT(object, token, sizeof(token));
+    TEST_ASSERT_GREATER_THAN(0, length);
+
+    const char *body = strchr(token, '.') + 1;
+    size_t bodyLength = strchr(body, '.') - body;
+    uint8_t decoded[JWT_MAX_PAYLOAD_SIZE];
+    uint8_t signature[JWT_SIGNATURE_SIZE];
+    char encoded[JWT_BASE64_LENGTH(JWT_SIGNATURE_SIZE) + 1];
+    bool valid = true;
+
+    benchmark("jwt sign (HMAC-SHA256)", [&]()
+              {
+        jwt.sign(token, length, signature);
+        benchmarkKeep(signature); });
+    benchmark("jwt encode signature", [&]()
+              { valid &= ArduinoJsonJWT::encode(signature, sizeof(signature), encoded, sizeof(encoded)) > 0; });
+    benchmark("jwt decode payload", [&]()
+              { valid &= ArduinoJsonJWT::decode(body, bodyLength, decoded, sizeof(decoded)) > 0; });
+    benchmark("jwt build", [&]()
+              { valid &= jwt.buildJWT(object, token, sizeof(token)) == length; });
+    benchmark("jwt parse", [&]()
+              {
+        JsonDocument doc;
+        valid &= jwt.parseJWT(token, length, doc); });
+    TEST_ASSERT_TRUE(valid);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_a1_payload_decodes);
+    RUN_TEST(test_a1_signature);
+    RUN_TEST(test_a1_token_rejected_for_its_header);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_tampered_tokens_rejected);
+    RUN_TEST(test_oversized_payload_rejected);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <PsychicHttpSources.h>
+#include <ArduinoJsonJWT.cpp>
+#include <JWTCache.cpp>
+
+static JWTCache *cache;
+
+static String token(int i)
+{
+    return String("eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.user") + String(i) + ".signature";
+}
+
+static Authentication user(int i)
+{
+    return Authentication(String("user") + String(i), PERMISSION_AUTHENTICATED | PERMISSION_READ_RELAYS);
+}
+
+static void store(int i)
+{
+    cache->store(token(i), JWTCache::hash(token(i)), cache->generation(), user(i));
+}
+
+static bool cached(int i)
+{
+    Authentication authentication;
+    bool found = cache->lookup(token(i), JWTCache::hash(token(i)), authentication);
+    if (found)
+    {
+        TEST_ASSERT_EQUAL_STRING(user(i).username.c_str(), authentication.username.c_str());
+        TEST_ASSERT_EQUAL(user(i).permissions, authentication.permissions);
+    }
+    return found;
+}
+
+void setUp()
+{
+    cache = new JWTCache();
+}
+
+void tearDown()
+{
+    delete cache;
+}
+
+void test_lookup_after_store()
+{
+    TEST_ASSERT_FALSE(cached(1));
+    store(1);
+    TEST_ASSERT_TRUE(cached(1));
+    TEST_ASSERT_FALSE(cached(2));
+}
+
+void test_same_hash_other_token()
+{
+    store(1);
+    // the hash only skips compares, the token decides
+    Authentication authentication;
+    TEST_ASSERT_FALSE(cache->lookup(token(2), JWTCache::hash(token(1)), authentication));
+    TEST_ASSERT_FALSE(authentication.authenticated);
+}
+
+void test_evicts_least_recently_used()
+{
+    for (int i = 0; i < JWT_CACHE_SIZE; i++)
+    {
+        store(i);
+    }
+    for (int i = 0; i < JWT_CACHE_SIZE; i++)
+    {
+        TEST_ASSERT_TRUE(cached(i));
+    }
+
+    // looking 0 up again leaves 1 as the least recently used
+    TEST_ASSERT_TRUE(cached(0));
+    store(100);
+    TEST_ASSERT_TRUE(cached(100));
+    TEST_ASSERT_TRUE(cached(0));
+    TEST_ASSERT_FALSE(cached(1));
+
+    // and then the one after it
+    store(101);
+    TEST_ASSERT_FALSE(cached(2));
+    for (int i = 3; i < JWT_CACHE_SIZE; i++)
+    {
+        TEST_ASSERT_TRUE(cached(i));
+    }
+}
+
+void test_clear_drops_entries()
+{
+    for (int i = 0; i < JWT_CACHE_SIZE; i++)
+    {
+        store(i);
+    }
+    uint32_t generation = cache->generation();
+    cache->clear();
+
+    TEST_ASSERT_EQUAL(generation + 1, cache->generation());
+    for (int i = 0; i < JWT_CACHE_SIZE; i++)
+    {
+        TEST_ASSERT_FALSE(cached(i));
+    }
+    store(1);
+    TEST_ASSERT_TRUE(cached(1));
+}
+
+void test_result_from_before_clear_is_not_stored()
+{
+    // a token verified while the users changed resolved against the old users
+    uint32_t generation = cache->generation();
+    cache->clear();
+    cache->store(token(1), JWTCache::hash(token(1)), generation, user(1));
+    TEST_ASSERT_FALSE(cached(1));
+
+    cache->store(token(1), JWTCache::hash(token(1)), cache->generation(), user(1));
+    TEST_ASSERT_TRUE(cached(1));
+}
+
+void test_benchmark()
+{
+    ArduinoJsonJWT jwt("benchmark-secret");
+    JsonDocument payload;
+    payload["username"] = "admin";
+    payload["admin"] = true;
+    payload["permissions"] = 0xcf;
+    JsonObject root = payload.as<JsonObject>();
+    String signedToken = jwt.buildJWT(root);
+    uint32_t signedHash = JWTCache::hash(signedToken);
+
+    // a full cache, the token looked up is in the last entry
+    for (int i = 0; i < JWT_CACHE_SIZE - 1; i++)
+    {
+        store(i);
+    }
+    cache->store(signedToken, signedHash, cache->generation(), user(0));
+
+    Authentication authentication;
+    benchmark("jwt cache hash", [&]()
+              { benchmarkKeep(JWTCache::hash(signedToken)); });
+    benchmark("jwt cache hit", [&]()
+              { benchmarkKeep(cache->lookup(signedToken, JWTCache::hash(signedToken), authentication)); });
+    String missing = token(1000);
+    benchmark("jwt cache miss", [&]()
+              { benchmarkKeep(cache->lookup(missing, JWTCache::hash(missing), authentication)); });
+    benchmark("jwt cache store (evicts)", [&]()
+              { cache->store(missing, JWTCache::hash(missing), cache->generation(), authentication); });
+    benchmark("jwt parse (what a hit saves)", [&]()
+              {
+        JsonDocument parsed;
+        jwt.parseJWT(signedToken, parsed);
+        benchmarkKeep(parsed.isNull()); });
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lookup_after_store);
+    RUN_TEST(test_same_hash_other_token);
+    RUN_TEST(test_evicts_least_recently_used);
+    RUN_TEST(test_clear_drops_entries);
+    RUN_TEST(test_result_from_before_clear_is_not_stored);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
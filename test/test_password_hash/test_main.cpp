@@ -0,0 +1,215 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <PsychicHttpSources.h>
+#include <ArduinoJsonJWT.cpp>
+#include <BufferedFileStream.cpp>
+#include <JWTCache.cpp>
+#include <PasswordHash.cpp>
+#include <SettingValue.cpp>
+#include <SettingsFile.cpp>
+#include <SettingsStore.cpp>
+#include <StatefulService.cpp>
+#include <SecuritySettingsService.cpp>
+
+// made with Python's hashlib.pbkdf2_hmac, password "correct horse", salt 00 01 .. 0f
+#define SALT "000102030405060708090a0b0c0d0e0f"
+#define HASH_1000 "pbkdf2-sha256$1000$" SALT "$c914cc4f06cc6e8f46d157e3a1b5aa7abceebb17bb0444cd4c4ac16ca2ae9864"
+#define HASH_1 "pbkdf2-sha256$1$" SALT "$c5199f52d095f03bb27ace7b385711999c67ec4aacd0f298a6da36ce47520daf"
+#define HASH_MAX "pbkdf2-sha256$100000$" SALT "$57f2c2f0739748d516419b062a884666323c583ea4ae165504a81f7b53c62a09"
+#define HASH_OVER_MAX "pbkdf2-sha256$100001$" SALT "$7502cb29892518d9551f3eeb8715a44fff8f7af26a587dc82c945daec395897d"
+#define KEY_1 "c5199f52d095f03bb27ace7b385711999c67ec4aacd0f298a6da36ce47520daf"
+
+static FS fileSystem;
+static PsychicHttpServer *server;
+
+// verifies and returns the PBKDF2 rounds it took
+static uint64_t verifyRounds(const char *hash, bool expected, const char *password = "correct horse")
+{
+    mbedtls_fake_pbkdf2_rounds = 0;
+    TEST_ASSERT_EQUAL_MESSAGE(expected, PasswordHash::verify(password, hash), hash);
+    return mbedtls_fake_pbkdf2_rounds;
+}
+
+static String usersFile(const char *adminPassword, const char *guestPassword)
+{
+    return String("{\"jwt_secret\":\"secret\",\"users\":[") +
+           "{\"username\":\"admin\",\"password\":\"" + adminPassword + "\",\"admin\":true,\"permissions\":255}," +
+           "{\"username\":\"guest\",\"password\":\"" + guestPassword + "\",\"admin\":false,\"permissions\":1}]}";
+}
+
+static String storedFile()
+{
+    std::vector<uint8_t> &file = fileSystem.files[SECURITY_SETTINGS_FILE];
+    return String((const char *)file.data(), file.size());
+}
+
+void setUp()
+{
+    fileSystem.files.clear();
+    fileSystem.directories.clear();
+    fileSystem.mkdir("/config");
+    server = new PsychicHttpServer();
+    server->listen(80);
+}
+
+void tearDown()
+{
+    // deletes the server as well
+    server->stop();
+}
+
+void test_hash_and_verify()
+{
+    String hash = PasswordHash::hash("correct horse");
+    TEST_ASSERT_TRUE(PasswordHash::isHash(hash));
+    TEST_ASSERT_TRUE(hash.startsWith(PASSWORD_HASH_PREFIX "1000$"));
+    TEST_ASSERT_EQUAL(strlen(HASH_1000), hash.length());
+
+    TEST_ASSERT_EQUAL(PASSWORD_HASH_ITERATIONS, verifyRounds(hash.c_str(), true));
+    verifyRounds(hash.c_str(), false, "correct horse ");
+    verifyRounds(hash.c_str(), false, "");
+
+    // a new salt every time
+    TEST_ASSERT_FALSE(hash == PasswordHash::hash("correct horse"));
+}
+
+void test_verify_hash_made_elsewhere()
+{
+    TEST_ASSERT_EQUAL(1000, verifyRounds(HASH_1000, true));
+    TEST_ASSERT_EQUAL(1, verifyRounds(HASH_1, true));
+    verifyRounds(HASH_1000, false, "correct hors");
+}
+
+void test_verify_rejects_malformed_hashes()
+{
+    const char *malformed[] = {
+        "",
+        "correct horse", // plaintext is never taken as a hash
+        "pbkdf2-sha256$",
+        "pbkdf2-sha1$1$" SALT "$" KEY_1,
+        "pbkdf2-sha256$0$" SALT "$" KEY_1,
+        "pbkdf2-sha256$$" SALT "$" KEY_1,
+        "pbkdf2-sha256$ 1$" SALT "$" KEY_1,
+        "pbkdf2-sha256$+1$" SALT "$" KEY_1,
+        "pbkdf2-sha256$-4294967295$" SALT "$" KEY_1, // wraps around to 1 in strtoul
+        "pbkdf2-sha256$18446744073709551617$" SALT "$" KEY_1,
+        "pbkdf2-sha256$4294967297$" SALT "$" KEY_1, // 1 in 32 bits
+        "pbkdf2-sha256$1x$" SALT "$" KEY_1,
+        "pbkdf2-sha256$1" SALT "$" KEY_1,
+        "pbkdf2-sha256$1$" SALT KEY_1,
+        "pbkdf2-sha256$1$" SALT "$" KEY_1 "0",
+        "pbkdf2-sha256$1$" SALT "0$" KEY_1,
+        "pbkdf2-sha256$1$" SALT "$c5199f52d095f03bb27ace7b385711999c67ec4aacd0f298a6da36ce47520da",
+        "pbkdf2-sha256$1$" SALT "$C5199F52D095F03BB27ACE7B385711999C67EC4AACD0F298A6DA36CE47520DAF",
+        "pbkdf2-sha256$1$" SALT "$c5199f52d095f03bb27ace7b385711999c67ec4aacd0f298a6da36ce47520dag",
+    };
+    for (const char *hash : malformed)
+    {
+        // always the work of a regular hash, a broken entry can't be told apart by timing
+        TEST_ASSERT_EQUAL_MESSAGE(PASSWORD_HASH_ITERATIONS, verifyRounds(hash, false), hash);
+    }
+}
+
+void test_iteration_cap()
+{
+    TEST_ASSERT_EQUAL(PASSWORD_HASH_MAX_ITERATIONS, verifyRounds(HASH_MAX, true));
+
+    // a correct key above the cap is not even derived
+    TEST_ASSERT_EQUAL(PASSWORD_HASH_ITERATIONS, verifyRounds(HASH_OVER_MAX, false));
+    TEST_ASSERT_EQUAL(PASSWORD_HASH_ITERATIONS, verifyRounds("pbkdf2-sha256$4294967295$" SALT "$" KEY_1, false));
+}
+
+void test_unknown_user_costs_a_verification()
+{
+    SecuritySettingsService service(server, &fileSystem);
+    service.begin();
+
+    mbedtls_fake_pbkdf2_rounds = 0;
+    TEST_ASSERT_FALSE(service.authenticate("nobody", "admin").authenticated);
+    TEST_ASSERT_EQUAL(PASSWORD_HASH_ITERATIONS, mbedtls_fake_pbkdf2_rounds);
+}
+
+void test_plaintext_passwords_are_migrated()
+{
+    // a settings file from before passwords were hashed
+    String plaintext = usersFile("sesame", "guest");
+    fileSystem.files[SECURITY_SETTINGS_FILE].assign(plaintext.c_str(), plaintext.c_str() + plaintext.length());
+
+    SecuritySettingsService service(server, &fileSystem);
+    service.begin();
+
+    // written back right away, without the plaintext
+    String stored = storedFile();
+    TEST_ASSERT_TRUE(stored.indexOf("sesame") < 0);
+    TEST_ASSERT_TRUE(stored.indexOf("\"guest\",\"password\":\"guest\"") < 0);
+    TEST_ASSERT_TRUE(stored.indexOf(PASSWORD_HASH_PREFIX) >= 0);
+
+    TEST_ASSERT_TRUE(service.authenticate("admin", "sesame").authenticated);
+    TEST_ASSERT_TRUE(service.authenticate("guest", "guest").authenticated);
+    TEST_ASSERT_FALSE(service.authenticate("admin", "guest").authenticated);
+}
+
+void test_hashed_passwords_are_kept()
+{
+    String hashed = usersFile(HASH_1000, HASH_1);
+    fileSystem.files[SECURITY_SETTINGS_FILE].assign(hashed.c_str(), hashed.c_str() + hashed.length());
+
+    SecuritySettingsService service(server, &fileSystem);
+    service.begin();
+
+    // nothing to migrate, the file is left alone
+    TEST_ASSERT_EQUAL_STRING(hashed.c_str(), storedFile().c_str());
+    TEST_ASSERT_TRUE(service.authenticate("admin", "correct horse").authenticated);
+    TEST_ASSERT_TRUE(service.authenticate("guest", "correct horse").authenticated);
+
+    // the UI sends stored hashes back unchanged, only new passwords are hashed
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, hashed));
+    doc["users"][1]["password"] = "new";
+    JsonObject root = doc.as<JsonObject>();
+    service.update(root, SecuritySettings::update, "test");
+
+    TEST_ASSERT_TRUE(service.authenticate("admin", "correct horse").authenticated);
+    TEST_ASSERT_FALSE(service.authenticate("guest", "correct horse").authenticated);
+    TEST_ASSERT_TRUE(service.authenticate("guest", "new").authenticated);
+}
+
+void test_benchmark()
+{
+    String hash = PasswordHash::hash("correct horse");
+    benchmark("PasswordHash::hash", [&]
+              { benchmarkKeep(PasswordHash::hash("correct horse")); });
+    benchmark("PasswordHash::verify", [&]
+              { benchmarkKeep(PasswordHash::verify("correct horse", hash)); });
+    benchmark("PasswordHash::verify malformed", [&]
+              { benchmarkKeep(PasswordHash::verify("correct horse", "pbkdf2-sha256$1x")); });
+    benchmark("PasswordHash::isHash", [&]
+              { benchmarkKeep(PasswordHash::isHash(hash)); });
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_and_verify);
+    RUN_TEST(test_verify_hash_made_elsewhere);
+    RUN_TEST(test_verify_rejects_malformed_hashes);
+    RUN_TEST(test_iteration_cap);
+    RUN_TEST(test_unknown_user_costs_a_verification);
+    RUN_TEST(test_plaintext_passwords_are_migrated);
+    RUN_TEST(test_hashed_passwords_are_kept);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,214 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+// the real scheduler, test/stubs has one with the same include guard for the other tests
+#include "../../lib/framework/PersistenceScheduler.h"
+#include <PersistenceScheduler.cpp>
+
+#define QUIET PERSISTENCE_QUIET_PERIOD_MS
+#define MAX_DELAY PERSISTENCE_MAX_DELAY_MS
+
+static int writes;
+static int failuresLeft;
+
+static bool writer()
+{
+    if (failuresLeft > 0)
+    {
+        failuresLeft--;
+        return false;
+    }
+    writes++;
+    return true;
+}
+
+// advances the clock and runs what the task would run then
+static uint32_t runAt(unsigned long ms, bool *failed = nullptr)
+{
+    advanceMillis(ms);
+    return writeDue(false, failed);
+}
+
+void setUp()
+{
+    fakeMillis(1000000);
+    entries.clear();
+    discarded = false;
+    changeCount = 0;
+    writeCount = 0;
+    writes = 0;
+    failuresLeft = 0;
+
+    // the test calls writeDue() itself, markDirty() only notifies the test's own task
+    taskHandle = xTaskGetCurrentTaskHandle();
+}
+
+void tearDown()
+{
+}
+
+void test_burst_is_one_write()
+{
+    persistence_id_t id = PersistenceScheduler::add(writer);
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, writeDue(false, nullptr));
+
+    for (int i = 0; i < 5; i++)
+    {
+        PersistenceScheduler::markDirty(id);
+        // due one quiet period after the latest change
+        TEST_ASSERT_EQUAL(QUIET - 200, runAt(200));
+    }
+    TEST_ASSERT_EQUAL(0, writes);
+
+    TEST_ASSERT_EQUAL(1, runAt(QUIET - 201));
+    TEST_ASSERT_EQUAL(0, writes);
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(1));
+    TEST_ASSERT_EQUAL(1, writes);
+
+    TEST_ASSERT_EQUAL(5, PersistenceScheduler::changes());
+    TEST_ASSERT_EQUAL(1, PersistenceScheduler::writes());
+    TEST_ASSERT_EQUAL(4, PersistenceScheduler::writesAvoided());
+
+    // nothing more without a change
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(10 * MAX_DELAY));
+    TEST_ASSERT_EQUAL(1, writes);
+}
+
+void test_max_delay_deadline()
+{
+    persistence_id_t id = PersistenceScheduler::add(writer);
+
+    // a change every half quiet period never leaves the state quiet
+    unsigned long elapsed = 0;
+    while (elapsed < MAX_DELAY - QUIET / 2)
+    {
+        PersistenceScheduler::markDirty(id);
+        uint32_t wait = runAt(QUIET / 2);
+        elapsed += QUIET / 2;
+        TEST_ASSERT_EQUAL(min((unsigned long)QUIET / 2, MAX_DELAY - elapsed), wait);
+    }
+    TEST_ASSERT_EQUAL(0, writes);
+
+    PersistenceScheduler::markDirty(id);
+    TEST_ASSERT_EQUAL(1, runAt(QUIET / 2 - 1));
+    TEST_ASSERT_EQUAL(0, writes);
+
+    // written MAX_DELAY after the first change, although the last one was just now
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(1));
+    TEST_ASSERT_EQUAL(1, writes);
+    TEST_ASSERT_EQUAL(MAX_DELAY / (QUIET / 2), PersistenceScheduler::changes());
+    TEST_ASSERT_EQUAL(MAX_DELAY / (QUIET / 2) - 1, PersistenceScheduler::writesAvoided());
+}
+
+void test_entries_have_their_own_delays()
+{
+    persistence_id_t settings = PersistenceScheduler::add(writer);
+    persistence_id_t log = PersistenceScheduler::add(writer, 5 * QUIET, 30000, false);
+
+    PersistenceScheduler::markDirty(settings);
+    PersistenceScheduler::markDirty(log);
+    TEST_ASSERT_EQUAL(4 * QUIET, runAt(QUIET));
+    TEST_ASSERT_EQUAL(1, writes);
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(4 * QUIET));
+    TEST_ASSERT_EQUAL(2, writes);
+
+    // the log is not counted
+    TEST_ASSERT_EQUAL(1, PersistenceScheduler::changes());
+    TEST_ASSERT_EQUAL(1, PersistenceScheduler::writes());
+    TEST_ASSERT_EQUAL(0, PersistenceScheduler::writesAvoided());
+}
+
+void test_failed_write_is_retried()
+{
+    persistence_id_t id = PersistenceScheduler::add(writer);
+    failuresLeft = 2;
+
+    PersistenceScheduler::markDirty(id);
+    bool failed = false;
+    TEST_ASSERT_EQUAL(QUIET, runAt(QUIET, &failed));
+    TEST_ASSERT_TRUE(failed);
+    TEST_ASSERT_EQUAL(1, failuresLeft);
+
+    // retried one quiet period later, not before
+    TEST_ASSERT_EQUAL(1, runAt(QUIET - 1));
+    TEST_ASSERT_EQUAL(1, failuresLeft);
+    failed = false;
+    TEST_ASSERT_EQUAL(QUIET, runAt(1, &failed));
+    TEST_ASSERT_TRUE(failed);
+    TEST_ASSERT_EQUAL(0, failuresLeft);
+
+    failed = false;
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(QUIET, &failed));
+    TEST_ASSERT_FALSE(failed);
+    TEST_ASSERT_EQUAL(1, writes);
+
+    // failed attempts are not writes
+    TEST_ASSERT_EQUAL(1, PersistenceScheduler::writes());
+    TEST_ASSERT_EQUAL(0, PersistenceScheduler::writesAvoided());
+}
+
+void test_flush_writes_everything_pending()
+{
+    persistence_id_t first = PersistenceScheduler::add(writer);
+    persistence_id_t second = PersistenceScheduler::add(writer);
+    PersistenceScheduler::add(writer);
+
+    PersistenceScheduler::markDirty(first);
+    PersistenceScheduler::markDirty(second);
+    PersistenceScheduler::markDirty(second);
+    TEST_ASSERT_TRUE(PersistenceScheduler::flush());
+    TEST_ASSERT_EQUAL(2, writes);
+    TEST_ASSERT_EQUAL(1, PersistenceScheduler::writesAvoided());
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(QUIET));
+
+    failuresLeft = 1;
+    PersistenceScheduler::markDirty(first);
+    TEST_ASSERT_FALSE(PersistenceScheduler::flush());
+    TEST_ASSERT_TRUE(PersistenceScheduler::flush());
+    TEST_ASSERT_EQUAL(3, writes);
+}
+
+void test_discard_drops_pending_writes()
+{
+    persistence_id_t id = PersistenceScheduler::add(writer);
+    PersistenceScheduler::markDirty(id);
+    PersistenceScheduler::discard();
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(MAX_DELAY));
+
+    PersistenceScheduler::markDirty(id);
+    TEST_ASSERT_TRUE(PersistenceScheduler::flush());
+    TEST_ASSERT_EQUAL(0, writes);
+}
+
+void test_removed_entry_is_not_written()
+{
+    persistence_id_t id = PersistenceScheduler::add(writer);
+    PersistenceScheduler::markDirty(id);
+    PersistenceScheduler::remove(id);
+    TEST_ASSERT_EQUAL(NOTHING_PENDING, runAt(MAX_DELAY));
+    TEST_ASSERT_EQUAL(0, writes);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_is_one_write);
+    RUN_TEST(test_max_delay_deadline);
+    RUN_TEST(test_entries_have_their_own_delays);
+    RUN_TEST(test_failed_write_is_retried);
+    RUN_TEST(test_flush_writes_everything_pending);
+    RUN_TEST(test_discard_drops_pending_writes);
+    RUN_TEST(test_removed_entry_is_not_written);
+    return UNITY_END();
+}
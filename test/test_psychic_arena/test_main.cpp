@@ -0,0 +1,241 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <Benchmark.h>
+
+#define HEADERS 8
+
+/*
+ * Counts heap allocations. glibc lets a program replace malloc() and reaches its own through
+ * __libc_malloc(), new and strdup() end up here as well. Elsewhere nothing is counted.
+ */
+static size_t mallocs = 0;
+
+#ifdef __GLIBC__
+#define COUNTS_MALLOC 1
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *malloc(size_t size)
+{
+  mallocs++;
+  return __libc_malloc(size);
+}
+#else
+#define COUNTS_MALLOC 0
+#endif
+
+typedef std::list<HTTPHeader, PsychicArenaAllocator<HTTPHeader>> Headers;
+
+// what a response does with its headers, with the arena of the connection or without one
+static void respond(PsychicArena *arena)
+{
+  if (arena != NULL)
+    arena->retain();
+  {
+    Headers headers{PsychicArenaAllocator<HTTPHeader>(arena)};
+    for (int i = 0; i < HEADERS; i++)
+    {
+      HTTPHeader header;
+      header.field = arena != NULL ? arena->strdup("Cache-Control") : strdup("Cache-Control");
+      header.value = arena != NULL ? arena->strdup("no-cache, no-store, must-revalidate") : strdup("no-cache, no-store, must-revalidate");
+      headers.push_back(header);
+    }
+    if (arena == NULL)
+    {
+      for (HTTPHeader header : headers)
+      {
+        free(header.field);
+        free(header.value);
+      }
+    }
+  }
+  if (arena != NULL)
+    arena->release();
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_alloc_is_aligned_and_owned()
+{
+  PsychicArena arena(256);
+  int outside;
+  TEST_ASSERT_FALSE(arena.owns(&outside));
+
+  for (size_t size = 1; size < 20; size++)
+  {
+    uint8_t *ptr = (uint8_t *)arena.alloc(size);
+    TEST_ASSERT_NOT_NULL(ptr);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)ptr % 8);
+    TEST_ASSERT_TRUE(arena.owns(ptr));
+    TEST_ASSERT_TRUE(arena.owns(ptr + size - 1));
+  }
+  TEST_ASSERT_FALSE(arena.owns(&outside));
+
+  char *copy = arena.strdup("Content-Type");
+  TEST_ASSERT_EQUAL_STRING("Content-Type", copy);
+  TEST_ASSERT_TRUE(arena.owns(copy));
+}
+
+void test_overflow_chains_blocks()
+{
+  PsychicArena arena(64);
+  char *first = (char *)arena.alloc(40);
+  memset(first, 'a', 40);
+  TEST_ASSERT_EQUAL(64, arena.capacity());
+
+  // does not fit in the rest of the block, a second one is chained on
+  char *second = (char *)arena.alloc(40);
+  memset(second, 'b', 40);
+  TEST_ASSERT_EQUAL(128, arena.capacity());
+  TEST_ASSERT_EQUAL(80, arena.used());
+  TEST_ASSERT_TRUE(arena.owns(first));
+  TEST_ASSERT_TRUE(arena.owns(second));
+  for (int i = 0; i < 40; i++)
+  {
+    TEST_ASSERT_EQUAL('a', first[i]);
+  }
+
+  // bigger than a block, gets a block of its own size
+  char *large = (char *)arena.alloc(200);
+  TEST_ASSERT_NOT_NULL(large);
+  TEST_ASSERT_TRUE(arena.owns(large + 199));
+  TEST_ASSERT_EQUAL(328, arena.capacity());
+  TEST_ASSERT_EQUAL(280, arena.used());
+}
+
+void test_reset_grows_block_after_overflow()
+{
+  PsychicArena arena(64);
+  arena.alloc(40);
+  arena.alloc(40);
+  arena.alloc(40);
+  TEST_ASSERT_EQUAL(192, arena.capacity());
+
+  // one block as big as the chain was, the same traffic then fits
+  arena.reset();
+  TEST_ASSERT_EQUAL(192, arena.capacity());
+  TEST_ASSERT_EQUAL(0, arena.used());
+
+  size_t before = mallocs;
+  arena.alloc(40);
+  arena.alloc(40);
+  arena.alloc(40);
+  if (COUNTS_MALLOC)
+    TEST_ASSERT_EQUAL(before, mallocs);
+  TEST_ASSERT_EQUAL(192, arena.capacity());
+  TEST_ASSERT_EQUAL(120, arena.used());
+
+  // without an overflow the block is only emptied
+  arena.reset();
+  TEST_ASSERT_EQUAL(192, arena.capacity());
+  TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+void test_reset_grows_at_most_to_max_size()
+{
+  PsychicArena arena(PSYCHIC_ARENA_SIZE);
+  for (size_t total = 0; total <= PSYCHIC_ARENA_MAX_SIZE; total += 512)
+    TEST_ASSERT_NOT_NULL(arena.alloc(512));
+  TEST_ASSERT_GREATER_THAN(PSYCHIC_ARENA_MAX_SIZE, arena.capacity());
+
+  arena.reset();
+  TEST_ASSERT_EQUAL(PSYCHIC_ARENA_MAX_SIZE, arena.capacity());
+}
+
+// nested requests on a connection share the arena, only the outermost one empties it
+void test_release_resets_outermost()
+{
+  PsychicArena arena(256);
+  arena.retain();
+  arena.alloc(16);
+  arena.retain();
+  arena.alloc(16);
+  arena.release();
+  TEST_ASSERT_EQUAL(32, arena.used());
+  arena.release();
+  TEST_ASSERT_EQUAL(0, arena.used());
+
+  // an unbalanced release does not underflow
+  arena.release();
+  arena.retain();
+  arena.alloc(16);
+  arena.release();
+  TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+void test_allocator_falls_back_to_heap()
+{
+  PsychicArena arena(256);
+  Headers inArena{PsychicArenaAllocator<HTTPHeader>(&arena)};
+  inArena.push_back(HTTPHeader());
+  TEST_ASSERT_TRUE(arena.owns(&inArena.front()));
+
+  Headers onHeap{PsychicArenaAllocator<HTTPHeader>(NULL)};
+  onHeap.push_back(HTTPHeader());
+  TEST_ASSERT_FALSE(arena.owns(&onHeap.front()));
+
+  // containers rebind the allocator to their node type, that has to keep the arena
+  TEST_ASSERT_TRUE(PsychicArenaAllocator<HTTPHeader>(&arena) == PsychicArenaAllocator<int>(&arena));
+  TEST_ASSERT_TRUE(PsychicArenaAllocator<HTTPHeader>(&arena) != PsychicArenaAllocator<int>(NULL));
+}
+
+void test_benchmark()
+{
+  PsychicArena arena;
+
+  // the first request takes the block, after that the connection does not touch the heap
+  size_t before = mallocs;
+  respond(&arena);
+  size_t firstRequest = mallocs - before;
+  before = mallocs;
+  respond(&arena);
+  size_t arenaRequest = mallocs - before;
+  before = mallocs;
+  respond(NULL);
+  size_t heapRequest = mallocs - before;
+
+  printf("mallocs for %d headers: first request %u, with arena %u, without arena %u\n", HEADERS,
+         (unsigned int)firstRequest, (unsigned int)arenaRequest, (unsigned int)heapRequest);
+  if (COUNTS_MALLOC)
+  {
+    TEST_ASSERT_EQUAL(1, firstRequest);
+    TEST_ASSERT_EQUAL(0, arenaRequest);
+    TEST_ASSERT_EQUAL(HEADERS * 3, heapRequest);
+  }
+
+  benchmark("response headers with arena", [&]()
+            { respond(&arena); });
+  benchmark("response headers on the heap", [&]()
+            { respond(NULL); });
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_alloc_is_aligned_and_owned);
+  RUN_TEST(test_overflow_chains_blocks);
+  RUN_TEST(test_reset_grows_block_after_overflow);
+  RUN_TEST(test_reset_grows_at_most_to_max_size);
+  RUN_TEST(test_release_resets_outermost);
+  RUN_TEST(test_allocator_falls_back_to_heap);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
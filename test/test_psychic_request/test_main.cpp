@@ -0,0 +1,204 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <Benchmark.h>
+
+// gets at the query scanner without a request around it
+class TestRequest : public PsychicRequest
+{
+public:
+    using PsychicRequest::_findParam;
+    using PsychicRequest::PsychicRequest;
+};
+
+static PsychicHttpServer *server;
+
+static bool findParam(const char *query, const char *name, char *value, size_t size)
+{
+    return TestRequest::_findParam(query, strlen(query), name, value, size);
+}
+
+void setUp()
+{
+    server = new PsychicHttpServer();
+}
+
+void tearDown()
+{
+    delete server;
+}
+
+void test_url_decode()
+{
+    char decoded[16];
+    const char *encoded = "a%20b+c%2Fd%zz%4";
+    TEST_ASSERT_TRUE(urlDecode(encoded, strlen(encoded), decoded, sizeof(decoded)));
+    // invalid and cut off escapes are kept as they are
+    TEST_ASSERT_EQUAL_STRING("a b c/d%zz%4", decoded);
+
+    TEST_ASSERT_EQUAL_STRING("a b c/d%zz%4", urlDecode(encoded).c_str());
+    TEST_ASSERT_EQUAL_STRING("", urlDecode("").c_str());
+}
+
+void test_url_decode_buffer_boundaries()
+{
+    char decoded[4];
+    memset(decoded, 'x', sizeof(decoded));
+
+    // three characters and the terminator fit exactly, escapes count once decoded
+    TEST_ASSERT_TRUE(urlDecode("a%41c", 5, decoded, 4));
+    TEST_ASSERT_EQUAL_STRING("aAc", decoded);
+
+    TEST_ASSERT_FALSE(urlDecode("abcd", 4, decoded, 4));
+    TEST_ASSERT_FALSE(urlDecode("a", 1, decoded, 0));
+
+    // only length bytes are decoded, the rest of the input is not looked at
+    TEST_ASSERT_TRUE(urlDecode("ab%41", 3, decoded, 4));
+    TEST_ASSERT_EQUAL_STRING("ab%", decoded);
+
+    TEST_ASSERT_TRUE(urlDecode("", 0, decoded, 1));
+    TEST_ASSERT_EQUAL_STRING("", decoded);
+}
+
+void test_find_param()
+{
+    char value[32];
+    const char *query = "first=1&na%6De=a%20b+c&empty=&flag&last=%26%3D";
+
+    TEST_ASSERT_TRUE(findParam(query, "first", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("1", value);
+
+    // names are compared decoded, values come out decoded
+    TEST_ASSERT_TRUE(findParam(query, "name", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("a b c", value);
+
+    TEST_ASSERT_TRUE(findParam(query, "empty", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("", value);
+    TEST_ASSERT_TRUE(findParam(query, "flag", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("", value);
+
+    TEST_ASSERT_TRUE(findParam(query, "last", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("&=", value);
+}
+
+void test_find_param_missing()
+{
+    char value[8] = "keep";
+    const char *query = "name=1&names=2&nam=3";
+
+    // prefixes of a name are not a match, neither are longer names
+    TEST_ASSERT_FALSE(findParam(query, "na", value, sizeof(value)));
+    TEST_ASSERT_FALSE(findParam(query, "namesake", value, sizeof(value)));
+    TEST_ASSERT_FALSE(findParam("", "name", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("keep", value);
+
+    TEST_ASSERT_TRUE(findParam(query, "names", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("2", value);
+    TEST_ASSERT_TRUE(findParam(query, "nam", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("3", value);
+}
+
+void test_find_param_truncated()
+{
+    char value[4];
+    TEST_ASSERT_FALSE(findParam("token=abcd", "token", value, sizeof(value)));
+    TEST_ASSERT_TRUE(findParam("token=abc", "token", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("abc", value);
+
+    // the decoded length is what has to fit
+    TEST_ASSERT_TRUE(findParam("token=%41%42%43", "token", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("ABC", value);
+}
+
+void test_get_param_from_uri()
+{
+    httpd_fake_request fake("/rest/events?id=42&name=hello%20world");
+    TestRequest request(server, &fake.req);
+
+    char value[16];
+    TEST_ASSERT_TRUE(request.getParam("name", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("hello world", value);
+    TEST_ASSERT_TRUE(request.getParam("id", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("42", value);
+
+    TEST_ASSERT_FALSE(request.getParam("missing", value, sizeof(value)));
+    TEST_ASSERT_FALSE(request.getParam("name", value, 8));
+}
+
+void test_get_param_falls_back_to_loaded_params()
+{
+    httpd_fake_request fake("/rest/settings", HTTP_POST);
+    fake.setBody("ssid=my+network&password=p%40ss", "application/x-www-form-urlencoded");
+    TestRequest request(server, &fake.req);
+
+    char value[16];
+    TEST_ASSERT_FALSE(request.getParam("ssid", value, sizeof(value)));
+
+    TEST_ASSERT_EQUAL(ESP_OK, request.loadBody());
+    request.loadParams();
+    TEST_ASSERT_TRUE(request.getParam("ssid", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("my network", value);
+    TEST_ASSERT_TRUE(request.getParam("password", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("p@ss", value);
+
+    TEST_ASSERT_FALSE(request.getParam("ssid", value, 10));
+}
+
+void test_benchmark()
+{
+    const char *query = "start=1700000000&end=1700086400&resolution=60&series=temperature%2Chumidity&access_token=eyJhbGciOiJIUzI1NiJ9";
+    size_t length = strlen(query);
+    char value[64];
+
+    benchmark("_findParam first", [&]
+              { benchmarkKeep(TestRequest::_findParam(query, length, "start", value, sizeof(value))); });
+    benchmark("_findParam last", [&]
+              { benchmarkKeep(TestRequest::_findParam(query, length, "access_token", value, sizeof(value))); });
+    benchmark("_findParam missing", [&]
+              { benchmarkKeep(TestRequest::_findParam(query, length, "missing", value, sizeof(value))); });
+
+    String uri = String("/rest/history?") + query;
+    httpd_fake_request fake(uri.c_str());
+    benchmark("getParam(name, buf, size)", [&]
+              {
+        TestRequest request(server, &fake.req);
+        benchmarkKeep(request.getParam("series", value, sizeof(value))); });
+    benchmark("loadParams + getParam(name)", [&]
+              {
+        TestRequest request(server, &fake.req);
+        request.loadParams();
+        benchmarkKeep(request.getParam("series")); });
+
+    const char *encoded = "temperature%2Chumidity%2Cpressure+and+more";
+    size_t encodedLength = strlen(encoded);
+    benchmark("urlDecode into buffer", [&]
+              { benchmarkKeep(urlDecode(encoded, encodedLength, value, sizeof(value))); });
+    benchmark("urlDecode to String", [&]
+              { benchmarkKeep(urlDecode(encoded)); });
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_url_decode);
+    RUN_TEST(test_url_decode_buffer_boundaries);
+    RUN_TEST(test_find_param);
+    RUN_TEST(test_find_param_missing);
+    RUN_TEST(test_find_param_truncated);
+    RUN_TEST(test_get_param_from_uri);
+    RUN_TEST(test_get_param_falls_back_to_loaded_params);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
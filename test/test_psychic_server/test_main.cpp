@@ -0,0 +1,201 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <Benchmark.h>
+
+// socket numbers no real descriptor has, closing them does nothing
+#define SOCKET 1000
+
+// gets at the client index and the idle connection reaper
+class TestServer : public PsychicHttpServer
+{
+public:
+  using PsychicHttpServer::_clientsBySocket;
+  using PsychicHttpServer::_reapIdleClients;
+  using PsychicHttpServer::_reapTimer;
+
+  // what the periodic timer does every idleTimeout / 4
+  void reap() { _reapTimer->args.callback(_reapTimer->args.arg); }
+};
+
+static TestServer *server;
+static std::vector<int> closed;
+
+static void open(int count)
+{
+  for (int i = 0; i < count; i++)
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_fake_open(server->server, SOCKET + i));
+}
+
+static bool isOpen(int socket)
+{
+  return httpd_fake_server_of(server->server)->sessions.count(socket) > 0;
+}
+
+void setUp()
+{
+  fakeMillis(0);
+  closed.clear();
+  server = new TestServer();
+  server->useHighConcurrencyProfile();
+  server->onClose([](PsychicClient *client)
+                  { closed.push_back(client->socket()); });
+  server->listen(80);
+}
+
+void tearDown()
+{
+  // deletes the server
+  server->stop();
+}
+
+void test_clients_by_socket()
+{
+  open(10);
+  TEST_ASSERT_EQUAL(10, server->count());
+  TEST_ASSERT_EQUAL(10, server->_clientsBySocket.size());
+  for (int i = 0; i < 10; i++)
+  {
+    PsychicClient *client = server->getClient(SOCKET + i);
+    TEST_ASSERT_NOT_NULL(client);
+    TEST_ASSERT_EQUAL(SOCKET + i, client->socket());
+  }
+  TEST_ASSERT_NULL(server->getClient(SOCKET + 10));
+
+  httpd_fake_close(server->server, SOCKET + 3);
+  TEST_ASSERT_EQUAL(1, closed.size());
+  TEST_ASSERT_EQUAL(SOCKET + 3, closed[0]);
+  TEST_ASSERT_FALSE(server->hasClient(SOCKET + 3));
+  TEST_ASSERT_EQUAL(9, server->count());
+  TEST_ASSERT_EQUAL(9, server->_clientsBySocket.size());
+  TEST_ASSERT_TRUE(server->hasClient(SOCKET + 4));
+
+  // lwIP hands out the number again, that is a new client
+  open(4);
+  TEST_ASSERT_EQUAL(10, server->count());
+  TEST_ASSERT_EQUAL(10, server->_clientsBySocket.size());
+  TEST_ASSERT_EQUAL(SOCKET + 3, server->getClient(SOCKET + 3)->socket());
+}
+
+// a socket the server already knows must not get a second client
+void test_open_callback_keeps_known_client()
+{
+  open(1);
+  PsychicClient *client = server->getClient(SOCKET);
+  PsychicHttpServer::openCallback(server->server, SOCKET);
+  TEST_ASSERT_EQUAL(1, server->count());
+  TEST_ASSERT_EQUAL(client, server->getClient(SOCKET));
+}
+
+void test_reaper_closes_idle_clients()
+{
+  open(4);
+  // 1 is in the middle of a request, 2 was upgraded to a websocket
+  server->getClient(SOCKET + 1)->beginRequest();
+  server->getClient(SOCKET + 2)->_friend = server;
+
+  // 3 was busy later on
+  advanceMillis(20000);
+  server->getClient(SOCKET + 3)->beginRequest();
+  server->getClient(SOCKET + 3)->endRequest();
+
+  // idle for exactly the timeout is not long enough yet
+  advanceMillis(PSYCHIC_IDLE_TIMEOUT - 20000);
+  server->reap();
+  TEST_ASSERT_EQUAL(0, closed.size());
+
+  advanceMillis(1);
+  server->reap();
+  TEST_ASSERT_EQUAL(1, closed.size());
+  TEST_ASSERT_EQUAL(SOCKET, closed[0]);
+  TEST_ASSERT_FALSE(isOpen(SOCKET));
+  TEST_ASSERT_FALSE(server->hasClient(SOCKET));
+
+  advanceMillis(20000);
+  server->reap();
+  TEST_ASSERT_EQUAL(2, closed.size());
+  TEST_ASSERT_EQUAL(SOCKET + 3, closed[1]);
+
+  // a finished request starts the timeout over
+  server->getClient(SOCKET + 1)->endRequest();
+  advanceMillis(PSYCHIC_IDLE_TIMEOUT);
+  server->reap();
+  TEST_ASSERT_EQUAL(2, closed.size());
+  advanceMillis(1);
+  server->reap();
+  TEST_ASSERT_EQUAL(3, closed.size());
+  TEST_ASSERT_EQUAL(SOCKET + 1, closed[2]);
+
+  TEST_ASSERT_TRUE(isOpen(SOCKET + 2));
+  TEST_ASSERT_EQUAL(1, server->count());
+  TEST_ASSERT_EQUAL(1, server->_clientsBySocket.size());
+}
+
+// one pass closes as many as there can be sockets, the next pass gets the rest
+void test_reaper_with_more_clients_than_sockets()
+{
+  open(CONFIG_LWIP_MAX_SOCKETS + 4);
+  advanceMillis(PSYCHIC_IDLE_TIMEOUT + 1);
+
+  TestServer::_reapIdleClients(server);
+  TEST_ASSERT_EQUAL(CONFIG_LWIP_MAX_SOCKETS, closed.size());
+  TEST_ASSERT_EQUAL(4, server->count());
+
+  TestServer::_reapIdleClients(server);
+  TEST_ASSERT_EQUAL(CONFIG_LWIP_MAX_SOCKETS + 4, closed.size());
+  TEST_ASSERT_EQUAL(0, server->count());
+  TEST_ASSERT_EQUAL(0, server->_clientsBySocket.size());
+  TEST_ASSERT_TRUE(httpd_fake_server_of(server->server)->sessions.empty());
+
+  // nothing left to do
+  TestServer::_reapIdleClients(server);
+}
+
+void test_no_reaper_without_idle_timeout()
+{
+  TestServer *plain = new TestServer();
+  plain->listen(81);
+  TEST_ASSERT_NULL(plain->_reapTimer);
+  plain->stop();
+
+  TEST_ASSERT_NOT_NULL(server->_reapTimer);
+  TEST_ASSERT_TRUE(server->_reapTimer->running);
+  TEST_ASSERT_EQUAL((uint64_t)PSYCHIC_IDLE_TIMEOUT * 1000 / 4, server->_reapTimer->period);
+}
+
+void test_benchmark()
+{
+  open(CONFIG_LWIP_MAX_SOCKETS);
+  int socket = SOCKET;
+  benchmark("server get client", [&]()
+            {
+    benchmarkKeep(server->getClient(socket));
+    socket = socket < SOCKET + CONFIG_LWIP_MAX_SOCKETS - 1 ? socket + 1 : SOCKET; });
+  benchmark("server reap idle clients, none idle", [&]()
+            { TestServer::_reapIdleClients(server); });
+  TEST_ASSERT_EQUAL(0, closed.size());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_clients_by_socket);
+  RUN_TEST(test_open_callback_keeps_known_client);
+  RUN_TEST(test_reaper_closes_idle_clients);
+  RUN_TEST(test_reaper_with_more_clients_than_sockets);
+  RUN_TEST(test_no_reaper_without_idle_timeout);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
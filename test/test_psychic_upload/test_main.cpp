@@ -0,0 +1,204 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <Benchmark.h>
+#include <random>
+
+#define BOUNDARY "----PsychicBoundary7MA4YWxk"
+
+// gives the benchmark the byte by byte parser the spans replace
+class TestUploadHandler : public PsychicUploadHandler
+{
+public:
+    void parseByteByByte(PsychicRequest *request, const std::string &body)
+    {
+        _request = request;
+        _boundary = BOUNDARY;
+        _delimiter = "\r\n--" BOUNDARY;
+        _parsedLength = 0;
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            _parseMultipartPostByte(body[i], i + 1 == body.size());
+            _parsedLength++;
+        }
+    }
+};
+
+struct Upload
+{
+    std::string file;
+    String filename;
+    size_t callbacks = 0;
+    bool indexOk = true;
+    bool finalSeen = false;
+};
+
+static PsychicHttpServer *server;
+
+static std::string multipartBody(const std::string &field, const std::string &file)
+{
+    return "--" BOUNDARY "\r\n"
+           "Content-Disposition: form-data; name=\"label\"\r\n"
+           "\r\n" +
+           field + "\r\n"
+                   "--" BOUNDARY "\r\n"
+                   "Content-Disposition: form-data; name=\"firmware\"; filename=\"firmware.bin\"\r\n"
+                   "Content-Type: application/octet-stream\r\n"
+                   "\r\n" +
+           file + "\r\n"
+                  "--" BOUNDARY "--\r\n";
+}
+
+// random bytes with plenty of \r, \n and - in them, so the parser keeps running into boundary look-alikes
+static std::string randomFile(size_t size, unsigned seed)
+{
+    static const char alphabet[] = "\r\n-abcdefPsychicBoundary";
+    std::mt19937 random(seed);
+    std::string file(size, 0);
+    for (char &c : file)
+    {
+        c = random() % 4 == 0 ? alphabet[random() % (sizeof(alphabet) - 1)] : (char)random();
+    }
+    return file;
+}
+
+static PsychicUploadCallback collect(Upload &upload)
+{
+    return [&upload](PsychicRequest *request, const String &filename, uint64_t index, uint8_t *data, size_t len, bool final)
+    {
+        upload.indexOk = upload.indexOk && index == upload.file.size() && !upload.finalSeen;
+        upload.file.append((const char *)data, len);
+        upload.filename = filename;
+        upload.callbacks++;
+        upload.finalSeen = upload.finalSeen || final;
+        return ESP_OK;
+    };
+}
+
+// uploads body in receive blocks of at most chunk bytes, returns the label field
+static String upload(const std::string &body, size_t chunk, Upload &result, esp_err_t *err = nullptr)
+{
+    httpd_fake_request fake("/rest/uploadFirmware", HTTP_POST);
+    fake.setBody(body, "multipart/form-data; boundary=" BOUNDARY);
+    fake.data.recvChunk = chunk;
+
+    PsychicUploadHandler handler;
+    handler.onUpload(collect(result));
+    PsychicRequest request(server, &fake.req);
+    esp_err_t handled = handler.handleRequest(&request);
+    if (err != nullptr)
+    {
+        *err = handled;
+    }
+
+    PsychicWebParameter *label = request.getParam("label");
+    return label != nullptr ? label->value() : String("<missing>");
+}
+
+void setUp()
+{
+    server = new PsychicHttpServer();
+}
+
+void tearDown()
+{
+    delete server;
+}
+
+void test_upload_in_one_block()
+{
+    std::string file = randomFile(3000, 1);
+    Upload result;
+    esp_err_t err;
+    TEST_ASSERT_EQUAL_STRING("hello", upload(multipartBody("hello", file), 0, result, &err).c_str());
+
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+    TEST_ASSERT_EQUAL(file.size(), result.file.size());
+    TEST_ASSERT_TRUE(result.file == file);
+    TEST_ASSERT_EQUAL_STRING("firmware.bin", result.filename.c_str());
+    TEST_ASSERT_TRUE(result.indexOk);
+    TEST_ASSERT_TRUE(result.finalSeen);
+}
+
+void test_boundary_split_across_blocks()
+{
+    // data that looks like the start of the delimiter right before the real one
+    std::string file = randomFile(200, 2) + "\r\n--" + std::string(BOUNDARY).substr(0, 10) + "\r\r\n-";
+    std::string field = "a\r\nb\r\n--c";
+    std::string body = multipartBody(field, file);
+
+    // every block size, so each delimiter gets cut at every possible position
+    for (size_t chunk = 1; chunk <= body.size(); chunk++)
+    {
+        Upload result;
+        String label = upload(body, chunk, result);
+        TEST_ASSERT_EQUAL_STRING(field.c_str(), label.c_str());
+        TEST_ASSERT_EQUAL(file.size(), result.file.size());
+        TEST_ASSERT_TRUE(result.file == file);
+        TEST_ASSERT_TRUE(result.indexOk);
+        TEST_ASSERT_TRUE(result.finalSeen);
+    }
+}
+
+void test_large_file_is_handed_over_in_chunks()
+{
+    std::string file = randomFile(5 * FILE_CHUNK_SIZE / 2, 3);
+    Upload result;
+    upload(multipartBody("large", file), 1460, result);
+
+    TEST_ASSERT_TRUE(result.file == file);
+    TEST_ASSERT_TRUE(result.indexOk);
+    TEST_ASSERT_EQUAL(3, result.callbacks);
+}
+
+void test_benchmark()
+{
+    const size_t size = 256 * 1024;
+    std::string body = multipartBody("benchmark", randomFile(size, 4));
+
+    // one operation is one byte of request body
+    BenchmarkResult spans = benchmark("multipart upload, spans (per byte)", [&]
+                                      {
+        Upload result;
+        upload(body, 1460, result);
+        benchmarkKeep(result.file.size()); }, body.size());
+
+    BenchmarkResult bytes = benchmark("multipart upload, byte parser (per byte)", [&]
+                                      {
+        httpd_fake_request fake("/rest/uploadFirmware", HTTP_POST);
+        fake.setBody(body, "multipart/form-data; boundary=" BOUNDARY);
+        PsychicRequest request(server, &fake.req);
+        Upload result;
+        TestUploadHandler handler;
+        handler.onUpload(collect(result));
+        handler.parseByteByByte(&request, body);
+        benchmarkKeep(result.file.size()); }, body.size());
+
+    printf("BENCH multipart upload: %.1f MB/s with spans, %.1f MB/s byte by byte\n", 1000.0 / spans.nsPerOperation,
+           1000.0 / bytes.nsPerOperation);
+}
+
+int main()
+{
+    // the handler logs every receive block
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_upload_in_one_block);
+    RUN_TEST(test_boundary_split_across_blocks);
+    RUN_TEST(test_large_file_is_handed_over_in_chunks);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,233 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <BufferedFileStream.cpp>
+#include <SettingsFile.cpp>
+
+#define PATH "/config/test.json"
+#define TRUNCATIONS 200
+
+static FS fileSystem;
+
+static void writeVersion(const char *path, int version, SettingsFormat format = SettingsFormat::JSON)
+{
+    JsonDocument doc;
+    doc["version"] = version;
+    doc["ssid"] = "greenhouse";
+    doc["password"] = "correct horse battery staple";
+    JsonArray relays = doc["relays"].to<JsonArray>();
+    for (int i = 0; i < 4; i++)
+    {
+        relays.add(version * 10 + i);
+    }
+    TEST_ASSERT_GREATER_THAN(0, SettingsFile::write(&fileSystem, path, doc, format));
+}
+
+static int readVersion(bool *recovered = nullptr, SettingsFormat format = SettingsFormat::JSON)
+{
+    JsonDocument doc;
+    if (!SettingsFile::read(&fileSystem, PATH, doc, recovered, format))
+    {
+        return -1;
+    }
+    TEST_ASSERT_EQUAL(doc["version"].as<int>() * 10 + 3, doc["relays"][3].as<int>());
+    return doc["version"];
+}
+
+static void truncate(const String &path, size_t size)
+{
+    fileSystem.files[path].resize(size);
+}
+
+void setUp()
+{
+    fileSystem = FS();
+    fileSystem.mkdir("/config");
+    srand(7);
+}
+
+void tearDown()
+{
+}
+
+void test_write_and_read()
+{
+    writeVersion(PATH, 1);
+    writeVersion(PATH, 2);
+    bool recovered = true;
+    TEST_ASSERT_EQUAL(2, readVersion(&recovered));
+    TEST_ASSERT_FALSE(recovered);
+    TEST_ASSERT_TRUE(fileSystem.exists(PATH SETTINGS_FILE_BACKUP_SUFFIX));
+    TEST_ASSERT_FALSE(fileSystem.exists(PATH SETTINGS_FILE_TMP_SUFFIX));
+}
+
+// a torn file falls back to the backup, unless only the footer is missing and the JSON is complete
+void test_truncated_file_reads_last_good_copy()
+{
+    writeVersion(PATH, 1);
+    writeVersion(PATH, 2);
+    std::vector<uint8_t> current = fileSystem.files[PATH];
+    size_t content = SettingsFile::contentLength((const char *)current.data(), current.size());
+    TEST_ASSERT_LESS_THAN(current.size(), content);
+
+    for (int i = 0; i < TRUNCATIONS; i++)
+    {
+        size_t size = rand() % current.size();
+        fileSystem.files[PATH] = current;
+        truncate(PATH, size);
+
+        bool recovered = false;
+        int version = readVersion(&recovered);
+        TEST_ASSERT_EQUAL_MESSAGE(size < content ? 1 : 2, version, ("truncated at " + std::to_string(size)).c_str());
+        TEST_ASSERT_EQUAL(size < content, recovered);
+    }
+}
+
+// power lost while the new version was written to the temporary file
+void test_truncated_temporary_file_is_ignored()
+{
+    writeVersion(PATH, 1);
+    writeVersion("/config/next.json", 2);
+    std::vector<uint8_t> next = fileSystem.files["/config/next.json"];
+
+    for (int i = 0; i < TRUNCATIONS; i++)
+    {
+        fileSystem.files[PATH SETTINGS_FILE_TMP_SUFFIX] = next;
+        truncate(PATH SETTINGS_FILE_TMP_SUFFIX, rand() % next.size());
+        bool recovered = true;
+        TEST_ASSERT_EQUAL(1, readVersion(&recovered));
+        TEST_ASSERT_FALSE(recovered);
+    }
+}
+
+// power lost between moving the file to the backup and renaming the temporary file into place
+void test_renamed_file_recovered_from_temporary_file()
+{
+    writeVersion(PATH, 1);
+    writeVersion("/config/next.json", 2);
+    std::vector<uint8_t> next = fileSystem.files["/config/next.json"];
+    size_t content = SettingsFile::contentLength((const char *)next.data(), next.size());
+    fileSystem.rename(PATH, PATH SETTINGS_FILE_BACKUP_SUFFIX);
+
+    for (int i = 0; i < TRUNCATIONS; i++)
+    {
+        size_t size = i == 0 ? next.size() : rand() % next.size();
+        fileSystem.files[PATH SETTINGS_FILE_TMP_SUFFIX] = next;
+        truncate(PATH SETTINGS_FILE_TMP_SUFFIX, size);
+        bool recovered = false;
+        TEST_ASSERT_EQUAL(size < content ? 1 : 2, readVersion(&recovered));
+        TEST_ASSERT_TRUE(recovered);
+    }
+}
+
+void test_flipped_bit_fails_crc()
+{
+    writeVersion(PATH, 1);
+    writeVersion(PATH, 2);
+    std::vector<uint8_t> current = fileSystem.files[PATH];
+    size_t content = SettingsFile::contentLength((const char *)current.data(), current.size());
+
+    // inside a string value, the JSON still parses
+    const char *password = strstr((const char *)current.data(), "horse");
+    TEST_ASSERT_NOT_NULL(password);
+    fileSystem.files[PATH][password - (const char *)current.data()] ^= 0x01;
+    TEST_ASSERT_LESS_THAN(content, (size_t)(password - (const char *)current.data()));
+    TEST_ASSERT_EQUAL(1, readVersion());
+}
+
+void test_truncated_msgpack_reads_last_good_copy()
+{
+    writeVersion(PATH, 1, SettingsFormat::MSGPACK);
+    writeVersion(PATH, 2, SettingsFormat::MSGPACK);
+    const char *path = "/config/test.msgpack";
+    std::vector<uint8_t> current = fileSystem.files[path];
+    size_t content = SettingsFile::contentLength((const char *)current.data(), current.size());
+
+    for (int i = 0; i < TRUNCATIONS; i++)
+    {
+        size_t size = rand() % current.size();
+        fileSystem.files[path] = current;
+        truncate(path, size);
+        TEST_ASSERT_EQUAL(size < content ? 1 : 2, readVersion(nullptr, SettingsFormat::MSGPACK));
+    }
+}
+
+void test_nothing_readable()
+{
+    TEST_ASSERT_EQUAL(-1, readVersion());
+    writeVersion(PATH, 1);
+    truncate(PATH, 10);
+    TEST_ASSERT_EQUAL(-1, readVersion());
+}
+
+// what WiFiSettingsService stores for a list of networks with static addresses
+static void wifiSettings(JsonDocument &doc, int networks)
+{
+    doc["hostname"] = "greenhouse-controller";
+    doc["connection_mode"] = 1;
+    JsonArray wifiNetworks = doc["wifi_networks"].to<JsonArray>();
+    for (int i = 0; i < networks; i++)
+    {
+        JsonObject wifiNetwork = wifiNetworks.add<JsonObject>();
+        wifiNetwork["ssid"] = String("greenhouse-") + i;
+        wifiNetwork["password"] = "correct horse battery staple";
+        wifiNetwork["static_ip_config"] = true;
+        wifiNetwork["local_ip"] = String("192.168.1.") + (100 + i);
+        wifiNetwork["gateway_ip"] = "192.168.1.1";
+        wifiNetwork["subnet_mask"] = "255.255.255.0";
+        wifiNetwork["dns_ip_1"] = "192.168.1.1";
+        wifiNetwork["dns_ip_2"] = "1.1.1.1";
+    }
+}
+
+static void benchmarkFormat(const char *loadName, const char *writeName, SettingsFormat format)
+{
+    JsonDocument doc;
+    wifiSettings(doc, 10);
+    size_t length = SettingsFile::write(&fileSystem, PATH, doc, format);
+    printf("%s: %u bytes\n", loadName, (unsigned int)length);
+
+    JsonDocument loaded;
+    TEST_ASSERT_TRUE(SettingsFile::read(&fileSystem, PATH, loaded, nullptr, format));
+    TEST_ASSERT_EQUAL(10, loaded["wifi_networks"].size());
+    TEST_ASSERT_EQUAL_STRING("greenhouse-9", loaded["wifi_networks"][9]["ssid"].as<const char *>());
+
+    benchmark(loadName, [&]()
+              {
+        JsonDocument boot;
+        benchmarkKeep(SettingsFile::read(&fileSystem, PATH, boot, nullptr, format)); });
+    benchmark(writeName, [&]()
+              { benchmarkKeep(SettingsFile::write(&fileSystem, PATH, doc, format)); });
+}
+
+void test_benchmark_wifi_networks()
+{
+    benchmarkFormat("settings load 10 networks JSON", "settings write 10 networks JSON", SettingsFormat::JSON);
+    benchmarkFormat("settings load 10 networks MessagePack", "settings write 10 networks MessagePack", SettingsFormat::MSGPACK);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_write_and_read);
+    RUN_TEST(test_truncated_file_reads_last_good_copy);
+    RUN_TEST(test_truncated_temporary_file_is_ignored);
+    RUN_TEST(test_renamed_file_recovered_from_temporary_file);
+    RUN_TEST(test_flipped_bit_fails_crc);
+    RUN_TEST(test_truncated_msgpack_reads_last_good_copy);
+    RUN_TEST(test_nothing_readable);
+    RUN_TEST(test_benchmark_wifi_networks);
+    return UNITY_END();
+}
@@ -0,0 +1,222 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#define SETTINGS_STORE_NVS
+
+#include <unity.h>
+#include <BufferedFileStream.cpp>
+#include <SettingsFile.cpp>
+#include <SettingsStore.cpp>
+
+#define PATH "/config/wifiSettings.json"
+
+static FS fileSystem;
+static NVSSettingsStore *store;
+
+static std::map<std::string, std::vector<uint8_t>> &stored()
+{
+    return nvs_fake.blobs[SETTINGS_STORE_NAMESPACE];
+}
+
+static JsonDocument settings(int version)
+{
+    JsonDocument doc;
+    doc["version"] = version;
+    doc["ssid"] = "greenhouse";
+    return doc;
+}
+
+static bool write(const char *path, int version, SettingsFormat format = SettingsFormat::JSON)
+{
+    JsonDocument doc = settings(version);
+    return store->write(path, doc, format);
+}
+
+static int read(const char *path, bool *recovered, SettingsFormat format = SettingsFormat::JSON)
+{
+    JsonDocument doc;
+    if (!store->read(path, doc, recovered, format))
+    {
+        return -1;
+    }
+    TEST_ASSERT_EQUAL_STRING("greenhouse", doc["ssid"].as<const char *>());
+    return doc["version"];
+}
+
+static void writeFile(const char *path, int version, SettingsFormat format = SettingsFormat::JSON)
+{
+    JsonDocument doc = settings(version);
+    TEST_ASSERT_GREATER_THAN(0, SettingsFile::write(&fileSystem, path, doc, format));
+}
+
+void setUp()
+{
+    fileSystem = FS();
+    fileSystem.mkdir("/config");
+    nvs_fake = esp_fake_nvs();
+    store = new NVSSettingsStore(&fileSystem);
+}
+
+void tearDown()
+{
+    delete store;
+}
+
+void test_write_and_read()
+{
+    bool recovered = true;
+    TEST_ASSERT_EQUAL(-1, read(PATH, &recovered));
+    TEST_ASSERT_FALSE(recovered);
+
+    TEST_ASSERT_TRUE(write(PATH, 1));
+    TEST_ASSERT_TRUE(write(PATH, 2));
+    TEST_ASSERT_EQUAL(2, read(PATH, &recovered));
+    TEST_ASSERT_FALSE(recovered);
+    TEST_ASSERT_EQUAL(2, nvs_fake.commits);
+    TEST_ASSERT_TRUE(fileSystem.files.empty());
+
+    TEST_ASSERT_TRUE(write("/config/mqtt.json", 3, SettingsFormat::MSGPACK));
+    TEST_ASSERT_EQUAL(3, read("/config/mqtt.json", &recovered, SettingsFormat::MSGPACK));
+}
+
+void test_keys_of_config_files_are_their_names()
+{
+    TEST_ASSERT_TRUE(write(PATH, 1));
+    TEST_ASSERT_TRUE(write("/config/ntpSettings.json", 1));
+    TEST_ASSERT_EQUAL(2, stored().size());
+    TEST_ASSERT_EQUAL(1, stored().count("wifiSettings"));
+    TEST_ASSERT_EQUAL(1, stored().count("ntpSettings"));
+}
+
+// keys have at most 15 characters, longer names still get keys of their own
+void test_long_names_are_hashed()
+{
+    const char *first = "/config/securitySettingsPrimary.json";
+    const char *second = "/config/securitySettingsBackup.json";
+    TEST_ASSERT_TRUE(write(first, 1));
+    TEST_ASSERT_TRUE(write(second, 2));
+    TEST_ASSERT_EQUAL(2, stored().size());
+    for (auto &entry : stored())
+    {
+        TEST_ASSERT_EQUAL(NVS_KEY_NAME_MAX_SIZE - 2, entry.first.length());
+        TEST_ASSERT_EQUAL(0, entry.first.compare(0, 6, "securi"));
+    }
+
+    bool recovered;
+    TEST_ASSERT_EQUAL(1, read(first, &recovered));
+    TEST_ASSERT_EQUAL(2, read(second, &recovered));
+}
+
+// the same name in another directory must not overwrite the settings in /config
+void test_other_directories_are_hashed()
+{
+    TEST_ASSERT_TRUE(write(PATH, 1));
+    TEST_ASSERT_TRUE(write("/data/wifiSettings.json", 2));
+    TEST_ASSERT_TRUE(write("/config/sub/wifiSettings.json", 3));
+    TEST_ASSERT_TRUE(write("/wifiSettings.json", 4));
+    TEST_ASSERT_EQUAL(4, stored().size());
+
+    bool recovered;
+    TEST_ASSERT_EQUAL(1, read(PATH, &recovered));
+    TEST_ASSERT_EQUAL(2, read("/data/wifiSettings.json", &recovered));
+    TEST_ASSERT_EQUAL(3, read("/config/sub/wifiSettings.json", &recovered));
+    TEST_ASSERT_EQUAL(4, read("/wifiSettings.json", &recovered));
+}
+
+void test_migration_removes_files()
+{
+    writeFile(PATH, 1);
+    writeFile(PATH, 2);
+    TEST_ASSERT_TRUE(fileSystem.exists(PATH SETTINGS_FILE_BACKUP_SUFFIX));
+
+    // the file is only read, FSPersistence writes recovered settings back
+    bool recovered = false;
+    TEST_ASSERT_EQUAL(2, read(PATH, &recovered));
+    TEST_ASSERT_TRUE(recovered);
+    TEST_ASSERT_TRUE(fileSystem.exists(PATH));
+
+    TEST_ASSERT_TRUE(write(PATH, 2));
+    TEST_ASSERT_TRUE(fileSystem.files.empty());
+    TEST_ASSERT_EQUAL(2, read(PATH, &recovered));
+    TEST_ASSERT_FALSE(recovered);
+}
+
+void test_migration_removes_json_and_msgpack_files()
+{
+    writeFile(PATH, 1);
+    writeFile("/config/mqtt.json", 2, SettingsFormat::MSGPACK);
+
+    bool recovered = false;
+    TEST_ASSERT_EQUAL(1, read(PATH, &recovered, SettingsFormat::MSGPACK));
+    TEST_ASSERT_TRUE(recovered);
+    TEST_ASSERT_EQUAL(2, read("/config/mqtt.json", &recovered, SettingsFormat::MSGPACK));
+    TEST_ASSERT_TRUE(recovered);
+
+    TEST_ASSERT_TRUE(write(PATH, 1, SettingsFormat::MSGPACK));
+    TEST_ASSERT_TRUE(write("/config/mqtt.json", 2, SettingsFormat::MSGPACK));
+    TEST_ASSERT_TRUE(fileSystem.files.empty());
+}
+
+// the files stay until NVS really holds the settings
+void test_failed_migration_keeps_files()
+{
+    writeFile(PATH, 1);
+    bool recovered = false;
+    TEST_ASSERT_EQUAL(1, read(PATH, &recovered));
+
+    nvs_fake.full = true;
+    TEST_ASSERT_FALSE(write(PATH, 1));
+    TEST_ASSERT_TRUE(fileSystem.exists(PATH));
+
+    nvs_fake.full = false;
+    TEST_ASSERT_TRUE(write(PATH, 1));
+    TEST_ASSERT_FALSE(fileSystem.exists(PATH));
+}
+
+// settings that never came from a file leave the file system alone
+void test_write_without_migration_keeps_files()
+{
+    writeFile(PATH, 1);
+    TEST_ASSERT_TRUE(write(PATH, 2));
+    TEST_ASSERT_TRUE(fileSystem.exists(PATH));
+
+    bool recovered = true;
+    TEST_ASSERT_EQUAL(2, read(PATH, &recovered));
+    TEST_ASSERT_FALSE(recovered);
+}
+
+void test_erase()
+{
+    TEST_ASSERT_TRUE(write(PATH, 1));
+    TEST_ASSERT_TRUE(write("/data/wifiSettings.json", 2));
+    store->erase();
+    TEST_ASSERT_TRUE(stored().empty());
+
+    bool recovered;
+    TEST_ASSERT_EQUAL(-1, read(PATH, &recovered));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_write_and_read);
+    RUN_TEST(test_keys_of_config_files_are_their_names);
+    RUN_TEST(test_long_names_are_hashed);
+    RUN_TEST(test_other_directories_are_hashed);
+    RUN_TEST(test_migration_removes_files);
+    RUN_TEST(test_migration_removes_json_and_msgpack_files);
+    RUN_TEST(test_failed_migration_keeps_files);
+    RUN_TEST(test_write_without_migration_keeps_files);
+    RUN_TEST(test_erase);
+    return UNITY_END();
+}
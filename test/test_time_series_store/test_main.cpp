@@ -0,0 +1,248 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <Benchmark.h>
+#include <TimeSeriesStore.cpp>
+#include <vector>
+
+#define CHANNELS 4
+#define START 1700000000
+#define SHARE 35
+
+struct Sample
+{
+    uint32_t timestamp;
+    float values[CHANNELS];
+};
+
+static FS fileSystem;
+
+// jittered timestamps with a gap every 500 samples, noise, steps, negative and missing values
+static Sample sample(int i)
+{
+    Sample sample;
+    sample.timestamp = START + i * 10 + (i % 7 == 0) - (i % 11 == 0) + (i / 500) * 3600;
+    sample.values[0] = 21.5f + sinf(i / 50.0f) * 3 + (rand() % 100) / 100.0f;
+    sample.values[1] = i % 97 == 0 ? NAN : 6.2f - i * 0.001f;
+    sample.values[2] = i % 300 < 150 ? -40.0f : 1000.25f;
+    sample.values[3] = (float)(i % 4000) * 100;
+    return sample;
+}
+
+static std::vector<Sample> appendSamples(TimeSeriesStore &store, int count)
+{
+    std::vector<Sample> samples;
+    for (int i = 0; i < count; i++)
+    {
+        Sample s = sample(i);
+        TEST_ASSERT_TRUE(store.append(s.timestamp, s.values));
+        samples.push_back(s);
+    }
+    return samples;
+}
+
+static std::vector<Sample> query(TimeSeriesStore &store, uint32_t from, uint32_t to)
+{
+    std::vector<Sample> samples;
+    store.query(from, to, [&](uint32_t timestamp, const float *values)
+                {
+        Sample s;
+        s.timestamp = timestamp;
+        memcpy(s.values, values, sizeof(s.values));
+        samples.push_back(s);
+        return true; });
+    return samples;
+}
+
+// values are stored as fixed point with 1 / TIMESERIES_VALUE_SCALE resolution
+static void assertSamples(const Sample *expected, const std::vector<Sample> &actual, size_t count)
+{
+    TEST_ASSERT_EQUAL(count, actual.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].timestamp, actual[i].timestamp);
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            if (isnan(expected[i].values[c]))
+            {
+                TEST_ASSERT_TRUE(isnan(actual[i].values[c]));
+            }
+            else
+            {
+                TEST_ASSERT_FLOAT_WITHIN(0.5f / TIMESERIES_VALUE_SCALE + 1e-3f, expected[i].values[c], actual[i].values[c]);
+            }
+        }
+    }
+}
+
+void setUp()
+{
+    fileSystem = FS();
+    FSUsage::totalBytes = 131072;
+    srand(42);
+}
+
+void tearDown()
+{
+}
+
+void test_round_trip()
+{
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+    store.begin();
+    std::vector<Sample> samples = appendSamples(store, 2000);
+    TEST_ASSERT_TRUE(store.sync());
+
+    assertSamples(samples.data(), query(store, 0, UINT32_MAX), samples.size());
+    TEST_ASSERT_EQUAL_UINT32(samples.front().timestamp, store.firstTimestamp());
+    TEST_ASSERT_EQUAL_UINT32(samples.back().timestamp, store.lastTimestamp());
+}
+
+void test_round_trip_after_restart()
+{
+    std::vector<Sample> samples;
+    {
+        TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+        store.begin();
+        samples = appendSamples(store, 1234);
+        TEST_ASSERT_TRUE(store.sync());
+    }
+
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+    store.begin();
+    assertSamples(samples.data(), query(store, 0, UINT32_MAX), samples.size());
+
+    // continues behind the last sample and rejects older ones
+    Sample next = sample(1234);
+    TEST_ASSERT_FALSE(store.append(samples.back().timestamp, next.values));
+    TEST_ASSERT_TRUE(store.append(next.timestamp, next.values));
+    samples.push_back(next);
+    assertSamples(samples.data(), query(store, 0, UINT32_MAX), samples.size());
+}
+
+void test_query_range()
+{
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+    store.begin();
+    std::vector<Sample> samples = appendSamples(store, 1500);
+    TEST_ASSERT_TRUE(store.sync());
+
+    uint32_t from = samples[321].timestamp;
+    uint32_t to = samples[987].timestamp;
+    assertSamples(&samples[321], query(store, from, to), 987 - 321 + 1);
+    TEST_ASSERT_EQUAL(0, query(store, 0, START - 1).size());
+}
+
+void test_oldest_segments_rotated_out()
+{
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+    store.begin();
+    std::vector<Sample> samples = appendSamples(store, 30000);
+    TEST_ASSERT_TRUE(store.sync());
+
+    size_t budget = FSUsage::budget(SHARE);
+    TEST_ASSERT_LESS_OR_EQUAL(budget, fileSystem.used());
+    TEST_ASSERT_LESS_OR_EQUAL(budget, store.flashBytes());
+
+    // the newest samples are complete
+    std::vector<Sample> kept = query(store, 0, UINT32_MAX);
+    TEST_ASSERT_GREATER_THAN(1000, kept.size());
+    assertSamples(&samples[samples.size() - kept.size()], kept, kept.size());
+    TEST_ASSERT_EQUAL_UINT32(kept.front().timestamp, store.firstTimestamp());
+}
+
+void test_full_file_system_drops_oldest_segment()
+{
+    // the budget would allow more than fits
+    fileSystem.capacity = 3 * TIMESERIES_SEGMENT_BLOCKS * TIMESERIES_BLOCK_SIZE;
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, 100);
+    store.begin();
+    std::vector<Sample> samples = appendSamples(store, 10000);
+    TEST_ASSERT_TRUE(store.sync());
+
+    std::vector<Sample> kept = query(store, 0, UINT32_MAX);
+    TEST_ASSERT_GREATER_THAN(0, kept.size());
+    TEST_ASSERT_EQUAL_UINT32(samples.back().timestamp, kept.back().timestamp);
+    TEST_ASSERT_EQUAL_UINT32(kept.front().timestamp, store.firstTimestamp());
+}
+
+// append rate, query latency and the flash a sample takes, compared to a plain record of it
+void test_benchmark()
+{
+    const int count = 5000;
+    FSUsage::totalBytes = 4 * 1024 * 1024;
+    std::vector<Sample> samples;
+    for (int i = 0; i < count; i++)
+    {
+        samples.push_back(sample(i));
+    }
+
+    {
+        TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+        store.begin();
+        for (const Sample &s : samples)
+        {
+            TEST_ASSERT_TRUE(store.append(s.timestamp, s.values));
+        }
+        TEST_ASSERT_TRUE(store.sync());
+
+        float bytesPerSample = (float)fileSystem.used() / count;
+        printf("BENCH %-44s %12.2f bytes/sample %10u raw\n", "timeseries flash", bytesPerSample, (unsigned)sizeof(Sample));
+        TEST_ASSERT_LESS_THAN(sizeof(Sample), bytesPerSample);
+
+        size_t visited = 0;
+        benchmark("timeseries query all (per sample)", [&]()
+                  {
+            visited = 0;
+            store.query(0, UINT32_MAX, [&](uint32_t timestamp, const float *values)
+                        {
+                visited++;
+                return true; }); }, count);
+        TEST_ASSERT_EQUAL(count, visited);
+
+        // a chart of the last hour, 10 s apart
+        uint32_t from = samples[count - 360].timestamp;
+        benchmark("timeseries query last hour", [&]()
+                  {
+            visited = 0;
+            store.query(from, UINT32_MAX, [&](uint32_t timestamp, const float *values)
+                        {
+                visited++;
+                return true; }); });
+        TEST_ASSERT_EQUAL(360, visited);
+    }
+
+    fileSystem = FS();
+    TimeSeriesStore store(&fileSystem, "/history", CHANNELS, SHARE);
+    store.begin();
+    uint32_t i = 0;
+    bool appended = true;
+    benchmark("timeseries append", [&]()
+              {
+        appended &= store.append(START + i * 10, samples[i % count].values);
+        i++; });
+    TEST_ASSERT_TRUE(appended);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_round_trip_after_restart);
+    RUN_TEST(test_query_range);
+    RUN_TEST(test_oldest_segments_rotated_out);
+    RUN_TEST(test_full_file_system_drops_oldest_segment);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
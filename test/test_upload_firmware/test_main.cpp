@@ -0,0 +1,173 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <unity.h>
+#include <PsychicHttpSources.h>
+#include <DeltaPatcher.cpp>
+#include <EventLog.cpp>
+#include <UploadFirmwareService.cpp>
+#include <future>
+
+#define BUFFER OTA_PIPELINE_BUFFER_SIZE
+#define SEGMENT 1436 // what a TCP segment brings
+
+// gets at the receive -> flash pipeline
+class TestService : public UploadFirmwareService
+{
+public:
+    TestService() : UploadFirmwareService(nullptr, nullptr) {}
+
+    using UploadFirmwareService::beginPipeline;
+    using UploadFirmwareService::endPipeline;
+    using UploadFirmwareService::handleEarlyDisconnect;
+    using UploadFirmwareService::pipelineWrite;
+};
+
+static TestService *service;
+static std::string firmware;
+
+// hands the firmware over the way the upload handler gets it
+static bool receive(size_t from, size_t to)
+{
+    for (size_t offset = from; offset < to; offset += SEGMENT)
+    {
+        if (!service->pipelineWrite((const uint8_t *)firmware.data() + offset, min((size_t)SEGMENT, to - offset)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void setUp()
+{
+    firmware.resize(10 * BUFFER + 100);
+    for (size_t i = 0; i < firmware.size(); i++)
+    {
+        firmware[i] = (char)(i * 7 + i / 251);
+    }
+    sha256[0] = '\0';
+    service = new TestService();
+    Update.begin(firmware.size());
+}
+
+void tearDown()
+{
+    delete service;
+}
+
+void test_pipeline_writes_whole_buffers()
+{
+    TEST_ASSERT_TRUE(service->beginPipeline());
+    TEST_ASSERT_TRUE(receive(0, firmware.size()));
+    TEST_ASSERT_TRUE(service->endPipeline());
+
+    // the rest goes out when the pipeline ends
+    TEST_ASSERT_EQUAL(11, Update.writes);
+    TEST_ASSERT_TRUE(Update.image == firmware);
+    TEST_ASSERT_FALSE(Update.writerIsCaller);
+    TEST_ASSERT_EQUAL(firmware.size(), otaBytes);
+    TEST_ASSERT_NULL(pipelineBuffers[0]);
+    TEST_ASSERT_NULL(fillBuffer);
+    TEST_ASSERT_TRUE(Update.end());
+}
+
+// one buffer is filled while the other one is written, the next one has to wait for the flash
+void test_receiving_overlaps_flash_write()
+{
+    std::promise<void> flashDone;
+    std::shared_future<void> flash = flashDone.get_future().share();
+    Update.onWrite = [flash]()
+    { flash.wait(); };
+
+    TEST_ASSERT_TRUE(service->beginPipeline());
+    // the first buffer is with the writer, the second one is full up to its last byte
+    TEST_ASSERT_TRUE(receive(0, 2 * BUFFER - 1));
+    TEST_ASSERT_EQUAL(0, Update.writes);
+
+    std::atomic<bool> received(false);
+    std::thread receiver([&]()
+                         {
+        receive(2 * BUFFER - 1, firmware.size());
+        received = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TEST_ASSERT_FALSE(received);
+
+    flashDone.set_value();
+    receiver.join();
+    TEST_ASSERT_TRUE(received);
+    TEST_ASSERT_TRUE(service->endPipeline());
+    TEST_ASSERT_TRUE(Update.image == firmware);
+}
+
+void test_sha256_of_received_data()
+{
+    unsigned char digest[32];
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts_ret(&context, 0);
+    mbedtls_sha256_update_ret(&context, (const unsigned char *)firmware.data(), firmware.size());
+    mbedtls_sha256_finish_ret(&context, digest);
+    for (int i = 0; i < 32; i++)
+    {
+        sprintf(sha256 + 2 * i, "%02x", digest[i]);
+    }
+
+    TEST_ASSERT_TRUE(service->beginPipeline());
+    TEST_ASSERT_TRUE(receive(0, firmware.size()));
+    TEST_ASSERT_TRUE(service->endPipeline());
+
+    unsigned char received[32];
+    mbedtls_sha256_finish_ret(&sha256Context, received);
+    TEST_ASSERT_EQUAL_MEMORY(digest, received, 32);
+}
+
+// the writer keeps the buffers moving after a failed write, so the receiver notices instead of hanging
+void test_flash_error_stops_pipeline()
+{
+    Update.failAt = 2 * BUFFER;
+    TEST_ASSERT_TRUE(service->beginPipeline());
+    TEST_ASSERT_FALSE(receive(0, firmware.size()));
+    TEST_ASSERT_FALSE(service->pipelineWrite((const uint8_t *)firmware.data(), 1));
+    TEST_ASSERT_FALSE(service->endPipeline());
+
+    TEST_ASSERT_EQUAL(2, Update.writes);
+    TEST_ASSERT_TRUE(Update.hasError());
+    TEST_ASSERT_NULL(fillBuffer);
+    TEST_ASSERT_NULL(fullBuffers);
+}
+
+void test_disconnect_aborts_update()
+{
+    TEST_ASSERT_TRUE(service->beginPipeline());
+    TEST_ASSERT_TRUE(receive(0, 3 * BUFFER / 2));
+    TEST_ASSERT_EQUAL(ESP_OK, service->handleEarlyDisconnect());
+
+    // what was received up to then was written before the update was dropped
+    TEST_ASSERT_EQUAL(3 * BUFFER / 2, Update.image.size());
+    TEST_ASSERT_TRUE(Update.aborted);
+    TEST_ASSERT_NULL(fillBuffer);
+    TEST_ASSERT_NULL(pipelineBuffers[1]);
+    TEST_ASSERT_FALSE(service->pipelineWrite((const uint8_t *)firmware.data(), 1));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pipeline_writes_whole_buffers);
+    RUN_TEST(test_receiving_overlaps_flash_write);
+    RUN_TEST(test_sha256_of_received_data);
+    RUN_TEST(test_flash_error_stops_pipeline);
+    RUN_TEST(test_disconnect_aborts_update);
+    return UNITY_END();
+}